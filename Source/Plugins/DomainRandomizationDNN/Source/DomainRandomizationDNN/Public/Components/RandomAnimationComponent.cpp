@@ -6,13 +6,13 @@
 
 #include "DomainRandomizationDNNPCH.h"
 #include "RandomAnimationComponent.h"
+#include "NVRandomizationLog.h"
 #include "Animation/AnimSequence.h"
 #include "AssetRegistryModule.h"
 
 // Sets default values
 URandomAnimationComponent::URandomAnimationComponent()
 {
-    CountdownUntilNextRandomization = 0.f;
     TimeWaitAfterEachAnimation = 0.f;
     CurrentAnimation = nullptr;
 }
@@ -70,16 +70,16 @@ void URandomAnimationComponent::OnRandomization_Implementation()
     UAnimSequence* RandAnim = CurrentAnimation;
     while (RandAnim == CurrentAnimation && RandomAnimList.Num() > 1)
     {
-        RandAnim = RandomAnimList[FMath::Rand() % RandomAnimList.Num()];
+        RandAnim = RandomAnimList[GetRandomStream().RandHelper(RandomAnimList.Num())];
         if (bUseAllAnimationsInAFolder)
         {
-            int32 RandIndex = FMath::Rand() % AnimCount;
+            int32 RandIndex = GetRandomStream().RandHelper(AnimCount);
             FSoftObjectPath& RandomAsset = FolderAnimSequenceReferences[RandIndex];
             RandAnim = Cast<UAnimSequence>(RandomAsset.ResolveObject());
         }
         else
         {
-            RandAnim = RandomAnimList[FMath::Rand() % AnimCount];
+            RandAnim = RandomAnimList[GetRandomStream().RandHelper(AnimCount)];
         }
     }
 
@@ -96,6 +96,33 @@ void URandomAnimationComponent::OnFinishedRandomization()
     {
         const float AnimPlayLength = CurrentAnimation->GetPlayLength();
         static const float MinAnimTime = 1.f;
-        CountdownUntilNextRandomization = FMath::Max(AnimPlayLength, MinAnimTime) + TimeWaitAfterEachAnimation;
+        StartRandomizationCountdown(FMath::Max(AnimPlayLength, MinAnimTime) + TimeWaitAfterEachAnimation);
+    }
+}
+
+void URandomAnimationComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    USkeletalMeshComponent* OwnerSkeletalMeshComp = OwnerActor ? Cast<USkeletalMeshComponent>(OwnerActor->GetComponentByClass(USkeletalMeshComponent::StaticClass())) : nullptr;
+    if (!OwnerSkeletalMeshComp)
+    {
+        return;
+    }
+
+    UAnimSequence* LoggedAnimation = CurrentAnimation;
+    float AnimationPosition = CurrentAnimation ? OwnerSkeletalMeshComp->GetPosition() : 0.f;
+    FNVRandomizationLog::SerializeObjectReference(Ar, LoggedAnimation);
+    Ar << AnimationPosition;
+    if (Ar.IsLoading() && LoggedAnimation)
+    {
+        if (LoggedAnimation != CurrentAnimation)
+        {
+            OwnerSkeletalMeshComp->PlayAnimation(LoggedAnimation, false);
+            CurrentAnimation = LoggedAnimation;
+        }
+        OwnerSkeletalMeshComp->SetPosition(AnimationPosition, false);
+        // Update the pose right away, the skeletal mesh already ticked this frame
+        OwnerSkeletalMeshComp->TickAnimation(0.f, false);
+        OwnerSkeletalMeshComp->RefreshBoneTransforms();
     }
 }
@@ -91,6 +91,7 @@ public: // Editor properties
 protected:
     virtual void OnRandomization_Implementation() override;
     virtual void OnFinishedRandomization() override;
+    virtual void SerializeRandomizationState(FArchive& Ar) override;
 
 protected:
     UPROPERTY(Transient)
@@ -30,19 +30,57 @@ void URandomLightComponent::OnRandomization_Implementation()
 
             if (bShouldModifyIntensity)
             {
-                float RandIntensity = FMath::RandRange(IntensityRange.Min, IntensityRange.Max);
+                float RandIntensity = GetRandomStream().FRandRange(IntensityRange.Min, IntensityRange.Max);
                 LightComp->SetIntensity(RandIntensity);
             }
 
             if (bShouldModifyColor)
             {
-                FLinearColor RandomColor = ColorData.GetRandomColor();
+                FLinearColor RandomColor = ColorData.GetRandomColor(GetRandomStream());
                 LightComp->SetLightColor(RandomColor);
             }
         }
     }
 }
 
+void URandomLightComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        TArray<ULightComponent*> RandLightCompList;
+        OwnerActor->GetComponents(RandLightCompList);
+
+        for (ULightComponent* LightComp : RandLightCompList)
+        {
+            if (!LightComp)
+            {
+                continue;
+            }
+
+            if (bShouldModifyIntensity)
+            {
+                float LightIntensity = LightComp->Intensity;
+                Ar << LightIntensity;
+                if (Ar.IsLoading())
+                {
+                    LightComp->SetIntensity(LightIntensity);
+                }
+            }
+
+            if (bShouldModifyColor)
+            {
+                FLinearColor LightColor = LightComp->GetLightColor();
+                Ar << LightColor;
+                if (Ar.IsLoading())
+                {
+                    LightComp->SetLightColor(LightColor);
+                }
+            }
+        }
+    }
+}
+
 #if WITH_EDITORONLY_DATA
 void URandomLightComponent::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
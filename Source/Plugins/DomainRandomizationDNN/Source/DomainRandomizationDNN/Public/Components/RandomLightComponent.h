@@ -44,4 +44,5 @@ protected:
 #endif //WITH_EDITORONLY_DATA
 
     void OnRandomization_Implementation() override;
+    void SerializeRandomizationState(FArchive& Ar) override;
 };
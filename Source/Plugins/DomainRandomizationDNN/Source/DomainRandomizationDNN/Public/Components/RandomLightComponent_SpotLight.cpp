@@ -35,15 +35,56 @@ void URandomLightComponent_SpotLight::OnRandomization_Implementation()
 
             if (bShouldModifyInnerConeAngle)
             {
-                float RandInnerConeAngle = FMath::RandRange(InnerConeAngleRange.Min, InnerConeAngleRange.Max);
+                float RandInnerConeAngle = GetRandomStream().FRandRange(InnerConeAngleRange.Min, InnerConeAngleRange.Max);
                 SpotLightComp->SetInnerConeAngle(RandInnerConeAngle);
             }
 
             if (bShouldModifyOuterConeAngle)
             {
-                float RandOuterConeAngle = FMath::RandRange(OuterConeAngleRange.Min, OuterConeAngleRange.Max);
+                float RandOuterConeAngle = GetRandomStream().FRandRange(OuterConeAngleRange.Min, OuterConeAngleRange.Max);
                 SpotLightComp->SetOuterConeAngle(RandOuterConeAngle);
             }
         }
     }
 }
+
+void URandomLightComponent_SpotLight::SerializeRandomizationState(FArchive& Ar)
+{
+    Super::SerializeRandomizationState(Ar);
+
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        TArray<ULightComponent*> RandLightCompList;
+        OwnerActor->GetComponents(RandLightCompList);
+
+        for (ULightComponent* LightComp : RandLightCompList)
+        {
+            USpotLightComponent* SpotLightComp = Cast<USpotLightComponent>(LightComp);
+            if (!SpotLightComp)
+            {
+                continue;
+            }
+
+            if (bShouldModifyInnerConeAngle)
+            {
+                float InnerConeAngle = SpotLightComp->InnerConeAngle;
+                Ar << InnerConeAngle;
+                if (Ar.IsLoading())
+                {
+                    SpotLightComp->SetInnerConeAngle(InnerConeAngle);
+                }
+            }
+
+            if (bShouldModifyOuterConeAngle)
+            {
+                float OuterConeAngle = SpotLightComp->OuterConeAngle;
+                Ar << OuterConeAngle;
+                if (Ar.IsLoading())
+                {
+                    SpotLightComp->SetOuterConeAngle(OuterConeAngle);
+                }
+            }
+        }
+    }
+}
@@ -41,4 +41,5 @@ protected: // Editor properties
 
 protected:
     void OnRandomization_Implementation() override;
+    void SerializeRandomizationState(FArchive& Ar) override;
 };
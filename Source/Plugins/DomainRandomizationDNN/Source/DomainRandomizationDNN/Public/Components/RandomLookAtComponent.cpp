@@ -29,7 +29,7 @@ void URandomLookAtComponent::OnRandomization_Implementation()
         return;
     }
 
-    AActor* NewFocalTarget = FocalTargetActors[FMath::Rand() % FocalTargetActors.Num()];
+    AActor* NewFocalTarget = FocalTargetActors[GetRandomStream().RandHelper(FocalTargetActors.Num())];
     if (NewFocalTarget)
     {
         CurrentFocalTarget = NewFocalTarget;
@@ -59,3 +59,18 @@ void URandomLookAtComponent::TickComponent(float DeltaTime, enum ELevelTick Tick
         }
     }
 }
+
+void URandomLookAtComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    // NOTE: The owner turn toward the focal target over multiple frames, so its rotation is logged rather than the chosen target
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        FQuat OwnerRotation = OwnerActor->GetActorQuat();
+        Ar << OwnerRotation;
+        if (Ar.IsLoading())
+        {
+            OwnerActor->SetActorRotation(OwnerRotation);
+        }
+    }
+}
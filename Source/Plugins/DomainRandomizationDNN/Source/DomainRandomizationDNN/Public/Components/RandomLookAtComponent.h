@@ -33,6 +33,7 @@ protected:
     virtual void BeginPlay() override;
     virtual void OnRandomization_Implementation() override;
     virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void SerializeRandomizationState(FArchive& Ar) override;
 
 protected:
     UPROPERTY(Transient)
@@ -9,6 +9,7 @@
 #include "Components/DecalComponent.h"
 #include "RandomMaterialParameterComponentBase.h"
 #include "RandomMaterialComponent.h"
+#include "NVRandomizationLog.h"
 
 // Sets default values
 URandomMaterialComponent::URandomMaterialComponent()
@@ -39,7 +40,7 @@ void URandomMaterialComponent::BeginPlay()
 
     if (bUseAllMaterialInDirectories)
     {
-        MaterialStreamer.Init(MaterialDirectories, UMaterialInterface::StaticClass());
+        MaterialStreamer.Init(this, MaterialDirectories, UMaterialInterface::StaticClass(), GetRandomizationLogKey());
     }
 
     // NOTE: Only randomize once if there's only 1 material to choose from
@@ -138,6 +139,71 @@ void URandomMaterialComponent::OnRandomization_Implementation()
     }
 }
 
+void URandomMaterialComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    const bool bAffectMeshComponents = (AffectedComponentType == EAffectedMaterialOwnerComponentType::OnlyAffectMeshComponents) ||
+                                       (AffectedComponentType == EAffectedMaterialOwnerComponentType::AffectBothMeshAndDecalComponents);
+    const bool bAffectDecalComponents = (AffectedComponentType == EAffectedMaterialOwnerComponentType::OnlyAffectDecalComponents) ||
+                                        (AffectedComponentType == EAffectedMaterialOwnerComponentType::AffectBothMeshAndDecalComponents);
+
+    if (bAffectMeshComponents)
+    {
+        for (UMeshComponent* CheckMeshComp : OwnerMeshComponents)
+        {
+            if (CheckMeshComp)
+            {
+                const TArray<int32> AffectedMaterialIndexes = MaterialSelectionConfigData.GetAffectMaterialIndexes(CheckMeshComp);
+                for (const int32 MaterialIndex : AffectedMaterialIndexes)
+                {
+                    // NOTE: The material parameter components replace the materials with their dynamic instances, only log the base material
+                    UMaterialInterface* CurrentMaterial = CheckMeshComp->GetMaterial(MaterialIndex);
+                    UMaterialInstanceDynamic* CurrentMaterialInstance = Cast<UMaterialInstanceDynamic>(CurrentMaterial);
+                    if (CurrentMaterialInstance)
+                    {
+                        CurrentMaterial = CurrentMaterialInstance->Parent;
+                    }
+
+                    UMaterialInterface* LoggedMaterial = CurrentMaterial;
+                    FNVRandomizationLog::SerializeObjectReference(Ar, LoggedMaterial);
+                    if (Ar.IsLoading() && LoggedMaterial && (LoggedMaterial != CurrentMaterial))
+                    {
+                        CheckMeshComp->SetMaterial(MaterialIndex, LoggedMaterial);
+                    }
+                }
+            }
+        }
+    }
+
+    if (bAffectDecalComponents)
+    {
+        for (UDecalComponent* CheckDecalComp : OwnerDecalComponents)
+        {
+            if (CheckDecalComp)
+            {
+                UMaterialInterface* CurrentMaterial = CheckDecalComp->GetDecalMaterial();
+                UMaterialInstanceDynamic* CurrentMaterialInstance = Cast<UMaterialInstanceDynamic>(CurrentMaterial);
+                if (CurrentMaterialInstance)
+                {
+                    CurrentMaterial = CurrentMaterialInstance->Parent;
+                }
+
+                UMaterialInterface* LoggedMaterial = CurrentMaterial;
+                FNVRandomizationLog::SerializeObjectReference(Ar, LoggedMaterial);
+                if (Ar.IsLoading() && LoggedMaterial && (LoggedMaterial != CurrentMaterial))
+                {
+                    CheckDecalComp->SetDecalMaterial(LoggedMaterial);
+                }
+            }
+        }
+    }
+}
+
+int32 URandomMaterialComponent::GetRandomizationLogPriority() const
+{
+    // NOTE: The materials must be restored after the meshes and before their parameters
+    return 2;
+}
+
 #if WITH_EDITORONLY_DATA
 void URandomMaterialComponent::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
@@ -157,17 +223,12 @@ void URandomMaterialComponent::PostEditChangeProperty(struct FPropertyChangedEve
 #endif //WITH_EDITORONLY_DATA
 bool URandomMaterialComponent::HasMaterialToRandomize() const
 {
-#if WITH_EDITORONLY_DATA
     return bUseAllMaterialInDirectories ? MaterialStreamer.HasAssets() : (MaterialList.Num() > 0);
-#else
-    return false;
-#endif //WITH_EDITORONLY_DATA
 }
 
 
 class UMaterialInterface* URandomMaterialComponent::GetNextMaterial()
 {
-#if WITH_EDITORONLY_DATA
     // Choose a random material in the list
     UMaterialInterface* NewMaterial = nullptr;
     if (bUseAllMaterialInDirectories)
@@ -176,10 +237,7 @@ class UMaterialInterface* URandomMaterialComponent::GetNextMaterial()
     }
     else if (MaterialList.Num() > 0)
     {
-        NewMaterial = MaterialList[FMath::Rand() % MaterialList.Num()];
+        NewMaterial = MaterialList[GetRandomStream().RandHelper(MaterialList.Num())];
     }
     return NewMaterial;
-#else
-    return nullptr;
-#endif //WITH_EDITORONLY_DATA
 }
\ No newline at end of file
@@ -27,6 +27,8 @@ public:
 protected:
     virtual void BeginPlay() override;
     virtual void OnRandomization_Implementation() override;
+    virtual void SerializeRandomizationState(FArchive& Ar) override;
+    virtual int32 GetRandomizationLogPriority() const override;
 
 #if WITH_EDITORONLY_DATA
     virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -31,12 +31,25 @@ void URandomMaterialParam_ColorComponent::UpdateMaterial(UMaterialInstanceDynami
         for (const FName& ParamName : MaterialParameterNames)
         {
             // TODO: Add option to use the same color for all the parameters or not
-            FLinearColor RandomColor = ColorData.GetRandomColor();
+            FLinearColor RandomColor = ColorData.GetRandomColor(GetRandomStream());
             MaterialToMofidy->SetVectorParameterValue(ParamName, RandomColor);
         }
     }
 }
 
+void URandomMaterialParam_ColorComponent::SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName)
+{
+    FLinearColor ParamValue = FLinearColor::Black;
+    const bool bHaveColorParam = Material && Material->GetVectorParameterValue(ParameterName, ParamValue);
+    Ar << ParamValue;
+
+    UMaterialInstanceDynamic* MaterialInstance = Cast<UMaterialInstanceDynamic>(Material);
+    if (Ar.IsLoading() && MaterialInstance && bHaveColorParam)
+    {
+        MaterialInstance->SetVectorParameterValue(ParameterName, ParamValue);
+    }
+}
+
 #if WITH_EDITORONLY_DATA
 void URandomMaterialParam_ColorComponent::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
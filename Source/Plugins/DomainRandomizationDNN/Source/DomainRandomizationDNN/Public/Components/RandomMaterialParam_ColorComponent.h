@@ -26,6 +26,7 @@ public:
 protected:
     void PostLoad() override;
     void UpdateMaterial(UMaterialInstanceDynamic* MaterialToMofidy) override;
+    void SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName) override;
 
 #if WITH_EDITORONLY_DATA
     virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
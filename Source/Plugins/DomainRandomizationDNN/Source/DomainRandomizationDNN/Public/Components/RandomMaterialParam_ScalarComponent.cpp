@@ -21,8 +21,21 @@ void URandomMaterialParam_ScalarComponent::UpdateMaterial(UMaterialInstanceDynam
         for (const FName& ParamName : MaterialParameterNames)
         {
             // TODO: Add option to use the same value for all the parameters or not
-            float RandValue = FMath::RandRange(ValueRange.Min, ValueRange.Max);
+            float RandValue = GetRandomStream().FRandRange(ValueRange.Min, ValueRange.Max);
             MaterialToMofidy->SetScalarParameterValue(ParamName, RandValue);
         }
     }
 }
+
+void URandomMaterialParam_ScalarComponent::SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName)
+{
+    float ParamValue = 0.f;
+    const bool bHaveScalarParam = Material && Material->GetScalarParameterValue(ParameterName, ParamValue);
+    Ar << ParamValue;
+
+    UMaterialInstanceDynamic* MaterialInstance = Cast<UMaterialInstanceDynamic>(Material);
+    if (Ar.IsLoading() && MaterialInstance && bHaveScalarParam)
+    {
+        MaterialInstance->SetScalarParameterValue(ParameterName, ParamValue);
+    }
+}
@@ -25,6 +25,7 @@ public:
 
 protected:
     void UpdateMaterial(UMaterialInstanceDynamic* MaterialToMofidy) override;
+    void SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName) override;
 
 protected: // Editor properties
     // Range of the scalar value to randomize
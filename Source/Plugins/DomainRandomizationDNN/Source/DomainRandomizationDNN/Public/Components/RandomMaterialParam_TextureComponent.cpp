@@ -7,6 +7,7 @@
 #include "DomainRandomizationDNNPCH.h"
 #include "DRUtils.h"
 #include "RandomMaterialParam_TextureComponent.h"
+#include "NVRandomizationLog.h"
 
 // Sets default values
 URandomMaterialParam_TextureComponent::URandomMaterialParam_TextureComponent()
@@ -36,12 +37,23 @@ void URandomMaterialParam_TextureComponent::BeginPlay()
 {
     if (bUseAllTextureInAFolder)
     {
-        TextureStreamer.Init(TextureDirectories, UTexture2D::StaticClass());
+        TextureStreamer.Init(this, TextureDirectories, UTexture2D::StaticClass(), GetRandomizationLogKey());
     }
 
     Super::BeginPlay();
 }
 
+void URandomMaterialParam_TextureComponent::OnOwnerReusedFromPool()
+{
+    if (bUseAllTextureInAFolder)
+    {
+        // NOTE: The streamer's picks are named after the log key, which change with the actor's index in its group
+        TextureStreamer.Init(this, TextureDirectories, UTexture2D::StaticClass(), GetRandomizationLogKey());
+    }
+
+    Super::OnOwnerReusedFromPool();
+}
+
 void URandomMaterialParam_TextureComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
     Super::EndPlay(EndPlayReason);
@@ -73,7 +85,7 @@ void URandomMaterialParam_TextureComponent::UpdateMaterial(UMaterialInstanceDyna
                 else
                 {
                     // TODO: Add option to use the same texture for all the parameters or not
-                    RandomTexture = TextureList[FMath::Rand() % TextureList.Num()];
+                    RandomTexture = TextureList[GetRandomStream().RandHelper(TextureList.Num())];
                 }
 
                 if (RandomTexture)
@@ -83,4 +95,17 @@ void URandomMaterialParam_TextureComponent::UpdateMaterial(UMaterialInstanceDyna
             }
         }
     }
-}
\ No newline at end of file
+}
+
+void URandomMaterialParam_TextureComponent::SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName)
+{
+    UTexture* ParamValue = nullptr;
+    const bool bHaveTextureParam = Material && Material->GetTextureParameterValue(ParameterName, ParamValue);
+    FNVRandomizationLog::SerializeObjectReference(Ar, ParamValue);
+
+    UMaterialInstanceDynamic* MaterialInstance = Cast<UMaterialInstanceDynamic>(Material);
+    if (Ar.IsLoading() && MaterialInstance && bHaveTextureParam && ParamValue)
+    {
+        MaterialInstance->SetTextureParameterValue(ParameterName, ParamValue);
+    }
+}
@@ -21,11 +21,14 @@ class DOMAINRANDOMIZATIONDNN_API URandomMaterialParam_TextureComponent : public
 public:
     URandomMaterialParam_TextureComponent();
 
+    virtual void OnOwnerReusedFromPool() override;
+
 protected:
     virtual void PostLoad() override;
     virtual void BeginPlay() override;
     virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void UpdateMaterial(UMaterialInstanceDynamic* MaterialToMofidy) override;
+    virtual void SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName) override;
 
     bool HasAssetToRandomize() const;
 
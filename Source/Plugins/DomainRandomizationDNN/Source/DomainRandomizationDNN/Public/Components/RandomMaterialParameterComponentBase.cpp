@@ -109,6 +109,62 @@ void URandomMaterialParameterComponentBase::UpdateDecalMaterial(class UDecalComp
     }
 }
 
+void URandomMaterialParameterComponentBase::SerializeRandomizationState(FArchive& Ar)
+{
+    const bool bAffectMeshComponents = (AffectedComponentType == EAffectedMaterialOwnerComponentType::OnlyAffectMeshComponents) ||
+                                       (AffectedComponentType == EAffectedMaterialOwnerComponentType::AffectBothMeshAndDecalComponents);
+    const bool bAffectDecalComponents = (AffectedComponentType == EAffectedMaterialOwnerComponentType::OnlyAffectDecalComponents) ||
+                                        (AffectedComponentType == EAffectedMaterialOwnerComponentType::AffectBothMeshAndDecalComponents);
+
+    if (bAffectMeshComponents)
+    {
+        for (UMeshComponent* CheckMeshComp : OwnerMeshComponents)
+        {
+            if (CheckMeshComp)
+            {
+                const TArray<int32> AffectedMaterialIndexes = MaterialSelectionConfigData.GetAffectMaterialIndexes(CheckMeshComp);
+                for (const int32 MaterialIndex : AffectedMaterialIndexes)
+                {
+                    // NOTE: Only create the dynamic material instance when the parameters need to be restored
+                    UMaterialInterface* CheckMaterial = Ar.IsLoading() ?
+                        CheckMeshComp->CreateDynamicMaterialInstance(MaterialIndex) :
+                        CheckMeshComp->GetMaterial(MaterialIndex);
+                    for (const FName& ParamName : MaterialParameterNames)
+                    {
+                        SerializeMaterialParameter(Ar, CheckMaterial, ParamName);
+                    }
+                }
+            }
+        }
+    }
+
+    if (bAffectDecalComponents)
+    {
+        for (UDecalComponent* CheckDecalComp : OwnerDecalComponents)
+        {
+            if (CheckDecalComp)
+            {
+                UMaterialInterface* CheckMaterial = CheckDecalComp->GetDecalMaterial();
+                if (Ar.IsLoading() && !Cast<UMaterialInstanceDynamic>(CheckMaterial))
+                {
+                    CheckMaterial = CheckDecalComp->CreateDynamicMaterialInstance();
+                }
+
+                for (const FName& ParamName : MaterialParameterNames)
+                {
+                    SerializeMaterialParameter(Ar, CheckMaterial, ParamName);
+                }
+            }
+        }
+    }
+}
+
+int32 URandomMaterialParameterComponentBase::GetRandomizationLogPriority() const
+{
+    // NOTE: The parameters must be restored after the materials they are set on
+    return 3;
+}
+
 #if WITH_EDITORONLY_DATA
 void URandomMaterialParameterComponentBase::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
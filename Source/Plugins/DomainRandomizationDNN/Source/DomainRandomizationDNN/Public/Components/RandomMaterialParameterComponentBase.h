@@ -27,6 +27,8 @@ public:
 protected:
     virtual void BeginPlay() override;
     virtual void OnRandomization_Implementation() override;
+    virtual void SerializeRandomizationState(FArchive& Ar) override;
+    virtual int32 GetRandomizationLogPriority() const override;
 
 #if WITH_EDITORONLY_DATA
     virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -35,6 +37,9 @@ protected:
     void UpdateMeshMaterial(class UMeshComponent* AffectedMeshComp);
     void UpdateDecalMaterial(class UDecalComponent* AffectedDecalComp);
     virtual void UpdateMaterial(UMaterialInstanceDynamic* MaterialToMofidy)  PURE_VIRTUAL(URandomMaterialParameterComponentBase::UpdateMaterial,);
+    /// Save the value of a parameter of the material to the randomization log, or restore it when the archive is loading
+    /// NOTE: The same number of bytes must be serialized whether the material has the parameter or not
+    virtual void SerializeMaterialParameter(FArchive& Ar, UMaterialInterface* Material, const FName& ParameterName) PURE_VIRTUAL(URandomMaterialParameterComponentBase::SerializeMaterialParameter,);
 
 protected: // Editor properties
     // List of the parameters in the material that we want to modify
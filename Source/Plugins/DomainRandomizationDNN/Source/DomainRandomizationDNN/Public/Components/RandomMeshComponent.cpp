@@ -8,6 +8,7 @@
 #include "RandomMaterialComponent.h"
 #include "RandomMeshComponent.h"
 #include "DRUtils.h"
+#include "NVRandomizationLog.h"
 
 // Sets default values
 URandomMeshComponent::URandomMeshComponent()
@@ -22,7 +23,7 @@ void URandomMeshComponent::BeginPlay()
     if (bUseAllMeshInDirectories)
     {
         // NOTE: Only support static meshes for now
-        MeshStreamer.Init(MeshDirectories, UStaticMesh::StaticClass());
+        MeshStreamer.Init(this, MeshDirectories, UStaticMesh::StaticClass(), GetRandomizationLogKey());
     }
 
     AActor* OwnerActor = GetOwner();
@@ -35,6 +36,17 @@ void URandomMeshComponent::BeginPlay()
     Super::BeginPlay();
 }
 
+void URandomMeshComponent::OnOwnerReusedFromPool()
+{
+    if (bUseAllMeshInDirectories)
+    {
+        // NOTE: The streamer's picks are named after the log key, which change with the actor's index in its group
+        MeshStreamer.Init(this, MeshDirectories, UStaticMesh::StaticClass(), GetRandomizationLogKey());
+    }
+
+    Super::OnOwnerReusedFromPool();
+}
+
 void URandomMeshComponent::OnRandomization_Implementation()
 {
     AActor* OwnerActor = GetOwner();
@@ -51,7 +63,7 @@ void URandomMeshComponent::OnRandomization_Implementation()
             }
             else
             {
-                NewMesh = StaticMeshList[FMath::Rand() % StaticMeshList.Num()];
+                NewMesh = StaticMeshList[GetRandomStream().RandHelper(StaticMeshList.Num())];
             }
 
             if (NewMesh && NewMesh != OwnerStaticMeshComp->GetStaticMesh())
@@ -81,6 +93,31 @@ void URandomMeshComponent::OnRandomization_Implementation()
     }
 }
 
+void URandomMeshComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    UStaticMeshComponent* OwnerStaticMeshComp = OwnerActor ? Cast<UStaticMeshComponent>(OwnerActor->GetComponentByClass(UStaticMeshComponent::StaticClass())) : nullptr;
+    if (!OwnerStaticMeshComp)
+    {
+        return;
+    }
+
+    UStaticMesh* CurrentMesh = OwnerStaticMeshComp->GetStaticMesh();
+    UStaticMesh* LoggedMesh = CurrentMesh;
+    FNVRandomizationLog::SerializeObjectReference(Ar, LoggedMesh);
+    if (Ar.IsLoading() && LoggedMesh && (LoggedMesh != CurrentMesh))
+    {
+        OwnerStaticMeshComp->SetStaticMesh(LoggedMesh);
+
+        // Reset the overrided materials, the material components restore their own materials after the mesh
+        int32 TotalNumberOfMaterials = OwnerStaticMeshComp->GetNumMaterials();
+        for (int32 i = 0; i < TotalNumberOfMaterials; i++)
+        {
+            OwnerStaticMeshComp->SetMaterial(i, nullptr);
+        }
+    }
+}
+
 bool URandomMeshComponent::HasMeshToRandomize() const
 {
     return bUseAllMeshInDirectories?
@@ -21,9 +21,12 @@ class DOMAINRANDOMIZATIONDNN_API URandomMeshComponent : public URandomComponentB
 public:
     URandomMeshComponent();
 
+    virtual void OnOwnerReusedFromPool() override;
+
 protected:
     virtual void BeginPlay() override;
     virtual void OnRandomization_Implementation() override;
+    virtual void SerializeRandomizationState(FArchive& Ar) override;
     bool HasMeshToRandomize() const;
 
 protected: // Editor properties
@@ -10,6 +10,10 @@
 // Sets default values
 URandomMovementComponent::URandomMovementComponent()
 {
+    // NOTE: The component only tick while it's moving toward its target location
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = false;
+
     bIsMoving = false;
 
     bShouldTeleport = true;
@@ -61,6 +65,7 @@ void URandomMovementComponent::TickComponent(float DeltaTime, enum ELevelTick Ti
         if (maxMoveDistance >= targetDistance)
         {
             bIsMoving = false;
+            SetComponentTickEnabled(false);
             OnFinishedRandomization();
         }
     }
@@ -78,19 +83,19 @@ void URandomMovementComponent::OnRandomization_Implementation()
     {
         if (bUseObjectAxesInsteadOfWorldAxes)
         {
-            TargetLocation = RandomLocationData.GetRandomLocationInLocalSpace(OriginalTransform);
+            TargetLocation = RandomLocationData.GetRandomLocationInLocalSpace(GetRandomStream(), OriginalTransform);
         }
         else
         {
-            TargetLocation = RandomLocationData.GetRandomLocationRelative(OriginalTransform.GetLocation());
+            TargetLocation = RandomLocationData.GetRandomLocationRelative(GetRandomStream(), OriginalTransform.GetLocation());
         }
     }
     else
     {
-        TargetLocation = RandomLocationVolume ? FMath::RandPointInBox(RandomLocationVolume->GetComponentsBoundingBox()) : OwnerActor->GetActorLocation();
+        TargetLocation = RandomLocationVolume ? GetRandomStream().PointInBox(RandomLocationVolume->GetComponentsBoundingBox()) : OwnerActor->GetActorLocation();
     }
 
-    CurrentSpeed = FMath::RandRange(RandomSpeedRange.Min, RandomSpeedRange.Max);
+    CurrentSpeed = GetRandomStream().FRandRange(RandomSpeedRange.Min, RandomSpeedRange.Max);
 
     if (bShouldTeleport)
     {
@@ -101,6 +106,7 @@ void URandomMovementComponent::OnRandomization_Implementation()
     else
     {
         bIsMoving = true;
+        SetComponentTickEnabled(true);
     }
 }
 
@@ -111,3 +117,17 @@ void URandomMovementComponent::OnFinishedRandomization()
         Super::OnFinishedRandomization();
     }
 }
+
+void URandomMovementComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        FVector OwnerLocation = OwnerActor->GetActorLocation();
+        Ar << OwnerLocation;
+        if (Ar.IsLoading())
+        {
+            OwnerActor->SetActorLocation(OwnerLocation, false, nullptr, ETeleportType::TeleportPhysics);
+        }
+    }
+}
@@ -63,6 +63,7 @@ protected:
 
     void OnRandomization_Implementation() override;
     void OnFinishedRandomization() override;
+    void SerializeRandomizationState(FArchive& Ar) override;
 
 protected:
     bool bIsMoving;
@@ -26,7 +26,21 @@ void URandomRotationComponent::OnRandomization_Implementation()
     AActor* OwnerActor = GetOwner();
     if (OwnerActor && RandomRotationData.ShouldRandomized())
     {
-        FRotator RandomRotation = bRelatedToOriginRotation ? RandomRotationData.GetRandomRotationRelative(OriginalRotation) : RandomRotationData.GetRandomRotation();
+        FRotator RandomRotation = bRelatedToOriginRotation ? RandomRotationData.GetRandomRotationRelative(GetRandomStream(), OriginalRotation) : RandomRotationData.GetRandomRotation(GetRandomStream());
         OwnerActor->SetActorRotation(RandomRotation);
     }
 }
+
+void URandomRotationComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        FQuat OwnerRotation = OwnerActor->GetActorQuat();
+        Ar << OwnerRotation;
+        if (Ar.IsLoading())
+        {
+            OwnerActor->SetActorRotation(OwnerRotation);
+        }
+    }
+}
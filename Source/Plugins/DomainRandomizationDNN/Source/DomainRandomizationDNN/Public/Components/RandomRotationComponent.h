@@ -32,6 +32,7 @@ protected: // Editor properties
 protected:
     void BeginPlay() override;
     void OnRandomization_Implementation() override;
+    void SerializeRandomizationState(FArchive& Ar) override;
 
 protected:
     UPROPERTY(Transient)
@@ -24,7 +24,21 @@ void URandomScaleComponent::OnRandomization_Implementation()
     AActor* OwnerActor = GetOwner();
     if ( OwnerActor && RandomScaleData.ShouldRandomized())
     {
-        FVector RandomScale3D = RandomScaleData.GetRandomScale3D();
+        FVector RandomScale3D = RandomScaleData.GetRandomScale3D(GetRandomStream());
         OwnerActor->SetActorScale3D(RandomScale3D);
     }
 }
+
+void URandomScaleComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        FVector OwnerScale3D = OwnerActor->GetActorScale3D();
+        Ar << OwnerScale3D;
+        if (Ar.IsLoading())
+        {
+            OwnerActor->SetActorScale3D(OwnerScale3D);
+        }
+    }
+}
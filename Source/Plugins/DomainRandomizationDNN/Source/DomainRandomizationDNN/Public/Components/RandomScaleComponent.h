@@ -27,4 +27,5 @@ protected: // Editor properties
 protected:
     void BeginPlay() override;
     void OnRandomization_Implementation() override;
+    void SerializeRandomizationState(FArchive& Ar) override;
 };
@@ -23,3 +23,18 @@ void URandomVisibilityComponent::OnRandomization_Implementation()
         OwnerActor->SetActorEnableCollision(!bNewHidden);
     }
 }
+
+void URandomVisibilityComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        bool bHidden = OwnerActor->bHidden;
+        Ar << bHidden;
+        if (Ar.IsLoading())
+        {
+            OwnerActor->SetActorHiddenInGame(bHidden);
+            OwnerActor->SetActorEnableCollision(!bHidden);
+        }
+    }
+}
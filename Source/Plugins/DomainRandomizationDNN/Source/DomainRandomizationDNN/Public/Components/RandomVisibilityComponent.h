@@ -22,4 +22,5 @@ public:
 
 protected:
     void OnRandomization_Implementation() override;
+    void SerializeRandomizationState(FArchive& Ar) override;
 };
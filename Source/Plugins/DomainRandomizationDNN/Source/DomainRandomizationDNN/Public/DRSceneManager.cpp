@@ -7,6 +7,8 @@
 #include "DomainRandomizationDNNPCH.h"
 #include "DRSceneManager.h"
 #include "GroupActorManager.h"
+#include "RandomAssetCache.h"
+#include "RandomizationScheduler.h"
 
 #include "NVSceneMarker.h"
 #include "NVSceneCapturerActor.h"
@@ -21,6 +23,10 @@ ADRSceneManager::ADRSceneManager(const FObjectInitializer& ObjectInitializer) :
     PrimaryActorTick.TickGroup = TG_PrePhysics;
 
     bIsActive = true;
+
+    AssetCacheBudgetMB = 2048;
+    MaxPrefetchAssetCount = 32;
+    bRandomizeOncePerCapturedFrame = false;
 }
 
 void ADRSceneManager::PostLoad()
@@ -36,19 +42,51 @@ void ADRSceneManager::PostLoad()
 void ADRSceneManager::BeginPlay()
 {
     Super::BeginPlay();
+
+    FRandomAssetCache::Get().SetBudget((int64)AssetCacheBudgetMB * 1024 * 1024, MaxPrefetchAssetCount);
+
+    FRandomizationScheduler* Scheduler = FRandomizationScheduler::Get(GetWorld());
+    if (Scheduler)
+    {
+        Scheduler->SetRandomizeOncePerCapturedFrame(bRandomizeOncePerCapturedFrame);
+    }
 }
 
 void ADRSceneManager::UpdateSettingsFromCommandLine()
 {
     Super::UpdateSettingsFromCommandLine();
 
+    const auto CommandLine = FCommandLine::Get();
+
+    FParse::Value(CommandLine, TEXT("-AssetCacheBudgetMB="), AssetCacheBudgetMB);
+    FParse::Value(CommandLine, TEXT("-MaxPrefetchAssetCount="), MaxPrefetchAssetCount);
+    if (FParse::Param(CommandLine, TEXT("RandomizeOncePerCapturedFrame")))
+    {
+        bRandomizeOncePerCapturedFrame = true;
+    }
+
+    for (AGroupActorManager* CheckActorManager : { GroupActorManager, NoiseActorManager })
+    {
+        if (CheckActorManager)
+        {
+            FParse::Value(CommandLine, TEXT("-ActorPoolWarmUpCount="), CheckActorManager->PoolWarmUpCountPerClass);
+            FParse::Value(CommandLine, TEXT("-MaxPooledActorsPerClass="), CheckActorManager->MaxPooledActorsPerClass);
+            if (FParse::Param(CommandLine, TEXT("NoActorPool")))
+            {
+                CheckActorManager->bUseActorPool = false;
+            }
+            if (FParse::Param(CommandLine, TEXT("InstancedDistractors")))
+            {
+                CheckActorManager->bUseInstancedDistractors = true;
+            }
+        }
+    }
+
     if (!GroupActorManager)
     {
         return;
     }
 
-    const auto CommandLine = FCommandLine::Get();
-
     int32 CountPerActorOverride = 0;
     if (FParse::Value(CommandLine, TEXT("-CountPerActor="), CountPerActorOverride))
     {
@@ -42,6 +42,18 @@ protected: // Editor properties
     UPROPERTY(EditInstanceOnly)
     class AGroupActorManager* NoiseActorManager;
 
+    // Maximum memory (in megabytes) the assets streamed from the randomization directories can use, the least recently used ones are released above it
+    UPROPERTY(EditAnywhere, Config, Category = AssetStreaming, meta = (ClampMin = 0))
+    int32 AssetCacheBudgetMB;
+
+    // Maximum number of assets each asset streamer can load ahead of their use
+    UPROPERTY(EditAnywhere, Config, Category = AssetStreaming, meta = (ClampMin = 1))
+    int32 MaxPrefetchAssetCount;
+
+    // If true, the random components are randomized exactly once after each captured frame instead of when their randomization duration expire
+    UPROPERTY(EditAnywhere, Config, Category = Randomization)
+    bool bRandomizeOncePerCapturedFrame;
+
 protected: // Transient properties
     UPROPERTY(Transient)
     bool bIsReady;
@@ -6,10 +6,8 @@
 
 #include "DomainRandomizationDNNPCH.h"
 #include "DRUtils.h"
-#include "Engine/AssetManager.h"
-#if WITH_EDITORONLY_DATA
-#include "AssetRegistryModule.h"
-#endif // WITH_EDITORONLY_DATA
+#include "RandomAssetCache.h"
+#include "RandomAssetStreamingService.h"
 
 DEFINE_LOG_CATEGORY(LogNVDRUtils);
 //=================================== FRandomRotationData ===================================
@@ -28,38 +26,38 @@ FRandomRotationData::FRandomRotationData()
     YawRange = FFloatInterval(-180.f, 180.f);
 }
 
-FRotator FRandomRotationData::GetRandomRotation() const
+FRotator FRandomRotationData::GetRandomRotation(FNVRandomStream& RandomStream) const
 {
     FRotator RandomRotation = FRotator::ZeroRotator;
 
     if (bRandomizeYaw)
     {
-        RandomRotation.Yaw = FMath::RandRange(YawRange.Min, YawRange.Max);
+        RandomRotation.Yaw = RandomStream.FRandRange(YawRange.Min, YawRange.Max);
     }
     if (bRandomizeRoll)
     {
-        RandomRotation.Roll = FMath::RandRange(RollRange.Min, RollRange.Max);
+        RandomRotation.Roll = RandomStream.FRandRange(RollRange.Min, RollRange.Max);
     }
     if (bRandomizePitch)
     {
-        RandomRotation.Pitch = FMath::RandRange(PitchRange.Min, PitchRange.Max);
+        RandomRotation.Pitch = RandomStream.FRandRange(PitchRange.Min, PitchRange.Max);
     }
 
     return RandomRotation;
 }
 
-FRotator FRandomRotationData::GetRandomRotationRelative(const FRotator& BaseRotation) const
+FRotator FRandomRotationData::GetRandomRotationRelative(FNVRandomStream& RandomStream, const FRotator& BaseRotation) const
 {
     if (bRandomizeRotationInACone)
     {
         const FVector& BaseDir = BaseRotation.Vector();
         const float ConeHalfAngleRad = FMath::DegreesToRadians(RandomConeHalfAngle);
 
-        FRotator RandomRotation = FMath::VRandCone(BaseDir, ConeHalfAngleRad).Rotation();
+        FRotator RandomRotation = RandomStream.VRandCone(BaseDir, ConeHalfAngleRad).Rotation();
         return RandomRotation;
     }
 
-    FRotator RandomRotation = GetRandomRotation();
+    FRotator RandomRotation = GetRandomRotation(RandomStream);
     return BaseRotation + RandomRotation;
 }
 
@@ -78,37 +76,37 @@ FRandomLocationData::FRandomLocationData()
     ZAxisRange.Max = 100.f;
 }
 
-FVector FRandomLocationData::GetRandomLocation() const
+FVector FRandomLocationData::GetRandomLocation(FNVRandomStream& RandomStream) const
 {
     FVector RandomLocation = FVector::ZeroVector;
 
     if (bRandomizeXAxis)
     {
-        RandomLocation.X = FMath::RandRange(XAxisRange.Min, XAxisRange.Max);
+        RandomLocation.X = RandomStream.FRandRange(XAxisRange.Min, XAxisRange.Max);
     }
     if (bRandomizeYAxis)
     {
-        RandomLocation.Y = FMath::RandRange(YAxisRange.Min, YAxisRange.Max);
+        RandomLocation.Y = RandomStream.FRandRange(YAxisRange.Min, YAxisRange.Max);
     }
     if (bRandomizeZAxis)
     {
-        RandomLocation.Z = FMath::RandRange(ZAxisRange.Min, ZAxisRange.Max);
+        RandomLocation.Z = RandomStream.FRandRange(ZAxisRange.Min, ZAxisRange.Max);
     }
 
     return RandomLocation;
 }
 
-FVector FRandomLocationData::GetRandomLocationRelative(const FVector& BaseLocation) const
+FVector FRandomLocationData::GetRandomLocationRelative(FNVRandomStream& RandomStream, const FVector& BaseLocation) const
 {
-    FVector RandomLocation = GetRandomLocation();
+    FVector RandomLocation = GetRandomLocation(RandomStream);
 
     return BaseLocation + RandomLocation;
 }
 
 // Get a random location in an object's local space
-FVector FRandomLocationData::GetRandomLocationInLocalSpace(const FTransform& ObjectTransform) const
+FVector FRandomLocationData::GetRandomLocationInLocalSpace(FNVRandomStream& RandomStream, const FTransform& ObjectTransform) const
 {
-    FVector RandomLocation = GetRandomLocation();
+    FVector RandomLocation = GetRandomLocation(RandomStream);
     FVector NewLocation = ObjectTransform.TransformPosition(RandomLocation);
 
     return NewLocation;
@@ -132,28 +130,28 @@ FRandomScale3DData::FRandomScale3DData()
     ZAxisRange.Max = 2.f;
 }
 
-FVector FRandomScale3DData::GetRandomScale3D() const
+FVector FRandomScale3DData::GetRandomScale3D(FNVRandomStream& RandomStream) const
 {
     static const float MinScale = 0.001f;
     FVector RandomScale = FVector(1.f, 1.f, 1.f);
 
     if (bUniformScale)
     {
-        RandomScale.X = RandomScale.Y = RandomScale.Z = FMath::Max(FMath::RandRange(UniformScaleRange.Min, UniformScaleRange.Max), MinScale);
+        RandomScale.X = RandomScale.Y = RandomScale.Z = FMath::Max(RandomStream.FRandRange(UniformScaleRange.Min, UniformScaleRange.Max), MinScale);
     }
     else
     {
         if (bRandomizeXAxis)
         {
-            RandomScale.X = FMath::Max(FMath::RandRange(XAxisRange.Min, XAxisRange.Max), MinScale);
+            RandomScale.X = FMath::Max(RandomStream.FRandRange(XAxisRange.Min, XAxisRange.Max), MinScale);
         }
         if (bRandomizeYAxis)
         {
-            RandomScale.Y = FMath::Max(FMath::RandRange(YAxisRange.Min, YAxisRange.Max), MinScale);
+            RandomScale.Y = FMath::Max(RandomStream.FRandRange(YAxisRange.Min, YAxisRange.Max), MinScale);
         }
         if (bRandomizeZAxis)
         {
-            RandomScale.Z = FMath::Max(FMath::RandRange(ZAxisRange.Min, ZAxisRange.Max), MinScale);
+            RandomScale.Z = FMath::Max(RandomStream.FRandRange(ZAxisRange.Min, ZAxisRange.Max), MinScale);
         }
     }
 
@@ -200,61 +198,61 @@ void FRandomColorData::PostEditChangeProperty(struct FPropertyChangedEvent& Prop
 }
 #endif // WITH_EDITORONLY_DATA
 
-FLinearColor FRandomColorData::GetRandomColor() const
+FLinearColor FRandomColorData::GetRandomColor(FNVRandomStream& RandomStream) const
 {
     switch (RandomizationType)
     {
         default:
         case ERandomColorType::RandomizeAllColor:
         {
-            return GetRandomAnyColor();
+            return GetRandomAnyColor(RandomStream);
         }
         case ERandomColorType::RandomizeBetweenTwoColors:
         {
-            return GetRandomColorInRange(FirstColor, SecondColor, bRandomizeInHSV);
+            return GetRandomColorInRange(RandomStream, FirstColor, SecondColor, bRandomizeInHSV);
         }
         case ERandomColorType::RandomizeAroundAColor:
         {
-            return GetRandomColorAround(MainColor, MaxHueChange, MaxSaturationChange, MaxValueChange);
+            return GetRandomColorAround(RandomStream, MainColor, MaxHueChange, MaxSaturationChange, MaxValueChange);
         }
     }
 }
 
-FLinearColor FRandomColorData::GetRandomAnyColor()
+FLinearColor FRandomColorData::GetRandomAnyColor(FNVRandomStream& RandomStream)
 {
     FLinearColor RandomColor;
-    RandomColor.R = FMath::FRand();
-    RandomColor.G = FMath::FRand();
-    RandomColor.B = FMath::FRand();
+    RandomColor.R = RandomStream.GetFraction();
+    RandomColor.G = RandomStream.GetFraction();
+    RandomColor.B = RandomStream.GetFraction();
 
     return RandomColor;
 }
 
-FLinearColor FRandomColorData::GetRandomColorInRange(const FLinearColor& Color1, const FLinearColor& Color2, const bool& bRandomizeInHSV)
+FLinearColor FRandomColorData::GetRandomColorInRange(FNVRandomStream& RandomStream, const FLinearColor& Color1, const FLinearColor& Color2, const bool& bRandomizeInHSV)
 {
     FLinearColor RandomColor;
     if (bRandomizeInHSV)
     {
-        RandomColor = FLinearColor::LerpUsingHSV(Color1, Color2, FMath::FRand());
+        RandomColor = FLinearColor::LerpUsingHSV(Color1, Color2, RandomStream.GetFraction());
     }
     else
     {
-        RandomColor.R = FMath::RandRange(Color1.R, Color2.R);
-        RandomColor.G = FMath::RandRange(Color1.G, Color2.G);
-        RandomColor.B = FMath::RandRange(Color1.B, Color2.B);
+        RandomColor.R = RandomStream.FRandRange(Color1.R, Color2.R);
+        RandomColor.G = RandomStream.FRandRange(Color1.G, Color2.G);
+        RandomColor.B = RandomStream.FRandRange(Color1.B, Color2.B);
     }
 
     return RandomColor;
 }
 
-FLinearColor FRandomColorData::GetRandomColorAround(const FLinearColor& BaseColor, const float& HueDelta, const float& SaturationDelta, const float& ValueDelta)
+FLinearColor FRandomColorData::GetRandomColorAround(FNVRandomStream& RandomStream, const FLinearColor& BaseColor, const float& HueDelta, const float& SaturationDelta, const float& ValueDelta)
 {
     FLinearColor BaseHSV = BaseColor.LinearRGBToHSV();
     // Randomize Hue
     if (HueDelta > 0.f)
     {
         //BaseHSV.R += FMath::RandRange(-HueDelta, HueDelta);
-        BaseHSV.R += FRandUtils::RandGaussian(0, HueDelta);
+        BaseHSV.R += RandomStream.Gaussian(0.f, HueDelta);
         if (BaseHSV.R < 0.f)
         {
             BaseHSV.R += 360.f;
@@ -269,7 +267,7 @@ FLinearColor FRandomColorData::GetRandomColorAround(const FLinearColor& BaseColo
     if (SaturationDelta > 0.f)
     {
         //BaseHSV.G = FMath::Max(FMath::Min(BaseHSV.G + FMath::RandRange(-SaturationDelta, SaturationDelta), 1.f), 0.f);
-        BaseHSV.G += FRandUtils::RandGaussian(0, SaturationDelta);
+        BaseHSV.G += RandomStream.Gaussian(0.f, SaturationDelta);
         BaseHSV.G = FMath::Max(FMath::Min(BaseHSV.G, 1.f), 0.f);
     }
 
@@ -277,7 +275,7 @@ FLinearColor FRandomColorData::GetRandomColorAround(const FLinearColor& BaseColo
     if (ValueDelta > 0.f)
     {
         //BaseHSV.B = FMath::Max(FMath::Min(BaseHSV.G + FMath::RandRange(-ValueDelta, ValueDelta), 1.f), 0.f);
-        BaseHSV.B += FRandUtils::RandGaussian(0, ValueDelta);
+        BaseHSV.B += RandomStream.Gaussian(0.f, ValueDelta);
         BaseHSV.B = FMath::Max(FMath::Min(BaseHSV.B, 1.f), 0.f);
     }
 
@@ -286,48 +284,35 @@ FLinearColor FRandomColorData::GetRandomColorAround(const FLinearColor& BaseColo
 }
 
 //=================================== FRandUtils ===================================
-// Reference: https://en.wikipedia.org/wiki/Box%E2%80%93Muller_transform#Implementation
-float FRandUtils::RandGaussian(const float mu, const float sigma)
+namespace
 {
-    static const float epsilon = SMALL_NUMBER;
-    static const float two_pi = 2.0 * 3.14159265358979323846;
-
-    float u1, u2;
-    do
+    FNVRandomStream& GetRandUtilsStream()
     {
-        u1 = FMath::FRand();
-        u2 = FMath::FRand();
+        static FNVRandomStream RandUtilsStream(TEXT("FRandUtils"));
+        return RandUtilsStream;
     }
-    while (u1 <= epsilon);
-
-    float z0, z1;
-    z0 = FMath::Sqrt(-2.0 * log(u1)) * cos(two_pi * u2);
-    z1 = FMath::Sqrt(-2.0 * log(u1)) * sin(two_pi * u2);
+}
 
-    return z0 * sigma + mu;
+float FRandUtils::RandGaussian(const float mu, const float sigma)
+{
+    return RandGaussian(GetRandUtilsStream(), mu, sigma);
 }
 
 FVector2D FRandUtils::RandGaussian2D(const float mu, const float sigma)
 {
-    static const float epsilon = SMALL_NUMBER;
-    static const float two_pi = 2.0 * 3.14159265358979323846;
-
-    float u1, u2;
-    do
-    {
-        u1 = FMath::FRand();
-        u2 = FMath::FRand();
-    }
-    while (u1 <= epsilon);
+    return RandGaussian2D(GetRandUtilsStream(), mu, sigma);
+}
 
-    float z0, z1;
-    z0 =  FMath::Sqrt(-2.0 * log(u1)) * cos(two_pi * u2);
-    z1 = FMath::Sqrt(-2.0 * log(u1)) * sin(two_pi * u2);
+float FRandUtils::RandGaussian(FNVRandomStream& RandomStream, const float mu, const float sigma)
+{
+    return RandomStream.Gaussian(mu, sigma);
+}
 
-    FVector2D v;
-    v.X = z0 * sigma + mu;
-    v.Y = z1 * sigma + mu;
-    return v;
+FVector2D FRandUtils::RandGaussian2D(FNVRandomStream& RandomStream, const float mu, const float sigma)
+{
+    float Values[2];
+    RandomStream.FillGaussian(TArrayView<float>(Values, 2), mu, sigma);
+    return FVector2D(Values[0], Values[1]);
 }
 
 //=================================== FRandomMaterialSelection ===================================
@@ -440,261 +425,310 @@ TArray<int32> FRandomMaterialSelection::GetAffectMaterialIndexes(const class UMe
 }
 
 //=================================== FRandomAssetStreamer ===================================
-// TODO: May expose these number as config parameter for the streamer
-// Maximum number of loaded textures to keep at a time
-const int32 MAX_LOADED_ASSETS_COUNT = 100;
-// When the number of unused texture is smaller than this then try to load new textures in
-const int32 MAX_LOADED_ASSETS_BUFFER = 20;
-// How many texture to be async loaded at a time
-const int32 MAX_ASYNC_LOAD_ASSETS_COUNT = 5;
+// Minimum number of assets a streamer prefetch, even before it knows how fast its assets are picked
+const int32 MIN_PREFETCH_ASSETS_COUNT = 2;
+// Weight of the latest pick in the average pick rates
+const float PICK_RATE_SMOOTHING = 0.25f;
 
 FRandomAssetStreamer::FRandomAssetStreamer()
 {
     AssetDirectories.Reset();
     ManagedAssetClass = nullptr;
+    TotalAssetCount = 0;
 
-    StreamerCallbackPtr = TSharedPtr<FRandomAssetStreamerCallback>(new FRandomAssetStreamerCallback());
-    if (StreamerCallbackPtr.IsValid())
-    {
-        StreamerCallbackPtr->AssetStreamer = this;
-    }
+    PickMasterSeed = FNVRandomStream::GetMasterSeed();
+    PickEpoch = FNVRandomStream::GetEpoch();
+    PickIndex = 0;
+    PicksPerEpoch = 0.f;
+    PicksPerSecond = 0.f;
+    LastPickTime = 0.0;
+    DrawnPickCount = 0;
 }
 
-FRandomAssetStreamer::FRandomAssetStreamer(const FRandomAssetStreamer& OtherStreamer)
+FRandomAssetStreamer::FRandomAssetStreamer(const FRandomAssetStreamer& OtherStreamer) : FRandomAssetStreamer()
 {
-    AssetDirectories = OtherStreamer.AssetDirectories;
-    ManagedAssetClass = OtherStreamer.ManagedAssetClass;
-
-    AllAssetReferences = OtherStreamer.AllAssetReferences;
-    LoadedAssetReferences = OtherStreamer.LoadedAssetReferences;
-    LoadingAssetReferences = OtherStreamer.LoadingAssetReferences;
+    *this = OtherStreamer;
 }
 
 FRandomAssetStreamer::~FRandomAssetStreamer()
 {
-    if (StreamerCallbackPtr.IsValid())
-    {
-        StreamerCallbackPtr->AssetStreamer = nullptr;
-        StreamerCallbackPtr = nullptr;
-    }
-
-    if (StreamableHandlePtr.IsValid())
-    {
-        StreamableHandlePtr->CancelHandle();
-        StreamableHandlePtr->ReleaseHandle();
-        StreamableHandlePtr = nullptr;
-    }
+    CancelPrefetch();
 
     AssetDirectories.Reset();
     ManagedAssetClass = nullptr;
 
-    AllAssetReferences.Reset();
-    LoadedAssetReferences.Reset();
-    LoadingAssetReferences.Reset();
+    TotalAssetCount = 0;
+    AssetSet.Reset();
 }
 
 FRandomAssetStreamer& FRandomAssetStreamer::operator=(const FRandomAssetStreamer& OtherStreamer)
 {
+    // NOTE: The prefetched assets are pinned in the cache for their streamer, the copy prefetch its own ones
+    CancelPrefetch();
+
     AssetDirectories = OtherStreamer.AssetDirectories;
     ManagedAssetClass = OtherStreamer.ManagedAssetClass;
 
-    AllAssetReferences = OtherStreamer.AllAssetReferences;
-    LoadedAssetReferences = OtherStreamer.LoadedAssetReferences;
-    LoadingAssetReferences = OtherStreamer.LoadingAssetReferences;
+    TotalAssetCount = OtherStreamer.TotalAssetCount;
+    OwnerWorld = OtherStreamer.OwnerWorld;
+    AssetSet = OtherStreamer.AssetSet;
+
+    PickMasterSeed = OtherStreamer.PickMasterSeed;
+    PickEpoch = OtherStreamer.PickEpoch;
+    PickIndex = OtherStreamer.PickIndex;
+    PicksPerEpoch = OtherStreamer.PicksPerEpoch;
+    PicksPerSecond = OtherStreamer.PicksPerSecond;
+    LastPickTime = OtherStreamer.LastPickTime;
+
+    RandomStream = OtherStreamer.RandomStream;
+    DrawnPickCount = OtherStreamer.DrawnPickCount;
 
     return *this;
 }
 
-void FRandomAssetStreamer::Init(const TArray<FDirectoryPath>& InAssetDirectories, UClass* InAssetClass)
+void FRandomAssetStreamer::Init(const UObject* WorldContextObject, const TArray<FDirectoryPath>& InAssetDirectories, UClass* InAssetClass, const FString& StreamName/*= FString()*/)
 {
+    OwnerWorld = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
     AssetDirectories = InAssetDirectories;
     ManagedAssetClass = InAssetClass;
+    RandomStream.Initialize(StreamName);
+
+    // NOTE: The picks start from the stream's first value in the current epoch
+    PickMasterSeed = FNVRandomStream::GetMasterSeed();
+    PickEpoch = FNVRandomStream::GetEpoch();
+    PickIndex = 0;
+    DrawnPickCount = 0;
 
     ScanPath();
 }
 
 void FRandomAssetStreamer::ScanPath()
 {
-    AllAssetReferences.Reset();
-    LoadedAssetReferences.Reset();
-    LoadingAssetReferences.Reset();
-
-    UAssetManager& AssetManager = UAssetManager::Get();
-    IAssetRegistry& AssetRegistry = AssetManager.GetAssetRegistry();
+    CancelPrefetch();
+    TotalAssetCount = 0;
+    AssetSet.Reset();
 
-    // FIXME: The AssetRegistryModule only work for Editor build
-    // May want to use AssetManager since it's available in runtime in UE 4.17
-#if WITH_EDITORONLY_DATA
     if (ManagedAssetClass && (AssetDirectories.Num() > 0))
     {
-        FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-
-        FPrimaryAssetType PrimaryAssetType = ManagedAssetClass->GetFName();
-        const bool bForceSynchronousScan = true;
-        TArray<FString> AssetDirPaths;
-        for (const auto& AssetDirectory : AssetDirectories)
+        UWorld* World = OwnerWorld.Get();
+        FRandomAssetStreamingService* StreamingService = World ? FRandomAssetStreamingService::Get(World) : nullptr;
+        if (StreamingService)
         {
-            FString DirPath = AssetDirectory.Path;
-            FPaths::NormalizeDirectoryName(DirPath);
-            while (!DirPath.IsEmpty() && DirPath.EndsWith(TEXT("/")))
-            {
-                DirPath = DirPath.Left(DirPath.Len() - 1);
-            }
-            // NOTE: All the directory must be inside the game's content folder
-            const FString& AssetDirPath = FPaths::Combine(TEXT("/Game"), DirPath);
-            AssetDirPaths.Add(AssetDirPath);
-
+            AssetSet = StreamingService->GetAssetSet(AssetDirectories, ManagedAssetClass);
         }
-        int32 AssetCount = AssetManager.ScanPathsForPrimaryAssets(PrimaryAssetType, AssetDirPaths, ManagedAssetClass, false, false, bForceSynchronousScan);
-
-        for (const auto& AssetDirPath : AssetDirPaths)
+        else
         {
-            TArray<FAssetData> AssetList;
-
-            if (AssetRegistryModule.Get().GetAssetsByPath(*AssetDirPath, AssetList, true))
-            {
-                for (const FAssetData& AssetData : AssetList)
-                {
-                    const UClass* CheckAssetClass = AssetData.GetClass();
-                    if (CheckAssetClass && CheckAssetClass->IsChildOf(ManagedAssetClass))
-                    {
-                        const FSoftObjectPath& AssetObjectPath = AssetData.ToSoftObjectPath();
-
-                        // NOTE: When the number of assets are really large this references array can take a lot of memory
-                        AllAssetReferences.Add(AssetObjectPath);
-                    }
-                }
-            }
+            // NOTE: A streamer outside of a world can't share its asset set
+            AssetSet = MakeShareable(new FRandomAssetSet(FRandomAssetSet::NormalizeAssetDirectories(AssetDirectories), ManagedAssetClass));
         }
+        TotalAssetCount = AssetSet->GetAssetCount();
 
-        const int32 TotalAssetCount = AllAssetReferences.Num();
         if (TotalAssetCount <= 0)
         {
             UE_LOG(LogNVDRUtils, Warning, TEXT("FRandomAssetStreamer - There are no asset of type '%s' in directory '%s'"), *ManagedAssetClass->GetName(), *AssetDirectories[0].Path);
         }
         else
         {
-            // NOTE: We force load asset in the initial setup, all other follow up load are async
-            LoadNextBatch(false);
+            // NOTE: We force load the first asset in the initial setup, all the following ones are prefetched asynchronously
+            UpdatePrefetch();
+            if (PrefetchedPicks.Num() > 0)
+            {
+                FRandomAssetCache::Get().WaitUntilLoaded(PrefetchedPicks[0].AssetPath);
+            }
         }
     }
-#endif // WITH_EDITORONLY_DATA
 }
 
 int FRandomAssetStreamer::GetAssetsCount() const
 {
-    return AllAssetReferences.Num();
+    return TotalAssetCount;
 }
 
 bool FRandomAssetStreamer::HasAssets() const
 {
-    return (AllAssetReferences.Num() > 0);
+    return (TotalAssetCount > 0);
+}
+
+FSoftObjectPath FRandomAssetStreamer::GetAssetReference(int32 AssetIndex) const
+{
+    return AssetSet.IsValid() ? AssetSet->GetAssetPath(AssetIndex) : FSoftObjectPath();
 }
 
 FSoftObjectPath FRandomAssetStreamer::GetNextAssetReference()
 {
-    FStringAssetReference NextAssetRef;
-    const uint32 TotalLoadedAssetCount = LoadedAssetReferences.Num();
-    if (TotalLoadedAssetCount > 0)
+    if (TotalAssetCount <= 0)
     {
-        LastUsedAssetIndex = LastUsedAssetIndex % TotalLoadedAssetCount;
-        NextAssetRef = LoadedAssetReferences[LastUsedAssetIndex];
-        LastUsedAssetIndex++;
+        return FSoftObjectPath();
+    }
 
-        // Reduce the number of unused assets and try to load new ones in if it's less than a threshold
-        UnusedAssetCount = FMath::Max(UnusedAssetCount - 1, 0);
-        if (UnusedAssetCount < MAX_LOADED_ASSETS_BUFFER)
-        {
-            LoadNextBatch();
-        }
+    UpdatePickRate();
+
+    // Drop the prefetched picks which were skipped
+    FRandomAssetCache& AssetCache = FRandomAssetCache::Get();
+    while ((PrefetchedPicks.Num() > 0) && IsPickBehind(PrefetchedPicks[0]))
+    {
+        AssetCache.CancelPrefetch(PrefetchedPicks[0].AssetPath);
+        PrefetchedPicks.RemoveAt(0, 1, false);
+    }
+
+    FSoftObjectPath NextAssetRef;
+    bool bWasPrefetched = false;
+    if ((PrefetchedPicks.Num() > 0) && (PrefetchedPicks[0].Epoch == PickEpoch) && (PrefetchedPicks[0].PickIndex == PickIndex))
+    {
+        NextAssetRef = PrefetchedPicks[0].AssetPath;
+        PrefetchedPicks.RemoveAt(0, 1, false);
+        bWasPrefetched = true;
     }
     else
     {
-        // FIXME: Need to cached some back up assets?
+        // The prefetch guessed the next picks wrong, start it again from this pick
+        CancelPrefetch();
+        NextAssetRef = DrawPickedAsset(PickMasterSeed, PickEpoch, PickIndex);
     }
+    PickIndex++;
+
+    // NOTE: Request the next assets before waiting for this one
+    UpdatePrefetch();
+    AssetCache.Acquire(NextAssetRef, bWasPrefetched);
 
     return NextAssetRef;
 }
 
 bool FRandomAssetStreamer::IsLoadingAssets() const
 {
-    return (LoadingAssetReferences.Num() > 0);
+    const FRandomAssetCache& AssetCache = FRandomAssetCache::Get();
+    for (const FPrefetchedPick& CheckPick : PrefetchedPicks)
+    {
+        if (!AssetCache.IsLoaded(CheckPick.AssetPath))
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
-void FRandomAssetStreamer::LoadNextBatch(bool bAsyncLoad/*= true*/)
+FSoftObjectPath FRandomAssetStreamer::DrawPickedAsset(int32 MasterSeed, int32 Epoch, int32 InPickIndex)
 {
-    if (IsLoadingAssets() || !StreamerCallbackPtr.IsValid())
+    if (!RandomStream.IsEpochPinned() || (MasterSeed != RandomStream.GetStreamMasterSeed()) || (Epoch != RandomStream.GetStreamEpoch())
+        || (DrawnPickCount > InPickIndex))
     {
-        return;
+        RandomStream.PinEpoch(MasterSeed, Epoch);
+        DrawnPickCount = 0;
     }
 
-    LoadingAssetReferences.Reset(MAX_ASYNC_LOAD_ASSETS_COUNT);
-
-    const int32 TotalAssetCount = AllAssetReferences.Num();
-    if (TotalAssetCount <= 0)
+    // NOTE: Each pick draw a single value, skip the values of the picks in between
+    while (DrawnPickCount < InPickIndex)
     {
-        return;
+        RandomStream.GetUnsignedInt();
+        DrawnPickCount++;
     }
 
-    for (int i = 0; i < MAX_ASYNC_LOAD_ASSETS_COUNT; i++)
-    {
-        int AssetIndex = FMath::Rand() % TotalAssetCount;
-        const FSoftObjectPath& StrAssetRef = AllAssetReferences[AssetIndex];
-        LoadingAssetReferences.Add(StrAssetRef);
-    }
+    const int32 AssetIndex = RandomStream.RandHelper(TotalAssetCount);
+    DrawnPickCount++;
+    return GetAssetReference(AssetIndex);
+}
 
-    if (bAsyncLoad)
+void FRandomAssetStreamer::UpdatePickRate()
+{
+    const int32 MasterSeed = FNVRandomStream::GetMasterSeed();
+    const int32 Epoch = FNVRandomStream::GetEpoch();
+    if ((MasterSeed != PickMasterSeed) || (Epoch != PickEpoch))
     {
-        StreamableHandlePtr = AssetStreamer.RequestAsyncLoad(LoadingAssetReferences,
-                              FStreamableDelegate::CreateSP(StreamerCallbackPtr.ToSharedRef(), &FRandomAssetStreamerCallback::Callback),
-                              FStreamableManager::DefaultAsyncLoadPriority, true);
+        // NOTE: When the capturer use a fixed seed the epoch change every frame, learn how many picks a frame has to prefetch the next frames' picks
+        if ((MasterSeed == PickMasterSeed) && (Epoch > PickEpoch) && (PickIndex > 0))
+        {
+            const float EpochPickCount = (float)PickIndex / (Epoch - PickEpoch);
+            PicksPerEpoch = (PicksPerEpoch > 0.f) ? FMath::Lerp(PicksPerEpoch, EpochPickCount, PICK_RATE_SMOOTHING) : EpochPickCount;
+        }
+
+        PickMasterSeed = MasterSeed;
+        PickEpoch = Epoch;
+        PickIndex = 0;
     }
-    else
+
+    const double CurrentTime = FPlatformTime::Seconds();
+    if (LastPickTime > 0.0)
     {
-        StreamableHandlePtr = AssetStreamer.RequestSyncLoad(LoadingAssetReferences, true);
-        OnAssetBatchLoaded();
+        const float CurrentPickRate = 1.f / FMath::Max(CurrentTime - LastPickTime, 0.0001);
+        PicksPerSecond = (PicksPerSecond > 0.f) ? FMath::Lerp(PicksPerSecond, CurrentPickRate, PICK_RATE_SMOOTHING) : CurrentPickRate;
     }
+    LastPickTime = CurrentTime;
 }
 
-void FRandomAssetStreamer::OnAssetBatchLoaded()
+int32 FRandomAssetStreamer::GetPrefetchCount() const
 {
-    const int32 NewLoadedAssetCount = LoadingAssetReferences.Num();
-    if (NewLoadedAssetCount <= 0)
-    {
-        return;
-    }
+    const FRandomAssetCache& AssetCache = FRandomAssetCache::Get();
 
-    const int32 NumberOfAssetToAdd = FMath::Min(MAX_LOADED_ASSETS_COUNT - LoadedAssetReferences.Num(), NewLoadedAssetCount);
+    // Cover twice the time an asset take to load at the current pick rate
+    const float LoadingPickCount = PicksPerSecond * AssetCache.GetAverageLoadSeconds() * 2.f;
+    const int32 PrefetchCount = FMath::Max(FMath::CeilToInt(LoadingPickCount) + 1, MIN_PREFETCH_ASSETS_COUNT);
+    return FMath::Min(PrefetchCount, AssetCache.GetMaxPrefetchCount());
+}
 
-    for (int i = 0; i < NumberOfAssetToAdd; i++)
+void FRandomAssetStreamer::UpdatePrefetch()
+{
+    if (TotalAssetCount <= 0)
     {
-        LoadedAssetReferences.Add(LoadingAssetReferences[i]);
+        return;
     }
-    const int32 TotalLoadedAssetCount = LoadedAssetReferences.Num();
-    if (TotalLoadedAssetCount <= 0)
+
+    int32 NextMasterSeed = PickMasterSeed;
+    int32 NextEpoch = PickEpoch;
+    int32 NextPickIndex = PickIndex;
+    if (PrefetchedPicks.Num() > 0)
     {
-        return;
+        const FPrefetchedPick& LastPick = PrefetchedPicks.Last();
+        NextMasterSeed = LastPick.MasterSeed;
+        NextEpoch = LastPick.Epoch;
+        NextPickIndex = LastPick.PickIndex + 1;
     }
 
-    UnusedAssetCount += NewLoadedAssetCount;
-    LastLoadedAssetIndex = (LastLoadedAssetIndex + NumberOfAssetToAdd) % TotalLoadedAssetCount;
+    // When the epoch change, guess the picks continue in a later epoch once an epoch's usual picks are done
+    const int32 EpochPickCount = FMath::Max(FMath::RoundToInt(PicksPerEpoch), 1);
+    const int32 EpochStep = (PicksPerEpoch > 0.f) ? FMath::Max(FMath::RoundToInt(1.f / PicksPerEpoch), 1) : 1;
 
-    // If there are more assets to add then add them to the front of the list
-    if (NumberOfAssetToAdd < NewLoadedAssetCount)
+    FRandomAssetCache& AssetCache = FRandomAssetCache::Get();
+    const int32 PrefetchCount = GetPrefetchCount();
+    while (PrefetchedPicks.Num() < PrefetchCount)
     {
-        for (int i = 0; i < NewLoadedAssetCount - NumberOfAssetToAdd; i++)
+        if ((PicksPerEpoch > 0.f) && (NextPickIndex >= EpochPickCount))
         {
-            LoadedAssetReferences[LastLoadedAssetIndex] = LoadingAssetReferences[NumberOfAssetToAdd + i];
-            LastLoadedAssetIndex = (LastLoadedAssetIndex + 1) % TotalLoadedAssetCount;
+            NextEpoch += EpochStep;
+            NextPickIndex = 0;
         }
+
+        FPrefetchedPick NewPick;
+        NewPick.MasterSeed = NextMasterSeed;
+        NewPick.Epoch = NextEpoch;
+        NewPick.PickIndex = NextPickIndex;
+        NewPick.AssetPath = DrawPickedAsset(NextMasterSeed, NextEpoch, NextPickIndex);
+
+        AssetCache.Prefetch(NewPick.AssetPath);
+        PrefetchedPicks.Add(NewPick);
+        NextPickIndex++;
     }
+}
 
-    LoadingAssetReferences.Reset();
+void FRandomAssetStreamer::CancelPrefetch()
+{
+    if (PrefetchedPicks.Num() == 0)
+    {
+        return;
+    }
 
-    if (LoadedAssetReferences.Num() + MAX_ASYNC_LOAD_ASSETS_COUNT <= MAX_LOADED_ASSETS_COUNT)
+    FRandomAssetCache& AssetCache = FRandomAssetCache::Get();
+    for (const FPrefetchedPick& CheckPick : PrefetchedPicks)
     {
-        LoadNextBatch();
+        AssetCache.CancelPrefetch(CheckPick.AssetPath);
     }
+    PrefetchedPicks.Reset();
+}
+
+bool FRandomAssetStreamer::IsPickBehind(const FPrefetchedPick& CheckPick) const
+{
+    return (CheckPick.MasterSeed != PickMasterSeed)
+           || (CheckPick.Epoch < PickEpoch)
+           || ((CheckPick.Epoch == PickEpoch) && (CheckPick.PickIndex < PickIndex));
 }
 
 //=================================== Misc ===================================
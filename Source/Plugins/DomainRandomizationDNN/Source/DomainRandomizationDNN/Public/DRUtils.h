@@ -7,8 +7,11 @@
 #pragma once
 
 #include "DomainRandomizationDNNPCH.h"
+#include "NVRandomStream.h"
 #include "DRUtils.generated.h"
 
+class FRandomAssetSet;
+
 DECLARE_LOG_CATEGORY_EXTERN(LogNVDRUtils, Log, All)
 
 USTRUCT(BlueprintType)
@@ -20,10 +23,10 @@ public:
     FRandomRotationData();
 
     // Get a random rotation from the constrained data
-    FRotator GetRandomRotation() const;
+    FRotator GetRandomRotation(FNVRandomStream& RandomStream) const;
 
     // Get a random rotation related to (the constrained data is applied around) a fixed rotation
-    FRotator GetRandomRotationRelative(const FRotator& BaseRotation) const;
+    FRotator GetRandomRotationRelative(FNVRandomStream& RandomStream, const FRotator& BaseRotation) const;
 
     bool ShouldRandomized() const
     {
@@ -69,13 +72,13 @@ public:
     FRandomLocationData();
 
     // Get a random location from the constrained data
-    FVector GetRandomLocation() const;
+    FVector GetRandomLocation(FNVRandomStream& RandomStream) const;
 
     // Get a random location related to (the constrained data is applied around) a fixed location
-    FVector GetRandomLocationRelative(const FVector& BaseLocation) const;
+    FVector GetRandomLocationRelative(FNVRandomStream& RandomStream, const FVector& BaseLocation) const;
 
     // Get a random location in an object's local space
-    FVector GetRandomLocationInLocalSpace(const FTransform& ObjectTransform) const;
+    FVector GetRandomLocationInLocalSpace(FNVRandomStream& RandomStream, const FTransform& ObjectTransform) const;
 
     bool ShouldRandomized() const
     {
@@ -117,7 +120,7 @@ public:
     FRandomScale3DData();
 
     // Get a random 3d scale from the constrained data
-    FVector GetRandomScale3D() const;
+    FVector GetRandomScale3D(FNVRandomStream& RandomStream) const;
 
     bool ShouldRandomized() const
     {
@@ -183,11 +186,11 @@ public:
     void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent);
 #endif //WITH_EDITORONLY_DATA
 
-    FLinearColor GetRandomColor() const;
+    FLinearColor GetRandomColor(FNVRandomStream& RandomStream) const;
 
-    static FLinearColor GetRandomAnyColor();
-    static FLinearColor GetRandomColorInRange(const FLinearColor& Color1, const FLinearColor& Color2, const bool& bRandomizeInHSV);
-    static FLinearColor GetRandomColorAround(const FLinearColor& BaseColor, const float& HueDelta, const float& SaturationDelta, const float& ValueDelta);
+    static FLinearColor GetRandomAnyColor(FNVRandomStream& RandomStream);
+    static FLinearColor GetRandomColorInRange(FNVRandomStream& RandomStream, const FLinearColor& Color1, const FLinearColor& Color2, const bool& bRandomizeInHSV);
+    static FLinearColor GetRandomColorAround(FNVRandomStream& RandomStream, const FLinearColor& BaseColor, const float& HueDelta, const float& SaturationDelta, const float& ValueDelta);
 
 public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere)
@@ -279,9 +282,13 @@ struct DOMAINRANDOMIZATIONDNN_API FRandUtils
     GENERATED_BODY()
 
 public:
+    // NOTE: These use a random stream shared by all their callers, the randomization code should draw from its own stream instead
     static float RandGaussian(const float mean, const float variance);
     static FVector2D RandGaussian2D(const float mean, const float variance);
 
+    static float RandGaussian(FNVRandomStream& RandomStream, const float mean, const float variance);
+    static FVector2D RandGaussian2D(FNVRandomStream& RandomStream, const float mean, const float variance);
+
 };
 
 // Utility functions
@@ -294,7 +301,10 @@ namespace DRUtils
     extern TArray<UMeshComponent*> GetValidChildMeshComponents(AActor* OwnerActor);
 }
 
-// This struct manage a large amount numbers of assets by
+// This struct manage a large amount numbers of assets by picking them randomly and streaming them in
+// It's a random cursor over an asset set shared by all the streamers of the world using the same directories and class
+// The assets of the next picks are prefetched in the shared FRandomAssetCache, so they are already loaded when the randomization use them
+// The number of prefetched assets follow how fast the assets are picked and how long they take to load
 USTRUCT(BlueprintType)
 struct DOMAINRANDOMIZATIONDNN_API FRandomAssetStreamer
 {
@@ -307,11 +317,15 @@ public:
 
     FRandomAssetStreamer& operator= (const FRandomAssetStreamer& OtherStreamer);
 
-    void Init(const TArray<FDirectoryPath>& InAssetDirectories, UClass* InAssetClass);
+    /// @param WorldContextObject   Object in the world whose asset streaming service share the asset set, e.g: the component which own the streamer
+    /// @param StreamName           Name of the random stream the streamer pick the assets to load with, e.g: the key of the component which own it
+    void Init(const UObject* WorldContextObject, const TArray<FDirectoryPath>& InAssetDirectories, UClass* InAssetClass, const FString& StreamName = FString());
+    // Get the asset set of the managed directories and class from the world's asset streaming service
     void ScanPath();
 
     int GetAssetsCount() const;
     bool HasAssets() const;
+    // Pick a random asset, it's loaded synchronously if its prefetch isn't done yet
     FSoftObjectPath GetNextAssetReference();
 
     template <typename AssetClassType>
@@ -323,27 +337,31 @@ public:
                 : nullptr);
     }
 
+    // Whether some of the prefetched assets are still loading
     bool IsLoadingAssets() const;
 
 protected:
-    void LoadNextBatch(bool bAsyncLoad = true);
-    void OnAssetBatchLoaded();
-
-private:
-
-    struct FRandomAssetStreamerCallback
+    // Get the path of a managed asset, the assets are indexed across all the managed directories
+    FSoftObjectPath GetAssetReference(int32 AssetIndex) const;
+    // Draw the asset of a pick, the picks are numbered in the random streams' master seed and epoch like the streams' values
+    FSoftObjectPath DrawPickedAsset(int32 MasterSeed, int32 Epoch, int32 InPickIndex);
+    // Update the average number of picks per second and per epoch, and move to the current master seed and epoch
+    void UpdatePickRate();
+    // Number of assets to prefetch so they are loaded before they are picked
+    int32 GetPrefetchCount() const;
+    // Prefetch the assets of the next picks
+    void UpdatePrefetch();
+    void CancelPrefetch();
+
+    struct FPrefetchedPick
     {
-    public:
-        FRandomAssetStreamer* AssetStreamer;
-
-        void Callback()
-        {
-            if (AssetStreamer)
-            {
-                AssetStreamer->OnAssetBatchLoaded();
-            }
-        }
+        int32 MasterSeed;
+        int32 Epoch;
+        int32 PickIndex;
+        FSoftObjectPath AssetPath;
     };
+    // Whether a prefetched pick is before the next pick, e.g: it was in an epoch without picks
+    bool IsPickBehind(const FPrefetchedPick& CheckPick) const;
 
 protected: // Transient properties
     // Path to the directory where we want to get the assets from
@@ -354,31 +372,31 @@ protected: // Transient properties
     UPROPERTY(Transient)
     UClass* ManagedAssetClass;
 
-    // List of all the assets in the managed directory
-    UPROPERTY(Transient)
-    TArray<FSoftObjectPath> AllAssetReferences;
-
-    // Circular queue of loaded assets
-    UPROPERTY(Transient)
-    TArray<FSoftObjectPath> LoadedAssetReferences;
-
-    // List of assets is streaming in
+    // Number of assets in the managed directories
     UPROPERTY(Transient)
-    TArray<FSoftObjectPath> LoadingAssetReferences;
-
-    UPROPERTY(Transient)
-    int32 LastLoadedAssetIndex;
-
-    UPROPERTY(Transient)
-    int32 LastUsedAssetIndex;
-
-    UPROPERTY(Transient)
-    int32 UnusedAssetCount;
-
-    FStreamableManager AssetStreamer;
-
-    TSharedPtr<FStreamableHandle> StreamableHandlePtr;
-    TSharedPtr<FRandomAssetStreamerCallback> StreamerCallbackPtr;
+    int32 TotalAssetCount;
+
+    // The master seed and epoch of the random streams when the last asset was picked, and the index of the next pick in them
+    int32 PickMasterSeed;
+    int32 PickEpoch;
+    int32 PickIndex;
+    // Average number of picks in an epoch, 0 while the epoch doesn't change
+    float PicksPerEpoch;
+    float PicksPerSecond;
+    double LastPickTime;
+
+    // The stream the picks are drawn from, it's pinned in the epoch of the last drawn pick
+    FNVRandomStream RandomStream;
+    // Number of picks drawn from the random stream in its epoch
+    int32 DrawnPickCount;
+
+    // The picks whose assets are prefetched, in the order they will be used
+    TArray<FPrefetchedPick> PrefetchedPicks;
+
+    // The world whose asset streaming service the asset set come from
+    TWeakObjectPtr<UWorld> OwnerWorld;
+    // The managed assets, shared with the other streamers of the world using the same directories and class
+    TSharedPtr<FRandomAssetSet> AssetSet;
 };
 
 // This enum is used by random material components to select which components it should modify material
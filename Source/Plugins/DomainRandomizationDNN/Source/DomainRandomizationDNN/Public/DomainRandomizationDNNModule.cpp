@@ -6,6 +6,7 @@
 
 #include "DomainRandomizationDNNPCH.h"
 #include "DomainRandomizationDNNModule.h"
+#include "RandomAssetCache.h"
 #include "ModuleManager.h"
 
 IMPLEMENT_GAME_MODULE(FDomainRandomizationDNNModule, DomainRandomizationDNN);
@@ -18,6 +19,8 @@ void FDomainRandomizationDNNModule::StartupModule()
 
 void FDomainRandomizationDNNModule::ShutdownModule()
 {
+    // NOTE: Release the streamed assets while the asset manager still exist
+    FRandomAssetCache::Get().Reset();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -11,13 +11,39 @@
 #include "NVSceneCapturerActor.h"
 #include "NVSceneManager.h"
 #include "NVObjectMaskManager.h"
+#include "NVRandomizationLog.h"
+#include "RandomComponentBase.h"
+#include "InstancedDistractorActor.h"
 #include "GroupActorManager.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    FAutoConsoleCommand GroupActorPoolStatsCommand(
+        TEXT("NV.GroupActorPoolStats"),
+        TEXT("Print how many actors each group actor manager spawned, reused from its pool and destroyed, and its instanced distractors"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            for (TObjectIterator<AGroupActorManager> It; It; ++It)
+            {
+                const UWorld* ManagerWorld = It->GetWorld();
+                if (ManagerWorld && ManagerWorld->IsGameWorld() && !It->IsPendingKill())
+                {
+                    It->LogActorPoolStats();
+                }
+            }
+        }));
+}
 
 // Sets default values
 AGroupActorManager::AGroupActorManager(const FObjectInitializer& ObjectInitializer)
 {
     PrimaryActorTick.bCanEverTick = true;
     PrimaryActorTick.TickGroup = TG_PrePhysics;
+    SpawningActorIndex = INDEX_NONE;
 
     LayoutGenerator = nullptr;
     bAutoActive = true;
@@ -29,12 +55,43 @@ AGroupActorManager::AGroupActorManager(const FObjectInitializer& ObjectInitializ
     SpawnDuration = 0.f;
     CountPerActor = FInt32Interval(1, 1);
     TotalNumberOfActorsToSpawn = FInt32Interval(0, 0);
+
+    bUseActorPool = true;
+    PoolWarmUpCountPerClass = 0;
+    MaxPooledActorsPerClass = 64;
+
+    bUseInstancedDistractors = false;
+    DistractorColorCount = 0;
+    DistractorColorParameterName = TEXT("Color");
+    DistractorScaleRange = FFloatInterval(1.f, 1.f);
+    DistractorSeed = 0;
+    DistractorMasterSeed = 0;
+    DistractorEpoch = 0;
+
+    bActorPoolWarmedUp = false;
+    SpawnedActorCount = 0;
+    ReusedActorCount = 0;
+    DestroyedActorCount = 0;
 }
 
 void AGroupActorManager::BeginPlay()
 {
     Super::BeginPlay();
 
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Get(GetWorld());
+    if (RandomizationLog)
+    {
+        FNVRandomizationLogSource LogSource;
+        LogSource.SourceObject = this;
+        // NOTE: The group must be spawned before the states of the spawned actors' components are restored
+        LogSource.Priority = 0;
+        LogSource.GetKey = [this]() { return GetName(); };
+        LogSource.SerializeState = [this](FArchive& Ar) { SerializeRandomizationState(Ar); };
+        RandomizationLog->RegisterSource(LogSource);
+    }
+
+    RandomStream.Initialize(GetName());
+
     if (bAutoActive)
     {
         SpawnActors();
@@ -47,7 +104,9 @@ void AGroupActorManager::BeginPlay()
 
 void AGroupActorManager::SpawnActors()
 {
-    DestroyManagedActors();
+    ReleaseManagedActors();
+    // NOTE: The pool is warmed up here rather than in BeginPlay so the settings from the command line are applied first
+    WarmUpActorPool();
 
     TArray<FNVActorTemplateConfig> ActorTemplates;
     ActorTemplates.Reset();
@@ -72,11 +131,11 @@ void AGroupActorManager::SpawnActors()
         {
             const int MeshCount = OverrideActorMeshes.Num();
             SpawnMeshes.Reset();
-            int TotalNumberOfActors = FMath::RandRange(TotalNumberOfActorsToSpawn.Min, TotalNumberOfActorsToSpawn.Max);
+            int TotalNumberOfActors = RandomStream.RandRange(TotalNumberOfActorsToSpawn.Min, TotalNumberOfActorsToSpawn.Max);
             for (int i = 0; i < TotalNumberOfActors; i++)
             {
                 // Pick a random mesh from the list
-                UStaticMesh* CheckMesh = OverrideActorMeshes[FMath::Rand() % MeshCount];
+                UStaticMesh* CheckMesh = OverrideActorMeshes[RandomStream.RandHelper(MeshCount)];
                 // TODO: Make sure the mesh is valid
                 SpawnMeshes.Add(CheckMesh);
             }
@@ -92,7 +151,7 @@ void AGroupActorManager::SpawnActors()
             UStaticMesh* CheckMesh = SpawnMeshes[i];
             if (CheckMesh)
             {
-                const int32 NumberInstanceOfActor = FMath::Max(FMath::RandRange(CountPerActor.Min, CountPerActor.Max), 0);
+                const int32 NumberInstanceOfActor = FMath::Max(RandomStream.RandRange(CountPerActor.Min, CountPerActor.Max), 0);
                 for (int j = 0; j < NumberInstanceOfActor; j++)
                 {
                     FNVActorTemplateConfig NewActorTemplate;
@@ -108,12 +167,12 @@ void AGroupActorManager::SpawnActors()
         if (bSpawnTotalNumberOfActors)
         {
             const int NumberOfActorClasses = ActorClassesToSpawn.Num();
-            int TotalNumberOfActors = FMath::RandRange(TotalNumberOfActorsToSpawn.Min, TotalNumberOfActorsToSpawn.Max);
+            int TotalNumberOfActors = RandomStream.RandRange(TotalNumberOfActorsToSpawn.Min, TotalNumberOfActorsToSpawn.Max);
             for (int i = 0; i < TotalNumberOfActors; i++)
             {
                 // Pick a random class from the list
                 FNVActorTemplateConfig NewActorTemplate;
-                NewActorTemplate.ActorClass = ActorClassesToSpawn[FMath::Rand() % NumberOfActorClasses];
+                NewActorTemplate.ActorClass = ActorClassesToSpawn[RandomStream.RandHelper(NumberOfActorClasses)];
                 NewActorTemplate.ActorOverrideMesh = nullptr;
                 ActorTemplates.Add(NewActorTemplate);
             }
@@ -126,7 +185,7 @@ void AGroupActorManager::SpawnActors()
                 TSubclassOf<AActor> ActorClass = ActorClassesToSpawn[i];
                 if (ActorClass)
                 {
-                    const int32 NumberInstanceOfActor = FMath::Max(FMath::RandRange(CountPerActor.Min, CountPerActor.Max), 0);
+                    const int32 NumberInstanceOfActor = FMath::Max(RandomStream.RandRange(CountPerActor.Min, CountPerActor.Max), 0);
                     for (int j = 0; j < NumberInstanceOfActor; j++)
                     {
                         FNVActorTemplateConfig NewActorTemplate;
@@ -138,13 +197,45 @@ void AGroupActorManager::SpawnActors()
             }
         }
     }
+
+    DistractorMeshes.Reset();
+    DistractorMeshCounts.Reset();
+    if (bUseInstancedDistractors)
+    {
+        // The templates which aren't annotated are rendered as instances instead of being spawned
+        TArray<FNVActorTemplateConfig> ActorTemplatesToSpawn;
+        for (const FNVActorTemplateConfig& ActorTemplate : ActorTemplates)
+        {
+            UStaticMesh* DistractorMesh = GetInstancedDistractorMesh(ActorTemplate);
+            if (DistractorMesh)
+            {
+                const int32 DistractorMeshIndex = DistractorMeshes.AddUnique(DistractorMesh);
+                if (DistractorMeshIndex == DistractorMeshCounts.Num())
+                {
+                    DistractorMeshCounts.Add(0);
+                }
+                DistractorMeshCounts[DistractorMeshIndex]++;
+            }
+            else
+            {
+                ActorTemplatesToSpawn.Add(ActorTemplate);
+            }
+        }
+        ActorTemplates = MoveTemp(ActorTemplatesToSpawn);
+
+        DistractorSeed = RandomStream.GetUnsignedInt();
+        DistractorMasterSeed = FNVRandomStream::GetMasterSeed();
+        DistractorEpoch = FNVRandomStream::GetEpoch();
+    }
+    RandomizeDistractors();
+
     const uint32 NumberOfActorsToSpawn = (uint32)ActorTemplates.Num();
     // Randomly rearrange the templates in the list
     for (uint32 i = NumberOfActorsToSpawn / 2; i < NumberOfActorsToSpawn; i++)
     {
         if (i > 0)
         {
-            uint32 j = FMath::RandRange(0, i - 1);
+            uint32 j = RandomStream.RandHelper(i);
             ActorTemplates.Swap(i, j);
         }
     }
@@ -158,11 +249,116 @@ void AGroupActorManager::SpawnActors()
         const FNVActorTemplateConfig& ActorTemplate = ActorTemplates[i];
         const FTransform& ActorTransform = ActorTransformList[i];
 
-        AActor* NewActor = CreateActorFromTemplate(ActorTemplate, ActorTransform);
-        if (NewActor)
+        AddManagedActor(ActorTemplate, ActorTransform);
+    }
+}
+
+void AGroupActorManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Find(GetWorld());
+    if (RandomizationLog)
+    {
+        RandomizationLog->UnregisterSource(this);
+    }
+
+    // NOTE: The pooled actors are destroyed with the world otherwise
+    if (EndPlayReason == EEndPlayReason::Destroyed)
+    {
+        DestroyPooledActors();
+        DestroyDistractorActors();
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AGroupActorManager::AddManagedActor(const FNVActorTemplateConfig& ActorTemplate, const FTransform& ActorTransform)
+{
+    SpawningActorIndex = ManagedActors.Num();
+    AActor* NewActor = AcquireActor(ActorTemplate, ActorTransform);
+    SpawningActorIndex = INDEX_NONE;
+    if (NewActor)
+    {
+        ManagedActors.Add(NewActor);
+        ManagedActorTemplates.Add(ActorTemplate);
+        ManagedActorTransforms.Add(ActorTransform);
+    }
+}
+
+int32 AGroupActorManager::GetManagedActorIndex(const AActor* CheckActor) const
+{
+    if (!CheckActor)
+    {
+        return INDEX_NONE;
+    }
+
+    const int32 ManagedActorIndex = ManagedActors.IndexOfByKey(CheckActor);
+    if ((ManagedActorIndex == INDEX_NONE) && (SpawningActorIndex != INDEX_NONE) && (CheckActor->GetOwner() == this))
+    {
+        return SpawningActorIndex;
+    }
+    return ManagedActorIndex;
+}
+
+void AGroupActorManager::SerializeRandomizationState(FArchive& Ar)
+{
+    // NOTE: The actors' transforms are their spawn transforms, the randomization components restore where the actors moved to
+    TArray<FNVActorTemplateConfig> GroupTemplates = ManagedActorTemplates;
+    TArray<FTransform> GroupTransforms = ManagedActorTransforms;
+    int32 GroupActorCount = GroupTemplates.Num();
+    Ar << GroupActorCount;
+    if (Ar.IsLoading())
+    {
+        GroupActorCount = FMath::Max(GroupActorCount, 0);
+        GroupTemplates.SetNum(GroupActorCount);
+        GroupTransforms.SetNum(GroupActorCount);
+    }
+    for (int32 i = 0; (i < GroupActorCount) && !Ar.IsError(); i++)
+    {
+        FNVActorTemplateConfig& ActorTemplate = GroupTemplates[i];
+        UClass* ActorClass = ActorTemplate.ActorClass;
+        FNVRandomizationLog::SerializeObjectReference(Ar, ActorClass);
+        FNVRandomizationLog::SerializeObjectReference(Ar, ActorTemplate.ActorOverrideMesh);
+        Ar << GroupTransforms[i];
+        ActorTemplate.ActorClass = ActorClass;
+    }
+
+    // NOTE: Only the distractors' meshes and their stream are logged, their transforms and colors are randomized again from the stream
+    TArray<UStaticMesh*> GroupDistractorMeshes = DistractorMeshes;
+    TArray<int32> GroupDistractorMeshCounts = DistractorMeshCounts;
+    int32 GroupDistractorMeshCount = GroupDistractorMeshes.Num();
+    Ar << GroupDistractorMeshCount;
+    if (Ar.IsLoading())
+    {
+        GroupDistractorMeshCount = FMath::Max(GroupDistractorMeshCount, 0);
+        GroupDistractorMeshes.SetNum(GroupDistractorMeshCount);
+        GroupDistractorMeshCounts.SetNum(GroupDistractorMeshCount);
+    }
+    for (int32 i = 0; (i < GroupDistractorMeshCount) && !Ar.IsError(); i++)
+    {
+        FNVRandomizationLog::SerializeObjectReference(Ar, GroupDistractorMeshes[i]);
+        Ar << GroupDistractorMeshCounts[i];
+    }
+    uint32 GroupDistractorSeed = DistractorSeed;
+    int32 GroupDistractorMasterSeed = DistractorMasterSeed;
+    int32 GroupDistractorEpoch = DistractorEpoch;
+    Ar << GroupDistractorSeed;
+    Ar << GroupDistractorMasterSeed;
+    Ar << GroupDistractorEpoch;
+
+    if (Ar.IsLoading() && !Ar.IsError())
+    {
+        ReleaseManagedActors();
+        for (int32 i = 0; i < GroupActorCount; i++)
         {
-            ManagedActors.Add(NewActor);
+            AddManagedActor(GroupTemplates[i], GroupTransforms[i]);
         }
+
+        DistractorMeshes = GroupDistractorMeshes;
+        DistractorMeshCounts = GroupDistractorMeshCounts;
+        DistractorSeed = GroupDistractorSeed;
+        DistractorMasterSeed = GroupDistractorMasterSeed;
+        DistractorEpoch = GroupDistractorEpoch;
+        RandomizeDistractors();
     }
 }
 
@@ -234,45 +430,445 @@ AActor* AGroupActorManager::CreateActorFromTemplate(const FNVActorTemplateConfig
 
         if (NewActor)
         {
-            // TODO: Pass shared config data to the new actor
-            if (ActorTemplate.ActorOverrideMesh)
+            SpawnedActorCount++;
+            ApplyActorTemplate(NewActor, ActorTemplate);
+        }
+    }
+
+    return NewActor;
+}
+
+void AGroupActorManager::ApplyActorTemplate(AActor* ManagedActor, const FNVActorTemplateConfig& ActorTemplate)
+{
+    check(ManagedActor);
+
+    // TODO: Pass shared config data to the new actor
+    if (ActorTemplate.ActorOverrideMesh)
+    {
+        ANVAnnotatedActor* AnnotatedActor = Cast<ANVAnnotatedActor>(ManagedActor);
+        if (AnnotatedActor)
+        {
+            AnnotatedActor->SetStaticMesh(ActorTemplate.ActorOverrideMesh);
+
+            ANVSceneManager* SceneManager = ANVSceneManager::GetANVSceneManagerPtr();
+            if (SceneManager)
+            {
+                const uint32 ClassSegmentationId = SceneManager->ObjectClassSegmentation.GetInstanceId(AnnotatedActor);
+                AnnotatedActor->SetClassSegmentationId(ClassSegmentationId);
+            }
+        }
+        else
+        {
+            UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(ManagedActor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
+            if (StaticMeshComp)
+            {
+                StaticMeshComp->SetStaticMesh(ActorTemplate.ActorOverrideMesh);
+            }
+        }
+    }
+
+    if (RandomLocationVolume)
+    {
+        URandomMovementComponent* MovementComp = Cast<URandomMovementComponent>(ManagedActor->GetComponentByClass(URandomMovementComponent::StaticClass()));
+        if (MovementComp)
+        {
+            MovementComp->SetRandomLocationVolume(RandomLocationVolume, true);
+        }
+    }
+}
+
+AActor* AGroupActorManager::AcquireActor(const FNVActorTemplateConfig& ActorTemplate, const FTransform& ActorTransform)
+{
+    UClass* ActorClass = ActorTemplate.ActorClass;
+    FNVGroupActorPool* ActorPool = ActorClass ? ActorPools.Find(ActorClass) : nullptr;
+    AActor* PooledActor = nullptr;
+    while (ActorPool && (ActorPool->Actors.Num() > 0) && !PooledActor)
+    {
+        // NOTE: The pooled actors may have been destroyed by something else, e.g: a level streaming out
+        AActor* CheckActor = ActorPool->Actors.Pop(false);
+        if (CheckActor && !CheckActor->IsPendingKillPending())
+        {
+            PooledActor = CheckActor;
+        }
+    }
+
+    if (!PooledActor)
+    {
+        AActor* NewActor = CreateActorFromTemplate(ActorTemplate, ActorTransform);
+        if (NewActor)
+        {
+            UpdateActorSegmentationMasks(NewActor);
+        }
+        return NewActor;
+    }
+
+    ReusedActorCount++;
+
+    PooledActor->SetActorTransform(ActorTransform, false, nullptr, ETeleportType::ResetPhysics);
+    PooledActor->SetActorHiddenInGame(false);
+    // Restore the actor and its components to the state they are spawned in
+    const AActor* DefaultActor = PooledActor->GetClass()->GetDefaultObject<AActor>();
+    PooledActor->SetActorEnableCollision(DefaultActor->GetActorEnableCollision());
+    PooledActor->SetActorTickEnabled(PooledActor->PrimaryActorTick.bStartWithTickEnabled);
+    for (UActorComponent* CheckComp : PooledActor->GetComponents())
+    {
+        if (CheckComp)
+        {
+            if (CheckComp->bAutoActivate)
             {
-                ANVAnnotatedActor* AnnotatedActor = Cast<ANVAnnotatedActor>(NewActor);
-                if (AnnotatedActor)
-                {
-                    AnnotatedActor->SetStaticMesh(ActorTemplate.ActorOverrideMesh);
+                CheckComp->Activate(true);
+            }
 
-                    ANVSceneManager* SceneManager = ANVSceneManager::GetANVSceneManagerPtr();
-                    if (SceneManager)
-                    {
-                        const uint32 ClassSegmentationId = SceneManager->ObjectClassSegmentation.GetInstanceId(AnnotatedActor);
-                        AnnotatedActor->SetClassSegmentationId(ClassSegmentationId);
-                    }
-                }
-                else
+            UPrimitiveComponent* CheckPrimitiveComp = Cast<UPrimitiveComponent>(CheckComp);
+            const UPrimitiveComponent* ArchetypePrimitiveComp = CheckPrimitiveComp ? Cast<UPrimitiveComponent>(CheckPrimitiveComp->GetArchetype()) : nullptr;
+            if (ArchetypePrimitiveComp && ArchetypePrimitiveComp->BodyInstance.bSimulatePhysics)
+            {
+                CheckPrimitiveComp->SetSimulatePhysics(true);
+            }
+        }
+    }
+
+    // NOTE: The random components randomize before the template is applied, the same as when a new actor begin play
+    TInlineComponentArray<URandomComponentBase*> RandomComponents(PooledActor);
+    for (URandomComponentBase* RandomComp : RandomComponents)
+    {
+        RandomComp->OnOwnerReusedFromPool();
+    }
+
+    ApplyActorTemplate(PooledActor, ActorTemplate);
+    UpdateActorSegmentationMasks(PooledActor);
+
+    return PooledActor;
+}
+
+void AGroupActorManager::ReleaseActor(AActor* ManagedActor)
+{
+    if (!ManagedActor || ManagedActor->IsPendingKillPending())
+    {
+        return;
+    }
+
+    ManagedActor->SetActorHiddenInGame(true);
+    // The hidden actor don't have a mask anymore
+    UpdateActorSegmentationMasks(ManagedActor);
+
+    const FNVGroupActorPool* ExistingActorPool = ActorPools.Find(ManagedActor->GetClass());
+    const int32 PooledActorCount = ExistingActorPool ? ExistingActorPool->Actors.Num() : 0;
+    if (!bUseActorPool || (PooledActorCount >= MaxPooledActorsPerClass))
+    {
+        ManagedActor->Destroy();
+        DestroyedActorCount++;
+        return;
+    }
+
+    TInlineComponentArray<URandomComponentBase*> RandomComponents(ManagedActor);
+    for (URandomComponentBase* RandomComp : RandomComponents)
+    {
+        RandomComp->OnOwnerReleasedToPool();
+    }
+
+    ManagedActor->SetActorEnableCollision(false);
+    ManagedActor->SetActorTickEnabled(false);
+    for (UActorComponent* CheckComp : ManagedActor->GetComponents())
+    {
+        if (CheckComp)
+        {
+            // NOTE: The simulating bodies would keep falling while their collision is disabled
+            UPrimitiveComponent* CheckPrimitiveComp = Cast<UPrimitiveComponent>(CheckComp);
+            if (CheckPrimitiveComp && CheckPrimitiveComp->IsSimulatingPhysics())
+            {
+                CheckPrimitiveComp->SetSimulatePhysics(false);
+            }
+
+            CheckComp->Deactivate();
+        }
+    }
+
+    ActorPools.FindOrAdd(ManagedActor->GetClass()).Actors.Add(ManagedActor);
+}
+
+void AGroupActorManager::DestroyPooledActors()
+{
+    for (auto& ActorPoolPair : ActorPools)
+    {
+        for (AActor* CheckActor : ActorPoolPair.Value.Actors)
+        {
+            if (CheckActor)
+            {
+                CheckActor->Destroy();
+                DestroyedActorCount++;
+            }
+        }
+    }
+    ActorPools.Reset();
+}
+
+void AGroupActorManager::WarmUpActorPool()
+{
+    if (bActorPoolWarmedUp)
+    {
+        return;
+    }
+    bActorPoolWarmedUp = true;
+
+    const int32 WarmUpCount = FMath::Min(PoolWarmUpCountPerClass, MaxPooledActorsPerClass);
+    if (!bUseActorPool || (WarmUpCount <= 0))
+    {
+        return;
+    }
+
+    // NOTE: Only the first class is spawned when the meshes are overridden
+    TArray<UClass*> WarmUpClasses;
+    for (const TSubclassOf<AActor>& ActorClass : ActorClassesToSpawn)
+    {
+        if (ActorClass)
+        {
+            // The classes rendered as instanced distractors are never spawned
+            FNVActorTemplateConfig ClassTemplate;
+            ClassTemplate.ActorClass = ActorClass;
+            ClassTemplate.ActorOverrideMesh = (OverrideActorMeshes.Num() > 0) ? OverrideActorMeshes[0] : nullptr;
+            if (!bUseInstancedDistractors || !GetInstancedDistractorMesh(ClassTemplate))
+            {
+                WarmUpClasses.AddUnique(ActorClass);
+            }
+            if (OverrideActorMeshes.Num() > 0)
+            {
+                break;
+            }
+        }
+    }
+
+    const FTransform& PoolTransform = GetActorTransform();
+    int32 WarmUpActorCount = 0;
+    for (UClass* ActorClass : WarmUpClasses)
+    {
+        FNVActorTemplateConfig WarmUpTemplate;
+        WarmUpTemplate.ActorClass = ActorClass;
+        WarmUpTemplate.ActorOverrideMesh = nullptr;
+
+        const FNVGroupActorPool* ActorPool = ActorPools.Find(ActorClass);
+        const int32 SpawnCount = WarmUpCount - (ActorPool ? ActorPool->Actors.Num() : 0);
+        for (int32 i = 0; i < SpawnCount; i++)
+        {
+            AActor* NewActor = CreateActorFromTemplate(WarmUpTemplate, PoolTransform);
+            if (!NewActor)
+            {
+                break;
+            }
+            ReleaseActor(NewActor);
+            WarmUpActorCount++;
+        }
+    }
+
+    UE_LOG(LogNVDRUtils, Log, TEXT("AGroupActorManager '%s' - Warmed up the actor pool with %d actors of %d classes"), *GetName(), WarmUpActorCount, WarmUpClasses.Num());
+}
+
+void AGroupActorManager::UpdateActorSegmentationMasks(AActor* ManagedActor)
+{
+    ANVSceneManager* SceneManager = ANVSceneManager::GetANVSceneManagerPtr();
+    if (SceneManager && ManagedActor)
+    {
+        SceneManager->ObjectClassSegmentation.UpdateActorMask(ManagedActor);
+        SceneManager->ObjectInstanceSegmentation.UpdateActorMask(ManagedActor);
+    }
+}
+
+UStaticMesh* AGroupActorManager::GetInstancedDistractorMesh(const FNVActorTemplateConfig& ActorTemplate)
+{
+    UClass* ActorClass = ActorTemplate.ActorClass;
+    if (!ActorClass || ActorClass->IsChildOf(ANVAnnotatedActor::StaticClass()))
+    {
+        return nullptr;
+    }
+
+    if (ActorTemplate.ActorOverrideMesh)
+    {
+        return ActorTemplate.ActorOverrideMesh;
+    }
+
+    const AActor* DefaultActor = ActorClass->GetDefaultObject<AActor>();
+    const UStaticMeshComponent* DefaultMeshComp = Cast<UStaticMeshComponent>(DefaultActor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
+    // NOTE: The components added in a blueprint are only in its construction script, not in its default object
+    for (const UBlueprintGeneratedClass* BlueprintClass = Cast<UBlueprintGeneratedClass>(ActorClass); BlueprintClass && !DefaultMeshComp;
+         BlueprintClass = Cast<UBlueprintGeneratedClass>(BlueprintClass->GetSuperClass()))
+    {
+        if (BlueprintClass->SimpleConstructionScript)
+        {
+            for (const USCS_Node* CheckNode : BlueprintClass->SimpleConstructionScript->GetAllNodes())
+            {
+                DefaultMeshComp = CheckNode ? Cast<UStaticMeshComponent>(CheckNode->ComponentTemplate) : nullptr;
+                if (DefaultMeshComp)
                 {
-                    UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(NewActor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
-                    if (StaticMeshComp)
-                    {
-                        StaticMeshComp->SetStaticMesh(ActorTemplate.ActorOverrideMesh);
-                    }
+                    break;
                 }
             }
+        }
+    }
+
+    return DefaultMeshComp ? DefaultMeshComp->GetStaticMesh() : nullptr;
+}
+
+int32 AGroupActorManager::GetDistractorCount() const
+{
+    int32 DistractorCount = 0;
+    for (const int32 DistractorMeshCount : DistractorMeshCounts)
+    {
+        DistractorCount += DistractorMeshCount;
+    }
+    return DistractorCount;
+}
+
+void AGroupActorManager::RandomizeDistractors()
+{
+    // NOTE: The distractors have their own stream, so restoring them from the log doesn't depend on the group's other random values
+    FNVRandomStream DistractorStream(FString::Printf(TEXT("%s.Distractors.%u"), *GetName(), DistractorSeed));
+    DistractorStream.PinEpoch(DistractorMasterSeed, DistractorEpoch);
+
+    const bool bUseColors = (DistractorColorCount > 0) && !DistractorColorParameterName.IsNone();
+    const int32 ColorCount = bUseColors ? DistractorColorCount : 1;
+    const FTransform& LayoutTransform = GetActorTransform();
+
+    TArray<AInstancedDistractorActor*> UsedDistractorActors;
+    TArray<FVector> DistractorLocations;
+    TArray<FQuat> DistractorRotations;
+    TArray<float> DistractorScales;
+    TArray<uint32> DistractorColorPicks;
+    TArray<TArray<FTransform>> ColorInstanceTransforms;
+    ColorInstanceTransforms.SetNum(ColorCount);
+
+    for (int32 MeshIndex = 0; MeshIndex < DistractorMeshes.Num(); MeshIndex++)
+    {
+        UStaticMesh* DistractorMesh = DistractorMeshes[MeshIndex];
+        const int32 DistractorCount = DistractorMeshCounts.IsValidIndex(MeshIndex) ? DistractorMeshCounts[MeshIndex] : 0;
+        if (!DistractorMesh || (DistractorCount <= 0))
+        {
+            continue;
+        }
+
+        // Draw all the instances' values in batches
+        DistractorLocations.SetNumUninitialized(DistractorCount);
+        DistractorRotations.SetNumUninitialized(DistractorCount);
+        DistractorScales.SetNumUninitialized(DistractorCount);
+        DistractorColorPicks.SetNumUninitialized(DistractorCount);
+        if (RandomLocationVolume)
+        {
+            DistractorStream.FillPointsInBox(DistractorLocations, RandomLocationVolume->GetComponentsBoundingBox());
+        }
+        else
+        {
+            const TArray<FTransform>& LayoutTransforms = LayoutGenerator ? LayoutGenerator->GetTransformForActors(LayoutTransform, DistractorCount)
+                    : USpatialLayoutGenerator::GetDefaultTransformForActors(LayoutTransform, DistractorCount);
+            for (int32 i = 0; i < DistractorCount; i++)
+            {
+                DistractorLocations[i] = LayoutTransforms.IsValidIndex(i) ? LayoutTransforms[i].GetLocation() : LayoutTransform.GetLocation();
+            }
+        }
+        DistractorStream.FillRotations(DistractorRotations);
+        DistractorStream.FillUniform(DistractorScales, DistractorScaleRange.Min, DistractorScaleRange.Max);
+        DistractorStream.FillUnsignedInts(DistractorColorPicks);
+
+        for (TArray<FTransform>& InstanceTransforms : ColorInstanceTransforms)
+        {
+            InstanceTransforms.Reset();
+        }
+        for (int32 i = 0; i < DistractorCount; i++)
+        {
+            const int32 ColorIndex = (int32)(DistractorColorPicks[i] % (uint32)ColorCount);
+            ColorInstanceTransforms[ColorIndex].Emplace(DistractorRotations[i], DistractorLocations[i], FVector(DistractorScales[i]));
+        }
 
-            if (RandomLocationVolume)
+        for (int32 ColorIndex = 0; ColorIndex < ColorCount; ColorIndex++)
+        {
+            const TArray<FTransform>& InstanceTransforms = ColorInstanceTransforms[ColorIndex];
+            AInstancedDistractorActor* DistractorActor = (InstanceTransforms.Num() > 0) ? GetDistractorActor(DistractorMesh, ColorIndex) : nullptr;
+            if (DistractorActor)
             {
-                URandomMovementComponent* MovementComp = Cast<URandomMovementComponent>(NewActor->GetComponentByClass(URandomMovementComponent::StaticClass()));
-                if (MovementComp)
+                if (bUseColors)
                 {
-                    MovementComp->SetRandomLocationVolume(RandomLocationVolume, true);
+                    DistractorActor->SetDistractorColor(DistractorColorData.GetRandomColor(DistractorStream));
                 }
+                DistractorActor->SetInstanceTransforms(InstanceTransforms);
+                UpdateActorSegmentationMasks(DistractorActor);
+                UsedDistractorActors.Add(DistractorActor);
             }
         }
     }
 
+    // Hide the distractor actors which aren't used by this group
+    for (AInstancedDistractorActor* DistractorActor : DistractorActors)
+    {
+        if (DistractorActor && !UsedDistractorActors.Contains(DistractorActor) && (DistractorActor->GetInstanceCount() > 0))
+        {
+            DistractorActor->SetInstanceTransforms(TArray<FTransform>());
+            UpdateActorSegmentationMasks(DistractorActor);
+        }
+    }
+}
+
+AInstancedDistractorActor* AGroupActorManager::GetDistractorActor(UStaticMesh* DistractorMesh, int32 ColorIndex)
+{
+    for (int32 i = 0; i < DistractorActors.Num(); i++)
+    {
+        AInstancedDistractorActor* CheckActor = DistractorActors[i];
+        if (CheckActor && (CheckActor->GetDistractorMesh() == DistractorMesh) && (DistractorActorColorIndexes[i] == ColorIndex))
+        {
+            return CheckActor;
+        }
+    }
+
+    UWorld* World = GetWorld();
+    ensure(World);
+    if (!World)
+    {
+        return nullptr;
+    }
+
+    FActorSpawnParameters SpawnParam;
+    SpawnParam.Owner = this;
+    SpawnParam.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    AInstancedDistractorActor* NewActor = World->SpawnActor<AInstancedDistractorActor>(AInstancedDistractorActor::StaticClass(), FTransform::Identity, SpawnParam);
+    if (NewActor)
+    {
+        const bool bUseColors = (DistractorColorCount > 0);
+        NewActor->SetDistractorMesh(DistractorMesh, bUseColors ? DistractorColorParameterName : NAME_None);
+        DistractorActors.Add(NewActor);
+        DistractorActorColorIndexes.Add(ColorIndex);
+    }
     return NewActor;
 }
 
+void AGroupActorManager::DestroyDistractorActors()
+{
+    for (AInstancedDistractorActor* DistractorActor : DistractorActors)
+    {
+        if (DistractorActor)
+        {
+            DistractorActor->Destroy();
+        }
+    }
+    DistractorActors.Reset();
+    DistractorActorColorIndexes.Reset();
+}
+
+void AGroupActorManager::LogActorPoolStats() const
+{
+    int32 PooledActorCount = 0;
+    for (const auto& ActorPoolPair : ActorPools)
+    {
+        PooledActorCount += ActorPoolPair.Value.Actors.Num();
+        if (ActorPoolPair.Value.Actors.Num() > 0)
+        {
+            UE_LOG(LogNVDRUtils, Log, TEXT("AGroupActorManager '%s' - '%s': %d pooled actors"), *GetName(),
+                   ActorPoolPair.Key ? *ActorPoolPair.Key->GetName() : TEXT("None"), ActorPoolPair.Value.Actors.Num());
+        }
+    }
+
+    UE_LOG(LogNVDRUtils, Log, TEXT("AGroupActorManager '%s' - %d managed actors - %d pooled actors - %d spawned - %d reused - %d destroyed"),
+           *GetName(), ManagedActors.Num(), PooledActorCount, SpawnedActorCount, ReusedActorCount, DestroyedActorCount);
+    UE_LOG(LogNVDRUtils, Log, TEXT("AGroupActorManager '%s' - %d instanced distractors of %d meshes in %d distractor actors"),
+           *GetName(), GetDistractorCount(), DistractorMeshes.Num(), DistractorActors.Num());
+}
+
 bool AGroupActorManager::ShouldSpawnRepeatively() const
 {
     return SpawnDuration > 0.f;
@@ -308,34 +904,30 @@ void AGroupActorManager::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
 
-    if (ShouldSpawnRepeatively())
+    // NOTE: While the randomization log is replayed, the spawned group is restored from the log instead
+    if (ShouldSpawnRepeatively() && !FNVRandomizationLog::IsReplaying(GetWorld()))
     {
-        if (CountdownUntilNextSpawn > 0.f)
-        {
-            CountdownUntilNextSpawn -= DeltaTime;
-        }
-        if (CountdownUntilNextSpawn <= 0.f)
+        if (!SpawnCountdown.IsActive() || SpawnCountdown.Tick(GetWorld(), DeltaTime))
         {
             SpawnActors();
-            CountdownUntilNextSpawn = SpawnDuration;
+            SpawnCountdown.Start(GetWorld(), SpawnDuration);
         }
     }
 }
 
 
 
-void AGroupActorManager::DestroyManagedActors()
+void AGroupActorManager::ReleaseManagedActors()
 {
     for (auto CheckActor : ManagedActors)
     {
-        if (CheckActor)
-        {
-            CheckActor->SetActorHiddenInGame(true);
-            CheckActor->Destroy();
-        }
+        ReleaseActor(CheckActor);
     }
     ManagedActors.Reset();
+    ManagedActorTemplates.Reset();
+    ManagedActorTransforms.Reset();
 }
+
 #if WITH_EDITORONLY_DATA
 void AGroupActorManager::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
@@ -8,9 +8,12 @@
 
 #include "GameFramework/Actor.h"
 #include "DomainRandomizationDNNPCH.h"
+#include "NVCaptureClock.h"
+#include "NVRandomStream.h"
 #include "GroupActorManager.generated.h"
 
 class USpatialLayoutGenerator;
+class AInstancedDistractorActor;
 
 USTRUCT(Blueprintable)
 struct DOMAINRANDOMIZATIONDNN_API FNVActorTemplateConfig
@@ -29,6 +32,17 @@ public:
     class UStaticMesh* ActorOverrideMesh;
 };
 
+/// The idle actors of a class kept by a AGroupActorManager to be reused
+USTRUCT()
+struct DOMAINRANDOMIZATIONDNN_API FNVGroupActorPool
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(Transient)
+    TArray<AActor*> Actors;
+};
+
 /**
 * Manages array of actors to spawn with mesh and spatial randomization control.
 */
@@ -43,8 +57,23 @@ public:
     void SpawnActors();
     void SpawnTemplateActors();
 
+    /// The index of a spawned actor in this manager's group, INDEX_NONE if the actor is not managed by this manager
+    int32 GetManagedActorIndex(const AActor* CheckActor) const;
+
+    /// Spawn the pool's warm-up actors of each class to spawn, it's done once before the first group is spawned
+    void WarmUpActorPool();
+    /// Print how many actors were spawned, reused and destroyed, and how many are idle in the pool
+    void LogActorPoolStats() const;
+
+    /// The mesh a template is rendered with when it's an instanced distractor, nullptr if it must be spawned as an actor
+    /// NOTE: The annotated actors are always spawned
+    static UStaticMesh* GetInstancedDistractorMesh(const FNVActorTemplateConfig& ActorTemplate);
+    /// Number of instanced distractors in the current group
+    int32 GetDistractorCount() const;
+
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void BeginDestroy() override;
     virtual void PostLoad() override;
 
@@ -53,6 +82,29 @@ protected:
     bool ShouldSpawnRepeatively() const;
 
     AActor* CreateActorFromTemplate(const FNVActorTemplateConfig& ActorTemplate, const FTransform& ActorTransform);
+    /// Apply the template's mesh and the group's settings to a spawned or reused actor
+    void ApplyActorTemplate(AActor* ManagedActor, const FNVActorTemplateConfig& ActorTemplate);
+    void AddManagedActor(const FNVActorTemplateConfig& ActorTemplate, const FTransform& ActorTransform);
+    /// Return the managed actors to the pool, the ones which don't fit in it are destroyed
+    void ReleaseManagedActors();
+
+    /// Reuse an idle actor of the template's class from the pool, or spawn a new one if there is none
+    AActor* AcquireActor(const FNVActorTemplateConfig& ActorTemplate, const FTransform& ActorTransform);
+    /// Hide and deactivate an actor and keep it in the pool, it's destroyed if the pool of its class is full
+    void ReleaseActor(AActor* ManagedActor);
+    void DestroyPooledActors();
+    /// Update the segmentation masks of an actor which was reused, released or had its mesh changed
+    void UpdateActorSegmentationMasks(AActor* ManagedActor);
+
+    /// Randomize the transforms and the colors of all the instanced distractors in bulk from the group's distractor stream
+    void RandomizeDistractors();
+    /// Get the distractor actor which render the instances of a mesh in a color, it's spawned the first time it's requested
+    AInstancedDistractorActor* GetDistractorActor(UStaticMesh* DistractorMesh, int32 ColorIndex);
+    void DestroyDistractorActors();
+
+    /// Save the spawned group (the templates and transforms of the actors) to the world's randomization log,
+    /// or destroy the spawned actors and spawn the logged group when the archive is loading
+    void SerializeRandomizationState(FArchive& Ar);
 
 public: // Editor properties
     UPROPERTY(EditAnywhere, Category = GroupActorManager)
@@ -83,8 +135,42 @@ public: // Editor properties
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     AVolume* RandomLocationVolume;
 
+    // If true, the actors of the previous group are hidden and kept in a pool to be reused by the next groups instead of being destroyed
+    UPROPERTY(EditAnywhere, Category = ActorPool)
+    bool bUseActorPool;
+
+    // How many actors of each class to spawn in the pool before the first group is spawned
+    UPROPERTY(EditAnywhere, Category = ActorPool, meta = (ClampMin = 0, EditCondition = bUseActorPool))
+    int32 PoolWarmUpCountPerClass;
+
+    // Maximum number of idle actors the pool keep for each class, the actors released above it are destroyed
+    UPROPERTY(EditAnywhere, Category = ActorPool, meta = (ClampMin = 0, EditCondition = bUseActorPool))
+    int32 MaxPooledActorsPerClass;
+
+    // If true, the actors to spawn which aren't annotated are rendered as instances grouped by mesh instead of being spawned,
+    // so the density of the distractors can scale to tens of thousands
+    // NOTE: The instances don't have the actors' components, their transforms and colors are randomized each time the group is spawned
+    UPROPERTY(EditAnywhere, Category = InstancedDistractors)
+    bool bUseInstancedDistractors;
+
+    // Number of random colors the instances of each mesh are split between, if 0 the instances keep the materials of their mesh
+    UPROPERTY(EditAnywhere, Category = InstancedDistractors, meta = (ClampMin = 0, EditCondition = bUseInstancedDistractors))
+    int32 DistractorColorCount;
+
+    // The vector parameter of the meshes' materials the distractor colors are set to
+    UPROPERTY(EditAnywhere, Category = InstancedDistractors, meta = (EditCondition = bUseInstancedDistractors))
+    FName DistractorColorParameterName;
+
+    UPROPERTY(EditAnywhere, Category = InstancedDistractors, meta = (EditCondition = bUseInstancedDistractors))
+    FRandomColorData DistractorColorData;
+
+    // Range of the uniform scale of the instances
+    UPROPERTY(EditAnywhere, Category = InstancedDistractors, meta = (EditCondition = bUseInstancedDistractors))
+    FFloatInterval DistractorScaleRange;
+
     // How long to wait until we spawn a new group of actors again
     // NOTE: If SpawnDuration <= 0 then we only spawn the actors once
+    // While the capturer's fixed step capture clock is running, the duration is counted in captured frames
     UPROPERTY(EditAnywhere, Category = GroupActorManager)
     float SpawnDuration;
 
@@ -92,10 +178,45 @@ protected: // Transient
     UPROPERTY(Transient)
     TArray<AActor*> ManagedActors;
 
+    /// The template and the spawn transform of each actor in ManagedActors
+    UPROPERTY(Transient)
+    TArray<FNVActorTemplateConfig> ManagedActorTemplates;
+
+    UPROPERTY(Transient)
+    TArray<FTransform> ManagedActorTransforms;
+
     UPROPERTY(Transient)
     TArray<AActor*> TemplateActors;
+
+    /// The idle actors of each class, they are hidden and deactivated until they are reused
     UPROPERTY(Transient)
-    float CountdownUntilNextSpawn;
+    TMap<UClass*, FNVGroupActorPool> ActorPools;
+
+    /// The actors rendering the instanced distractors and the index of the color each of them use
+    UPROPERTY(Transient)
+    TArray<AInstancedDistractorActor*> DistractorActors;
+    TArray<int32> DistractorActorColorIndexes;
+
+    /// The meshes of the instanced distractors and the number of instances of each of them
+    UPROPERTY(Transient)
+    TArray<UStaticMesh*> DistractorMeshes;
+    TArray<int32> DistractorMeshCounts;
+
+    /// The name and the epoch of the stream the distractors are randomized from, they are logged so the distractors can be restored
+    uint32 DistractorSeed;
+    int32 DistractorMasterSeed;
+    int32 DistractorEpoch;
+
+    bool bActorPoolWarmedUp;
+    int32 SpawnedActorCount;
+    int32 ReusedActorCount;
+    int32 DestroyedActorCount;
+
+    FNVCaptureClockCountdown SpawnCountdown;
+    FNVRandomStream RandomStream;
+
+    /// The index the actor being spawned will have in ManagedActors, its components begin play before it's added to the list
+    int32 SpawningActorIndex;
 
 #if WITH_EDITORONLY_DATA
     virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -107,7 +228,6 @@ protected:
 
     void UpdateProxyMeshes();
     void UpdateProxyMeshesVisibility();
-    void DestroyManagedActors();
 
 #endif // WITH_EDITORONLY_DATA
 };
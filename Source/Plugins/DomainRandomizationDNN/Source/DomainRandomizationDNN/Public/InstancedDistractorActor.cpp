@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "DomainRandomizationDNNPCH.h"
+#include "InstancedDistractorActor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+AInstancedDistractorActor::AInstancedDistractorActor(const class FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+    PrimaryActorTick.bCanEverTick = false;
+
+    InstancedMeshComp = ObjectInitializer.CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(this, TEXT("InstancedMeshComp"));
+    // NOTE: The distractors are only rendered, they don't block anything
+    InstancedMeshComp->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+    InstancedMeshComp->SetMobility(EComponentMobility::Movable);
+    // The tree is rebuilt once after all the instances changed
+    InstancedMeshComp->bAutoRebuildTreeOnInstanceChanges = false;
+    RootComponent = InstancedMeshComp;
+
+    ColorMaterials.Reset();
+    ColorParameterName = NAME_None;
+}
+
+void AInstancedDistractorActor::SetDistractorMesh(UStaticMesh* NewMesh, const FName& NewColorParameterName)
+{
+    InstancedMeshComp->SetStaticMesh(NewMesh);
+    InstancedMeshComp->EmptyOverrideMaterials();
+    ColorMaterials.Reset();
+    ColorParameterName = NewColorParameterName;
+
+    if (NewMesh && !ColorParameterName.IsNone())
+    {
+        const int32 MaterialCount = InstancedMeshComp->GetNumMaterials();
+        for (int32 i = 0; i < MaterialCount; i++)
+        {
+            UMaterialInstanceDynamic* ColorMaterial = InstancedMeshComp->CreateDynamicMaterialInstance(i);
+            if (ColorMaterial)
+            {
+                ColorMaterials.Add(ColorMaterial);
+            }
+        }
+    }
+}
+
+UStaticMesh* AInstancedDistractorActor::GetDistractorMesh() const
+{
+    return InstancedMeshComp->GetStaticMesh();
+}
+
+void AInstancedDistractorActor::SetDistractorColor(const FLinearColor& NewColor)
+{
+    for (UMaterialInstanceDynamic* ColorMaterial : ColorMaterials)
+    {
+        if (ColorMaterial)
+        {
+            ColorMaterial->SetVectorParameterValue(ColorParameterName, NewColor);
+        }
+    }
+}
+
+void AInstancedDistractorActor::SetInstanceTransforms(const TArray<FTransform>& InstanceTransforms)
+{
+    const int32 InstanceCount = InstanceTransforms.Num();
+    if (InstancedMeshComp->GetInstanceCount() == InstanceCount)
+    {
+        for (int32 i = 0; i < InstanceCount; i++)
+        {
+            const bool bMarkRenderStateDirty = (i == InstanceCount - 1);
+            InstancedMeshComp->UpdateInstanceTransform(i, InstanceTransforms[i], true, bMarkRenderStateDirty, true);
+        }
+    }
+    else
+    {
+        InstancedMeshComp->ClearInstances();
+        for (const FTransform& InstanceTransform : InstanceTransforms)
+        {
+            InstancedMeshComp->AddInstanceWorldSpace(InstanceTransform);
+        }
+    }
+
+    if (InstanceCount > 0)
+    {
+        // NOTE: Build the tree right away, an async build would render and mask the instances with the stale tree in the frame the capturer read back
+        InstancedMeshComp->BuildTreeIfOutdated(false, true);
+    }
+
+    // NOTE: The hidden actors are ignored by the object mask managers
+    SetActorHiddenInGame(InstanceCount == 0);
+}
+
+int32 AInstancedDistractorActor::GetInstanceCount() const
+{
+    return InstancedMeshComp->GetInstanceCount();
+}
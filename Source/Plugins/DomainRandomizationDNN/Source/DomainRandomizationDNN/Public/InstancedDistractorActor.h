@@ -0,0 +1,48 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "InstancedDistractorActor.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+
+/// AInstancedDistractorActor render the distractors of a AGroupActorManager which use the same mesh and color as instances of a single component,
+/// so thousands of distractors cost a few draws and a single actor instead of one actor and one draw each
+/// NOTE: The object mask managers scan the distractor actor like any other actor: all its instances share the mask of their mesh
+/// NOTE: Per-instance custom data isn't available in this engine version, the instances' color is the one of their actor's materials instead
+/// @cond DOXYGEN_SUPPRESSED_CODE
+UCLASS(NotBlueprintable, NotPlaceable, Transient, ClassGroup = (NVIDIA))
+/// @endcond DOXYGEN_SUPPRESSED_CODE
+class DOMAINRANDOMIZATIONDNN_API AInstancedDistractorActor : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AInstancedDistractorActor(const class FObjectInitializer& ObjectInitializer);
+
+    /// Set the mesh of the instances, its materials are replaced by dynamic instances if the color parameter is valid
+    void SetDistractorMesh(UStaticMesh* NewMesh, const FName& NewColorParameterName);
+    UStaticMesh* GetDistractorMesh() const;
+
+    /// Change the color of all the instances
+    void SetDistractorColor(const FLinearColor& NewColor);
+
+    /// Replace the transforms (in world space) of all the instances, the actor is hidden while it has no instance
+    /// NOTE: The instances are updated in place when their number doesn't change and the instance tree is only rebuilt once
+    void SetInstanceTransforms(const TArray<FTransform>& InstanceTransforms);
+    int32 GetInstanceCount() const;
+
+protected:
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    UHierarchicalInstancedStaticMeshComponent* InstancedMeshComp;
+
+    UPROPERTY(Transient)
+    TArray<UMaterialInstanceDynamic*> ColorMaterials;
+
+    FName ColorParameterName;
+};
@@ -47,7 +47,7 @@ void UOrbitalMovementComponent::SetFocalActor(AActor* NewFocalActor)
     UpdateDistanceToTarget();
     if (bRandomizePitchAfterEachYawRotation)
     {
-        RotationFromTarget.Pitch = FMath::RandRange(PitchRotationRange.Min, PitchRotationRange.Max);
+        RotationFromTarget.Pitch = GetRandomStream().FRandRange(PitchRotationRange.Min, PitchRotationRange.Max);
     }
     else
     {
@@ -163,7 +163,7 @@ void UOrbitalMovementComponent::TickComponent(float DeltaTime, enum ELevelTick T
     FRotator NewRotation = (-TargetToExporterDir).Rotation();
     if (bShouldWiggle)
     {
-        NewRotation = WiggleRotationData.GetRandomRotationRelative(NewRotation);
+        NewRotation = WiggleRotationData.GetRandomRotationRelative(GetRandomStream(), NewRotation);
     }
 
     OwnerActor->SetActorLocationAndRotation(NewLocation, NewRotation, false, nullptr, ETeleportType::TeleportPhysics);
@@ -178,11 +178,27 @@ void UOrbitalMovementComponent::OnRandomization_Implementation()
     }
 }
 
+void UOrbitalMovementComponent::SerializeRandomizationState(FArchive& Ar)
+{
+    AActor* OwnerActor = GetOwner();
+    if (OwnerActor)
+    {
+        FVector OwnerLocation = OwnerActor->GetActorLocation();
+        FQuat OwnerRotation = OwnerActor->GetActorQuat();
+        Ar << OwnerLocation;
+        Ar << OwnerRotation;
+        if (Ar.IsLoading())
+        {
+            OwnerActor->SetActorLocationAndRotation(OwnerLocation, OwnerRotation, false, nullptr, ETeleportType::TeleportPhysics);
+        }
+    }
+}
+
 void UOrbitalMovementComponent::UpdateDistanceToTarget()
 {
     if (bShouldChangeDistance && (DistanceChangeCountdown <= 0.f))
     {
-        DistanceToTarget = FMath::RandRange(TargetDistanceRange.Min, TargetDistanceRange.Max);
+        DistanceToTarget = GetRandomStream().FRandRange(TargetDistanceRange.Min, TargetDistanceRange.Max);
         DistanceChangeCountdown = TargetDistanceChangeDuration;
     }
 }
@@ -201,7 +217,7 @@ void UOrbitalMovementComponent::OnYawRotationCompleted(float DeltaTime)
 
     if (bRandomizePitchAfterEachYawRotation)
     {
-        RotationFromTarget.Pitch = FMath::RandRange(PitchRotationRange.Min, PitchRotationRange.Max);
+        RotationFromTarget.Pitch = GetRandomStream().FRandRange(PitchRotationRange.Min, PitchRotationRange.Max);
     }
     else
     {
@@ -222,9 +238,9 @@ void UOrbitalMovementComponent::TeleportRandomly()
     AActor* OwnerActor = GetOwner();
     if (OwnerActor)
     {
-        RotationFromTarget.Yaw = FMath::RandRange(YawRotationRange.Min, YawRotationRange.Max);
-        RotationFromTarget.Pitch = FMath::RandRange(PitchRotationRange.Min, PitchRotationRange.Max);
-        DistanceToTarget = FMath::RandRange(TargetDistanceRange.Min, TargetDistanceRange.Max);
+        RotationFromTarget.Yaw = GetRandomStream().FRandRange(YawRotationRange.Min, YawRotationRange.Max);
+        RotationFromTarget.Pitch = GetRandomStream().FRandRange(PitchRotationRange.Min, PitchRotationRange.Max);
+        DistanceToTarget = GetRandomStream().FRandRange(TargetDistanceRange.Min, TargetDistanceRange.Max);
         CurrentDistanceToTarget = DistanceToTarget;
 
         const FVector TargetLocation = FocalTargetActor ? FocalTargetActor->GetActorLocation() : FVector::ZeroVector;
@@ -240,7 +256,7 @@ void UOrbitalMovementComponent::TeleportRandomly()
         FRotator NewRotation = OwnerToTarget.Rotation();
         if (bShouldWiggle)
         {
-            NewRotation = WiggleRotationData.GetRandomRotationRelative(NewRotation);
+            NewRotation = WiggleRotationData.GetRandomRotationRelative(GetRandomStream(), NewRotation);
         }
 
         OwnerActor->SetActorRotation(NewRotation, TeleportType);
@@ -30,6 +30,7 @@ protected:
     virtual void BeginPlay() override;
     virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
     virtual void OnRandomization_Implementation() override;
+    virtual void SerializeRandomizationState(FArchive& Ar) override;
 
     void UpdateDistanceToTarget();
     void OnYawRotationCompleted(float DeltaTime);
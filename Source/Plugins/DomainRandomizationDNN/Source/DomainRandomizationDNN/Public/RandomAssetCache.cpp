@@ -0,0 +1,391 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "DomainRandomizationDNNPCH.h"
+#include "RandomAssetCache.h"
+#include "NVSceneCapturerUtils.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    FAutoConsoleCommand TestAssetCacheCommand(
+        TEXT("NV.TestAssetCache"),
+        TEXT("Check the streamed asset cache's loading, pinning and eviction"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FRandomAssetCache::RunSelfTest();
+        }));
+
+    FAutoConsoleCommand AssetCacheStatsCommand(
+        TEXT("NV.AssetCacheStats"),
+        TEXT("Print the hit, miss and stall counters and the memory used by the streamed asset cache"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FRandomAssetCache::Get().LogStats();
+        }));
+
+    const int64 DefaultBudgetBytes = 2048LL * 1024 * 1024;
+    const int32 DefaultMaxPrefetchCount = 32;
+    // Weight of the latest load in the average load time
+    const double LoadTimeSmoothing = 0.1;
+
+    double BytesToMegabytes(int64 Bytes)
+    {
+        return Bytes / (1024.0 * 1024.0);
+    }
+}
+
+//=================================== FRandomAssetCacheStats ===================================
+FRandomAssetCacheStats::FRandomAssetCacheStats()
+{
+    HitCount = 0;
+    MissCount = 0;
+    StallCount = 0;
+    StallSeconds = 0.0;
+    EvictionCount = 0;
+    ResidentAssetCount = 0;
+    ResidentBytes = 0;
+    PeakResidentBytes = 0;
+}
+
+//=================================== FRandomAssetCache ===================================
+FRandomAssetCache::FRandomAssetCache()
+{
+    BudgetBytes = DefaultBudgetBytes;
+    MaxPrefetchCount = DefaultMaxPrefetchCount;
+    AverageLoadSeconds = 0.0;
+    LoadedAssetCount = 0;
+    bWarnedPinnedOverBudget = false;
+}
+
+FRandomAssetCache::~FRandomAssetCache()
+{
+    Reset();
+}
+
+FRandomAssetCache& FRandomAssetCache::Get()
+{
+    static FRandomAssetCache AssetCache;
+    return AssetCache;
+}
+
+void FRandomAssetCache::Reset()
+{
+    TArray<FSoftObjectPath> AssetPaths;
+    Entries.GetKeys(AssetPaths);
+    for (const FSoftObjectPath& AssetPath : AssetPaths)
+    {
+        ReleaseEntry(AssetPath);
+    }
+    Entries.Reset();
+    UsageList.Empty();
+
+    Stats = FRandomAssetCacheStats();
+    AverageLoadSeconds = 0.0;
+    LoadedAssetCount = 0;
+}
+
+void FRandomAssetCache::SetBudget(int64 InBudgetBytes, int32 InMaxPrefetchCount)
+{
+    BudgetBytes = FMath::Max<int64>(InBudgetBytes, 0);
+    MaxPrefetchCount = FMath::Max(InMaxPrefetchCount, 1);
+    bWarnedPinnedOverBudget = false;
+
+    EvictOverBudget();
+}
+
+void FRandomAssetCache::Prefetch(const FSoftObjectPath& AssetPath)
+{
+    if (!AssetPath.IsValid())
+    {
+        return;
+    }
+
+    FCacheEntry* Entry = Entries.Find(AssetPath);
+    if (Entry)
+    {
+        Entry->PinCount++;
+        return;
+    }
+
+    Entry = &Entries.Add(AssetPath);
+    Entry->RequestTime = FPlatformTime::Seconds();
+    // NOTE: Pin the asset before requesting it, the request completes right away when the asset is already in memory
+    Entry->PinCount++;
+
+    TSharedPtr<FStreamableHandle> LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetPath,
+            FStreamableDelegate::CreateRaw(this, &FRandomAssetCache::OnAssetLoaded, AssetPath),
+            FStreamableManager::DefaultAsyncLoadPriority, true);
+
+    Entry = Entries.Find(AssetPath);
+    if (Entry)
+    {
+        Entry->Handle = LoadHandle;
+        if (!LoadHandle.IsValid())
+        {
+            // NOTE: There is nothing to load, e.g: the asset doesn't exist
+            OnAssetLoaded(AssetPath);
+        }
+    }
+}
+
+void FRandomAssetCache::CancelPrefetch(const FSoftObjectPath& AssetPath)
+{
+    FCacheEntry* Entry = Entries.Find(AssetPath);
+    if (Entry && (Entry->PinCount > 0))
+    {
+        // NOTE: The asset keep loading, it's released like the other assets once it's the least recently used
+        Entry->PinCount--;
+        EvictOverBudget();
+    }
+}
+
+void FRandomAssetCache::WaitUntilLoaded(const FSoftObjectPath& AssetPath)
+{
+    FCacheEntry* Entry = Entries.Find(AssetPath);
+    if (Entry && !Entry->bLoaded)
+    {
+        if (Entry->Handle.IsValid())
+        {
+            Entry->Handle->WaitUntilComplete();
+        }
+        OnAssetLoaded(AssetPath);
+    }
+}
+
+UObject* FRandomAssetCache::Acquire(const FSoftObjectPath& AssetPath, bool bWasPrefetched)
+{
+    if (!AssetPath.IsValid())
+    {
+        return nullptr;
+    }
+
+    FCacheEntry* Entry = Entries.Find(AssetPath);
+    const bool bMissed = (Entry == nullptr);
+    if (bMissed)
+    {
+        Stats.MissCount++;
+        Entry = &Entries.Add(AssetPath);
+        Entry->RequestTime = FPlatformTime::Seconds();
+    }
+    else if (Entry->bLoaded)
+    {
+        Stats.HitCount++;
+    }
+    else
+    {
+        Stats.StallCount++;
+    }
+
+    // NOTE: Pin the asset while it's acquired so it isn't released before it's used
+    Entry->PinCount++;
+
+    if (!Entry->bLoaded)
+    {
+        const double StallStartTime = FPlatformTime::Seconds();
+        if (bMissed)
+        {
+            Entry->Handle = UAssetManager::GetStreamableManager().RequestSyncLoad(AssetPath, true);
+        }
+        else if (Entry->Handle.IsValid())
+        {
+            Entry->Handle->WaitUntilComplete();
+        }
+        // NOTE: The load's callback may only be called on the next tick
+        OnAssetLoaded(AssetPath);
+        Stats.StallSeconds += FPlatformTime::Seconds() - StallStartTime;
+
+        Entry = &Entries.FindChecked(AssetPath);
+    }
+
+    if (bWasPrefetched && (Entry->PinCount > 1))
+    {
+        Entry->PinCount--;
+    }
+    MarkAsUsed(*Entry);
+
+    UObject* Asset = AssetPath.ResolveObject();
+
+    Entry->PinCount--;
+    EvictOverBudget();
+
+    return Asset;
+}
+
+bool FRandomAssetCache::IsLoaded(const FSoftObjectPath& AssetPath) const
+{
+    const FCacheEntry* Entry = Entries.Find(AssetPath);
+    return (Entry && Entry->bLoaded);
+}
+
+void FRandomAssetCache::LogStats() const
+{
+    UE_LOG(LogNVDRUtils, Log, TEXT("FRandomAssetCache - Hits: %d - Misses: %d - Stalls: %d (%.3f seconds) - Evictions: %d - Resident: %d assets, %.1f MB (peak %.1f MB, budget %.1f MB) - Average load time: %.3f seconds"),
+           Stats.HitCount, Stats.MissCount, Stats.StallCount, Stats.StallSeconds, Stats.EvictionCount,
+           Stats.ResidentAssetCount, BytesToMegabytes(Stats.ResidentBytes), BytesToMegabytes(Stats.PeakResidentBytes), BytesToMegabytes(BudgetBytes),
+           AverageLoadSeconds);
+}
+
+void FRandomAssetCache::OnAssetLoaded(FSoftObjectPath AssetPath)
+{
+    FCacheEntry* Entry = Entries.Find(AssetPath);
+    if (!Entry || Entry->bLoaded)
+    {
+        return;
+    }
+
+    Entry->bLoaded = true;
+    const double LoadSeconds = FPlatformTime::Seconds() - Entry->RequestTime;
+    AverageLoadSeconds = (LoadedAssetCount == 0) ? LoadSeconds : FMath::Lerp(AverageLoadSeconds, LoadSeconds, LoadTimeSmoothing);
+    LoadedAssetCount++;
+
+    UObject* Asset = AssetPath.ResolveObject();
+    Entry->ResourceBytes = Asset ? (int64)Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+
+    UsageList.AddHead(AssetPath);
+    Entry->UsageNode = UsageList.GetHead();
+
+    Stats.ResidentAssetCount++;
+    Stats.ResidentBytes += Entry->ResourceBytes;
+    Stats.PeakResidentBytes = FMath::Max(Stats.PeakResidentBytes, Stats.ResidentBytes);
+
+    EvictOverBudget();
+}
+
+void FRandomAssetCache::MarkAsUsed(FCacheEntry& Entry)
+{
+    if (Entry.UsageNode && (Entry.UsageNode != UsageList.GetHead()))
+    {
+        UsageList.RemoveNode(Entry.UsageNode, false);
+        UsageList.AddHead(Entry.UsageNode);
+    }
+}
+
+void FRandomAssetCache::EvictOverBudget()
+{
+    TDoubleLinkedList<FSoftObjectPath>::TDoubleLinkedListNode* CheckNode = UsageList.GetTail();
+    while (CheckNode && (Stats.ResidentBytes > BudgetBytes))
+    {
+        TDoubleLinkedList<FSoftObjectPath>::TDoubleLinkedListNode* PrevNode = CheckNode->GetPrevNode();
+
+        const FSoftObjectPath AssetPath = CheckNode->GetValue();
+        const FCacheEntry* Entry = Entries.Find(AssetPath);
+        if (Entry && (Entry->PinCount <= 0))
+        {
+            ReleaseEntry(AssetPath);
+            Stats.EvictionCount++;
+        }
+
+        CheckNode = PrevNode;
+    }
+
+    if ((Stats.ResidentBytes > BudgetBytes) && !bWarnedPinnedOverBudget)
+    {
+        bWarnedPinnedOverBudget = true;
+        UE_LOG(LogNVDRUtils, Warning, TEXT("FRandomAssetCache - The prefetched assets (%.1f MB) don't fit in the budget (%.1f MB), raise the budget or lower the number of prefetched assets"),
+               BytesToMegabytes(Stats.ResidentBytes), BytesToMegabytes(BudgetBytes));
+    }
+}
+
+void FRandomAssetCache::ReleaseEntry(const FSoftObjectPath& AssetPath)
+{
+    FCacheEntry* Entry = Entries.Find(AssetPath);
+    if (!Entry)
+    {
+        return;
+    }
+
+    if (Entry->UsageNode)
+    {
+        UsageList.RemoveNode(Entry->UsageNode);
+        Entry->UsageNode = nullptr;
+    }
+    if (Entry->bLoaded)
+    {
+        Stats.ResidentAssetCount--;
+        Stats.ResidentBytes -= Entry->ResourceBytes;
+    }
+    if (Entry->Handle.IsValid())
+    {
+        // NOTE: The released asset stay in memory until it's garbage collected, as long as nothing else reference it
+        if (!Entry->bLoaded)
+        {
+            Entry->Handle->CancelHandle();
+        }
+        Entry->Handle->ReleaseHandle();
+        Entry->Handle = nullptr;
+    }
+
+    Entries.Remove(AssetPath);
+}
+
+bool FRandomAssetCache::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Asset cache"), LogNVDRUtils);
+
+    const FSoftObjectPath AssetA(TEXT("/Engine/EngineResources/DefaultTexture.DefaultTexture"));
+    const FSoftObjectPath AssetB(TEXT("/Engine/EngineResources/WhiteSquareTexture.WhiteSquareTexture"));
+    const FSoftObjectPath AssetC(TEXT("/Engine/EngineMaterials/DefaultMaterial.DefaultMaterial"));
+
+    FRandomAssetCache TestCache;
+
+    // A prefetched asset is a hit, an asset which wasn't requested is a miss
+    TestCache.Prefetch(AssetA);
+    TestCache.WaitUntilLoaded(AssetA);
+    TestResult.Check(TestCache.IsLoaded(AssetA), TEXT("the prefetched asset isn't loaded"));
+    TestResult.Check(TestCache.Acquire(AssetA, true) != nullptr, TEXT("the prefetched asset can't be acquired"));
+    TestResult.Check(TestCache.Acquire(AssetB, false) != nullptr, TEXT("the missed asset can't be acquired"));
+    TestResult.Check((TestCache.GetStats().HitCount == 1) && (TestCache.GetStats().MissCount == 1), TEXT("the hits and misses aren't counted"));
+
+    // An asset acquired right after its prefetch is a hit or a stall, never a miss
+    TestCache.Prefetch(AssetC);
+    TestResult.Check(TestCache.Acquire(AssetC, true) != nullptr, TEXT("the stalled asset can't be acquired"));
+    TestResult.Check((TestCache.GetStats().HitCount + TestCache.GetStats().StallCount == 2) && (TestCache.GetStats().MissCount == 1),
+                     TEXT("the prefetched asset isn't counted as a hit or a stall"));
+    TestResult.Check(TestCache.GetStats().ResidentAssetCount == 3, TEXT("the loaded assets aren't resident"));
+
+    const int64 ResidentBytes = TestCache.GetStats().ResidentBytes;
+    if (ResidentBytes <= 0)
+    {
+        UE_LOG(LogNVDRUtils, Warning, TEXT("Asset cache test: the test assets have no resource size, the eviction isn't tested"));
+    }
+    else
+    {
+        // The least recently used asset is released first
+        TestCache.Acquire(AssetB, false);
+        TestCache.Acquire(AssetC, false);
+        TestCache.Acquire(AssetA, false);
+        TestCache.SetBudget(ResidentBytes - 1, DefaultMaxPrefetchCount);
+        TestResult.Check(!TestCache.IsLoaded(AssetB), TEXT("the least recently used asset wasn't released"));
+        TestResult.Check(TestCache.IsLoaded(AssetA), TEXT("the most recently used asset was released"));
+        TestResult.Check(TestCache.GetStats().ResidentBytes <= TestCache.GetBudgetBytes(), TEXT("the resident assets are over the budget"));
+
+        // A pinned asset isn't released until its prefetch is consumed or cancelled
+        TestCache.Prefetch(AssetA);
+        TestCache.SetBudget(0, DefaultMaxPrefetchCount);
+        TestResult.Check(TestCache.IsLoaded(AssetA) && !TestCache.IsLoaded(AssetC), TEXT("the pinned asset was released"));
+        TestCache.CancelPrefetch(AssetA);
+        TestResult.Check(!TestCache.IsLoaded(AssetA) && (TestCache.GetStats().ResidentBytes == 0), TEXT("the cancelled asset wasn't released"));
+        TestResult.Check(TestCache.GetStats().EvictionCount == 3, TEXT("the evictions aren't counted"));
+
+        // Using the released assets again load them back as misses, and the least recently used one is released again to stay under the budget
+        TestCache.SetBudget(ResidentBytes - 1, DefaultMaxPrefetchCount);
+        const int32 MissCountBeforeReload = TestCache.GetStats().MissCount;
+        TestCache.Acquire(AssetA, false);
+        TestCache.Acquire(AssetB, false);
+        TestResult.Check(TestCache.Acquire(AssetC, false) != nullptr, TEXT("the released asset can't be acquired again"));
+        TestResult.Check(TestCache.GetStats().MissCount == MissCountBeforeReload + 3, TEXT("the released assets aren't counted as misses"));
+        TestResult.Check(!TestCache.IsLoaded(AssetA), TEXT("the least recently used asset wasn't released again"));
+        TestResult.Check(TestCache.GetStats().ResidentBytes <= TestCache.GetBudgetBytes(), TEXT("the reloaded assets put the cache over its budget"));
+    }
+
+    TestCache.Reset();
+    TestResult.Check((TestCache.GetStats().ResidentAssetCount == 0) && (TestCache.UsageList.Num() == 0), TEXT("the cache isn't empty after a reset"));
+
+    return TestResult.Finish();
+}
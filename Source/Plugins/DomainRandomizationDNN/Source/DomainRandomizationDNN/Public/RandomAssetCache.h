@@ -0,0 +1,127 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/List.h"
+
+struct FStreamableHandle;
+
+// Statistics of the asset cache
+struct DOMAINRANDOMIZATIONDNN_API FRandomAssetCacheStats
+{
+public:
+    FRandomAssetCacheStats();
+
+    // Number of acquired assets which were already loaded
+    int32 HitCount;
+    // Number of acquired assets which weren't loading, they were loaded synchronously
+    int32 MissCount;
+    // Number of acquired assets which were still loading, the randomization waited for them
+    int32 StallCount;
+    // Total time (in seconds) the randomization waited for the missed and stalled assets
+    double StallSeconds;
+    // Number of loaded assets released to stay under the budget
+    int32 EvictionCount;
+    // Number of loaded assets and their estimated size (in bytes)
+    int32 ResidentAssetCount;
+    int64 ResidentBytes;
+    int64 PeakResidentBytes;
+};
+
+// FRandomAssetCache keeps the assets streamed by the FRandomAssetStreamers loaded, it's shared by all the streamers in the process
+// The least recently used assets are released when the loaded assets' estimated size is over the memory budget
+// The streamers prefetch the assets they will pick next, the prefetched assets are pinned in the cache until they are acquired
+// NOTE: The cache is only used on the game thread
+class DOMAINRANDOMIZATIONDNN_API FRandomAssetCache
+{
+public:
+    FRandomAssetCache();
+    ~FRandomAssetCache();
+
+    static FRandomAssetCache& Get();
+    // Release all the assets, e.g: when the module shuts down
+    void Reset();
+
+    // Set the maximum size (in bytes) of the loaded assets and the maximum number of assets a streamer can prefetch
+    void SetBudget(int64 InBudgetBytes, int32 InMaxPrefetchCount);
+    int64 GetBudgetBytes() const
+    {
+        return BudgetBytes;
+    }
+    int32 GetMaxPrefetchCount() const
+    {
+        return MaxPrefetchCount;
+    }
+
+    // Start loading an asset ahead of its use, it can't be released until it's acquired or its prefetch is cancelled
+    void Prefetch(const FSoftObjectPath& AssetPath);
+    void CancelPrefetch(const FSoftObjectPath& AssetPath);
+    // Wait until a prefetched asset is loaded, without counting it as a stall (e.g: while the streamers are set up)
+    void WaitUntilLoaded(const FSoftObjectPath& AssetPath);
+    // Get an asset for the randomization and mark it as the most recently used one, it's loaded synchronously if it isn't loaded yet
+    // @param bWasPrefetched    Whether the asset was prefetched, its prefetch is consumed
+    UObject* Acquire(const FSoftObjectPath& AssetPath, bool bWasPrefetched);
+
+    bool IsLoaded(const FSoftObjectPath& AssetPath) const;
+    // Average time (in seconds) an asset take to load, the streamers size their prefetch with it
+    double GetAverageLoadSeconds() const
+    {
+        return AverageLoadSeconds;
+    }
+
+    const FRandomAssetCacheStats& GetStats() const
+    {
+        return Stats;
+    }
+    void LogStats() const;
+
+    // Check the cache's loading, pinning and eviction with the engine's assets, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    struct FCacheEntry
+    {
+        TSharedPtr<FStreamableHandle> Handle;
+        // Estimated size of the loaded asset, 0 until it's loaded
+        int64 ResourceBytes;
+        // Number of prefetches and acquisitions in progress, a pinned asset can't be released
+        int32 PinCount;
+        double RequestTime;
+        bool bLoaded;
+        // The asset's node in the usage list, null until it's loaded
+        TDoubleLinkedList<FSoftObjectPath>::TDoubleLinkedListNode* UsageNode;
+
+        FCacheEntry()
+            : ResourceBytes(0)
+            , PinCount(0)
+            , RequestTime(0.0)
+            , bLoaded(false)
+            , UsageNode(nullptr)
+        {
+        }
+    };
+
+    void OnAssetLoaded(FSoftObjectPath AssetPath);
+    void MarkAsUsed(FCacheEntry& Entry);
+    // Release the least recently used assets until the loaded assets fit in the budget
+    void EvictOverBudget();
+    void ReleaseEntry(const FSoftObjectPath& AssetPath);
+
+protected:
+    TMap<FSoftObjectPath, FCacheEntry> Entries;
+    // The loaded assets, the most recently used first
+    TDoubleLinkedList<FSoftObjectPath> UsageList;
+
+    int64 BudgetBytes;
+    int32 MaxPrefetchCount;
+    double AverageLoadSeconds;
+    int32 LoadedAssetCount;
+    bool bWarnedPinnedOverBudget;
+
+    FRandomAssetCacheStats Stats;
+};
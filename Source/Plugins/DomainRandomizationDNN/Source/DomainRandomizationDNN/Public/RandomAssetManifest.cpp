@@ -0,0 +1,547 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "DomainRandomizationDNNPCH.h"
+#include "RandomAssetManifest.h"
+#include "NVSceneCapturerUtils.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#endif // WITH_EDITOR
+
+namespace
+{
+    FAutoConsoleCommand TestAssetManifestCommand(
+        TEXT("NV.TestAssetManifest"),
+        TEXT("Check that the asset manifests are written, validated and filtered correctly"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FRandomAssetManifest::RunSelfTest();
+        }));
+
+#if WITH_EDITOR
+    FAutoConsoleCommand BuildAssetManifestsCommand(
+        TEXT("NV.BuildAssetManifests"),
+        TEXT("Build the asset manifest files of content directories, e.g: NV.BuildAssetManifests /Game/Textures /Game/Meshes"),
+        FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+        {
+            for (const FString& ContentDirectory : Args)
+            {
+                FRandomAssetManifest::BuildManifest(ContentDirectory);
+            }
+        }));
+#endif // WITH_EDITOR
+
+    const uint32 ManifestFileMagic = 0x4D41564E; // "NVAM"
+    const uint32 ManifestFileVersion = 1;
+    const TCHAR* ManifestFileExtension = TEXT(".nvmanifest");
+
+    // A manifest file starts with this header, followed by the class table, the asset entries and the string data
+    struct FManifestFileHeader
+    {
+        uint32 Magic;
+        uint32 Version;
+        int64 LatestModifiedTicks;
+        int32 AssetFileCount;
+        int32 ClassCount;
+        int32 AssetCount;
+        int32 StringDataSize;
+        // The content directory the manifest was built for, in the string data
+        int32 DirectoryOffset;
+        int32 DirectoryLength;
+    };
+    static_assert(sizeof(FManifestFileHeader) == 40, "The manifest file's tables must stay 4 bytes aligned");
+
+    // The manifests currently used in the process, by content directory
+    TMap<FString, TWeakPtr<FRandomAssetManifest>>& GetLoadedManifests()
+    {
+        static TMap<FString, TWeakPtr<FRandomAssetManifest>> LoadedManifests;
+        return LoadedManifests;
+    }
+}
+
+FRandomAssetManifest::FRandomAssetManifest()
+{
+    ClassNames = nullptr;
+    ClassCount = 0;
+    AssetEntries = nullptr;
+    AssetCount = 0;
+    StringData = nullptr;
+    StringDataSize = 0;
+}
+
+FRandomAssetManifest::~FRandomAssetManifest()
+{
+    // NOTE: The region must be unmapped before its file is closed
+    MappedRegion.Reset();
+    MappedFile.Reset();
+}
+
+TSharedPtr<FRandomAssetManifest> FRandomAssetManifest::Get(const FString& InContentDirectory)
+{
+    const FString NormalizedDirectory = NormalizeContentDirectory(InContentDirectory);
+
+    TMap<FString, TWeakPtr<FRandomAssetManifest>>& LoadedManifests = GetLoadedManifests();
+    TSharedPtr<FRandomAssetManifest> Manifest = LoadedManifests.FindRef(NormalizedDirectory).Pin();
+    if (Manifest.IsValid())
+    {
+        return Manifest;
+    }
+
+    const FString FilePath = GetManifestFilePath(NormalizedDirectory);
+    Manifest = MakeShareable(new FRandomAssetManifest());
+#if WITH_EDITOR
+    const FContentStamp ContentStamp = GetContentStamp(NormalizedDirectory);
+    if (!Manifest->LoadManifestFile(FilePath, NormalizedDirectory, &ContentStamp))
+    {
+        // NOTE: Release the old file's mapping before it's replaced
+        Manifest = MakeShareable(new FRandomAssetManifest());
+
+        // NOTE: Another process may have rebuilt the manifest at the same time, its file is as good as ours
+        BuildManifest(NormalizedDirectory);
+        if (!Manifest->LoadManifestFile(FilePath, NormalizedDirectory, &ContentStamp))
+        {
+            UE_LOG(LogNVDRUtils, Error, TEXT("FRandomAssetManifest - Can't build the manifest of directory '%s'"), *NormalizedDirectory);
+            return nullptr;
+        }
+    }
+#else
+    if (!Manifest->LoadManifestFile(FilePath, NormalizedDirectory, nullptr))
+    {
+        UE_LOG(LogNVDRUtils, Error, TEXT("FRandomAssetManifest - There is no valid manifest of directory '%s' at '%s', build it in the editor with the 'NV.BuildAssetManifests' command"),
+               *NormalizedDirectory, *FilePath);
+        return nullptr;
+    }
+#endif // WITH_EDITOR
+
+    LoadedManifests.Add(NormalizedDirectory, Manifest);
+    return Manifest;
+}
+
+FString FRandomAssetManifest::GetManifestDirectory()
+{
+    FString ManifestDirectory;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("-AssetManifestDir="), ManifestDirectory))
+    {
+        ManifestDirectory = FPaths::Combine(FPaths::ProjectContentDir(), TEXT("AssetManifests"));
+    }
+    return ManifestDirectory;
+}
+
+FString FRandomAssetManifest::GetManifestFilePath(const FString& InContentDirectory)
+{
+    const FString NormalizedDirectory = NormalizeContentDirectory(InContentDirectory);
+
+    // NOTE: The directory's hash keep apart the directories whose names only differ by their separators
+    const FString ManifestFileName = FPaths::MakeValidFileName(NormalizedDirectory.Mid(1).Replace(TEXT("/"), TEXT("_")))
+                                     + FString::Printf(TEXT("-%08X"), FCrc::StrCrc32(*NormalizedDirectory.ToLower()))
+                                     + ManifestFileExtension;
+    return FPaths::Combine(GetManifestDirectory(), ManifestFileName);
+}
+
+FString FRandomAssetManifest::NormalizeContentDirectory(const FString& InContentDirectory)
+{
+    FString NormalizedDirectory = InContentDirectory;
+    FPaths::NormalizeDirectoryName(NormalizedDirectory);
+    while (!NormalizedDirectory.IsEmpty() && NormalizedDirectory.EndsWith(TEXT("/")))
+    {
+        NormalizedDirectory = NormalizedDirectory.Left(NormalizedDirectory.Len() - 1);
+    }
+    if (!NormalizedDirectory.StartsWith(TEXT("/")))
+    {
+        NormalizedDirectory = TEXT("/") + NormalizedDirectory;
+    }
+    return NormalizedDirectory;
+}
+
+#if WITH_EDITOR
+bool FRandomAssetManifest::BuildManifest(const FString& InContentDirectory)
+{
+    const FString NormalizedDirectory = NormalizeContentDirectory(InContentDirectory);
+    // NOTE: Stamp the content before scanning it so a change made during the scan is noticed the next time
+    const FContentStamp ContentStamp = GetContentStamp(NormalizedDirectory);
+
+    FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+    IAssetRegistry& AssetRegistry = AssetRegistryModule.Get();
+
+    TArray<FString> ScanPaths;
+    ScanPaths.Add(NormalizedDirectory);
+    AssetRegistry.ScanPathsSynchronous(ScanPaths);
+
+    TArray<FAssetData> AssetList;
+    AssetRegistry.GetAssetsByPath(*NormalizedDirectory, AssetList, true);
+
+    TArray<TPair<FString, FName>> Assets;
+    Assets.Reserve(AssetList.Num());
+    for (const FAssetData& AssetData : AssetList)
+    {
+        Assets.Emplace(AssetData.ObjectPath.ToString(), AssetData.AssetClass);
+    }
+    // NOTE: The registry doesn't list the assets in a stable order, sort them so an asset index pick the same asset in every process
+    Assets.Sort([](const TPair<FString, FName>& A, const TPair<FString, FName>& B)
+    {
+        return A.Key < B.Key;
+    });
+
+    const FString FilePath = GetManifestFilePath(NormalizedDirectory);
+    if (!WriteManifestFile(FilePath, NormalizedDirectory, ContentStamp, Assets))
+    {
+        UE_LOG(LogNVDRUtils, Warning, TEXT("FRandomAssetManifest - Can't write the manifest of directory '%s' to '%s'"), *NormalizedDirectory, *FilePath);
+        return false;
+    }
+
+    UE_LOG(LogNVDRUtils, Log, TEXT("FRandomAssetManifest - Wrote the manifest of directory '%s' (%d assets) to '%s'"), *NormalizedDirectory, Assets.Num(), *FilePath);
+    return true;
+}
+
+FRandomAssetManifest::FContentStamp FRandomAssetManifest::GetContentStamp(const FString& InContentDirectory)
+{
+    FContentStamp ContentStamp;
+    ContentStamp.LatestModifiedTicks = 0;
+    ContentStamp.AssetFileCount = 0;
+
+    FString DiskDirectory;
+    if (FPackageName::TryConvertLongPackageNameToFilename(InContentDirectory + TEXT("/"), DiskDirectory))
+    {
+        const FString& AssetExtension = FPackageName::GetAssetPackageExtension();
+        const FString& MapExtension = FPackageName::GetMapPackageExtension();
+
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        PlatformFile.IterateDirectoryStatRecursively(*DiskDirectory, [&](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+        {
+            if (!StatData.bIsDirectory)
+            {
+                const FString Extension = FPaths::GetExtension(FilenameOrDirectory, true);
+                if ((Extension == AssetExtension) || (Extension == MapExtension))
+                {
+                    ContentStamp.LatestModifiedTicks = FMath::Max(ContentStamp.LatestModifiedTicks, StatData.ModificationTime.GetTicks());
+                    ContentStamp.AssetFileCount++;
+                }
+            }
+            return true;
+        });
+    }
+
+    return ContentStamp;
+}
+#endif // WITH_EDITOR
+
+FSoftObjectPath FRandomAssetManifest::GetAssetPath(int32 AssetIndex) const
+{
+    if ((AssetIndex < 0) || (AssetIndex >= AssetCount))
+    {
+        return FSoftObjectPath();
+    }
+    return FSoftObjectPath(GetManifestString(AssetEntries[AssetIndex].ObjectPath));
+}
+
+bool FRandomAssetManifest::FilterAssets(const UClass* AssetClass, TArray<int32>& OutAssetIndexes) const
+{
+    OutAssetIndexes.Reset();
+
+    // NOTE: The manifest only has a few classes, resolve each of them once instead of once per asset
+    TArray<bool> ClassMatches;
+    ClassMatches.SetNumZeroed(ClassCount);
+    bool bAllClassesMatch = true;
+    for (int32 ClassIndex = 0; ClassIndex < ClassCount; ClassIndex++)
+    {
+        const FString ClassName = GetManifestString(ClassNames[ClassIndex]);
+        const UClass* CheckClass = ClassName.IsEmpty() ? nullptr : FindObject<UClass>(ANY_PACKAGE, *ClassName);
+        ClassMatches[ClassIndex] = AssetClass && CheckClass && CheckClass->IsChildOf(AssetClass);
+        bAllClassesMatch = bAllClassesMatch && ClassMatches[ClassIndex];
+    }
+    if (bAllClassesMatch)
+    {
+        return true;
+    }
+
+    for (int32 AssetIndex = 0; AssetIndex < AssetCount; AssetIndex++)
+    {
+        const int32 ClassIndex = AssetEntries[AssetIndex].ClassIndex;
+        if (ClassMatches.IsValidIndex(ClassIndex) && ClassMatches[ClassIndex])
+        {
+            OutAssetIndexes.Add(AssetIndex);
+        }
+    }
+    return false;
+}
+
+bool FRandomAssetManifest::WriteManifestFile(const FString& FilePath, const FString& InContentDirectory, const FContentStamp& ContentStamp, const TArray<TPair<FString, FName>>& Assets)
+{
+    TArray<uint8> StringBytes;
+    auto AddString = [&StringBytes](const FString& NewString)
+    {
+        FTCHARToUTF8 Converter(*NewString);
+        FManifestString ManifestString;
+        ManifestString.Offset = StringBytes.Num();
+        ManifestString.Length = Converter.Length();
+        StringBytes.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+        return ManifestString;
+    };
+
+    FManifestFileHeader Header;
+    FMemory::Memzero(Header);
+    Header.Magic = ManifestFileMagic;
+    Header.Version = ManifestFileVersion;
+    Header.LatestModifiedTicks = ContentStamp.LatestModifiedTicks;
+    Header.AssetFileCount = ContentStamp.AssetFileCount;
+
+    const FManifestString DirectoryString = AddString(InContentDirectory);
+    Header.DirectoryOffset = DirectoryString.Offset;
+    Header.DirectoryLength = DirectoryString.Length;
+
+    TArray<FManifestString> ClassTable;
+    TMap<FName, int32> ClassIndexes;
+    TArray<FManifestAssetEntry> AssetTable;
+    AssetTable.Reserve(Assets.Num());
+    for (const TPair<FString, FName>& Asset : Assets)
+    {
+        int32* FoundClassIndex = ClassIndexes.Find(Asset.Value);
+        if (!FoundClassIndex)
+        {
+            FoundClassIndex = &ClassIndexes.Add(Asset.Value, ClassTable.Add(AddString(Asset.Value.ToString())));
+        }
+        const int32 ClassIndex = *FoundClassIndex;
+
+        FManifestAssetEntry NewEntry;
+        NewEntry.ObjectPath = AddString(Asset.Key);
+        NewEntry.ClassIndex = ClassIndex;
+        AssetTable.Add(NewEntry);
+    }
+    Header.ClassCount = ClassTable.Num();
+    Header.AssetCount = AssetTable.Num();
+    Header.StringDataSize = StringBytes.Num();
+
+    TArray<uint8> FileBytes;
+    FileBytes.Reserve(sizeof(FManifestFileHeader) + ClassTable.Num() * sizeof(FManifestString) + AssetTable.Num() * sizeof(FManifestAssetEntry) + StringBytes.Num());
+    FileBytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FManifestFileHeader));
+    FileBytes.Append(reinterpret_cast<const uint8*>(ClassTable.GetData()), ClassTable.Num() * sizeof(FManifestString));
+    FileBytes.Append(reinterpret_cast<const uint8*>(AssetTable.GetData()), AssetTable.Num() * sizeof(FManifestAssetEntry));
+    FileBytes.Append(StringBytes);
+
+    // NOTE: Write a temporary file then rename it, so the other processes never map a partially written manifest
+    const FString TempFilePath = FilePath + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+    if (!FFileHelper::SaveArrayToFile(FileBytes, *TempFilePath))
+    {
+        return false;
+    }
+    if (!IFileManager::Get().Move(*FilePath, *TempFilePath, true, true))
+    {
+        IFileManager::Get().Delete(*TempFilePath);
+        return false;
+    }
+    return true;
+}
+
+bool FRandomAssetManifest::LoadManifestFile(const FString& FilePath, const FString& InContentDirectory, const FContentStamp* ExpectedStamp)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*FilePath))
+    {
+        return false;
+    }
+
+    const uint8* ManifestData = nullptr;
+    int64 ManifestSize = 0;
+    MappedFile.Reset(PlatformFile.OpenMapped(*FilePath));
+    if (MappedFile.IsValid() && (MappedFile->GetFileSize() > 0))
+    {
+        MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+    }
+    if (MappedRegion.IsValid())
+    {
+        ManifestData = MappedRegion->GetMappedPtr();
+        ManifestSize = MappedRegion->GetMappedSize();
+    }
+    else
+    {
+        // NOTE: Not all the platforms can memory map a file
+        MappedFile.Reset();
+        if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+        {
+            return false;
+        }
+        ManifestData = FileData.GetData();
+        ManifestSize = FileData.Num();
+    }
+
+    if (!ManifestData || (ManifestSize < (int64)sizeof(FManifestFileHeader)))
+    {
+        UE_LOG(LogNVDRUtils, Warning, TEXT("FRandomAssetManifest - '%s' isn't a valid manifest file"), *FilePath);
+        return false;
+    }
+
+    FManifestFileHeader Header;
+    FMemory::Memcpy(&Header, ManifestData, sizeof(FManifestFileHeader));
+    const int64 ClassTableOffset = sizeof(FManifestFileHeader);
+    const int64 AssetTableOffset = ClassTableOffset + (int64)Header.ClassCount * sizeof(FManifestString);
+    const int64 StringDataOffset = AssetTableOffset + (int64)Header.AssetCount * sizeof(FManifestAssetEntry);
+    if ((Header.Magic != ManifestFileMagic) || (Header.Version != ManifestFileVersion)
+        || (Header.ClassCount < 0) || (Header.AssetCount < 0) || (Header.StringDataSize < 0)
+        || (StringDataOffset + Header.StringDataSize != ManifestSize))
+    {
+        UE_LOG(LogNVDRUtils, Warning, TEXT("FRandomAssetManifest - '%s' isn't a valid manifest file"), *FilePath);
+        return false;
+    }
+
+    StringData = ManifestData + StringDataOffset;
+    StringDataSize = Header.StringDataSize;
+
+    FManifestString DirectoryString;
+    DirectoryString.Offset = Header.DirectoryOffset;
+    DirectoryString.Length = Header.DirectoryLength;
+    const FString ManifestDirectory = GetManifestString(DirectoryString);
+    if (!ManifestDirectory.Equals(InContentDirectory, ESearchCase::IgnoreCase))
+    {
+        UE_LOG(LogNVDRUtils, Warning, TEXT("FRandomAssetManifest - '%s' is the manifest of directory '%s' instead of '%s'"), *FilePath, *ManifestDirectory, *InContentDirectory);
+        return false;
+    }
+    if (ExpectedStamp && ((Header.LatestModifiedTicks != ExpectedStamp->LatestModifiedTicks) || (Header.AssetFileCount != ExpectedStamp->AssetFileCount)))
+    {
+        UE_LOG(LogNVDRUtils, Log, TEXT("FRandomAssetManifest - The manifest of directory '%s' is out of date"), *InContentDirectory);
+        return false;
+    }
+
+    // NOTE: The tables are used in place, the file's offsets are all 4 bytes aligned
+    ClassNames = reinterpret_cast<const FManifestString*>(ManifestData + ClassTableOffset);
+    ClassCount = Header.ClassCount;
+    AssetEntries = reinterpret_cast<const FManifestAssetEntry*>(ManifestData + AssetTableOffset);
+    AssetCount = Header.AssetCount;
+    ContentDirectory = InContentDirectory;
+    return true;
+}
+
+FString FRandomAssetManifest::GetManifestString(const FManifestString& ManifestString) const
+{
+    if (!StringData || (ManifestString.Offset < 0) || (ManifestString.Length <= 0) || (ManifestString.Offset > StringDataSize - ManifestString.Length))
+    {
+        return FString();
+    }
+
+    FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(StringData + ManifestString.Offset), ManifestString.Length);
+    return FString(Converter.Length(), Converter.Get());
+}
+
+bool FRandomAssetManifest::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Asset manifest"), LogNVDRUtils);
+
+    IFileManager& FileManager = IFileManager::Get();
+    const FString TestDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("NVAssetManifestTest"));
+    FileManager.DeleteDirectory(*TestDirectory, false, true);
+
+    const FString TestContentDirectory = TEXT("/Game/NVAssetManifestTest");
+    FContentStamp TestStamp;
+    TestStamp.LatestModifiedTicks = FDateTime(2018, 6, 1).GetTicks();
+    TestStamp.AssetFileCount = 5;
+
+    TArray<TPair<FString, FName>> TestAssets;
+    TestAssets.Emplace(TEXT("/Game/NVAssetManifestTest/T_Wood.T_Wood"), FName(TEXT("Texture2D")));
+    TestAssets.Emplace(TEXT("/Game/NVAssetManifestTest/M_Wood.M_Wood"), FName(TEXT("Material")));
+    TestAssets.Emplace(TEXT("/Game/NVAssetManifestTest/Sky/T_Sky.T_Sky"), FName(TEXT("TextureCube")));
+    TestAssets.Emplace(TEXT("/Game/NVAssetManifestTest/\u00C9t\u00E9/SM_Rock.SM_Rock"), FName(TEXT("StaticMesh")));
+    TestAssets.Emplace(TEXT("/Game/NVAssetManifestTest/X_Unknown.X_Unknown"), FName(TEXT("NVNotAnAssetClass")));
+
+    const FString TestFilePath = FPaths::Combine(TestDirectory, TEXT("Test.nvmanifest"));
+    TestResult.Check(WriteManifestFile(TestFilePath, TestContentDirectory, TestStamp, TestAssets), TEXT("the manifest file can't be written"));
+
+    {
+        FRandomAssetManifest TestManifest;
+        TestResult.Check(TestManifest.LoadManifestFile(TestFilePath, TestContentDirectory, &TestStamp), TEXT("the manifest file can't be loaded"));
+        TestResult.Check(TestManifest.GetAssetCount() == TestAssets.Num(), TEXT("the manifest doesn't have all the assets"));
+
+        bool bPathsMatch = true;
+        for (int32 AssetIndex = 0; AssetIndex < TestAssets.Num(); AssetIndex++)
+        {
+            bPathsMatch = bPathsMatch && (TestManifest.GetAssetPath(AssetIndex) == FSoftObjectPath(TestAssets[AssetIndex].Key));
+        }
+        TestResult.Check(bPathsMatch, TEXT("the asset paths don't match the written ones"));
+        TestResult.Check(!TestManifest.GetAssetPath(TestAssets.Num()).IsValid(), TEXT("an asset out of the manifest has a path"));
+
+        TArray<int32> AssetIndexes;
+        TestResult.Check(!TestManifest.FilterAssets(UTexture::StaticClass(), AssetIndexes) && (AssetIndexes == TArray<int32>({ 0, 2 })),
+                         TEXT("the textures aren't filtered correctly"));
+        TestResult.Check(!TestManifest.FilterAssets(UMaterialInterface::StaticClass(), AssetIndexes) && (AssetIndexes == TArray<int32>({ 1 })),
+                         TEXT("the materials aren't filtered correctly"));
+        TestResult.Check(!TestManifest.FilterAssets(USkeletalMesh::StaticClass(), AssetIndexes) && (AssetIndexes.Num() == 0),
+                         TEXT("an asset of another class passed the filter"));
+        TestResult.Check(!TestManifest.FilterAssets(UObject::StaticClass(), AssetIndexes) && (AssetIndexes.Num() == TestAssets.Num() - 1),
+                         TEXT("an asset of an unknown class passed the filter"));
+
+        // The shard processes map the same manifest file at the same time, a mapped manifest must not lock it
+        FRandomAssetManifest OtherProcessManifest;
+        TestResult.Check(OtherProcessManifest.LoadManifestFile(TestFilePath, TestContentDirectory, &TestStamp)
+                         && (OtherProcessManifest.GetAssetPath(2) == TestManifest.GetAssetPath(2)),
+                         TEXT("a manifest file can't be shared while it's mapped"));
+    }
+
+    // A manifest whose assets all match isn't copied to an index list
+    {
+        TArray<TPair<FString, FName>> TextureAssets;
+        TextureAssets.Add(TestAssets[0]);
+        TextureAssets.Add(TestAssets[2]);
+        const FString TextureFilePath = FPaths::Combine(TestDirectory, TEXT("Textures.nvmanifest"));
+        TestResult.Check(WriteManifestFile(TextureFilePath, TestContentDirectory, TestStamp, TextureAssets), TEXT("the texture manifest file can't be written"));
+
+        FRandomAssetManifest TestManifest;
+        TArray<int32> AssetIndexes;
+        TestResult.Check(TestManifest.LoadManifestFile(TextureFilePath, TestContentDirectory, nullptr), TEXT("the texture manifest file can't be loaded"));
+        TestResult.Check(TestManifest.FilterAssets(UTexture::StaticClass(), AssetIndexes) && (AssetIndexes.Num() == 0), TEXT("the matching assets are listed"));
+    }
+
+    // An empty directory has a valid manifest
+    {
+        const FString EmptyFilePath = FPaths::Combine(TestDirectory, TEXT("Empty.nvmanifest"));
+        TestResult.Check(WriteManifestFile(EmptyFilePath, TestContentDirectory, TestStamp, TArray<TPair<FString, FName>>()), TEXT("the empty manifest file can't be written"));
+
+        FRandomAssetManifest TestManifest;
+        TestResult.Check(TestManifest.LoadManifestFile(EmptyFilePath, TestContentDirectory, &TestStamp) && (TestManifest.GetAssetCount() == 0),
+                         TEXT("the empty manifest file can't be loaded"));
+    }
+
+    // The out of date, mismatched and damaged manifests are rejected
+    {
+        FContentStamp ChangedStamp = TestStamp;
+        ChangedStamp.AssetFileCount++;
+        FRandomAssetManifest TestManifest;
+        TestResult.Check(!TestManifest.LoadManifestFile(TestFilePath, TestContentDirectory, &ChangedStamp), TEXT("a manifest with a deleted file was loaded"));
+    }
+    {
+        FContentStamp ChangedStamp = TestStamp;
+        ChangedStamp.LatestModifiedTicks += ETimespan::TicksPerSecond;
+        FRandomAssetManifest TestManifest;
+        TestResult.Check(!TestManifest.LoadManifestFile(TestFilePath, TestContentDirectory, &ChangedStamp), TEXT("a manifest with a modified file was loaded"));
+    }
+    {
+        FRandomAssetManifest TestManifest;
+        TestResult.Check(!TestManifest.LoadManifestFile(TestFilePath, TEXT("/Game/NVAssetManifestOther"), nullptr), TEXT("the manifest of another directory was loaded"));
+    }
+    {
+        TArray<uint8> FileBytes;
+        FFileHelper::LoadFileToArray(FileBytes, *TestFilePath);
+        FileBytes.SetNum(FMath::Max(0, FileBytes.Num() - 1));
+        const FString TruncatedFilePath = FPaths::Combine(TestDirectory, TEXT("Truncated.nvmanifest"));
+        FFileHelper::SaveArrayToFile(FileBytes, *TruncatedFilePath);
+
+        FRandomAssetManifest TestManifest;
+        TestResult.Check(!TestManifest.LoadManifestFile(TruncatedFilePath, TestContentDirectory, nullptr), TEXT("a truncated manifest was loaded"));
+    }
+
+    // The directories map to distinct manifest files
+    TestResult.Check(GetManifestFilePath(TEXT("/Game/A/B")) == GetManifestFilePath(TEXT("Game\\A\\B\\")), TEXT("the same directory map to different manifest files"));
+    TestResult.Check(GetManifestFilePath(TEXT("/Game/A_B")) != GetManifestFilePath(TEXT("/Game/A/B")), TEXT("different directories map to the same manifest file"));
+
+    FileManager.DeleteDirectory(*TestDirectory, false, true);
+
+    return TestResult.Finish();
+}
@@ -0,0 +1,107 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// FRandomAssetManifest is the list of all the assets inside a content directory (and its sub-directories) saved to a file,
+// so the asset streamers don't need to scan their directories with the asset registry when they start
+// The manifest file is memory mapped and filtered in place, an asset's path is only converted to a string when it's used
+// NOTE: The manifest files are built ahead of time with the 'NV.BuildAssetManifests' console command or when a directory is first used in the editor,
+// all the processes using the project (e.g: the frame range shards) share them
+// A packaged build can't scan its content: its manifests must be built in the editor and the manifest directory staged with the build,
+// the project's DefaultGame.ini stage Content/AssetManifests as loose files (DirectoriesToAlwaysStageAsNonUFS) so they can be memory mapped
+// NOTE: Keep that setting in sync when the manifests are moved, a packaged build overriding '-AssetManifestDir=' must ship the directory itself
+class DOMAINRANDOMIZATIONDNN_API FRandomAssetManifest
+{
+public:
+    FRandomAssetManifest();
+    ~FRandomAssetManifest();
+
+    // Get the manifest of a content directory (e.g: "/Game/Textures"), the manifests are shared by all their users in the process
+    // In the editor, the manifest file is (re)built when it's missing or when the directory's content changed since it was written
+    static TSharedPtr<FRandomAssetManifest> Get(const FString& ContentDirectory);
+
+    // The directory where the manifest files are, it can be overridden with the '-AssetManifestDir=' command line argument
+    static FString GetManifestDirectory();
+    static FString GetManifestFilePath(const FString& ContentDirectory);
+
+#if WITH_EDITOR
+    // Scan a content directory with the asset registry and write its manifest file
+    static bool BuildManifest(const FString& ContentDirectory);
+#endif // WITH_EDITOR
+
+    const FString& GetContentDirectory() const
+    {
+        return ContentDirectory;
+    }
+    int32 GetAssetCount() const
+    {
+        return AssetCount;
+    }
+    FSoftObjectPath GetAssetPath(int32 AssetIndex) const;
+
+    // Find the indexes of the assets whose class is AssetClass or one of its children
+    // Return true if all the assets in the manifest match, OutAssetIndexes is left empty in that case
+    bool FilterAssets(const UClass* AssetClass, TArray<int32>& OutAssetIndexes) const;
+
+    // Check that the manifest files are written, validated and filtered correctly, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    // The fingerprint of a directory's content, the manifest must be rebuilt when it changes
+    struct FContentStamp
+    {
+        // Latest modification time (in ticks) of the asset files in the directory
+        int64 LatestModifiedTicks;
+        // Number of asset files in the directory, so deleted files are noticed too
+        int32 AssetFileCount;
+    };
+
+    // A string in the manifest's string data (UTF-8)
+    struct FManifestString
+    {
+        int32 Offset;
+        int32 Length;
+    };
+
+    struct FManifestAssetEntry
+    {
+        FManifestString ObjectPath;
+        // Index of the asset's class name in the manifest's class table
+        int32 ClassIndex;
+    };
+
+    static FString NormalizeContentDirectory(const FString& ContentDirectory);
+#if WITH_EDITOR
+    static FContentStamp GetContentStamp(const FString& ContentDirectory);
+#endif // WITH_EDITOR
+
+    // Write a manifest file, the assets are pairs of object path and class name
+    static bool WriteManifestFile(const FString& FilePath, const FString& InContentDirectory, const FContentStamp& ContentStamp, const TArray<TPair<FString, FName>>& Assets);
+    // Map a manifest file and check it's valid for a directory, the content stamp is only checked if ExpectedStamp isn't null
+    bool LoadManifestFile(const FString& FilePath, const FString& InContentDirectory, const FContentStamp* ExpectedStamp);
+    FString GetManifestString(const FManifestString& ManifestString) const;
+
+protected:
+    FString ContentDirectory;
+
+    TUniquePtr<IMappedFileHandle> MappedFile;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    // The content of the manifest file when the platform can't memory map it
+    TArray<uint8> FileData;
+
+    const FManifestString* ClassNames;
+    int32 ClassCount;
+    const FManifestAssetEntry* AssetEntries;
+    int32 AssetCount;
+    const uint8* StringData;
+    int32 StringDataSize;
+};
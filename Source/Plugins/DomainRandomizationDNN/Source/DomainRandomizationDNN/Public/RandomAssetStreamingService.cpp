@@ -0,0 +1,274 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "DomainRandomizationDNNPCH.h"
+#include "RandomAssetStreamingService.h"
+#include "NVSceneCapturerUtils.h"
+#include "RandomAssetManifest.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    TMap<TWeakObjectPtr<const UWorld>, TSharedPtr<FRandomAssetStreamingService>> WorldStreamingServices;
+
+    FAutoConsoleCommand TestAssetStreamingServiceCommand(
+        TEXT("NV.TestAssetStreamingService"),
+        TEXT("Check that the asset streamers using equivalent directories share their asset set"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FRandomAssetStreamingService::RunSelfTest();
+        }));
+
+    FAutoConsoleCommand AssetStreamingStatsCommand(
+        TEXT("NV.AssetStreamingStats"),
+        TEXT("Print the asset sets shared by the asset streamers of each world"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            for (const auto& ServicePair : WorldStreamingServices)
+            {
+                const UWorld* ServiceWorld = ServicePair.Key.Get();
+                if (ServiceWorld)
+                {
+                    UE_LOG(LogNVDRUtils, Log, TEXT("World '%s':"), *ServiceWorld->GetName());
+                    ServicePair.Value->LogStats();
+                }
+            }
+        }));
+}
+
+//=================================== FRandomAssetSet ===================================
+FRandomAssetSet::FRandomAssetSet(const TArray<FString>& InContentDirectories, const UClass* InAssetClass)
+{
+    ContentDirectories = InContentDirectories;
+    AssetClass = InAssetClass;
+    AssetCount = 0;
+
+    if (!AssetClass)
+    {
+        return;
+    }
+
+    for (const FString& ContentDirectory : ContentDirectories)
+    {
+        // NOTE: The manifest is shared with the other asset sets using the same directory, only the indexes of the class' assets are copied
+        TSharedPtr<FRandomAssetManifest> AssetManifest = FRandomAssetManifest::Get(ContentDirectory);
+        if (AssetManifest.IsValid())
+        {
+            TArray<int32> AssetIndexes;
+            const bool bAllAssetsMatch = AssetManifest->FilterAssets(AssetClass, AssetIndexes);
+            const int32 MatchedAssetCount = bAllAssetsMatch ? AssetManifest->GetAssetCount() : AssetIndexes.Num();
+            if (MatchedAssetCount > 0)
+            {
+                AssetManifests.Add(AssetManifest);
+                ManifestAssetIndexes.Add(MoveTemp(AssetIndexes));
+                AssetCount += MatchedAssetCount;
+            }
+        }
+    }
+}
+
+TArray<FString> FRandomAssetSet::NormalizeAssetDirectories(const TArray<FDirectoryPath>& AssetDirectories)
+{
+    TArray<FString> ContentDirectories;
+    for (const FDirectoryPath& AssetDirectory : AssetDirectories)
+    {
+        FString DirPath = AssetDirectory.Path;
+        FPaths::NormalizeDirectoryName(DirPath);
+        while (!DirPath.IsEmpty() && DirPath.EndsWith(TEXT("/")))
+        {
+            DirPath = DirPath.Left(DirPath.Len() - 1);
+        }
+        while (DirPath.StartsWith(TEXT("/")))
+        {
+            DirPath = DirPath.Mid(1);
+        }
+
+        // NOTE: All the directory must be inside the game's content folder
+        ContentDirectories.AddUnique(DirPath.IsEmpty() ? FString(TEXT("/Game")) : FPaths::Combine(TEXT("/Game"), DirPath));
+    }
+
+    // NOTE: The assets are indexed in the directories' order, sort them so all the streamers of the set agree on the indexes
+    ContentDirectories.Sort();
+    return ContentDirectories;
+}
+
+FString FRandomAssetSet::MakeAssetSetKey(const TArray<FString>& InContentDirectories, const UClass* InAssetClass)
+{
+    const FString AssetClassPath = InAssetClass ? InAssetClass->GetPathName() : FString();
+    return AssetClassPath + TEXT("|") + FString::Join(InContentDirectories, TEXT(";"));
+}
+
+FSoftObjectPath FRandomAssetSet::GetAssetPath(int32 AssetIndex) const
+{
+    for (int32 ManifestIndex = 0; ManifestIndex < AssetManifests.Num(); ManifestIndex++)
+    {
+        const TArray<int32>& AssetIndexes = ManifestAssetIndexes[ManifestIndex];
+        const bool bAllAssetsMatch = (AssetIndexes.Num() == 0);
+        const int32 MatchedAssetCount = bAllAssetsMatch ? AssetManifests[ManifestIndex]->GetAssetCount() : AssetIndexes.Num();
+        if (AssetIndex < MatchedAssetCount)
+        {
+            return AssetManifests[ManifestIndex]->GetAssetPath(bAllAssetsMatch ? AssetIndex : AssetIndexes[AssetIndex]);
+        }
+        AssetIndex -= MatchedAssetCount;
+    }
+    return FSoftObjectPath();
+}
+
+//=================================== FRandomAssetStreamingService ===================================
+FRandomAssetStreamingService::FRandomAssetStreamingService()
+{
+    AssetSets.Reset();
+}
+
+FRandomAssetStreamingService* FRandomAssetStreamingService::Get(UWorld* World)
+{
+    ensure(World);
+    if (!World)
+    {
+        UE_LOG(LogNVDRUtils, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    // NOTE: The services are only accessed on the game thread
+    check(IsInGameThread());
+
+    const TSharedPtr<FRandomAssetStreamingService>* ExistingServicePtr = WorldStreamingServices.Find(World);
+    if (ExistingServicePtr)
+    {
+        return ExistingServicePtr->Get();
+    }
+
+    // Drop the services of the worlds which are already destroyed
+    for (auto It = WorldStreamingServices.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    TSharedPtr<FRandomAssetStreamingService> NewService = MakeShareable(new FRandomAssetStreamingService());
+    WorldStreamingServices.Add(World, NewService);
+    return NewService.Get();
+}
+
+FRandomAssetStreamingService* FRandomAssetStreamingService::Find(const UWorld* World)
+{
+    const TSharedPtr<FRandomAssetStreamingService>* ExistingServicePtr = World ? WorldStreamingServices.Find(World) : nullptr;
+    return ExistingServicePtr ? ExistingServicePtr->Get() : nullptr;
+}
+
+TSharedPtr<FRandomAssetSet> FRandomAssetStreamingService::GetAssetSet(const TArray<FDirectoryPath>& AssetDirectories, const UClass* AssetClass)
+{
+    const TArray<FString> ContentDirectories = FRandomAssetSet::NormalizeAssetDirectories(AssetDirectories);
+    const FString AssetSetKey = FRandomAssetSet::MakeAssetSetKey(ContentDirectories, AssetClass);
+
+    TSharedPtr<FRandomAssetSet> AssetSet = AssetSets.FindRef(AssetSetKey).Pin();
+    if (!AssetSet.IsValid())
+    {
+        RemoveUnusedAssetSets();
+
+        AssetSet = MakeShareable(new FRandomAssetSet(ContentDirectories, AssetClass));
+        AssetSets.Add(AssetSetKey, AssetSet);
+    }
+    return AssetSet;
+}
+
+int32 FRandomAssetStreamingService::GetAssetSetCount() const
+{
+    int32 AssetSetCount = 0;
+    for (const auto& AssetSetPair : AssetSets)
+    {
+        if (AssetSetPair.Value.IsValid())
+        {
+            AssetSetCount++;
+        }
+    }
+    return AssetSetCount;
+}
+
+void FRandomAssetStreamingService::LogStats() const
+{
+    int32 StreamerCount = 0;
+    for (const auto& AssetSetPair : AssetSets)
+    {
+        const TSharedPtr<FRandomAssetSet> AssetSet = AssetSetPair.Value.Pin();
+        if (AssetSet.IsValid())
+        {
+            // NOTE: Don't count the reference held for this log
+            const int32 SetStreamerCount = AssetSet.GetSharedReferenceCount() - 1;
+            StreamerCount += SetStreamerCount;
+
+            const UClass* AssetClass = AssetSet->GetAssetClass();
+            UE_LOG(LogNVDRUtils, Log, TEXT("FRandomAssetStreamingService - '%s' in [%s]: %d assets - %d streamers"),
+                   AssetClass ? *AssetClass->GetName() : TEXT("None"), *FString::Join(AssetSet->GetContentDirectories(), TEXT(", ")),
+                   AssetSet->GetAssetCount(), SetStreamerCount);
+        }
+    }
+    UE_LOG(LogNVDRUtils, Log, TEXT("FRandomAssetStreamingService - %d asset sets shared by %d streamers"), GetAssetSetCount(), StreamerCount);
+}
+
+void FRandomAssetStreamingService::RemoveUnusedAssetSets()
+{
+    for (auto It = AssetSets.CreateIterator(); It; ++It)
+    {
+        if (!It.Value().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+bool FRandomAssetStreamingService::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Asset streaming service"), LogNVDRUtils);
+
+    auto MakeDirectories = [](std::initializer_list<const TCHAR*> DirPaths)
+    {
+        TArray<FDirectoryPath> AssetDirectories;
+        for (const TCHAR* DirPath : DirPaths)
+        {
+            FDirectoryPath AssetDirectory;
+            AssetDirectory.Path = DirPath;
+            AssetDirectories.Add(AssetDirectory);
+        }
+        return AssetDirectories;
+    };
+
+    const TArray<FString> ContentDirectories = FRandomAssetSet::NormalizeAssetDirectories(MakeDirectories({ TEXT("Textures/Wood/"), TEXT("/Backgrounds"), TEXT("Textures\\Wood") }));
+    TestResult.Check(ContentDirectories == TArray<FString>({ TEXT("/Game/Backgrounds"), TEXT("/Game/Textures/Wood") }),
+                     TEXT("the directories aren't normalized, sorted and unique"));
+    TestResult.Check(FRandomAssetSet::NormalizeAssetDirectories(MakeDirectories({ TEXT("/") })) == TArray<FString>({ TEXT("/Game") }),
+                     TEXT("the content folder itself isn't normalized"));
+
+    const FString TextureSetKey = FRandomAssetSet::MakeAssetSetKey(ContentDirectories, UTexture2D::StaticClass());
+    TestResult.Check(TextureSetKey == FRandomAssetSet::MakeAssetSetKey(FRandomAssetSet::NormalizeAssetDirectories(MakeDirectories({ TEXT("Backgrounds/"), TEXT("Textures/Wood") })), UTexture2D::StaticClass()),
+                     TEXT("equivalent directories don't share their asset set"));
+    TestResult.Check(TextureSetKey != FRandomAssetSet::MakeAssetSetKey(ContentDirectories, UMaterialInterface::StaticClass()),
+                     TEXT("the asset sets of different classes are shared"));
+    TestResult.Check(TextureSetKey != FRandomAssetSet::MakeAssetSetKey(FRandomAssetSet::NormalizeAssetDirectories(MakeDirectories({ TEXT("Backgrounds") })), UTexture2D::StaticClass()),
+                     TEXT("the asset sets of different directories are shared"));
+
+    // The streamers of equivalent requests share one asset set, which is released with its last streamer
+    // NOTE: Without any directory no manifest is loaded, only the sharing is tested
+    {
+        FRandomAssetStreamingService TestService;
+        TSharedPtr<FRandomAssetSet> TextureSetA = TestService.GetAssetSet(TArray<FDirectoryPath>(), UTexture2D::StaticClass());
+        TSharedPtr<FRandomAssetSet> TextureSetB = TestService.GetAssetSet(TArray<FDirectoryPath>(), UTexture2D::StaticClass());
+        TSharedPtr<FRandomAssetSet> MaterialSet = TestService.GetAssetSet(TArray<FDirectoryPath>(), UMaterialInterface::StaticClass());
+        TestResult.Check(TextureSetA.IsValid() && (TextureSetA == TextureSetB), TEXT("the streamers of the same asset set don't share it"));
+        TestResult.Check(MaterialSet.IsValid() && (MaterialSet != TextureSetA), TEXT("the streamers of different classes share an asset set"));
+        TestResult.Check(TestService.GetAssetSetCount() == 2, TEXT("wrong number of asset sets in use"));
+
+        TextureSetA.Reset();
+        TestResult.Check(TestService.GetAssetSetCount() == 2, TEXT("the asset set was released while a streamer still use it"));
+        TextureSetB.Reset();
+        TestResult.Check(TestService.GetAssetSetCount() == 1, TEXT("the asset set wasn't released with its last streamer"));
+    }
+
+    return TestResult.Finish();
+}
@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+class FRandomAssetManifest;
+struct FDirectoryPath;
+
+// FRandomAssetSet is the list of the assets of a class inside some content directories
+// It's shared by all the asset streamers which use the same directories and class, each streamer only keep its own random picks
+class DOMAINRANDOMIZATIONDNN_API FRandomAssetSet
+{
+public:
+    // @param InContentDirectories  Normalized content directories, e.g: "/Game/Textures"
+    FRandomAssetSet(const TArray<FString>& InContentDirectories, const UClass* InAssetClass);
+
+    // Convert the directories picked in the editor (relative to the game's content folder) to sorted and unique content directories
+    // e.g: "Textures/", "/Textures" and "Textures" are all "/Game/Textures"
+    static TArray<FString> NormalizeAssetDirectories(const TArray<FDirectoryPath>& AssetDirectories);
+    // The key which identify the asset set of some normalized directories and class
+    static FString MakeAssetSetKey(const TArray<FString>& ContentDirectories, const UClass* AssetClass);
+
+    const TArray<FString>& GetContentDirectories() const
+    {
+        return ContentDirectories;
+    }
+    const UClass* GetAssetClass() const
+    {
+        return AssetClass;
+    }
+    int32 GetAssetCount() const
+    {
+        return AssetCount;
+    }
+    // Get the path of an asset, the assets are indexed across all the directories
+    FSoftObjectPath GetAssetPath(int32 AssetIndex) const;
+
+protected:
+    TArray<FString> ContentDirectories;
+    const UClass* AssetClass;
+    int32 AssetCount;
+
+    // The manifests of the directories which have some assets of the class
+    TArray<TSharedPtr<FRandomAssetManifest>> AssetManifests;
+    // The indexes of the class' assets in each manifest, empty when all the manifest's assets are of the class
+    TArray<TArray<int32>> ManifestAssetIndexes;
+};
+
+// FRandomAssetStreamingService is the per world service the asset streamers get their asset sets from
+// The streamers using the same directories and class share one asset set, so the directories are only filtered once
+// and the cost of the streaming follow the number of unique directories rather than the number of randomized components
+// NOTE: The loaded assets are kept in the FRandomAssetCache which is shared by all the worlds
+class DOMAINRANDOMIZATIONDNN_API FRandomAssetStreamingService
+{
+public:
+    FRandomAssetStreamingService();
+
+    // Get the service of a world, it's created the first time it's requested
+    static FRandomAssetStreamingService* Get(UWorld* World);
+    // Get the service of a world only if it was already created
+    static FRandomAssetStreamingService* Find(const UWorld* World);
+
+    // Get the asset set of some directories and class, it's created the first time it's requested
+    // The set is released when none of the streamers use it anymore
+    TSharedPtr<FRandomAssetSet> GetAssetSet(const TArray<FDirectoryPath>& AssetDirectories, const UClass* AssetClass);
+
+    // Number of asset sets in use
+    int32 GetAssetSetCount() const;
+    // Print the asset sets in use and how many streamers share each of them
+    void LogStats() const;
+
+    // Check that the asset sets of equivalent directories are shared by the streamers and released with the last one, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    void RemoveUnusedAssetSets();
+
+protected:
+    TMap<FString, TWeakPtr<FRandomAssetSet>> AssetSets;
+};
@@ -6,13 +6,16 @@
 
 #include "DomainRandomizationDNNPCH.h"
 #include "RandomComponentBase.h"
+#include "GroupActorManager.h"
+#include "RandomizationScheduler.h"
+#include "NVRandomizationLog.h"
 
 // Sets default values
 URandomComponentBase::URandomComponentBase()
 {
-    // TODO (TT): Should only tick if the componnent is actively do randomization
+    // NOTE: The world's FRandomizationScheduler count down the randomization durations, only the components which animate their randomization need to tick
     PrimaryComponentTick.TickGroup = TG_PrePhysics;
-    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bCanEverTick = false;
 
     bShouldRandomize = true;
     RandomizationDurationRange = FFloatRange(1.f, 3.f);
@@ -21,15 +24,14 @@ URandomComponentBase::URandomComponentBase()
     bAutoActivate = true;
     bAutoRegister = true;
 
-    CountdownUntilNextRandomization = -1.f;
-
     bOnlyRandomizeOnce = false;
     bAlreadyRandomized = false;
 }
 
 bool URandomComponentBase::ShouldRandomize() const
 {
-    return bShouldRandomize && (!bOnlyRandomizeOnce || !bAlreadyRandomized);
+    // NOTE: While the randomization log is replayed, the components' states are restored from the log instead
+    return bShouldRandomize && (!bOnlyRandomizeOnce || !bAlreadyRandomized) && !FNVRandomizationLog::IsReplaying(GetWorld());
 }
 
 void URandomComponentBase::StartRandomizing()
@@ -64,24 +66,12 @@ void URandomComponentBase::PostLoad()
     }
 }
 
-void URandomComponentBase::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-    if (CountdownUntilNextRandomization >= 0.f)
-    {
-        CountdownUntilNextRandomization -= DeltaTime;
-        if (CountdownUntilNextRandomization <= 0.f)
-        {
-            UpdateRandomization();
-        }
-    }
-}
-
 void URandomComponentBase::BeginPlay()
 {
     Super::BeginPlay();
 
+    RegisterRandomization();
+
     UpdateRandomization();
     // NOTE: Since the order of the randomizing components matter, just don't mark the component to be already randomized from BeginPlay and wait after its 1rst time randomizing
     bAlreadyRandomized = false;
@@ -89,11 +79,63 @@ void URandomComponentBase::BeginPlay()
 
 void URandomComponentBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    CountdownUntilNextRandomization = -1.f;
+    UnregisterRandomization();
 
     Super::EndPlay(EndPlayReason);
 }
 
+void URandomComponentBase::OnOwnerReleasedToPool()
+{
+    UnregisterRandomization();
+
+    // NOTE: The stream is named again after the component's new log key the next time it's used
+    RandomStream = FNVRandomStream();
+    bAlreadyRandomized = false;
+}
+
+void URandomComponentBase::OnOwnerReusedFromPool()
+{
+    RegisterRandomization();
+
+    UpdateRandomization();
+    bAlreadyRandomized = false;
+}
+
+void URandomComponentBase::RegisterRandomization()
+{
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Get(GetWorld());
+    if (RandomizationLog)
+    {
+        FNVRandomizationLogSource LogSource;
+        LogSource.SourceObject = this;
+        LogSource.Priority = GetRandomizationLogPriority();
+        LogSource.GetKey = [this]() { return GetRandomizationLogKey(); };
+        LogSource.SerializeState = [this](FArchive& Ar) { SerializeRandomizationState(Ar); };
+        RandomizationLog->RegisterSource(LogSource);
+    }
+
+    FRandomizationScheduler* Scheduler = FRandomizationScheduler::Get(GetWorld());
+    if (Scheduler)
+    {
+        Scheduler->RegisterComponent(this);
+    }
+}
+
+void URandomComponentBase::UnregisterRandomization()
+{
+    FRandomizationScheduler* Scheduler = FRandomizationScheduler::Find(GetWorld());
+    if (Scheduler)
+    {
+        Scheduler->UnregisterComponent(this);
+    }
+
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Find(GetWorld());
+    if (RandomizationLog)
+    {
+        RandomizationLog->UnregisterSource(this);
+    }
+}
+
 void URandomComponentBase::OnRandomization_Implementation()
 {
 }
@@ -104,8 +146,53 @@ void URandomComponentBase::OnFinishedRandomization()
     const float MaxDuration = RandomizationDurationInterval.Max;
     if (MaxDuration >= 0.f)
     {
-        CountdownUntilNextRandomization = FMath::RandRange(MinDuration, MaxDuration);
+        StartRandomizationCountdown(GetRandomStream().FRandRange(MinDuration, MaxDuration));
+    }
+}
+
+void URandomComponentBase::StartRandomizationCountdown(float DurationSeconds)
+{
+    FRandomizationScheduler* Scheduler = FRandomizationScheduler::Find(GetWorld());
+    if (Scheduler)
+    {
+        Scheduler->Schedule(this, DurationSeconds);
+    }
+}
+
+void URandomComponentBase::SerializeRandomizationState(FArchive& Ar)
+{
+}
+
+int32 URandomComponentBase::GetRandomizationLogPriority() const
+{
+    return 1;
+}
+
+FString URandomComponentBase::GetRandomizationLogKey() const
+{
+    const AActor* OwnerActor = GetOwner();
+    if (!OwnerActor)
+    {
+        return FString();
+    }
+
+    // NOTE: The names of the spawned actors depend on how many actors were spawned before them, use their index in their group instead
+    const AGroupActorManager* GroupActorManager = Cast<AGroupActorManager>(OwnerActor->GetOwner());
+    const int32 ManagedActorIndex = GroupActorManager ? GroupActorManager->GetManagedActorIndex(OwnerActor) : INDEX_NONE;
+    if (ManagedActorIndex != INDEX_NONE)
+    {
+        return FString::Printf(TEXT("%s/%d.%s"), *GroupActorManager->GetName(), ManagedActorIndex, *GetName());
+    }
+    return FString::Printf(TEXT("%s.%s"), *OwnerActor->GetName(), *GetName());
+}
+
+FNVRandomStream& URandomComponentBase::GetRandomStream()
+{
+    if (!RandomStream.IsInitialized())
+    {
+        RandomStream.Initialize(GetRandomizationLogKey());
     }
+    return RandomStream;
 }
 
 void URandomComponentBase::UpdateRandomization()
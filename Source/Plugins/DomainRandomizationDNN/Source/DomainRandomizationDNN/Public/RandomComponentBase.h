@@ -9,6 +9,7 @@
 #include "DomainRandomizationDNNPCH.h"
 #include "GameFramework/Actor.h"
 #include "Components/ActorComponent.h"
+#include "NVRandomStream.h"
 #include "RandomComponentBase.generated.h"
 
 UCLASS(Blueprintable, Abstract, HideCategories = (Replication, ComponentReplication, Cooking, Events, ComponentTick, Actor, Input, Rendering, Collision, PhysX, Activation, Sockets, Tags))
@@ -24,9 +25,14 @@ public:
     void StartRandomizing();
     void StopRandomizing();
 
+    /// Stop randomizing while the owner actor is kept in its AGroupActorManager's actor pool
+    virtual void OnOwnerReleasedToPool();
+    /// Randomize again like a newly spawned component when the owner actor is reused from its AGroupActorManager's actor pool
+    /// NOTE: The owner may have a different index in its group so the randomization log key and the random stream are derived again
+    virtual void OnOwnerReusedFromPool();
+
 protected:
     virtual void PostLoad() override;
-    virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
     virtual void BeginPlay() override;
     virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
@@ -36,6 +42,22 @@ protected:
 
     virtual void OnFinishedRandomization();
 
+    /// Wait for a duration (in seconds) before the next randomization, the world's FRandomizationScheduler randomize the component when it expire
+    /// NOTE: While the capturer's fixed step capture clock is running, the duration is counted in captured frames
+    void StartRandomizationCountdown(float DurationSeconds);
+
+    /// Save the state this component randomized to the world's randomization log, or restore it from the log when the archive is loading
+    /// NOTE: Nothing is logged for the components which don't override it
+    virtual void SerializeRandomizationState(FArchive& Ar);
+    /// The components with lower priority are restored first from the randomization log
+    virtual int32 GetRandomizationLogPriority() const;
+    /// The key of this component in the randomization log, it must be the same in the run which replay the log
+    FString GetRandomizationLogKey() const;
+
+    /// The random stream this component draw its values from, it's named after the component's randomization log key the first time it's used
+    /// so each component get the same values in every run with the same seed, no matter how many values the other components draw
+    FNVRandomStream& GetRandomStream();
+
 protected: // Editor properties
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Randomization)
     bool bShouldRandomize;
@@ -59,11 +81,15 @@ protected: // Editor properties
     bool bOnlyRandomizeOnce;
 
 protected: // Transient properties
-    UPROPERTY(Transient)
-    float CountdownUntilNextRandomization;
+    FNVRandomStream RandomStream;
     UPROPERTY(Transient)
     bool bAlreadyRandomized;
 
 private:
+    friend class FRandomizationScheduler;
+
     void UpdateRandomization();
+    /// Register this component to the world's randomization log and scheduler, or unregister it
+    void RegisterRandomization();
+    void UnregisterRandomization();
 };
@@ -22,6 +22,15 @@ void URandomDataObject::OnRandomization()
     // TODO
 }
 
+FNVRandomStream& URandomDataObject::GetRandomStream()
+{
+    if (!RandomStream.IsInitialized())
+    {
+        RandomStream.Initialize(GetPathName());
+    }
+    return RandomStream;
+}
+
 URandomMovementDataObject::URandomMovementDataObject() : Super()
 {
     bRelatedToOriginLocation = true;
@@ -43,7 +52,7 @@ void URandomMovementDataObject::OnRandomization()
         if (bUseObjectAxesInsteadOfWorldAxes)
         {
             FTransform OriginalTransform = FTransform::Identity;
-            TargetLocation = RandomLocationData.GetRandomLocationInLocalSpace(OriginalTransform);
+            TargetLocation = RandomLocationData.GetRandomLocationInLocalSpace(GetRandomStream(), OriginalTransform);
         }
         // FIXME
         //if (bUseObjectAxesInsteadOfWorldAxes)
@@ -57,7 +66,7 @@ void URandomMovementDataObject::OnRandomization()
     }
     else
     {
-        TargetLocation = FMath::RandPointInBox(RandomLocationVolume->GetComponentsBoundingBox());
+        TargetLocation = GetRandomStream().PointInBox(RandomLocationVolume->GetComponentsBoundingBox());
     }
 
     if (bShouldTeleport)
@@ -80,6 +89,6 @@ void URandomRotationDataObject::OnRandomization()
         return;
     }
     FRotator OriginalRotation = FRotator::ZeroRotator;
-    FRotator RandomRotation = bRelatedToOriginRotation ? RandomRotationData.GetRandomRotationRelative(OriginalRotation) : RandomRotationData.GetRandomRotation();
+    FRotator RandomRotation = bRelatedToOriginRotation ? RandomRotationData.GetRandomRotationRelative(GetRandomStream(), OriginalRotation) : RandomRotationData.GetRandomRotation(GetRandomStream());
     OwnerActor->SetActorRotation(RandomRotation);
 }
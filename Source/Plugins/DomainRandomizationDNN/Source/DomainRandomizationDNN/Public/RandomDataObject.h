@@ -21,9 +21,15 @@ public:
     bool ShouldRandomize() const;
     virtual void OnRandomization();
 
+protected:
+    /// The random stream this object draw its values from, it's named after the object's path the first time it's used
+    FNVRandomStream& GetRandomStream();
+
 protected:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Randomization)
     bool bShouldRandomize;
+
+    FNVRandomStream RandomStream;
 };
 
 UCLASS(Blueprintable, DefaultToInstanced, editinlinenew, ClassGroup = (NVIDIA))
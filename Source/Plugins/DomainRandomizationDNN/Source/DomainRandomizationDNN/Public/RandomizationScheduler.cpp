@@ -0,0 +1,685 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "DomainRandomizationDNNPCH.h"
+#include "RandomizationScheduler.h"
+#include "NVSceneCapturerUtils.h"
+#include "RandomComponentBase.h"
+#include "NVCaptureClock.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    TMap<TWeakObjectPtr<const UWorld>, TSharedPtr<FRandomizationScheduler>> WorldSchedulers;
+
+    FAutoConsoleCommand TestRandomizationSchedulerCommand(
+        TEXT("NV.TestRandomizationScheduler"),
+        TEXT("Check the randomization scheduler's deadlines expire in order and on the expected captured frames"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FRandomizationScheduler::RunSelfTest();
+        }));
+
+    FAutoConsoleCommand RandomizationSchedulerStatsCommand(
+        TEXT("NV.RandomizationSchedulerStats"),
+        TEXT("Print the number of scheduled random components and of randomized batches of each world"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            for (const auto& SchedulerPair : WorldSchedulers)
+            {
+                const UWorld* SchedulerWorld = SchedulerPair.Key.Get();
+                if (SchedulerWorld)
+                {
+                    UE_LOG(LogNVDRUtils, Log, TEXT("World '%s':"), *SchedulerWorld->GetName());
+                    SchedulerPair.Value->LogStats();
+                }
+            }
+        }));
+
+    struct FDeadlineFramePredicate
+    {
+        template<typename DeadlineType>
+        bool operator()(const DeadlineType& A, const DeadlineType& B) const
+        {
+            return (A.ExpireFrame < B.ExpireFrame) || ((A.ExpireFrame == B.ExpireFrame) && (A.ScheduleSequence < B.ScheduleSequence));
+        }
+    };
+
+    struct FDeadlineSecondsPredicate
+    {
+        template<typename DeadlineType>
+        bool operator()(const DeadlineType& A, const DeadlineType& B) const
+        {
+            return (A.ExpireSeconds < B.ExpireSeconds) || ((A.ExpireSeconds == B.ExpireSeconds) && (A.ScheduleSequence < B.ScheduleSequence));
+        }
+    };
+}
+
+//=================================== FRandomizationSchedulerTickFunction ===================================
+FRandomizationSchedulerTickFunction::FRandomizationSchedulerTickFunction()
+{
+    TickGroup = TG_PrePhysics;
+    bCanEverTick = true;
+    bTickEvenWhenPaused = false;
+    Scheduler = nullptr;
+}
+
+void FRandomizationSchedulerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+    if (Scheduler && (TickType != LEVELTICK_ViewportsOnly))
+    {
+        Scheduler->Tick(DeltaTime);
+    }
+}
+
+FString FRandomizationSchedulerTickFunction::DiagnosticMessage()
+{
+    return TEXT("FRandomizationScheduler::Tick");
+}
+
+//=================================== FRandomizationTimeline ===================================
+FRandomizationTimeline::FRandomizationTimeline()
+{
+    Entries.Reset();
+    FreeEntryIndexes.Reset();
+    FrameDeadlines.Reset();
+    SecondsDeadlines.Reset();
+
+    ElapsedSeconds = 0.0;
+    NextScheduleSequence = 0;
+    ScheduledCount = 0;
+    LastCheckedCapturedFrame = INDEX_NONE;
+}
+
+int32 FRandomizationTimeline::AddEntry()
+{
+    int32 EntryIndex = INDEX_NONE;
+    if (FreeEntryIndexes.Num() > 0)
+    {
+        // NOTE: Keep counting the generations of a reused entry so the deadlines of its previous user stay stale
+        EntryIndex = FreeEntryIndexes.Pop(false);
+        Entries[EntryIndex].Generation++;
+    }
+    else
+    {
+        EntryIndex = Entries.AddZeroed();
+    }
+
+    FEntry& NewEntry = Entries[EntryIndex];
+    NewEntry.bInUse = true;
+    NewEntry.bScheduled = false;
+    NewEntry.ScheduleSequence = 0;
+    NewEntry.ScheduledCapturedFrame = 0;
+    return EntryIndex;
+}
+
+void FRandomizationTimeline::RemoveEntry(int32 EntryIndex)
+{
+    if (!Entries.IsValidIndex(EntryIndex) || !Entries[EntryIndex].bInUse)
+    {
+        return;
+    }
+
+    Unschedule(EntryIndex);
+    Entries[EntryIndex].bInUse = false;
+    FreeEntryIndexes.Add(EntryIndex);
+}
+
+void FRandomizationTimeline::Schedule(int32 EntryIndex, float DurationSeconds, const FNVCaptureClock* WorldClock)
+{
+    if (!Entries.IsValidIndex(EntryIndex) || !Entries[EntryIndex].bInUse)
+    {
+        return;
+    }
+
+    FEntry& ScheduledEntry = Entries[EntryIndex];
+    if (!ScheduledEntry.bScheduled)
+    {
+        ScheduledCount++;
+    }
+    ScheduledEntry.bScheduled = true;
+    ScheduledEntry.Generation++;
+    ScheduledEntry.ScheduleSequence = NextScheduleSequence++;
+    ScheduledEntry.ScheduledCapturedFrame = WorldClock ? WorldClock->GetCapturedFrameCount() : 0;
+    if (ScheduledEntry.ScheduledCapturedFrame < LastCheckedCapturedFrame)
+    {
+        // The entry is already due for the frames captured before
+        LastCheckedCapturedFrame = INDEX_NONE;
+    }
+
+    FDeadline NewDeadline;
+    NewDeadline.EntryIndex = EntryIndex;
+    NewDeadline.Generation = ScheduledEntry.Generation;
+    NewDeadline.ScheduleSequence = ScheduledEntry.ScheduleSequence;
+    if (WorldClock && WorldClock->IsRunning())
+    {
+        NewDeadline.ExpireFrame = WorldClock->GetFrameCount() + WorldClock->SecondsToFrameCount(DurationSeconds);
+        NewDeadline.ExpireSeconds = 0.0;
+        FrameDeadlines.HeapPush(NewDeadline, FDeadlineFramePredicate());
+    }
+    else
+    {
+        NewDeadline.ExpireFrame = INDEX_NONE;
+        NewDeadline.ExpireSeconds = ElapsedSeconds + FMath::Max(DurationSeconds, 0.f);
+        SecondsDeadlines.HeapPush(NewDeadline, FDeadlineSecondsPredicate());
+    }
+}
+
+void FRandomizationTimeline::Unschedule(int32 EntryIndex)
+{
+    if (!Entries.IsValidIndex(EntryIndex) || !Entries[EntryIndex].bScheduled)
+    {
+        return;
+    }
+
+    FEntry& ScheduledEntry = Entries[EntryIndex];
+    ScheduledEntry.bScheduled = false;
+    ScheduledEntry.Generation++;
+    ScheduledCount--;
+
+    if (ScheduledCount == 0)
+    {
+        // All the deadlines left are stale
+        FrameDeadlines.Reset();
+        SecondsDeadlines.Reset();
+    }
+}
+
+bool FRandomizationTimeline::IsScheduled(int32 EntryIndex) const
+{
+    return Entries.IsValidIndex(EntryIndex) && Entries[EntryIndex].bScheduled;
+}
+
+bool FRandomizationTimeline::IsDeadlineValid(const FDeadline& CheckDeadline) const
+{
+    const FEntry& CheckEntry = Entries[CheckDeadline.EntryIndex];
+    return CheckEntry.bScheduled && (CheckEntry.Generation == CheckDeadline.Generation);
+}
+
+void FRandomizationTimeline::SwitchClock(const FNVCaptureClock* WorldClock, bool bClockRunning)
+{
+    TArray<FDeadline>& OldDeadlines = bClockRunning ? SecondsDeadlines : FrameDeadlines;
+    if (OldDeadlines.Num() == 0)
+    {
+        return;
+    }
+
+    for (FDeadline& MovedDeadline : OldDeadlines)
+    {
+        if (!IsDeadlineValid(MovedDeadline))
+        {
+            continue;
+        }
+
+        if (bClockRunning)
+        {
+            const double RemainingSeconds = FMath::Max(MovedDeadline.ExpireSeconds - ElapsedSeconds, 0.0);
+            MovedDeadline.ExpireFrame = WorldClock->GetFrameCount() + WorldClock->SecondsToFrameCount((float)RemainingSeconds);
+            FrameDeadlines.HeapPush(MovedDeadline, FDeadlineFramePredicate());
+        }
+        else
+        {
+            const int32 RemainingFrameCount = WorldClock ? FMath::Max(MovedDeadline.ExpireFrame - WorldClock->GetFrameCount(), 0) : 0;
+            const float ClockStepSeconds = WorldClock ? WorldClock->GetFixedStepSeconds() : 0.f;
+            MovedDeadline.ExpireFrame = INDEX_NONE;
+            MovedDeadline.ExpireSeconds = ElapsedSeconds + RemainingFrameCount * ClockStepSeconds;
+            SecondsDeadlines.HeapPush(MovedDeadline, FDeadlineSecondsPredicate());
+        }
+    }
+    OldDeadlines.Reset();
+}
+
+void FRandomizationTimeline::PopEntry(int32 EntryIndex, TArray<int32>& OutDueEntries)
+{
+    OutDueEntries.Add(EntryIndex);
+    Unschedule(EntryIndex);
+}
+
+void FRandomizationTimeline::PopDueEntries(const FNVCaptureClock* WorldClock, float DeltaTime, bool bOncePerCapturedFrame, TArray<int32>& OutDueEntries)
+{
+    OutDueEntries.Reset();
+
+    const bool bClockRunning = WorldClock && WorldClock->IsRunning();
+    SwitchClock(WorldClock, bClockRunning);
+    if (!bClockRunning)
+    {
+        ElapsedSeconds += DeltaTime;
+    }
+
+    if (!bOncePerCapturedFrame)
+    {
+        LastCheckedCapturedFrame = INDEX_NONE;
+    }
+
+    if (ScheduledCount == 0)
+    {
+        return;
+    }
+
+    if (bOncePerCapturedFrame)
+    {
+        // Only scan the entries once per captured frame instead of every tick
+        const int32 CapturedFrameCount = WorldClock ? WorldClock->GetCapturedFrameCount() : 0;
+        if (CapturedFrameCount == LastCheckedCapturedFrame)
+        {
+            return;
+        }
+        LastCheckedCapturedFrame = CapturedFrameCount;
+
+        for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++)
+        {
+            const FEntry& CheckEntry = Entries[EntryIndex];
+            if (CheckEntry.bScheduled && (CheckEntry.ScheduledCapturedFrame < CapturedFrameCount))
+            {
+                PopEntry(EntryIndex, OutDueEntries);
+            }
+        }
+    }
+    else if (bClockRunning)
+    {
+        const int32 CurrentFrame = WorldClock->GetFrameCount();
+        while ((FrameDeadlines.Num() > 0) && (FrameDeadlines.HeapTop().ExpireFrame <= CurrentFrame))
+        {
+            FDeadline DueDeadline;
+            FrameDeadlines.HeapPop(DueDeadline, FDeadlineFramePredicate(), false);
+            if (IsDeadlineValid(DueDeadline))
+            {
+                PopEntry(DueDeadline.EntryIndex, OutDueEntries);
+            }
+        }
+    }
+    else
+    {
+        while ((SecondsDeadlines.Num() > 0) && (SecondsDeadlines.HeapTop().ExpireSeconds <= ElapsedSeconds))
+        {
+            FDeadline DueDeadline;
+            SecondsDeadlines.HeapPop(DueDeadline, FDeadlineSecondsPredicate(), false);
+            if (IsDeadlineValid(DueDeadline))
+            {
+                PopEntry(DueDeadline.EntryIndex, OutDueEntries);
+            }
+        }
+    }
+
+    // NOTE: The entries are popped in their deadlines' order, the ones due together are handled in the order they were scheduled
+    OutDueEntries.Sort([this](int32 A, int32 B)
+    {
+        return Entries[A].ScheduleSequence < Entries[B].ScheduleSequence;
+    });
+}
+
+//=================================== FRandomizationScheduler ===================================
+FRandomizationScheduler::FRandomizationScheduler()
+{
+    TickFunction.Scheduler = this;
+
+    ComponentEntryIndexes.Reset();
+    EntryComponents.Reset();
+    ClassGroupIndexes.Reset();
+    NextRegistrationIndex = 0;
+
+    bRandomizeOncePerCapturedFrame = false;
+
+    RandomizedCount = 0;
+    BatchCount = 0;
+    TickCount = 0;
+}
+
+FRandomizationScheduler::~FRandomizationScheduler()
+{
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        TickFunction.UnRegisterTickFunction();
+    }
+    TickFunction.Scheduler = nullptr;
+}
+
+FRandomizationScheduler* FRandomizationScheduler::Get(UWorld* World)
+{
+    ensure(World);
+    if (!World)
+    {
+        UE_LOG(LogNVDRUtils, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    // NOTE: The schedulers are only accessed on the game thread
+    check(IsInGameThread());
+
+    const TSharedPtr<FRandomizationScheduler>* ExistingSchedulerPtr = WorldSchedulers.Find(World);
+    if (ExistingSchedulerPtr)
+    {
+        return ExistingSchedulerPtr->Get();
+    }
+
+    // Drop the schedulers of the worlds which are already destroyed
+    for (auto It = WorldSchedulers.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    TSharedPtr<FRandomizationScheduler> NewScheduler = MakeShareable(new FRandomizationScheduler());
+    NewScheduler->OwnerWorld = World;
+    WorldSchedulers.Add(World, NewScheduler);
+    return NewScheduler.Get();
+}
+
+FRandomizationScheduler* FRandomizationScheduler::Find(const UWorld* World)
+{
+    const TSharedPtr<FRandomizationScheduler>* ExistingSchedulerPtr = World ? WorldSchedulers.Find(World) : nullptr;
+    return ExistingSchedulerPtr ? ExistingSchedulerPtr->Get() : nullptr;
+}
+
+void FRandomizationScheduler::RegisterComponent(URandomComponentBase* Component)
+{
+    if (!Component || ComponentEntryIndexes.Contains(Component))
+    {
+        return;
+    }
+
+    const int32 EntryIndex = Timeline.AddEntry();
+    if (EntryIndex >= EntryComponents.Num())
+    {
+        EntryComponents.SetNum(EntryIndex + 1);
+    }
+    ComponentEntryIndexes.Add(Component, EntryIndex);
+
+    const UClass* ComponentClass = Component->GetClass();
+    const int32* ClassGroupIndexPtr = ClassGroupIndexes.Find(ComponentClass);
+    const int32 ClassGroupIndex = ClassGroupIndexPtr ? *ClassGroupIndexPtr : ClassGroupIndexes.Add(ComponentClass, ClassGroupIndexes.Num());
+
+    FScheduledComponent& NewScheduledComponent = EntryComponents[EntryIndex];
+    NewScheduledComponent.Component = Component;
+    NewScheduledComponent.Priority = Component->GetRandomizationLogPriority();
+    NewScheduledComponent.ClassGroupIndex = ClassGroupIndex;
+    NewScheduledComponent.RegistrationIndex = NextRegistrationIndex++;
+
+    UpdateTickFunction();
+}
+
+void FRandomizationScheduler::UnregisterComponent(URandomComponentBase* Component)
+{
+    int32 EntryIndex = INDEX_NONE;
+    if (!ComponentEntryIndexes.RemoveAndCopyValue(Component, EntryIndex))
+    {
+        return;
+    }
+
+    Timeline.RemoveEntry(EntryIndex);
+    EntryComponents[EntryIndex].Component.Reset();
+
+    UpdateTickFunction();
+}
+
+void FRandomizationScheduler::Schedule(URandomComponentBase* Component, float DurationSeconds)
+{
+    const int32* EntryIndexPtr = ComponentEntryIndexes.Find(Component);
+    if (EntryIndexPtr)
+    {
+        Timeline.Schedule(*EntryIndexPtr, DurationSeconds, FNVCaptureClock::Find(OwnerWorld.Get()));
+        UpdateTickFunction();
+    }
+}
+
+void FRandomizationScheduler::Unschedule(URandomComponentBase* Component)
+{
+    const int32* EntryIndexPtr = ComponentEntryIndexes.Find(Component);
+    if (EntryIndexPtr)
+    {
+        Timeline.Unschedule(*EntryIndexPtr);
+    }
+}
+
+void FRandomizationScheduler::SetRandomizeOncePerCapturedFrame(bool bInRandomizeOncePerCapturedFrame)
+{
+    bRandomizeOncePerCapturedFrame = bInRandomizeOncePerCapturedFrame;
+}
+
+void FRandomizationScheduler::LogStats() const
+{
+    UE_LOG(LogNVDRUtils, Log, TEXT("FRandomizationScheduler - Components: %d registered, %d scheduled - Randomized: %lld components in %lld batches over %lld ticks - Once per captured frame: %s"),
+           ComponentEntryIndexes.Num(), Timeline.GetScheduledCount(), RandomizedCount, BatchCount, TickCount,
+           bRandomizeOncePerCapturedFrame ? TEXT("true") : TEXT("false"));
+}
+
+void FRandomizationScheduler::UpdateTickFunction()
+{
+    UWorld* World = OwnerWorld.Get();
+    const bool bHasComponents = (ComponentEntryIndexes.Num() > 0);
+    if (bHasComponents && !TickFunction.IsTickFunctionRegistered() && World && World->PersistentLevel)
+    {
+        TickFunction.RegisterTickFunction(World->PersistentLevel);
+    }
+    else if (!bHasComponents && TickFunction.IsTickFunctionRegistered())
+    {
+        // NOTE: All the components are unregistered when their world end play, the tick function must not outlive the world's level
+        TickFunction.UnRegisterTickFunction();
+    }
+
+    // The scheduler only tick while some randomizations are scheduled
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        const bool bShouldTick = (Timeline.GetScheduledCount() > 0);
+        if (TickFunction.IsTickFunctionEnabled() != bShouldTick)
+        {
+            TickFunction.SetTickFunctionEnable(bShouldTick);
+        }
+    }
+}
+
+void FRandomizationScheduler::Tick(float DeltaTime)
+{
+    TickCount++;
+
+    TArray<int32> DueEntries;
+    Timeline.PopDueEntries(FNVCaptureClock::Find(OwnerWorld.Get()), DeltaTime, bRandomizeOncePerCapturedFrame, DueEntries);
+
+    // Group the due components by priority then by class, the components of a group are randomized in the order they were registered
+    DueEntries.Sort([this](int32 A, int32 B)
+    {
+        const FScheduledComponent& ComponentA = EntryComponents[A];
+        const FScheduledComponent& ComponentB = EntryComponents[B];
+        if (ComponentA.Priority != ComponentB.Priority)
+        {
+            return ComponentA.Priority < ComponentB.Priority;
+        }
+        if (ComponentA.ClassGroupIndex != ComponentB.ClassGroupIndex)
+        {
+            return ComponentA.ClassGroupIndex < ComponentB.ClassGroupIndex;
+        }
+        return ComponentA.RegistrationIndex < ComponentB.RegistrationIndex;
+    });
+
+    // NOTE: A randomization may unregister other components (e.g: destroying their actors) and their entries may be reused, keep the components themselves
+    TArray<TWeakObjectPtr<URandomComponentBase>> DueComponents;
+    DueComponents.Reserve(DueEntries.Num());
+    for (const int32 EntryIndex : DueEntries)
+    {
+        DueComponents.Add(EntryComponents[EntryIndex].Component);
+    }
+
+    const FNVCaptureClock* WorldClock = FNVCaptureClock::Find(OwnerWorld.Get());
+    const UClass* BatchClass = nullptr;
+    for (const TWeakObjectPtr<URandomComponentBase>& DueComponentPtr : DueComponents)
+    {
+        URandomComponentBase* DueComponent = DueComponentPtr.Get();
+        const int32* EntryIndexPtr = DueComponent ? ComponentEntryIndexes.Find(DueComponent) : nullptr;
+        if (!EntryIndexPtr)
+        {
+            continue;
+        }
+
+        if (!DueComponent->IsActive())
+        {
+            // The deactivated components wait until they are activated again, like their tick used to
+            Timeline.Schedule(*EntryIndexPtr, 0.f, WorldClock);
+            continue;
+        }
+
+        if (DueComponent->GetClass() != BatchClass)
+        {
+            BatchClass = DueComponent->GetClass();
+            BatchCount++;
+        }
+        DueComponent->UpdateRandomization();
+        RandomizedCount++;
+    }
+
+    UpdateTickFunction();
+}
+
+bool FRandomizationScheduler::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Randomization scheduler"), LogNVDRUtils);
+
+    TArray<int32> DueEntries;
+
+    // The deadlines on the delta time expire in order, no matter the order they were scheduled in
+    {
+        FRandomizationTimeline TestTimeline;
+        const int32 EntryA = TestTimeline.AddEntry();
+        const int32 EntryB = TestTimeline.AddEntry();
+        const int32 EntryC = TestTimeline.AddEntry();
+        TestTimeline.Schedule(EntryA, 0.3f, nullptr);
+        TestTimeline.Schedule(EntryB, 0.1f, nullptr);
+        TestTimeline.Schedule(EntryC, 0.2f, nullptr);
+
+        TestTimeline.PopDueEntries(nullptr, 0.15f, false, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryB }), TEXT("the first deadline didn't expire first"));
+        TestTimeline.PopDueEntries(nullptr, 0.1f, false, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryC }), TEXT("the second deadline didn't expire second"));
+        TestTimeline.PopDueEntries(nullptr, 0.1f, false, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryA }), TEXT("the last deadline didn't expire last"));
+        TestResult.Check(TestTimeline.GetScheduledCount() == 0, TEXT("the expired entries are still scheduled"));
+
+        // Rescheduling replace the deadline and the unscheduled entries never expire
+        TestTimeline.Schedule(EntryA, 0.1f, nullptr);
+        TestTimeline.Schedule(EntryA, 0.5f, nullptr);
+        TestTimeline.Schedule(EntryB, 0.1f, nullptr);
+        TestTimeline.Unschedule(EntryB);
+        TestTimeline.PopDueEntries(nullptr, 0.2f, false, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("a replaced or unscheduled deadline expired"));
+        TestTimeline.PopDueEntries(nullptr, 0.3f, false, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryA }), TEXT("the replacing deadline didn't expire"));
+
+        // A removed entry's deadline doesn't expire for the entry reusing its index
+        TestTimeline.Schedule(EntryC, 0.1f, nullptr);
+        TestTimeline.RemoveEntry(EntryC);
+        const int32 EntryD = TestTimeline.AddEntry();
+        TestResult.Check(EntryD == EntryC, TEXT("the removed entry wasn't reused"));
+        TestTimeline.PopDueEntries(nullptr, 1.f, false, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("a removed entry's deadline expired"));
+    }
+
+    // The deadlines on the capture clock expire on the expected frames, no matter how many ticks happen in between
+    {
+        FRandomizationTimeline TestTimeline;
+        FNVCaptureClock TestClock;
+        TestClock.Start(0.1f);
+        const int32 EntryA = TestTimeline.AddEntry();
+        TestTimeline.Schedule(EntryA, 0.3f, &TestClock);
+
+        int32 ExpiredFrame = INDEX_NONE;
+        for (int32 i = 0; (i < 10) && (ExpiredFrame == INDEX_NONE); i++)
+        {
+            TestTimeline.PopDueEntries(&TestClock, 1.f, false, DueEntries);
+            TestResult.Check(DueEntries.Num() == 0, TEXT("deadline expired without a captured frame"));
+
+            TestClock.AdvanceFrame();
+            TestTimeline.PopDueEntries(&TestClock, 0.f, false, DueEntries);
+            if (DueEntries.Num() > 0)
+            {
+                ExpiredFrame = TestClock.GetFrameCount();
+            }
+        }
+        TestResult.Check(ExpiredFrame == 3, TEXT("deadline didn't expire on the expected frame"));
+
+        // A deadline on the delta time move to the clock when it start running
+        FNVCaptureClock TestClock2;
+        TestTimeline.Schedule(EntryA, 0.2f, &TestClock2);
+        TestClock2.Start(0.1f);
+        TestTimeline.PopDueEntries(&TestClock2, 1.f, false, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("deadline didn't move to the capture clock"));
+        TestClock2.AdvanceFrame();
+        TestClock2.AdvanceFrame();
+        TestTimeline.PopDueEntries(&TestClock2, 0.f, false, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryA }), TEXT("deadline moved to the capture clock didn't expire"));
+
+        // And back to the delta time when the clock stop
+        TestTimeline.Schedule(EntryA, 0.2f, &TestClock2);
+        TestClock2.AdvanceFrame();
+        TestClock2.Stop();
+        TestTimeline.PopDueEntries(&TestClock2, 0.05f, false, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("deadline expired before the remaining step"));
+        TestTimeline.PopDueEntries(&TestClock2, 0.05f, false, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryA }), TEXT("deadline moved to the delta time didn't expire"));
+    }
+
+    // All the scheduled entries are due once per captured frame, in the order they were scheduled
+    {
+        FRandomizationTimeline TestTimeline;
+        FNVCaptureClock TestClock;
+        const int32 EntryA = TestTimeline.AddEntry();
+        const int32 EntryB = TestTimeline.AddEntry();
+        TestTimeline.Schedule(EntryB, 20.f, &TestClock);
+        TestTimeline.Schedule(EntryA, 10.f, &TestClock);
+
+        TestTimeline.PopDueEntries(&TestClock, 100.f, true, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("entries due before a frame was captured"));
+        TestClock.AdvanceFrame();
+        TestTimeline.PopDueEntries(&TestClock, 0.f, true, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryB, EntryA }), TEXT("the scheduled entries weren't all due after a captured frame"));
+
+        TestTimeline.Schedule(EntryA, 0.f, &TestClock);
+        TestTimeline.PopDueEntries(&TestClock, 1.f, true, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("an entry was due twice for the same captured frame"));
+        TestClock.AdvanceFrame();
+        TestTimeline.PopDueEntries(&TestClock, 0.f, true, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryA }), TEXT("the rescheduled entry wasn't due after the next captured frame"));
+
+        // An entry scheduled without the clock count as scheduled before any captured frame, it's due even if the frame was already checked
+        TestTimeline.Schedule(EntryB, 0.f, &TestClock);
+        TestTimeline.PopDueEntries(&TestClock, 0.f, true, DueEntries);
+        TestResult.Check(DueEntries.Num() == 0, TEXT("an entry was due before the next captured frame"));
+        TestTimeline.Schedule(EntryA, 0.f, nullptr);
+        TestTimeline.PopDueEntries(&TestClock, 0.f, true, DueEntries);
+        TestResult.Check(DueEntries == TArray<int32>({ EntryA }), TEXT("an entry scheduled for an older captured frame wasn't due"));
+    }
+
+    // With thousands of scheduled components, each captured frame only hand out the ones which are due, in the order they were scheduled
+    {
+        FRandomizationTimeline TestTimeline;
+        FNVCaptureClock TestClock;
+        TestClock.Start(0.1f);
+        const int32 TestEntryCount = 5000;
+        const int32 TestFrameCount = 10;
+        for (int32 i = 0; i < TestEntryCount; i++)
+        {
+            const int32 EntryIndex = TestTimeline.AddEntry();
+            TestTimeline.Schedule(EntryIndex, 0.1f * (1 + (EntryIndex % TestFrameCount)), &TestClock);
+        }
+
+        bool bOnlyDueEntries = true;
+        for (int32 FrameIndex = 1; FrameIndex <= TestFrameCount; FrameIndex++)
+        {
+            TestClock.AdvanceFrame();
+            TestTimeline.PopDueEntries(&TestClock, 0.f, false, DueEntries);
+            bOnlyDueEntries &= (DueEntries.Num() == TestEntryCount / TestFrameCount);
+            for (int32 i = 0; i < DueEntries.Num(); i++)
+            {
+                bOnlyDueEntries &= ((DueEntries[i] % TestFrameCount) == (FrameIndex - 1)) && ((i == 0) || (DueEntries[i - 1] < DueEntries[i]));
+            }
+        }
+        TestResult.Check(bOnlyDueEntries, TEXT("a captured frame didn't hand out exactly its due entries"));
+        TestResult.Check(TestTimeline.GetScheduledCount() == 0, TEXT("some entries were never due"));
+    }
+
+    return TestResult.Finish();
+}
@@ -0,0 +1,180 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "RandomizationScheduler.generated.h"
+
+class UWorld;
+class URandomComponentBase;
+class FNVCaptureClock;
+class FRandomizationScheduler;
+
+// The world's tick of the randomization scheduler, it tick in the same group as the random components used to
+USTRUCT()
+struct DOMAINRANDOMIZATIONDNN_API FRandomizationSchedulerTickFunction : public FTickFunction
+{
+    GENERATED_BODY()
+
+public:
+    FRandomizationSchedulerTickFunction();
+
+    virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+    virtual FString DiagnosticMessage() override;
+
+    FRandomizationScheduler* Scheduler;
+};
+
+template<>
+struct TStructOpsTypeTraits<FRandomizationSchedulerTickFunction> : public TStructOpsTypeTraitsBase2<FRandomizationSchedulerTickFunction>
+{
+    enum
+    {
+        WithCopy = false
+    };
+};
+
+// FRandomizationTimeline keep the deadlines of the scheduled randomizations in min-heaps
+// The deadlines run on the world's capture clock while it's running or on the world's delta time otherwise, like FNVCaptureClockCountdown
+// NOTE: An entry's deadline is replaced when it's scheduled again, the old deadline is only dropped when it reach the top of its heap
+class DOMAINRANDOMIZATIONDNN_API FRandomizationTimeline
+{
+public:
+    FRandomizationTimeline();
+
+    // Add an entry which can be scheduled, return its index
+    int32 AddEntry();
+    void RemoveEntry(int32 EntryIndex);
+
+    // Schedule an entry after a duration (in seconds), its previous deadline is replaced
+    // @param WorldClock    The world's capture clock, it may be stopped or nullptr
+    void Schedule(int32 EntryIndex, float DurationSeconds, const FNVCaptureClock* WorldClock);
+    void Unschedule(int32 EntryIndex);
+    bool IsScheduled(int32 EntryIndex) const;
+    int32 GetScheduledCount() const
+    {
+        return ScheduledCount;
+    }
+
+    // Advance the timeline and unschedule the entries which are due, they are sorted in the order they were scheduled
+    // @param DeltaTime             The world's delta time, only used when the capture clock is not running
+    // @param bOncePerCapturedFrame If true, all the scheduled entries are due once a frame was captured since they were scheduled, no matter their duration
+    void PopDueEntries(const FNVCaptureClock* WorldClock, float DeltaTime, bool bOncePerCapturedFrame, TArray<int32>& OutDueEntries);
+
+protected:
+    struct FEntry
+    {
+        bool bInUse;
+        bool bScheduled;
+        // Incremented each time the entry is scheduled or unscheduled, the deadlines of the older generations are stale
+        int32 Generation;
+        uint64 ScheduleSequence;
+        // The capture clock's captured frame count when the entry was scheduled
+        int32 ScheduledCapturedFrame;
+    };
+
+    struct FDeadline
+    {
+        int32 EntryIndex;
+        int32 Generation;
+        // The capture clock's frame when the deadline expire, or the elapsed time (in seconds) when the clock isn't running
+        int32 ExpireFrame;
+        double ExpireSeconds;
+        uint64 ScheduleSequence;
+    };
+
+    bool IsDeadlineValid(const FDeadline& CheckDeadline) const;
+    // Move the deadlines to the capture clock when it start running and back to the delta time when it stop
+    void SwitchClock(const FNVCaptureClock* WorldClock, bool bClockRunning);
+    void PopEntry(int32 EntryIndex, TArray<int32>& OutDueEntries);
+
+protected:
+    TArray<FEntry> Entries;
+    TArray<int32> FreeEntryIndexes;
+
+    TArray<FDeadline> FrameDeadlines;
+    TArray<FDeadline> SecondsDeadlines;
+
+    // The world's time (in seconds) accumulated while the capture clock isn't running
+    double ElapsedSeconds;
+    uint64 NextScheduleSequence;
+    int32 ScheduledCount;
+    // The captured frame count the entries were last checked against once per captured frame, INDEX_NONE if they must be checked again
+    // NOTE: No entry can be due again until a new frame is captured
+    int32 LastCheckedCapturedFrame;
+};
+
+// FRandomizationScheduler randomize the random components of a world when their randomization duration expire
+// The components don't tick to count down their durations, the scheduler's single tick only handle the randomizations which are due
+// The due components are randomized in batches of the same class, ordered by their randomization log priority so
+// e.g: the meshes are randomized before the materials applied on them
+class DOMAINRANDOMIZATIONDNN_API FRandomizationScheduler
+{
+public:
+    FRandomizationScheduler();
+    ~FRandomizationScheduler();
+
+    // Get the scheduler of a world, it's created the first time it's requested
+    static FRandomizationScheduler* Get(UWorld* World);
+    // Get the scheduler of a world only if it was already created
+    static FRandomizationScheduler* Find(const UWorld* World);
+
+    void RegisterComponent(URandomComponentBase* Component);
+    void UnregisterComponent(URandomComponentBase* Component);
+
+    // Randomize a registered component again after a duration (in seconds), its previous deadline is replaced
+    // NOTE: While the capturer's fixed step capture clock is running, the duration is counted in captured frames
+    void Schedule(URandomComponentBase* Component, float DurationSeconds);
+    void Unschedule(URandomComponentBase* Component);
+
+    // If true, the scheduled components are randomized exactly once after each captured frame, no matter their randomization duration
+    // NOTE: Nothing is randomized again until the capturer capture its first frame
+    void SetRandomizeOncePerCapturedFrame(bool bInRandomizeOncePerCapturedFrame);
+    bool IsRandomizingOncePerCapturedFrame() const
+    {
+        return bRandomizeOncePerCapturedFrame;
+    }
+
+    // Print the number of scheduled components and of randomized batches
+    void LogStats() const;
+
+    // Check the deadlines expire in order and on the expected frames, and only the due ones are handed out, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    friend struct FRandomizationSchedulerTickFunction;
+
+    void Tick(float DeltaTime);
+    void UpdateTickFunction();
+
+    struct FScheduledComponent
+    {
+        TWeakObjectPtr<URandomComponentBase> Component;
+        int32 Priority;
+        int32 ClassGroupIndex;
+        int32 RegistrationIndex;
+    };
+
+protected:
+    TWeakObjectPtr<UWorld> OwnerWorld;
+    FRandomizationSchedulerTickFunction TickFunction;
+    FRandomizationTimeline Timeline;
+
+    TMap<const URandomComponentBase*, int32> ComponentEntryIndexes;
+    // The registered components, indexed by their timeline entry
+    TArray<FScheduledComponent> EntryComponents;
+    // The index of each class in the order they were first registered, the due components are grouped by class
+    TMap<const UClass*, int32> ClassGroupIndexes;
+    int32 NextRegistrationIndex;
+
+    bool bRandomizeOncePerCapturedFrame;
+
+    int64 RandomizedCount;
+    int64 BatchCount;
+    int64 TickCount;
+};
@@ -20,12 +20,13 @@ void ARandomizedActorManager::BeginPlay()
     Super::BeginPlay();
 
     UWorld* World = GetWorld();
+    FNVRandomStream RandomStream(GetName());
 
     FBox LocationBox = RandomLocationVolume ? RandomLocationVolume->GetComponentsBoundingBox() : FBox(ForceInitToZero);
     for (int i = 0; i < NumberOfActorsToSpawn; i++)
     {
-        TSubclassOf<AActor> ActorClass = ActorClassesToSpawn[FMath::Rand() % ActorClassesToSpawn.Num()];
-        FVector SpawnLocation = FMath::RandPointInBox(LocationBox);
+        TSubclassOf<AActor> ActorClass = ActorClassesToSpawn[RandomStream.RandHelper(ActorClassesToSpawn.Num())];
+        FVector SpawnLocation = RandomStream.PointInBox(LocationBox);
         // TODO: May need to pick random rotation for the actor too
         FRotator SpawnRotation = FRotator::ZeroRotator;
         FVector SpawnScale3D = FVector(1.f, 1.f, 1.f);
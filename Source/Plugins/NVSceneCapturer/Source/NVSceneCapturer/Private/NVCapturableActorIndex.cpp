@@ -0,0 +1,129 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVCapturableActorIndex.h"
+#include "NVSceneCapturerUtils.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+namespace
+{
+    TMap<TWeakObjectPtr<const UWorld>, TSharedPtr<FNVCapturableActorIndex>> WorldActorIndexes;
+}
+
+//================================== FNVCapturableActorIndex ==================================
+FNVCapturableActorIndex::FNVCapturableActorIndex()
+{
+    Entries.Reset();
+}
+
+FNVCapturableActorIndex* FNVCapturableActorIndex::Get(UWorld* World)
+{
+    ensure(World);
+    if (!World)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    // NOTE: The index is only accessed on the game thread
+    check(IsInGameThread());
+
+    const TSharedPtr<FNVCapturableActorIndex>* ExistingIndexPtr = WorldActorIndexes.Find(World);
+    if (ExistingIndexPtr)
+    {
+        return ExistingIndexPtr->Get();
+    }
+
+    // Drop the indexes of the worlds which are already destroyed
+    for (auto It = WorldActorIndexes.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    TSharedPtr<FNVCapturableActorIndex> NewIndex = MakeShareable(new FNVCapturableActorIndex());
+    WorldActorIndexes.Add(World, NewIndex);
+
+    // This is the only full scan of the world, after it the tags keep the index up to date by themselves
+    for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+    {
+        AActor* CheckActor = *ActorIt;
+        if (CheckActor)
+        {
+            UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
+            if (Tag)
+            {
+                NewIndex->RegisterTag(Tag);
+            }
+        }
+    }
+
+    return NewIndex.Get();
+}
+
+FNVCapturableActorIndex* FNVCapturableActorIndex::Find(const UWorld* World)
+{
+    const TSharedPtr<FNVCapturableActorIndex>* ExistingIndexPtr = World ? WorldActorIndexes.Find(World) : nullptr;
+    return ExistingIndexPtr ? ExistingIndexPtr->Get() : nullptr;
+}
+
+void FNVCapturableActorIndex::RegisterTag(UNVCapturableActorTag* Tag)
+{
+    AActor* OwnerActor = Tag ? Tag->GetOwner() : nullptr;
+    if (!OwnerActor)
+    {
+        return;
+    }
+
+    // An actor is only registered once even if it have more than one tag
+    const int32 ExistingEntryIndex = FindActorEntryIndex(OwnerActor);
+    if (ExistingEntryIndex == INDEX_NONE)
+    {
+        FNVCapturableActorEntry NewEntry;
+        NewEntry.Actor = OwnerActor;
+        NewEntry.Tag = Tag;
+        Entries.Add(NewEntry);
+    }
+    else if (!Entries[ExistingEntryIndex].Tag.IsValid())
+    {
+        Entries[ExistingEntryIndex].Tag = Tag;
+    }
+}
+
+void FNVCapturableActorIndex::UnregisterTag(UNVCapturableActorTag* Tag)
+{
+    // NOTE: Keep the order of the other entries, the tagged actors are only a small part of the world so this is cheap enough
+    Entries.RemoveAll([Tag](const FNVCapturableActorEntry& CheckEntry)
+    {
+        return (CheckEntry.Tag.Get() == Tag) || !CheckEntry.Actor.IsValid();
+    });
+}
+
+void FNVCapturableActorIndex::GetIncludedActors(TArray<AActor*>& OutActors) const
+{
+    OutActors.Reset(Entries.Num());
+    for (const FNVCapturableActorEntry& CheckEntry : Entries)
+    {
+        AActor* CheckActor = CheckEntry.Actor.Get();
+        const UNVCapturableActorTag* Tag = CheckEntry.Tag.Get();
+        if (CheckActor && Tag && Tag->bIncludeMe)
+        {
+            OutActors.Add(CheckActor);
+        }
+    }
+}
+
+int32 FNVCapturableActorIndex::FindActorEntryIndex(const AActor* CheckActor) const
+{
+    return Entries.IndexOfByPredicate([CheckActor](const FNVCapturableActorEntry& CheckEntry)
+    {
+        return (CheckEntry.Actor.Get() == CheckActor);
+    });
+}
@@ -0,0 +1,273 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVCaptureClock.h"
+#include "NVSceneCapturerUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    TMap<TWeakObjectPtr<const UWorld>, TSharedPtr<FNVCaptureClock>> WorldCaptureClocks;
+
+    FAutoConsoleCommand TestCaptureClockCommand(
+        TEXT("NV.TestCaptureClock"),
+        TEXT("Check the capture clock countdowns expire on the expected captured frames"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FNVCaptureClockCountdown::RunSelfTest();
+        }));
+}
+
+//================================== FNVCaptureClock ==================================
+FNVCaptureClock::FNVCaptureClock()
+{
+    bRunning = false;
+    FrameCount = 0;
+    CapturedFrameCount = 0;
+    FixedStepSeconds = 1.f / 30.f;
+}
+
+FNVCaptureClock* FNVCaptureClock::Get(UWorld* World)
+{
+    ensure(World);
+    if (!World)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    check(IsInGameThread());
+
+    const TSharedPtr<FNVCaptureClock>* ExistingClockPtr = WorldCaptureClocks.Find(World);
+    if (ExistingClockPtr)
+    {
+        return ExistingClockPtr->Get();
+    }
+
+    // Drop the clocks of the worlds which are already destroyed
+    for (auto It = WorldCaptureClocks.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    TSharedPtr<FNVCaptureClock> NewClock = MakeShareable(new FNVCaptureClock());
+    WorldCaptureClocks.Add(World, NewClock);
+    return NewClock.Get();
+}
+
+FNVCaptureClock* FNVCaptureClock::Find(const UWorld* World)
+{
+    const TSharedPtr<FNVCaptureClock>* ExistingClockPtr = World ? WorldCaptureClocks.Find(World) : nullptr;
+    return ExistingClockPtr ? ExistingClockPtr->Get() : nullptr;
+}
+
+FNVCaptureClock* FNVCaptureClock::FindRunning(const UWorld* World)
+{
+    FNVCaptureClock* WorldClock = Find(World);
+    return (WorldClock && WorldClock->IsRunning()) ? WorldClock : nullptr;
+}
+
+void FNVCaptureClock::Start(float InFixedStepSeconds)
+{
+    ensure(InFixedStepSeconds > 0.f);
+    if (InFixedStepSeconds <= 0.f)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
+
+    FixedStepSeconds = InFixedStepSeconds;
+    FrameCount = 0;
+    bRunning = true;
+}
+
+void FNVCaptureClock::Stop()
+{
+    bRunning = false;
+}
+
+void FNVCaptureClock::AdvanceFrame()
+{
+    CapturedFrameCount++;
+    if (bRunning)
+    {
+        FrameCount++;
+    }
+}
+
+int32 FNVCaptureClock::SecondsToFrameCount(float DurationSeconds) const
+{
+    // NOTE: Same as counting down the duration by the fixed step, ignoring the rounding errors of the division
+    const int32 DurationFrameCount = FMath::CeilToInt((DurationSeconds / FixedStepSeconds) - KINDA_SMALL_NUMBER);
+    return FMath::Max(DurationFrameCount, 1);
+}
+
+//================================== FNVCaptureClockCountdown ==================================
+FNVCaptureClockCountdown::FNVCaptureClockCountdown()
+{
+    RemainingSeconds = -1.f;
+    ExpireFrame = INDEX_NONE;
+}
+
+void FNVCaptureClockCountdown::Start(const UWorld* World, float DurationSeconds)
+{
+    StartOnClock(FNVCaptureClock::Find(World), DurationSeconds);
+}
+
+void FNVCaptureClockCountdown::StartOnClock(const FNVCaptureClock* WorldClock, float DurationSeconds)
+{
+    if (WorldClock && WorldClock->IsRunning())
+    {
+        ExpireFrame = WorldClock->GetFrameCount() + WorldClock->SecondsToFrameCount(DurationSeconds);
+        RemainingSeconds = 0.f;
+    }
+    else
+    {
+        ExpireFrame = INDEX_NONE;
+        RemainingSeconds = FMath::Max(DurationSeconds, 0.f);
+    }
+}
+
+void FNVCaptureClockCountdown::Stop()
+{
+    RemainingSeconds = -1.f;
+    ExpireFrame = INDEX_NONE;
+}
+
+bool FNVCaptureClockCountdown::IsActive() const
+{
+    return (ExpireFrame != INDEX_NONE) || (RemainingSeconds >= 0.f);
+}
+
+bool FNVCaptureClockCountdown::Tick(const UWorld* World, float DeltaTime)
+{
+    return TickOnClock(FNVCaptureClock::Find(World), DeltaTime);
+}
+
+bool FNVCaptureClockCountdown::TickOnClock(const FNVCaptureClock* WorldClock, float DeltaTime)
+{
+    if (!IsActive())
+    {
+        return false;
+    }
+
+    // Move the countdown to the capture clock when it start running and back to the delta time when it stop
+    const bool bClockRunning = WorldClock && WorldClock->IsRunning();
+    if (bClockRunning && (ExpireFrame == INDEX_NONE))
+    {
+        StartOnClock(WorldClock, RemainingSeconds);
+    }
+    else if (!bClockRunning && (ExpireFrame != INDEX_NONE))
+    {
+        const int32 RemainingFrameCount = WorldClock ? FMath::Max(ExpireFrame - WorldClock->GetFrameCount(), 0) : 0;
+        const float ClockStepSeconds = WorldClock ? WorldClock->GetFixedStepSeconds() : 0.f;
+        StartOnClock(nullptr, RemainingFrameCount * ClockStepSeconds);
+    }
+
+    bool bExpired = false;
+    if (bClockRunning)
+    {
+        bExpired = (WorldClock->GetFrameCount() >= ExpireFrame);
+    }
+    else
+    {
+        RemainingSeconds -= DeltaTime;
+        bExpired = (RemainingSeconds <= 0.f);
+    }
+
+    if (bExpired)
+    {
+        Stop();
+    }
+    return bExpired;
+}
+
+bool FNVCaptureClockCountdown::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Capture clock"), LogNVSceneCapturer);
+
+    FNVCaptureClock TestClock;
+    TestClock.Start(0.1f);
+    TestResult.Check(TestClock.SecondsToFrameCount(0.3f) == 3, TEXT("duration which is a multiple of the step"));
+    TestResult.Check(TestClock.SecondsToFrameCount(0.25f) == 3, TEXT("duration which is not a multiple of the step"));
+    TestResult.Check(TestClock.SecondsToFrameCount(0.f) == 1, TEXT("empty duration"));
+
+    // The captured frames are counted while the clock is stopped, without advancing its steps
+    FNVCaptureClock StoppedClock;
+    StoppedClock.AdvanceFrame();
+    TestResult.Check((StoppedClock.GetCapturedFrameCount() == 1) && (StoppedClock.GetFrameCount() == 0), TEXT("captured frame counted on a stopped clock"));
+
+    // The countdown expire after the same number of captured frames no matter how many ticks happen in between
+    FNVCaptureClockCountdown TestCountdown;
+    TestCountdown.StartOnClock(&TestClock, 0.3f);
+    int32 ExpiredFrame = INDEX_NONE;
+    for (int32 i = 0; (i < 10) && (ExpiredFrame == INDEX_NONE); i++)
+    {
+        // Ticks which don't capture a frame, with a delta time big enough to expire a countdown running on the delta time
+        TestResult.Check(!TestCountdown.TickOnClock(&TestClock, 1.f), TEXT("countdown expired without a captured frame"));
+
+        TestClock.AdvanceFrame();
+        if (TestCountdown.TickOnClock(&TestClock, 0.f))
+        {
+            ExpiredFrame = TestClock.GetFrameCount();
+        }
+    }
+    TestResult.Check(ExpiredFrame == 3, TEXT("countdown didn't expire on the expected frame"));
+    TestResult.Check(!TestCountdown.IsActive(), TEXT("expired countdown still active"));
+
+    // A countdown started on the delta time move to the clock when it start running
+    FNVCaptureClock TestClock2;
+    FNVCaptureClockCountdown TestCountdown2;
+    TestCountdown2.StartOnClock(&TestClock2, 0.2f);
+    TestClock2.Start(0.1f);
+    TestResult.Check(!TestCountdown2.TickOnClock(&TestClock2, 1.f), TEXT("countdown didn't move to the capture clock"));
+    TestClock2.AdvanceFrame();
+    TestClock2.AdvanceFrame();
+    TestResult.Check(TestCountdown2.TickOnClock(&TestClock2, 0.f), TEXT("countdown moved to the capture clock didn't expire"));
+
+    // And back to the delta time when the clock stop
+    TestCountdown2.StartOnClock(&TestClock2, 0.2f);
+    TestClock2.AdvanceFrame();
+    TestClock2.Stop();
+    TestResult.Check(!TestCountdown2.TickOnClock(&TestClock2, 0.05f), TEXT("countdown expired before the remaining step"));
+    TestResult.Check(TestCountdown2.TickOnClock(&TestClock2, 0.05f), TEXT("countdown moved to the delta time didn't expire"));
+
+    // A repeating randomization timer fire on the same captured frames on a fast and a slow machine: the slow one tick (with a bigger delta time)
+    // more often between the captured frames while it wait for the exporter
+    auto GetTimerFrames = [](int32 TicksPerCapturedFrame, float TickDeltaTime)
+    {
+        FNVCaptureClock MachineClock;
+        MachineClock.Start(1.f / 30.f);
+        FNVCaptureClockCountdown RandomizationTimer;
+        RandomizationTimer.StartOnClock(&MachineClock, 0.25f);
+
+        TArray<int32> TimerFrames;
+        for (int32 FrameIndex = 0; FrameIndex < 60; FrameIndex++)
+        {
+            for (int32 TickIndex = 0; TickIndex < TicksPerCapturedFrame; TickIndex++)
+            {
+                if (RandomizationTimer.TickOnClock(&MachineClock, TickDeltaTime))
+                {
+                    TimerFrames.Add(MachineClock.GetFrameCount());
+                    RandomizationTimer.StartOnClock(&MachineClock, 0.25f);
+                }
+            }
+            MachineClock.AdvanceFrame();
+        }
+        return TimerFrames;
+    };
+    const TArray<int32> FastMachineFrames = GetTimerFrames(1, 1.f / 60.f);
+    const TArray<int32> SlowMachineFrames = GetTimerFrames(5, 0.5f);
+    TestResult.Check(FastMachineFrames.Num() > 1, TEXT("the randomization timer didn't repeat"));
+    TestResult.Check(FastMachineFrames == SlowMachineFrames, TEXT("the randomization timer fired on different frames on a slower machine"));
+
+    return TestResult.Finish();
+}
@@ -0,0 +1,281 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVCaptureCreditPool.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVCaptureClock.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+    FAutoConsoleCommand TestCaptureCreditsCommand(
+        TEXT("NV.TestCaptureCredits"),
+        TEXT("Check the accounting of the capture credit pool without rendering anything"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FNVCaptureCreditPool::RunSelfTest();
+        }));
+}
+
+//================================== FNVCaptureCreditStats ==================================
+FNVCaptureCreditStats::FNVCaptureCreditStats()
+{
+    MaxCreditCount = 0;
+    OutstandingCreditCount = 0;
+    PeakOutstandingCreditCount = 0;
+    GrantedCreditCount = 0;
+    RetiredCreditCount = 0;
+    DeniedRequestCount = 0;
+    AverageCreditLifetime = 0.0;
+    TotalWaitTime = 0.0;
+}
+
+//================================== FNVCaptureCreditPool ==================================
+FNVCaptureCreditPool::FNVCaptureCreditPool(int32 InMaxCreditCount)
+{
+    Stats.MaxCreditCount = FMath::Max(1, InMaxCreditCount);
+    TotalCreditLifetime = 0.0;
+    CreditRetiredEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FNVCaptureCreditPool::~FNVCaptureCreditPool()
+{
+    // The outstanding credits hold a weak reference to the pool, they just get deleted when they are released
+    FPlatformProcess::ReturnSynchEventToPool(CreditRetiredEvent);
+    CreditRetiredEvent = nullptr;
+}
+
+FNVCaptureCreditPtr FNVCaptureCreditPool::TryAcquireCredit(int32 FrameIndex)
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+
+    // The frame already have a credit, share it
+    TWeakPtr<FNVCaptureCredit, ESPMode::ThreadSafe>* ExistingCredit = FrameCredits.Find(FrameIndex);
+    if (ExistingCredit)
+    {
+        FNVCaptureCreditPtr FrameCredit = ExistingCredit->Pin();
+        if (FrameCredit.IsValid())
+        {
+            return FrameCredit;
+        }
+    }
+
+    if (Stats.OutstandingCreditCount >= Stats.MaxCreditCount)
+    {
+        Stats.DeniedRequestCount++;
+        return nullptr;
+    }
+
+    FNVCaptureCredit* NewCredit = new FNVCaptureCredit();
+    NewCredit->FrameIndex = FrameIndex;
+    NewCredit->GrantedTimestamp = FPlatformTime::Seconds();
+
+    TWeakPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> WeakPool = AsShared();
+    FNVCaptureCreditPtr NewCreditPtr = FNVCaptureCreditPtr(NewCredit, [WeakPool](FNVCaptureCredit* RetiredCredit)
+    {
+        TSharedPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> OwnerPool = WeakPool.Pin();
+        if (OwnerPool.IsValid())
+        {
+            OwnerPool->RetireCredit(RetiredCredit);
+        }
+        delete RetiredCredit;
+    });
+
+    FrameCredits.Add(FrameIndex, NewCreditPtr);
+    Stats.OutstandingCreditCount++;
+    Stats.PeakOutstandingCreditCount = FMath::Max(Stats.PeakOutstandingCreditCount, Stats.OutstandingCreditCount);
+    Stats.GrantedCreditCount++;
+
+    return NewCreditPtr;
+}
+
+FNVCaptureCreditPtr FNVCaptureCreditPool::FindFrameCredit(int32 FrameIndex) const
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+
+    const TWeakPtr<FNVCaptureCredit, ESPMode::ThreadSafe>* FrameCredit = FrameCredits.Find(FrameIndex);
+    return FrameCredit ? FrameCredit->Pin() : nullptr;
+}
+
+void FNVCaptureCreditPool::RetireCredit(FNVCaptureCredit* RetiredCredit)
+{
+    if (!RetiredCredit)
+    {
+        return;
+    }
+
+    {
+        FScopeLock CreditScopeLock(&CreditLock);
+
+        // The frame's entry may already be used by a newer credit of the same frame
+        const TWeakPtr<FNVCaptureCredit, ESPMode::ThreadSafe>* FrameCredit = FrameCredits.Find(RetiredCredit->FrameIndex);
+        if (FrameCredit && !FrameCredit->IsValid())
+        {
+            FrameCredits.Remove(RetiredCredit->FrameIndex);
+        }
+
+        Stats.OutstandingCreditCount--;
+        Stats.RetiredCreditCount++;
+        TotalCreditLifetime += FPlatformTime::Seconds() - RetiredCredit->GrantedTimestamp;
+    }
+
+    CreditRetiredEvent->Trigger();
+}
+
+bool FNVCaptureCreditPool::WaitForRetiredCredit(float TimeOutSeconds)
+{
+    const double StartWaitTime = FPlatformTime::Seconds();
+    const uint32 TimeOutMS = (uint32)FMath::Max(0, FMath::CeilToInt(TimeOutSeconds * 1000.f));
+    const bool bCreditRetired = CreditRetiredEvent->Wait(TimeOutMS);
+
+    FScopeLock CreditScopeLock(&CreditLock);
+    Stats.TotalWaitTime += FPlatformTime::Seconds() - StartWaitTime;
+    return bCreditRetired;
+}
+
+void FNVCaptureCreditPool::SetMaxCreditCount(int32 NewMaxCreditCount)
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+    Stats.MaxCreditCount = FMath::Max(1, NewMaxCreditCount);
+}
+
+int32 FNVCaptureCreditPool::GetMaxCreditCount() const
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+    return Stats.MaxCreditCount;
+}
+
+int32 FNVCaptureCreditPool::GetAvailableCreditCount() const
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+    return FMath::Max(0, Stats.MaxCreditCount - Stats.OutstandingCreditCount);
+}
+
+int32 FNVCaptureCreditPool::GetOutstandingCreditCount() const
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+    return Stats.OutstandingCreditCount;
+}
+
+FNVCaptureCreditStats FNVCaptureCreditPool::GetStats() const
+{
+    FScopeLock CreditScopeLock(&CreditLock);
+    FNVCaptureCreditStats CurrentStats = Stats;
+    CurrentStats.AverageCreditLifetime = (Stats.RetiredCreditCount > 0) ? (TotalCreditLifetime / Stats.RetiredCreditCount) : 0.0;
+    return CurrentStats;
+}
+
+bool FNVCaptureCreditPool::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Capture credit pool"), LogNVSceneCapturer);
+
+    const int32 TestMaxCreditCount = 3;
+    TSharedPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> TestPool = MakeShareable(new FNVCaptureCreditPool(TestMaxCreditCount));
+
+    // Acquire all the credits
+    TArray<FNVCaptureCreditPtr> Credits;
+    for (int32 i = 0; i < TestMaxCreditCount; i++)
+    {
+        Credits.Add(TestPool->TryAcquireCredit(i));
+        TestResult.Check(Credits.Last().IsValid(), TEXT("credit denied while some are available"));
+    }
+    TestResult.Check(TestPool->GetAvailableCreditCount() == 0, TEXT("available credit count after acquiring all the credits"));
+    TestResult.Check(!TestPool->TryAcquireCredit(TestMaxCreditCount).IsValid(), TEXT("credit granted while all are outstanding"));
+    TestResult.Check(TestPool->GetStats().DeniedRequestCount == 1, TEXT("denied request count"));
+
+    // A frame which already have a credit share it
+    TestResult.Check(TestPool->TryAcquireCredit(0) == Credits[0], TEXT("second credit granted for the same frame"));
+    TestResult.Check(TestPool->FindFrameCredit(1) == Credits[1], TEXT("frame credit not found"));
+    TestResult.Check(!TestPool->FindFrameCredit(TestMaxCreditCount).IsValid(), TEXT("credit found for a frame which doesn't have one"));
+
+    // The exported data keep the credit outstanding after the capturer released it
+    FNVCaptureCreditPtr ExportedDataCredit = TestPool->FindFrameCredit(0);
+    Credits[0].Reset();
+    TestResult.Check(TestPool->GetOutstandingCreditCount() == TestMaxCreditCount, TEXT("credit retired while the exported data still use it"));
+    TestResult.Check(!TestPool->WaitForRetiredCredit(0.f), TEXT("credit retired event triggered without any retired credit"));
+
+    // The credit is retired when the last user release it
+    ExportedDataCredit.Reset();
+    TestResult.Check(TestPool->GetOutstandingCreditCount() == (TestMaxCreditCount - 1), TEXT("credit not retired after its last reference was released"));
+    TestResult.Check(TestPool->WaitForRetiredCredit(0.f), TEXT("credit retired event not triggered"));
+    TestResult.Check(!TestPool->FindFrameCredit(0).IsValid(), TEXT("retired credit still found"));
+    Credits[0] = TestPool->TryAcquireCredit(TestMaxCreditCount);
+    TestResult.Check(Credits[0].IsValid(), TEXT("credit denied after one was retired"));
+
+    // Lowering the max credit count doesn't affect the outstanding credits
+    TestPool->SetMaxCreditCount(1);
+    TestResult.Check(TestPool->GetAvailableCreditCount() == 0, TEXT("available credit count after lowering the max"));
+    TestResult.Check(!TestPool->TryAcquireCredit(TestMaxCreditCount + 1).IsValid(), TEXT("credit granted above the lowered max"));
+
+    const FNVCaptureCreditStats TestStats = TestPool->GetStats();
+    TestResult.Check(TestStats.GrantedCreditCount == (TestMaxCreditCount + 1), TEXT("granted credit count"));
+    TestResult.Check(TestStats.RetiredCreditCount == 1, TEXT("retired credit count"));
+    TestResult.Check(TestStats.PeakOutstandingCreditCount == TestMaxCreditCount, TEXT("peak outstanding credit count"));
+
+    // The credits can outlive their pool
+    TestPool.Reset();
+    Credits.Reset();
+
+    // Capture with an exporter slower than the capturer, the way the capturer actor does: wait for a retired credit when none is available
+    // and only advance the capture clock on the captured frames. No frame may be skipped and the simulated time must not depend on the waits
+    const int32 TestFrameCount = 20;
+    const float TestFixedStep = 1.f / 30.f;
+    TSharedPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> CapturePool = MakeShareable(new FNVCaptureCreditPool(2));
+    FNVCaptureClock CaptureClock;
+    CaptureClock.Start(TestFixedStep);
+
+    FCriticalSection ExportedFramesLock;
+    TArray<int32> ExportedFrames;
+    FGraphEventArray ExportTasks;
+    const double MaxWaitEndTime = FPlatformTime::Seconds() + 10.0;
+    for (int32 FrameIndex = 0; FrameIndex < TestFrameCount; FrameIndex++)
+    {
+        FNVCaptureCreditPtr FrameCredit = CapturePool->TryAcquireCredit(FrameIndex);
+        while (!FrameCredit.IsValid() && (FPlatformTime::Seconds() < MaxWaitEndTime))
+        {
+            CapturePool->WaitForRetiredCredit(0.01f);
+            FrameCredit = CapturePool->TryAcquireCredit(FrameIndex);
+        }
+        TestResult.Check(FrameCredit.IsValid(), TEXT("the exporter never retired a credit"));
+        if (!FrameCredit.IsValid())
+        {
+            break;
+        }
+        TestResult.Check(CaptureClock.GetFrameCount() == FrameIndex, TEXT("the capture clock advanced while waiting for a credit"));
+
+        // The exported data keep the frame's credit until the (slow) export is done
+        ExportTasks.Add(FFunctionGraphTask::CreateAndDispatchWhenReady([FrameCredit, FrameIndex, &ExportedFramesLock, &ExportedFrames]()
+        {
+            FPlatformProcess::Sleep(0.002f);
+            FScopeLock ExportedScopeLock(&ExportedFramesLock);
+            ExportedFrames.Add(FrameIndex);
+        }, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask));
+        FrameCredit.Reset();
+
+        CaptureClock.AdvanceFrame();
+    }
+    FTaskGraphInterface::Get().WaitUntilTasksComplete(ExportTasks);
+
+    ExportedFrames.Sort();
+    bool bAllFramesExported = (ExportedFrames.Num() == TestFrameCount);
+    for (int32 i = 0; bAllFramesExported && (i < ExportedFrames.Num()); i++)
+    {
+        bAllFramesExported = (ExportedFrames[i] == i);
+    }
+    TestResult.Check(bAllFramesExported, TEXT("a frame was skipped or exported twice while the exporter was saturated"));
+    TestResult.Check(CaptureClock.GetSimulatedSeconds() == ((double)TestFrameCount * TestFixedStep), TEXT("the simulated time isn't exactly one step per captured frame"));
+
+    const FNVCaptureCreditStats CaptureStats = CapturePool->GetStats();
+    TestResult.Check(CaptureStats.DeniedRequestCount > 0, TEXT("the slow exporter never made the capturer wait"));
+    TestResult.Check(CaptureStats.PeakOutstandingCreditCount <= 2, TEXT("more frames in flight than credits"));
+    TestResult.Check(CaptureStats.OutstandingCreditCount == 0, TEXT("credits still outstanding after all the frames were exported"));
+
+    return TestResult.Finish();
+}
@@ -0,0 +1,628 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVFrameRangeShard.h"
+#include "NVRandomStream.h"
+#include "NVCaptureClock.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVTarShardWriter.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "JsonObjectConverter.h"
+
+namespace
+{
+    FAutoConsoleCommand TestFrameRangeShardsCommand(
+        TEXT("NV.TestFrameRangeShards"),
+        TEXT("Check that the frame range shards reproduce the frames of a single capturer and merge into a contiguous dataset"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FNVFrameRangeShard::RunSelfTest();
+        }));
+
+    const FString MergeManifestFileName = TEXT("_frame_range_shards.json");
+    const FString ShardsStagingDirectoryName = TEXT("_shards");
+
+    /// The command line arguments the launcher override for each child process
+    const TCHAR* ShardingArgumentKeys[] = { TEXT("-ShardCount="), TEXT("-ShardIndex="), TEXT("-RandomSeed="), TEXT("-OutputPath=") };
+
+    /// Get the frame index of a frame's file (e.g: 000042.left.depth.png), return INDEX_NONE if it's not a frame's file
+    int32 GetFileFrameIndex(const FString& FileName)
+    {
+        int32 DigitCount = 0;
+        while ((DigitCount < FileName.Len()) && FChar::IsDigit(FileName[DigitCount]))
+        {
+            DigitCount++;
+        }
+        if ((DigitCount == 0) || (DigitCount >= FileName.Len()) || (FileName[DigitCount] != TEXT('.')))
+        {
+            return INDEX_NONE;
+        }
+        return FCString::Atoi(*FileName.Left(DigitCount));
+    }
+
+    /// Split a command line into its arguments, the quoted parts are kept as they are
+    TArray<FString> SplitCommandLine(const FString& CommandLine)
+    {
+        TArray<FString> Arguments;
+        FString CurrentArgument;
+        bool bInQuotes = false;
+        for (const TCHAR CheckChar : CommandLine)
+        {
+            if (CheckChar == TEXT('"'))
+            {
+                bInQuotes = !bInQuotes;
+            }
+            if (!bInQuotes && FChar::IsWhitespace(CheckChar))
+            {
+                if (!CurrentArgument.IsEmpty())
+                {
+                    Arguments.Add(CurrentArgument);
+                    CurrentArgument.Reset();
+                }
+            }
+            else
+            {
+                CurrentArgument.AppendChar(CheckChar);
+            }
+        }
+        if (!CurrentArgument.IsEmpty())
+        {
+            Arguments.Add(CurrentArgument);
+        }
+        return Arguments;
+    }
+}
+
+//================================== FNVFrameRangeShard ==================================
+FNVFrameRangeShard::FNVFrameRangeShard()
+{
+    ShardIndex = 0;
+    ShardCount = 0;
+    TotalFrameCount = 0;
+    FrameOffset = 0;
+    FrameCount = 0;
+    RandomSeed = 0;
+    bSkipLeadingFrames = false;
+}
+
+FNVFrameRangeShard FNVFrameRangeShard::MakeShard(int32 TotalFrameCount, int32 ShardCount, int32 ShardIndex, int32 RandomSeed)
+{
+    FNVFrameRangeShard NewShard;
+    ensure((ShardCount > 0) && (ShardIndex >= 0) && (ShardIndex < ShardCount) && (TotalFrameCount >= 0));
+    if ((ShardCount <= 0) || (ShardIndex < 0) || (ShardIndex >= ShardCount) || (TotalFrameCount < 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return NewShard;
+    }
+
+    const int32 BaseFrameCount = TotalFrameCount / ShardCount;
+    const int32 RemainderFrameCount = TotalFrameCount % ShardCount;
+
+    NewShard.ShardIndex = ShardIndex;
+    NewShard.ShardCount = ShardCount;
+    NewShard.TotalFrameCount = TotalFrameCount;
+    NewShard.FrameOffset = ShardIndex * BaseFrameCount + FMath::Min(ShardIndex, RemainderFrameCount);
+    NewShard.FrameCount = BaseFrameCount + ((ShardIndex < RemainderFrameCount) ? 1 : 0);
+    NewShard.RandomSeed = RandomSeed;
+    return NewShard;
+}
+
+bool FNVFrameRangeShard::ParseCommandLine(const TCHAR* CommandLine, int32 TotalFrameCount, int32 RandomSeed, FNVFrameRangeShard& OutShard)
+{
+    int32 ShardCount = 0;
+    int32 ShardIndex = INDEX_NONE;
+    if (!FParse::Value(CommandLine, TEXT("-ShardCount="), ShardCount) || !FParse::Value(CommandLine, TEXT("-ShardIndex="), ShardIndex))
+    {
+        return false;
+    }
+
+    if ((TotalFrameCount <= 0) || (ShardCount <= 0) || (ShardIndex < 0) || (ShardIndex >= ShardCount))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Invalid frame range shard %d / %d of %d frames, the shards need -NumberOfFrame= to be set."),
+            ShardIndex, ShardCount, TotalFrameCount);
+        return false;
+    }
+
+    OutShard = MakeShard(TotalFrameCount, ShardCount, ShardIndex, RandomSeed);
+    OutShard.bSkipLeadingFrames = FParse::Param(CommandLine, TEXT("ShardSkipLeadingFrames"));
+    return true;
+}
+
+int32 FNVFrameRangeShard::GetFrameSeed(int32 RandomSeed, int32 FrameIndex)
+{
+    return (int32)HashCombine(GetTypeHash(RandomSeed), GetTypeHash(FrameIndex));
+}
+
+void FNVFrameRangeShard::SeedFrameRandomStreams(int32 RandomSeed, int32 FrameIndex)
+{
+    const int32 FrameSeed = GetFrameSeed(RandomSeed, FrameIndex);
+    FMath::RandInit(FrameSeed);
+    FMath::SRandInit(FrameSeed);
+    // NOTE: The named random streams restart at each frame, their values only depend on the dataset's seed and the frame's index
+    FNVRandomStream::SetMasterSeed(RandomSeed, FrameIndex);
+}
+
+FNVFrameRangeShardData FNVFrameRangeShard::GetShardData() const
+{
+    FNVFrameRangeShardData ShardData;
+    ShardData.shard_index = ShardIndex;
+    ShardData.frame_offset = FrameOffset;
+    ShardData.frame_count = FrameCount;
+    ShardData.shard_seed = GetShardSeed();
+    return ShardData;
+}
+
+bool FNVFrameRangeShard::MergeShardOutputs(const TArray<FNVFrameRangeShard>& Shards,
+        const TArray<FString>& ShardDirectories,
+        const FString& MergedDirectory,
+        FNVFrameRangeMergeData& OutMergeData)
+{
+    ensure((Shards.Num() > 0) && (Shards.Num() == ShardDirectories.Num()));
+    if ((Shards.Num() == 0) || (Shards.Num() != ShardDirectories.Num()))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return false;
+    }
+
+    IFileManager& FileManager = IFileManager::Get();
+    FileManager.MakeDirectory(*MergedDirectory, true);
+
+    OutMergeData = FNVFrameRangeMergeData();
+    OutMergeData.total_frame_count = Shards[0].TotalFrameCount;
+    OutMergeData.random_seed = Shards[0].RandomSeed;
+
+    bool bSettingsConsistent = true;
+    TMap<FString, FString> MergedSettingsFiles;
+    TBitArray<> MergedFrames(false, OutMergeData.total_frame_count);
+
+    for (int32 i = 0; i < Shards.Num(); i++)
+    {
+        const FNVFrameRangeShard& Shard = Shards[i];
+        const FString& ShardDirectory = ShardDirectories[i];
+        OutMergeData.shards.Add(Shard.GetShardData());
+
+        TArray<FString> ShardFileNames;
+        FileManager.FindFiles(ShardFileNames, *ShardDirectory, nullptr);
+        if (ShardFileNames.Num() == 0)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Frame range shard %d didn't export anything to '%s'."), Shard.ShardIndex, *ShardDirectory);
+        }
+
+        for (const FString& FileName : ShardFileNames)
+        {
+            const FString SourceFilePath = FPaths::Combine(ShardDirectory, FileName);
+
+            // The tar shards are numbered per process, give them a name unique in the merged directory
+            if (FileName.EndsWith(TEXT(".tar")))
+            {
+                const FString TarBaseName = FPaths::GetBaseFilename(FileName);
+                const FString MergedTarBaseName = FString::Printf(TEXT("%s_range%03d"), *TarBaseName, Shard.ShardIndex);
+                const FString TarIndexFilePath = FPaths::Combine(ShardDirectory, TarBaseName + TEXT(".index.json"));
+
+                FString TarIndexStr;
+                FNVTarShardIndexData TarIndexData;
+                if (FFileHelper::LoadFileToString(TarIndexStr, *TarIndexFilePath)
+                    && FJsonObjectConverter::JsonObjectStringToUStruct(TarIndexStr, &TarIndexData, 0, 0))
+                {
+                    TarIndexData.shard_name = MergedTarBaseName + TEXT(".tar");
+                    for (const FNVTarShardIndexEntry& IndexEntry : TarIndexData.entries)
+                    {
+                        if ((IndexEntry.frame_index >= 0) && (IndexEntry.frame_index < OutMergeData.total_frame_count))
+                        {
+                            MergedFrames[IndexEntry.frame_index] = true;
+                        }
+                    }
+                    TSharedPtr<FJsonObject> TarIndexJsonObj = NVSceneCapturerUtils::UStructToJsonObject(TarIndexData);
+                    NVSceneCapturerUtils::SaveJsonObjectToFile(TarIndexJsonObj, FPaths::Combine(MergedDirectory, MergedTarBaseName + TEXT(".index.json")));
+                }
+                else
+                {
+                    UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't read the index of the tar shard '%s'."), *SourceFilePath);
+                }
+
+                FileManager.Move(*FPaths::Combine(MergedDirectory, MergedTarBaseName + TEXT(".tar")), *SourceFilePath, true);
+                continue;
+            }
+            if (FileName.EndsWith(TEXT(".index.json")))
+            {
+                // Already rewritten with its tar shard
+                continue;
+            }
+
+            // The settings files are exported by every process and must all be the same
+            if (FileName.StartsWith(TEXT("_")))
+            {
+                FString SettingsStr;
+                FFileHelper::LoadFileToString(SettingsStr, *SourceFilePath);
+                const FString* MergedSettingsStr = MergedSettingsFiles.Find(FileName);
+                if (!MergedSettingsStr)
+                {
+                    MergedSettingsFiles.Add(FileName, SettingsStr);
+                    FFileHelper::SaveStringToFile(SettingsStr, *FPaths::Combine(MergedDirectory, FileName));
+                }
+                else if (!MergedSettingsStr->Equals(SettingsStr, ESearchCase::CaseSensitive))
+                {
+                    UE_LOG(LogNVSceneCapturer, Error, TEXT("The settings file '%s' of frame range shard %d is different from the other shards."), *FileName, Shard.ShardIndex);
+                    bSettingsConsistent = false;
+                }
+                continue;
+            }
+
+            const int32 FileFrameIndex = GetFileFrameIndex(FileName);
+            if ((FileFrameIndex < Shard.FrameOffset) || (FileFrameIndex >= Shard.GetEndFrame()))
+            {
+                UE_LOG(LogNVSceneCapturer, Warning, TEXT("The file '%s' is outside of the frame range of shard %d [%d, %d), it's not merged."),
+                    *FileName, Shard.ShardIndex, Shard.FrameOffset, Shard.GetEndFrame());
+                continue;
+            }
+
+            if (FileManager.Move(*FPaths::Combine(MergedDirectory, FileName), *SourceFilePath, true))
+            {
+                MergedFrames[FileFrameIndex] = true;
+            }
+            else
+            {
+                UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't move '%s' to the merged directory '%s'."), *SourceFilePath, *MergedDirectory);
+            }
+        }
+    }
+
+    OutMergeData.merged_frame_count = 0;
+    for (int32 FrameIndex = 0; FrameIndex < OutMergeData.total_frame_count; FrameIndex++)
+    {
+        if (MergedFrames[FrameIndex])
+        {
+            OutMergeData.merged_frame_count++;
+        }
+        else
+        {
+            OutMergeData.missing_frames.Add(FrameIndex);
+        }
+    }
+
+    TSharedPtr<FJsonObject> MergeDataJsonObj = NVSceneCapturerUtils::UStructToJsonObject(OutMergeData);
+    NVSceneCapturerUtils::SaveJsonObjectToFile(MergeDataJsonObj, FPaths::Combine(MergedDirectory, MergeManifestFileName));
+
+    if (OutMergeData.missing_frames.Num() > 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("%d frames are missing from the merged frame range shards, the first one is %d."),
+            OutMergeData.missing_frames.Num(), OutMergeData.missing_frames[0]);
+    }
+
+    return bSettingsConsistent && (OutMergeData.missing_frames.Num() == 0);
+}
+
+bool FNVFrameRangeShard::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Frame range shard"), LogNVSceneCapturer);
+
+    // The ranges cover all the frames without overlapping
+    const int32 TestTotalFrameCount = 11;
+    const int32 TestRandomSeed = 12345;
+    int32 NextFrameOffset = 0;
+    for (int32 ShardIndex = 0; ShardIndex < 3; ShardIndex++)
+    {
+        const FNVFrameRangeShard TestShard = MakeShard(TestTotalFrameCount, 3, ShardIndex, TestRandomSeed);
+        TestResult.Check(TestShard.FrameOffset == NextFrameOffset, TEXT("shard ranges are not contiguous"));
+        TestResult.Check(FMath::Abs(TestShard.FrameCount - TestTotalFrameCount / 3) <= 1, TEXT("shard ranges are not balanced"));
+        NextFrameOffset = TestShard.GetEndFrame();
+    }
+    TestResult.Check(NextFrameOffset == TestTotalFrameCount, TEXT("shard ranges don't cover all the frames"));
+
+    // The frames before the shard are fast forwarded unless the command line explicitly ask for skipping them
+    FNVFrameRangeShard ParsedShard;
+    TestResult.Check(ParseCommandLine(TEXT("-ShardCount=2 -ShardIndex=1"), TestTotalFrameCount, TestRandomSeed, ParsedShard)
+                     && !ParsedShard.bSkipLeadingFrames && (ParsedShard.GetStartFrame() == 0) && ParsedShard.IsFastForwardFrame(0) && !ParsedShard.IsFastForwardFrame(ParsedShard.FrameOffset),
+                     TEXT("a shard doesn't fast forward the frames before its range by default"));
+    TestResult.Check(ParseCommandLine(TEXT("-ShardCount=2 -ShardIndex=1 -ShardSkipLeadingFrames"), TestTotalFrameCount, TestRandomSeed, ParsedShard)
+                     && ParsedShard.bSkipLeadingFrames && (ParsedShard.GetStartFrame() == ParsedShard.FrameOffset) && !ParsedShard.IsFastForwardFrame(0),
+                     TEXT("-ShardSkipLeadingFrames doesn't start the shard at its first frame"));
+
+    // Run the frames the way the capturer does: start at the shard's start frame, seed the random streams at the beginning of each frame,
+    // advance the capture clock after each frame and only capture the frames which are not fast forwarded
+    // The randomization components keep their named random streams from frame to frame, like here, and a movement carry its position
+    // from frame to frame while its velocity is randomized every few frames of the capture clock
+    // return the number of frames which were run
+    auto RunCapturerFrames = [](int32 RandomSeed, int32 TotalFrameCount, const FNVFrameRangeShard* Shard,
+                                TMap<int32, FVector>& OutFrameValues, TMap<int32, FVector>& OutFrameStates)
+    {
+        FNVRandomStream ColorStream(TEXT("NVFrameRangeShardTest.Color"));
+        FNVRandomStream MovementStream(TEXT("NVFrameRangeShardTest.Movement"));
+        FNVCaptureClock CaptureClock;
+        CaptureClock.Start(1.f / 30.f);
+        const int32 VelocityChangeFrameCount = 3;
+        float Position = 0.f;
+        float Velocity = 0.f;
+
+        const int32 StartFrame = Shard ? Shard->GetStartFrame() : 0;
+        const int32 EndFrame = Shard ? Shard->GetEndFrame() : TotalFrameCount;
+        for (int32 FrameIndex = StartFrame; FrameIndex < EndFrame; FrameIndex++)
+        {
+            SeedFrameRandomStreams(RandomSeed, FrameIndex);
+
+            // The number of values drawn change from frame to frame, it must not affect the values of the next frames
+            const int32 SkippedValueCount = ColorStream.RandRange(0, 3);
+            for (int32 i = 0; i < SkippedValueCount; i++)
+            {
+                ColorStream.GetUnsignedInt();
+            }
+            const float Color = ColorStream.GetFraction();
+
+            if ((CaptureClock.GetFrameCount() % VelocityChangeFrameCount) == 0)
+            {
+                Velocity = MovementStream.FRandRange(-1.f, 1.f);
+            }
+            Position += Velocity;
+
+            if (!Shard || !Shard->IsFastForwardFrame(FrameIndex))
+            {
+                OutFrameValues.Add(FrameIndex, FVector((float)SkippedValueCount, Color, FMath::FRand()));
+                OutFrameStates.Add(FrameIndex, FVector(Position, Velocity, 0.f));
+            }
+            CaptureClock.AdvanceFrame();
+        }
+        return EndFrame - StartFrame;
+    };
+
+    const int32 TestShardCount = 2;
+    TMap<int32, FVector> SingleRunFrames;
+    TMap<int32, FVector> SingleRunStates;
+    RunCapturerFrames(TestRandomSeed, TestTotalFrameCount, nullptr, SingleRunFrames, SingleRunStates);
+
+    // Each shard must capture exactly the same range of frames of the single run
+    TMap<int32, FVector> ShardedFrames;
+    for (const bool bSkipLeadingFrames : { false, true })
+    {
+        bool bSameStates = true;
+        for (int32 ShardIndex = 0; ShardIndex < TestShardCount; ShardIndex++)
+        {
+            FNVFrameRangeShard TestShard = MakeShard(TestTotalFrameCount, TestShardCount, ShardIndex, TestRandomSeed);
+            TestShard.bSkipLeadingFrames = bSkipLeadingFrames;
+            TMap<int32, FVector> ShardFrames;
+            TMap<int32, FVector> ShardStates;
+            const int32 RunFrameCount = RunCapturerFrames(TestRandomSeed, TestTotalFrameCount, &TestShard, ShardFrames, ShardStates);
+            TestResult.Check(RunFrameCount == (bSkipLeadingFrames ? TestShard.FrameCount : TestShard.GetEndFrame()),
+                             bSkipLeadingFrames ? TEXT("a shard skipping its leading frames ran frames before its range")
+                                                : TEXT("the frames before a shard were not fast forwarded"));
+            TestResult.Check(ShardFrames.Num() == TestShard.FrameCount, TEXT("a shard didn't capture exactly its range of frames"));
+
+            for (int32 FrameIndex = TestShard.FrameOffset; FrameIndex < TestShard.GetEndFrame(); FrameIndex++)
+            {
+                const FVector* ShardFrame = ShardFrames.Find(FrameIndex);
+                TestResult.Check(ShardFrame && (*ShardFrame == SingleRunFrames.FindRef(FrameIndex)), TEXT("a shard's random values are different from the single run's"));
+                const FVector* ShardState = ShardStates.Find(FrameIndex);
+                bSameStates = bSameStates && ShardState && (*ShardState == SingleRunStates.FindRef(FrameIndex));
+                if (!bSkipLeadingFrames && ShardFrame)
+                {
+                    ShardedFrames.Add(FrameIndex, *ShardFrame);
+                }
+            }
+        }
+
+        // NOTE: Skipping the leading frames start the movement over in the second shard, that's the documented caveat of bSkipLeadingFrames
+        TestResult.Check(bSameStates != bSkipLeadingFrames, bSkipLeadingFrames ? TEXT("the test's movement doesn't depend on the frames before the shard")
+                                                                               : TEXT("a fast forwarded shard's frames are different from the single run's"));
+    }
+
+    TMap<int32, FVector> OtherSeedFrames;
+    TMap<int32, FVector> OtherSeedStates;
+    RunCapturerFrames(TestRandomSeed + 1, TestTotalFrameCount, nullptr, OtherSeedFrames, OtherSeedStates);
+    TestResult.Check(!OtherSeedFrames.OrderIndependentCompareEqual(SingleRunFrames), TEXT("a different seed produced the same frames"));
+
+    // Merge the fake outputs of the 2 shards
+    const FString TestDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("NVFrameRangeShardTest"));
+    const FString MergedDirectory = FPaths::Combine(TestDirectory, TEXT("Merged"));
+    IFileManager& FileManager = IFileManager::Get();
+    FileManager.DeleteDirectory(*TestDirectory, false, true);
+
+    TArray<FNVFrameRangeShard> TestShards;
+    TArray<FString> TestShardDirectories;
+    for (int32 ShardIndex = 0; ShardIndex < TestShardCount; ShardIndex++)
+    {
+        TestShards.Add(MakeShard(TestTotalFrameCount, TestShardCount, ShardIndex, TestRandomSeed));
+        TestShardDirectories.Add(FPaths::Combine(TestDirectory, FString::Printf(TEXT("shard_%03d"), ShardIndex)));
+    }
+
+    // NOTE: The merge move the frames' files so the outputs are written again before each merge
+    auto WriteShardOutputs = [&TestShards, &TestShardDirectories, &ShardedFrames](bool bConsistentSettings)
+    {
+        for (int32 ShardIndex = 0; ShardIndex < TestShards.Num(); ShardIndex++)
+        {
+            const FNVFrameRangeShard& TestShard = TestShards[ShardIndex];
+            const FString& ShardDirectory = TestShardDirectories[ShardIndex];
+            const bool bDifferentSettings = !bConsistentSettings && (ShardIndex > 0);
+            FFileHelper::SaveStringToFile(bDifferentSettings ? TEXT("{\"camera_settings\": [0]}") : TEXT("{\"camera_settings\": []}"),
+                                          *FPaths::Combine(ShardDirectory, TEXT("_camera_settings.json")));
+            FFileHelper::SaveStringToFile(TEXT("{\"exported_objects\": []}"), *FPaths::Combine(ShardDirectory, TEXT("_object_settings.json")));
+            for (int32 FrameIndex = TestShard.FrameOffset; FrameIndex < TestShard.GetEndFrame(); FrameIndex++)
+            {
+                const FVector FrameData = ShardedFrames.FindRef(FrameIndex);
+                FFileHelper::SaveStringToFile(FrameData.ToString(), *FPaths::Combine(ShardDirectory, FString::Printf(TEXT("%06i.json"), FrameIndex)));
+            }
+        }
+    };
+
+    WriteShardOutputs(true);
+    FNVFrameRangeMergeData MergeData;
+    TestResult.Check(MergeShardOutputs(TestShards, TestShardDirectories, MergedDirectory, MergeData), TEXT("merge failed"));
+    TestResult.Check(MergeData.merged_frame_count == TestTotalFrameCount, TEXT("merged frame count"));
+    TestResult.Check(MergeData.missing_frames.Num() == 0, TEXT("merged frames are missing"));
+    TestResult.Check(FPaths::FileExists(FPaths::Combine(MergedDirectory, TEXT("_camera_settings.json"))), TEXT("camera settings not merged"));
+    TestResult.Check(FPaths::FileExists(FPaths::Combine(MergedDirectory, MergeManifestFileName)), TEXT("merge manifest not exported"));
+    for (int32 FrameIndex = 0; FrameIndex < TestTotalFrameCount; FrameIndex++)
+    {
+        FString MergedFrameStr;
+        FFileHelper::LoadFileToString(MergedFrameStr, *FPaths::Combine(MergedDirectory, FString::Printf(TEXT("%06i.json"), FrameIndex)));
+        TestResult.Check(MergedFrameStr == SingleRunFrames.FindRef(FrameIndex).ToString(), TEXT("merged frame is different from the single run's frame"));
+    }
+
+    // Shards with different settings can't be merged, even when all their frames are there
+    WriteShardOutputs(false);
+    TestResult.Check(!MergeShardOutputs(TestShards, TestShardDirectories, MergedDirectory, MergeData), TEXT("shards with different settings merged"));
+    TestResult.Check(MergeData.missing_frames.Num() == 0, TEXT("frames are missing from the shards with different settings"));
+
+    FileManager.DeleteDirectory(*TestDirectory, false, true);
+
+    return TestResult.Finish();
+}
+
+//================================== FNVFrameRangeShardLauncher ==================================
+FNVFrameRangeShardLauncher::FNVFrameRangeShardLauncher(int32 InTotalFrameCount, int32 InShardCount, int32 InRandomSeed, const FString& InMergedDirectory)
+{
+    ensure((InTotalFrameCount > 0) && (InShardCount > 0));
+    const int32 ShardCount = FMath::Max(1, InShardCount);
+    for (int32 ShardIndex = 0; ShardIndex < ShardCount; ShardIndex++)
+    {
+        Shards.Add(FNVFrameRangeShard::MakeShard(FMath::Max(0, InTotalFrameCount), ShardCount, ShardIndex, InRandomSeed));
+    }
+    MergedDirectory = InMergedDirectory;
+    bRunning = false;
+    bSucceeded = false;
+    LaunchTimestamp = 0.0;
+}
+
+FNVFrameRangeShardLauncher::~FNVFrameRangeShardLauncher()
+{
+    // The children can't be merged anymore, don't leave them running
+    for (FProcHandle& ChildProcess : ChildProcesses)
+    {
+        if (ChildProcess.IsValid())
+        {
+            if (FPlatformProcess::IsProcRunning(ChildProcess))
+            {
+                FPlatformProcess::TerminateProc(ChildProcess, true);
+            }
+            FPlatformProcess::CloseProc(ChildProcess);
+        }
+    }
+}
+
+FString FNVFrameRangeShardLauncher::GetShardDirectory(int32 ShardIndex) const
+{
+    return FPaths::Combine(MergedDirectory, ShardsStagingDirectoryName, FString::Printf(TEXT("shard_%03d"), ShardIndex));
+}
+
+FString FNVFrameRangeShardLauncher::MakeChildCommandLine(const FString& BaseCommandLine, const FNVFrameRangeShard& Shard, const FString& ShardDirectory)
+{
+    FString ChildCommandLine;
+    for (const FString& Argument : SplitCommandLine(BaseCommandLine))
+    {
+        bool bIsShardingArgument = false;
+        for (const TCHAR* ArgumentKey : ShardingArgumentKeys)
+        {
+            if (Argument.StartsWith(ArgumentKey))
+            {
+                bIsShardingArgument = true;
+                break;
+            }
+        }
+
+        if (!bIsShardingArgument)
+        {
+            ChildCommandLine += Argument + TEXT(" ");
+        }
+    }
+
+    ChildCommandLine += FString::Printf(TEXT("-ShardCount=%d -ShardIndex=%d -RandomSeed=%d -OutputPath=\"%s\""),
+                                        Shard.ShardCount, Shard.ShardIndex, Shard.RandomSeed, *ShardDirectory);
+    return ChildCommandLine;
+}
+
+bool FNVFrameRangeShardLauncher::Launch(const FString& BaseCommandLine)
+{
+    if (bRunning)
+    {
+        return false;
+    }
+
+    // Clean the outputs of the previous launch so the children don't move their output directory because of a conflict
+    IFileManager::Get().DeleteDirectory(*FPaths::Combine(MergedDirectory, ShardsStagingDirectoryName), false, true);
+
+    const FString ExecutablePath = FPlatformProcess::ExecutablePath();
+    ChildProcesses.Reset();
+    ChildReturnCodes.Init(INDEX_NONE, Shards.Num());
+    for (const FNVFrameRangeShard& Shard : Shards)
+    {
+        const FString ChildCommandLine = MakeChildCommandLine(BaseCommandLine, Shard, GetShardDirectory(Shard.ShardIndex));
+        UE_LOG(LogNVSceneCapturer, Log, TEXT("Launching frame range shard %d / %d - frames [%d, %d) - seed %d: %s %s"),
+            Shard.ShardIndex, Shard.ShardCount, Shard.FrameOffset, Shard.GetEndFrame(), Shard.GetShardSeed(), *ExecutablePath, *ChildCommandLine);
+
+        FProcHandle ChildProcess = FPlatformProcess::CreateProc(*ExecutablePath, *ChildCommandLine, false, true, true, nullptr, 0, nullptr, nullptr);
+        if (!ChildProcess.IsValid())
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't launch the capturer process of frame range shard %d."), Shard.ShardIndex);
+        }
+        ChildProcesses.Add(ChildProcess);
+    }
+
+    bRunning = true;
+    bSucceeded = false;
+    LaunchTimestamp = FPlatformTime::Seconds();
+    return true;
+}
+
+bool FNVFrameRangeShardLauncher::Update()
+{
+    if (!bRunning)
+    {
+        return true;
+    }
+
+    bool bAllChildrenExited = true;
+    for (int32 i = 0; i < ChildProcesses.Num(); i++)
+    {
+        FProcHandle& ChildProcess = ChildProcesses[i];
+        if (!ChildProcess.IsValid())
+        {
+            continue;
+        }
+
+        if (FPlatformProcess::IsProcRunning(ChildProcess))
+        {
+            bAllChildrenExited = false;
+        }
+        else
+        {
+            FPlatformProcess::GetProcReturnCode(ChildProcess, &ChildReturnCodes[i]);
+            FPlatformProcess::CloseProc(ChildProcess);
+            ChildProcess.Reset();
+            UE_LOG(LogNVSceneCapturer, Log, TEXT("Frame range shard %d exited with code %d."), i, ChildReturnCodes[i]);
+        }
+    }
+
+    if (bAllChildrenExited)
+    {
+        MergeShardOutputs();
+        bRunning = false;
+    }
+    return !bRunning;
+}
+
+void FNVFrameRangeShardLauncher::MergeShardOutputs()
+{
+    TArray<FString> ShardDirectories;
+    for (const FNVFrameRangeShard& Shard : Shards)
+    {
+        ShardDirectories.Add(GetShardDirectory(Shard.ShardIndex));
+    }
+
+    FNVFrameRangeMergeData MergeData;
+    bSucceeded = FNVFrameRangeShard::MergeShardOutputs(Shards, ShardDirectories, MergedDirectory, MergeData);
+    if (bSucceeded)
+    {
+        // Every file was moved or copied to the merged directory
+        IFileManager::Get().DeleteDirectory(*FPaths::Combine(MergedDirectory, ShardsStagingDirectoryName), false, true);
+    }
+
+    UE_LOG(LogNVSceneCapturer, Log, TEXT("Merged %d frame range shards into '%s' in %.2fs: %d / %d frames - %s."),
+        Shards.Num(), *MergedDirectory, FPlatformTime::Seconds() - LaunchTimestamp,
+        MergeData.merged_frame_count, MergeData.total_frame_count, bSucceeded ? TEXT("succeeded") : TEXT("failed"));
+}
@@ -6,9 +6,13 @@
 
 #include "NVSceneCapturerModule.h"
 #include "NVImageExporter.h"
+#include "NVQOICodec.h"
 #include "HAL/Runnable.h"
 #include "HAL/RunnableThread.h"
-#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "RHI.h"
 #include "FileManager.h"
 #include "ImageUtils.h"
 #include "IImageWrapperModule.h"
@@ -156,9 +160,9 @@ TArray<uint8> FNVImageExporter::CompressImagePNG(const FNVTexturePixelData& Sour
     EPixelFormat ImgPixelFormat = SourcePixelData.PixelFormat;
 	if (ensure(CanPixelFormatBeExported(ImgPixelFormat)))
     {
-        // NOTE: This code is similar to FImageWrapperBase::SetRaw
-        TArray<uint8> RawData = SourcePixelData.PixelData;
-        if (RawData.Num() <= 0)
+        // NOTE: This code is similar to FImageWrapperBase::SetRaw but it use the shared pixels buffer directly instead of copying it
+        const uint8* RawData = SourcePixelData.GetPixels();
+        if (SourcePixelData.GetPixelsByteSize() <= 0)
         {
             UE_LOG(LogNVSceneCapturer, Error, TEXT("Number of Pixels is 0."));
         }
@@ -209,9 +213,10 @@ TArray<uint8> FNVImageExporter::CompressImagePNG(const FNVTexturePixelData& Sour
 							const uint32 BytesPerPixel = (RawBitDepth * PixelChannels) / 8;
 							const uint32 BytesPerRow = BytesPerPixel * Width;
 
+							// NOTE: libpng copies each row to its own buffer before applying the transforms so the shared pixels are never modified
 							for (int32 i = 0; i < Height; i++)
 							{
-								row_pointers[i] = &RawData[i * BytesPerRow];
+								row_pointers[i] = const_cast<png_bytep>(&RawData[i * BytesPerRow]);
 							}
 							png_set_rows(png_ptr, info_ptr, row_pointers);
 
@@ -248,12 +253,276 @@ TArray<uint8> FNVImageExporter::CompressImagePNG(const FNVTexturePixelData& Sour
     return CompressedData;
 }
 
+#if WITH_UNREALPNG
+static void AppendBigEndianUInt32(TArray<uint8>& OutData, uint32 Value)
+{
+    OutData.Add((Value >> 24) & 0xFF);
+    OutData.Add((Value >> 16) & 0xFF);
+    OutData.Add((Value >> 8) & 0xFF);
+    OutData.Add(Value & 0xFF);
+}
+
+// Start a PNG chunk by appending its length and type, return the offset of the chunk's type
+static int32 BeginPNGChunk(TArray<uint8>& OutData, const char* ChunkType, uint32 ChunkSize)
+{
+    AppendBigEndianUInt32(OutData, ChunkSize);
+    const int32 ChunkTypeOffset = OutData.Num();
+    OutData.Append((const uint8*)ChunkType, 4);
+    return ChunkTypeOffset;
+}
+
+// Finish a PNG chunk by appending its CRC, which covers the chunk's type and data
+static void EndPNGChunk(TArray<uint8>& OutData, int32 ChunkTypeOffset)
+{
+    const uLong ChunkCRC = crc32(crc32(0L, Z_NULL, 0), OutData.GetData() + ChunkTypeOffset, OutData.Num() - ChunkTypeOffset);
+    AppendBigEndianUInt32(OutData, ChunkCRC);
+}
+
+// Compressed data of a band of rows
+struct FNVPNGBandData
+{
+    TArray<uint8> CompressedData;
+    uLong Adler;
+    uLong FilteredByteSize;
+    bool bSucceeded;
+};
+#endif // WITH_UNREALPNG
+
+TArray<uint8> FNVImageExporter::CompressImagePNG_Parallel(const FNVTexturePixelData& SourcePixelData, int32 NumberOfBands /*= 0*/)
+{
+#if WITH_UNREALPNG
+    const EPixelFormat ImgPixelFormat = SourcePixelData.PixelFormat;
+    uint8 RawBitDepth = 32;
+    ERGBFormat RawFormat = ERGBFormat::BGRA;
+    const uint8* RawData = SourcePixelData.GetPixels();
+    if (!RawData || !CanPixelFormatBeExported(ImgPixelFormat) || !GetExportedImageSettings(ImgPixelFormat, RawBitDepth, RawFormat))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return TArray<uint8>();
+    }
+
+    const int32 Width = SourcePixelData.PixelSize.X;
+    const int32 Height = SourcePixelData.PixelSize.Y;
+    const bool bIsGrayscale = (RawFormat == ERGBFormat::Gray);
+    const uint32 PixelChannels = bIsGrayscale ? 1 : 4;
+    const uint32 BytesPerSample = RawBitDepth / 8;
+    const uint32 BytesPerPixel = BytesPerSample * PixelChannels;
+    const uint32 BytesPerRow = BytesPerPixel * Width;
+    if ((Width <= 0) || (Height <= 0) || (SourcePixelData.GetPixelsByteSize() < (int32)(BytesPerRow * Height)))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return TArray<uint8>();
+    }
+
+    // NOTE: Each band restart the deflate window so the bands shouldn't be too small
+    static const int32 MinRowsPerBand = 32;
+    if (NumberOfBands <= 0)
+    {
+        NumberOfBands = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+    }
+    const int32 RowsPerBand = FMath::Max(MinRowsPerBand, FMath::DivideAndRoundUp(Height, NumberOfBands));
+    const int32 BandCount = FMath::DivideAndRoundUp(Height, RowsPerBand);
+
+    TArray<FNVPNGBandData> BandDataList;
+    BandDataList.SetNum(BandCount);
+
+    // Filter and deflate each band of rows in parallel
+    // Each band is a raw deflate stream ended with a sync flush (the last one with a finish)
+    // so they can be concatenated into one valid zlib stream, the same way pigz does it
+    ParallelFor(BandCount, [&](int32 BandIndex)
+    {
+        FNVPNGBandData& BandData = BandDataList[BandIndex];
+        BandData.bSucceeded = false;
+
+        const int32 StartRow = BandIndex * RowsPerBand;
+        const int32 EndRow = FMath::Min(Height, StartRow + RowsPerBand);
+        const uint32 FilteredRowByteSize = BytesPerRow + 1;
+
+        TArray<uint8> FilteredRows;
+        FilteredRows.SetNumUninitialized((EndRow - StartRow) * FilteredRowByteSize);
+        TArray<uint8> TransformedRow;
+        TransformedRow.SetNumUninitialized(BytesPerRow);
+
+        uint8* FilteredPtr = FilteredRows.GetData();
+        for (int32 Row = StartRow; Row < EndRow; Row++)
+        {
+            // Apply the same transforms the libpng encoder use: BGR to RGB and 16 bits samples to big-endian
+            const uint8* SrcRow = RawData + Row * BytesPerRow;
+            uint8* DestRow = TransformedRow.GetData();
+            for (int32 X = 0; X < Width; X++)
+            {
+                const uint8* SrcPixel = SrcRow + X * BytesPerPixel;
+                uint8* DestPixel = DestRow + X * BytesPerPixel;
+                for (uint32 Channel = 0; Channel < PixelChannels; Channel++)
+                {
+                    const uint32 SrcChannel = (!bIsGrayscale && (Channel != 1) && (Channel != 3)) ? (2 - Channel) : Channel;
+                    const uint8* SrcSample = SrcPixel + SrcChannel * BytesPerSample;
+                    uint8* DestSample = DestPixel + Channel * BytesPerSample;
+                    if (BytesPerSample == 2)
+                    {
+#if PLATFORM_LITTLE_ENDIAN
+                        DestSample[0] = SrcSample[1];
+                        DestSample[1] = SrcSample[0];
+#else
+                        DestSample[0] = SrcSample[0];
+                        DestSample[1] = SrcSample[1];
+#endif
+                    }
+                    else
+                    {
+                        DestSample[0] = SrcSample[0];
+                    }
+                }
+            }
+
+            // Use the Sub filter since it only depends on the current row
+            FilteredPtr[0] = 1;
+            for (uint32 i = 0; i < BytesPerRow; i++)
+            {
+                const uint8 Left = (i >= BytesPerPixel) ? DestRow[i - BytesPerPixel] : 0;
+                FilteredPtr[i + 1] = DestRow[i] - Left;
+            }
+            FilteredPtr += FilteredRowByteSize;
+        }
+
+        BandData.FilteredByteSize = FilteredRows.Num();
+        BandData.Adler = adler32(adler32(0L, Z_NULL, 0), FilteredRows.GetData(), FilteredRows.Num());
+
+        z_stream Stream;
+        FMemory::Memzero(&Stream, sizeof(Stream));
+        // NOTE: Negative window bits mean a raw deflate stream without the zlib header and trailer
+        if (deflateInit2(&Stream, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return;
+        }
+
+        const bool bIsLastBand = (BandIndex == BandCount - 1);
+        const int32 FlushMode = bIsLastBand ? Z_FINISH : Z_SYNC_FLUSH;
+        Stream.next_in = FilteredRows.GetData();
+        Stream.avail_in = FilteredRows.Num();
+
+        TArray<uint8>& CompressedData = BandData.CompressedData;
+        const uint32 OutputChunkSize = deflateBound(&Stream, FilteredRows.Num()) + 64;
+        int32 Result = Z_OK;
+        while (true)
+        {
+            const int32 OutputOffset = CompressedData.AddUninitialized(OutputChunkSize);
+            Stream.next_out = CompressedData.GetData() + OutputOffset;
+            Stream.avail_out = OutputChunkSize;
+
+            Result = deflate(&Stream, FlushMode);
+            CompressedData.SetNum(Stream.total_out, false);
+
+            if ((Result == Z_STREAM_END) || ((Result == Z_OK) && (Stream.avail_out != 0)))
+            {
+                break;
+            }
+            if ((Result != Z_OK) && (Result != Z_BUF_ERROR))
+            {
+                break;
+            }
+        }
+        deflateEnd(&Stream);
+
+        BandData.bSucceeded = bIsLastBand ? (Result == Z_STREAM_END) : (Result == Z_OK);
+    });
+
+    // Stitch the bands together into one zlib stream
+    uint32 TotalCompressedSize = 0;
+    uLong CombinedAdler = adler32(0L, Z_NULL, 0);
+    for (int32 BandIndex = 0; BandIndex < BandCount; BandIndex++)
+    {
+        const FNVPNGBandData& BandData = BandDataList[BandIndex];
+        if (!BandData.bSucceeded)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Failed to compress the PNG image's rows."));
+            return TArray<uint8>();
+        }
+        TotalCompressedSize += BandData.CompressedData.Num();
+        CombinedAdler = (BandIndex == 0) ? BandData.Adler : adler32_combine(CombinedAdler, BandData.Adler, BandData.FilteredByteSize);
+    }
+
+    TArray<uint8> CompressedData;
+    CompressedData.Reserve(8 + 25 + (12 + 2 + TotalCompressedSize + 4) + 12);
+
+    static const uint8 PNGSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    CompressedData.Append(PNGSignature, 8);
+
+    int32 ChunkTypeOffset = BeginPNGChunk(CompressedData, "IHDR", 13);
+    AppendBigEndianUInt32(CompressedData, Width);
+    AppendBigEndianUInt32(CompressedData, Height);
+    CompressedData.Add(RawBitDepth);
+    CompressedData.Add(bIsGrayscale ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGBA);
+    CompressedData.Add(PNG_COMPRESSION_TYPE_DEFAULT);
+    CompressedData.Add(PNG_FILTER_TYPE_DEFAULT);
+    CompressedData.Add(PNG_INTERLACE_NONE);
+    EndPNGChunk(CompressedData, ChunkTypeOffset);
+
+    // Put the whole zlib stream in one IDAT chunk
+    ChunkTypeOffset = BeginPNGChunk(CompressedData, "IDAT", 2 + TotalCompressedSize + 4);
+    // zlib header: deflate with 32K window, fastest compression level
+    CompressedData.Add(0x78);
+    CompressedData.Add(0x01);
+    for (const FNVPNGBandData& BandData : BandDataList)
+    {
+        CompressedData.Append(BandData.CompressedData);
+    }
+    AppendBigEndianUInt32(CompressedData, CombinedAdler);
+    EndPNGChunk(CompressedData, ChunkTypeOffset);
+
+    ChunkTypeOffset = BeginPNGChunk(CompressedData, "IEND", 0);
+    EndPNGChunk(CompressedData, ChunkTypeOffset);
+
+    return CompressedData;
+#else
+    return CompressImagePNG(SourcePixelData);
+#endif // WITH_UNREALPNG
+}
+
+TArray<uint8> FNVImageExporter::CompressImageQOI(const FNVTexturePixelData& SourcePixelData)
+{
+    uint8 RawBitDepth = 32;
+    ERGBFormat RawFormat = ERGBFormat::BGRA;
+    if (!GetExportedImageSettings(SourcePixelData.PixelFormat, RawBitDepth, RawFormat)
+        || (RawBitDepth != 8) || (RawFormat != ERGBFormat::BGRA))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
+        return TArray<uint8>();
+    }
+
+    const FIntPoint& ImageSize = SourcePixelData.PixelSize;
+    if (SourcePixelData.GetPixelsByteSize() < ImageSize.X * ImageSize.Y * 4)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return TArray<uint8>();
+    }
+
+    const bool bIsBGRA = true;
+    return NVQOICodec::Encode(SourcePixelData.GetPixels(), ImageSize.X, ImageSize.Y, bIsBGRA);
+}
+
+ENVImageFormat FNVImageExporter::GetSupportedExportImageFormat(ENVImageFormat RequestedImageFormat, EPixelFormat ImagePixelFormat)
+{
+    if (RequestedImageFormat == ENVImageFormat::QOI)
+    {
+        uint8 RawBitDepth = 32;
+        ERGBFormat RawFormat = ERGBFormat::BGRA;
+        const bool bCanUseQOI = GetExportedImageSettings(ImagePixelFormat, RawBitDepth, RawFormat)
+            && (RawBitDepth == 8) && (RawFormat == ERGBFormat::BGRA);
+        if (!bCanUseQOI)
+        {
+            return ENVImageFormat::PNG;
+        }
+    }
+    return RequestedImageFormat;
+}
+
 TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapperModule, const FNVTexturePixelData& SourcePixelData,
-        ENVImageFormat ImageFormat, uint8 CompressionQuality/*= 100*/)
+        ENVImageFormat ImageFormat, uint8 CompressionQuality/*= 100*/, const FNVImageExporterSettings* ExporterSettings/*= nullptr*/)
 {
     TArray<uint8> CompressedData;
     CompressedData.Reset();
-    const auto& PixelData = SourcePixelData.PixelData;
+    const auto& PixelData = SourcePixelData.GetPixelData();
     const uint32 PixelCount = PixelData.Num();
 
     if ((PixelCount == 0) ||                    // The source pixels data must be valid
@@ -263,8 +532,19 @@ TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapper
         return CompressedData;
     }
 
+    if (ImageFormat == ENVImageFormat::QOI)
+    {
+        return CompressImageQOI(SourcePixelData);
+    }
+
     if (ImageFormat == ENVImageFormat::PNG)
     {
+        // Split the big images into bands of rows and compress them in parallel
+        const int64 ParallelMinByteSize = ExporterSettings ? (int64)ExporterSettings->ParallelPNGCompressionMinSizeKB * 1024 : 0;
+        if ((ParallelMinByteSize > 0) && (PixelCount >= ParallelMinByteSize))
+        {
+            return CompressImagePNG_Parallel(SourcePixelData);
+        }
         return CompressImagePNG(SourcePixelData);
     }
 
@@ -282,6 +562,7 @@ TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapper
 	{
 		const auto& ImageSize = SourcePixelData.PixelSize;
 
+		// NOTE: The image wrapper keeps its own copy of the raw data
 		const void* RawData = (void*)PixelData.GetData();
 		int32 AllocatedSize = PixelData.GetAllocatedSize();
 		ImageWrapper->SetRaw(RawData, AllocatedSize, ImageSize.X, ImageSize.Y, ImgRGBFormat, ImgBitDepth);
@@ -296,11 +577,11 @@ TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapper
     return CompressedData;
 }
 
-bool FNVImageExporter::ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData)
+bool FNVImageExporter::ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData, const FNVImageExporterSettings* ExporterSettings/*= nullptr*/)
 {
 	bool bResult = false;
 	const auto& ExportedPixelData = ImageExporterData.PixelDataToBeExported;
-	const auto& PixelData = ExportedPixelData.PixelData;
+	const auto& PixelData = ExportedPixelData.GetPixelData();
 	const auto& ExportFilePath = ImageExporterData.ExportFilePath;
 	const auto& ExportImageFormat = ImageExporterData.ExportImageFormat;
 	uint32 PixelCount = PixelData.Num();
@@ -310,12 +591,13 @@ bool FNVImageExporter::ExportImage(IImageWrapperModule* ImageWrapperModule, cons
 		if (ExportImageFormat == ENVImageFormat::BMP)
 		{
 			const auto& ImageSize = ExportedPixelData.PixelSize;
-			bResult = FFileHelper::CreateBitmap(*ExportFilePath, ImageSize.X, ImageSize.Y, (FColor*)((void*)PixelData.GetData()));
+			// NOTE: CreateBitmap only read the pixels
+			bResult = FFileHelper::CreateBitmap(*ExportFilePath, ImageSize.X, ImageSize.Y, (FColor*)(const_cast<uint8*>(PixelData.GetData())));
 		}
 		else
 		{
 			const uint8 CompressedQuality = 100;
-			const TArray<uint8>& CompressedBitmap = CompressImage(ImageWrapperModule, ExportedPixelData, ExportImageFormat, CompressedQuality);
+			const TArray<uint8>& CompressedBitmap = CompressImage(ImageWrapperModule, ExportedPixelData, ExportImageFormat, CompressedQuality, ExporterSettings);
 			bResult = FFileHelper::SaveArrayToFile(CompressedBitmap, *ExportFilePath);
 		}
 		if (!bResult)
@@ -331,128 +613,679 @@ bool FNVImageExporter::ExportImage(const FNVImageExporterData& ImageExporterData
 	return FNVImageExporter::ExportImage(ImageWrapperModule, ImageExporterData);
 }
 
-//====================================== FNVSaveImageToFileThread ==========================================
-FNVImageExporter_Thread::FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule)
-    : ImageWrapperModule(InImageWrapperModule)
+// Verify a PNG image can be decoded by the engine's PNG reader and it match the source pixels
+static bool VerifyPNGImage(IImageWrapperModule* ImageWrapperModule, const TArray<uint8>& CompressedData, const FNVTexturePixelData& SourcePixelData)
+{
+    uint8 RawBitDepth = 32;
+    ERGBFormat RawFormat = ERGBFormat::BGRA;
+    if (!ImageWrapperModule || !GetExportedImageSettings(SourcePixelData.PixelFormat, RawBitDepth, RawFormat))
+    {
+        return false;
+    }
+
+    TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule->CreateImageWrapper(EImageFormat::PNG);
+    if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(CompressedData.GetData(), CompressedData.Num()))
+    {
+        return false;
+    }
+
+    const TArray<uint8>* DecodedData = nullptr;
+    if (!ImageWrapper->GetRaw(RawFormat, RawBitDepth, DecodedData) || !DecodedData)
+    {
+        return false;
+    }
+
+    const TArray<uint8>& SourceData = SourcePixelData.GetPixelData();
+    return (DecodedData->Num() == SourceData.Num()) && (FMemory::Memcmp(DecodedData->GetData(), SourceData.GetData(), SourceData.Num()) == 0);
+}
+
+void FNVImageExporter::BenchmarkPNGEncoders(IImageWrapperModule* ImageWrapperModule, const FIntPoint& ImageSize, int32 IterationCount)
 {
     ensure(ImageWrapperModule);
+    if (!ImageWrapperModule || (ImageSize.X <= 0) || (ImageSize.Y <= 0) || (IterationCount <= 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
 
-    bIsRunning = false;
+    const EPixelFormat BenchmarkPixelFormats[] = { PF_B8G8R8A8, PF_R8G8, PF_A16B16G16R16 };
+    for (const EPixelFormat CheckPixelFormat : BenchmarkPixelFormats)
+    {
+        // Build a synthetic frame: smooth gradients with some noise so it's neither trivial nor impossible to compress
+        const uint8 PixelByteSize = NVSceneCapturerUtils::GetPixelByteSize(CheckPixelFormat);
+        TArray<uint8> SyntheticPixels;
+        SyntheticPixels.SetNumUninitialized(ImageSize.X * ImageSize.Y * PixelByteSize);
+        FRandomStream RandomStream(ImageSize.X * 31 + ImageSize.Y);
+        for (int32 Y = 0; Y < ImageSize.Y; Y++)
+        {
+            for (int32 X = 0; X < ImageSize.X; X++)
+            {
+                uint8* PixelPtr = SyntheticPixels.GetData() + (Y * ImageSize.X + X) * PixelByteSize;
+                for (int32 i = 0; i < PixelByteSize; i++)
+                {
+                    const int32 Gradient = (X * (i + 1) + Y * (PixelByteSize - i)) / 4;
+                    PixelPtr[i] = (uint8)(Gradient + (RandomStream.RandRange(0, 3)));
+                }
+            }
+        }
 
-    PendingImageCounter.Reset();
+        FNVTexturePixelData BenchmarkPixelData;
+        BenchmarkPixelData.PixelFormat = CheckPixelFormat;
+        BenchmarkPixelData.PixelSize = ImageSize;
+        BenchmarkPixelData.RowStride = ImageSize.X * PixelByteSize;
+        BenchmarkPixelData.SetPixelData(MoveTemp(SyntheticPixels));
+
+        const double RawMegaBytes = BenchmarkPixelData.GetPixelsByteSize() / (1024.0 * 1024.0);
+
+        TArray<uint8> SingleThreadData;
+        const double SingleThreadStartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < IterationCount; i++)
+        {
+            SingleThreadData = CompressImagePNG(BenchmarkPixelData);
+        }
+        const double SingleThreadDuration = (FPlatformTime::Seconds() - SingleThreadStartTime) / IterationCount;
+
+        TArray<uint8> ParallelData;
+        const double ParallelStartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < IterationCount; i++)
+        {
+            ParallelData = CompressImagePNG_Parallel(BenchmarkPixelData);
+        }
+        const double ParallelDuration = (FPlatformTime::Seconds() - ParallelStartTime) / IterationCount;
+
+        const bool bSingleThreadValid = VerifyPNGImage(ImageWrapperModule, SingleThreadData, BenchmarkPixelData);
+        const bool bParallelValid = VerifyPNGImage(ImageWrapperModule, ParallelData, BenchmarkPixelData);
+
+        UE_LOG(LogNVSceneCapturer, Display, TEXT("PNG benchmark %s %dx%d (%.2f MB): single thread %.2f ms (%.1f MB/s, %d bytes, %s) - parallel %.2f ms (%.1f MB/s, %d bytes, %s)"),
+            GetPixelFormatString(CheckPixelFormat), ImageSize.X, ImageSize.Y, RawMegaBytes,
+            SingleThreadDuration * 1000.0, RawMegaBytes / FMath::Max(SingleThreadDuration, SMALL_NUMBER), SingleThreadData.Num(), bSingleThreadValid ? TEXT("valid") : TEXT("INVALID"),
+            ParallelDuration * 1000.0, RawMegaBytes / FMath::Max(ParallelDuration, SMALL_NUMBER), ParallelData.Num(), bParallelValid ? TEXT("valid") : TEXT("INVALID"));
+    }
+}
+
+void FNVImageExporter::BenchmarkQOIEncoder(const FIntPoint& ImageSize, int32 IterationCount)
+{
+    if ((ImageSize.X <= 0) || (ImageSize.Y <= 0) || (IterationCount <= 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
+
+    // Build a synthetic frame: smooth gradients with some noise and flat areas, similar to a rendered scene
+    const int32 PixelByteSize = 4;
+    TArray<uint8> SyntheticPixels;
+    SyntheticPixels.SetNumUninitialized(ImageSize.X * ImageSize.Y * PixelByteSize);
+    FRandomStream RandomStream(ImageSize.X * 31 + ImageSize.Y);
+    for (int32 Y = 0; Y < ImageSize.Y; Y++)
+    {
+        for (int32 X = 0; X < ImageSize.X; X++)
+        {
+            uint8* PixelPtr = SyntheticPixels.GetData() + (Y * ImageSize.X + X) * PixelByteSize;
+            const bool bIsFlatArea = ((X / 64 + Y / 64) % 3) == 0;
+            PixelPtr[0] = bIsFlatArea ? 32 : (uint8)(X / 4 + RandomStream.RandRange(0, 3));
+            PixelPtr[1] = bIsFlatArea ? 96 : (uint8)(Y / 4 + RandomStream.RandRange(0, 3));
+            PixelPtr[2] = bIsFlatArea ? 160 : (uint8)((X + Y) / 8 + RandomStream.RandRange(0, 3));
+            PixelPtr[3] = 255;
+        }
+    }
+
+    FNVTexturePixelData BenchmarkPixelData;
+    BenchmarkPixelData.PixelFormat = PF_B8G8R8A8;
+    BenchmarkPixelData.PixelSize = ImageSize;
+    BenchmarkPixelData.RowStride = ImageSize.X * PixelByteSize;
+    BenchmarkPixelData.SetPixelData(MoveTemp(SyntheticPixels));
+
+    const double RawMegaBytes = BenchmarkPixelData.GetPixelsByteSize() / (1024.0 * 1024.0);
+
+    TArray<uint8> PNGData;
+    const double PNGStartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < IterationCount; i++)
+    {
+        PNGData = CompressImagePNG(BenchmarkPixelData);
+    }
+    const double PNGDuration = (FPlatformTime::Seconds() - PNGStartTime) / IterationCount;
+
+    TArray<uint8> QOIData;
+    const double QOIStartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < IterationCount; i++)
+    {
+        QOIData = CompressImageQOI(BenchmarkPixelData);
+    }
+    const double QOIDuration = (FPlatformTime::Seconds() - QOIStartTime) / IterationCount;
+
+    TArray<uint8> DecodedPixels;
+    int32 DecodedWidth = 0;
+    int32 DecodedHeight = 0;
+    const double DecodeStartTime = FPlatformTime::Seconds();
+    const bool bOutputBGRA = true;
+    const bool bDecoded = NVQOICodec::Decode(QOIData.GetData(), QOIData.Num(), DecodedPixels, DecodedWidth, DecodedHeight, bOutputBGRA);
+    const double DecodeDuration = FPlatformTime::Seconds() - DecodeStartTime;
+    const bool bQOIValid = bDecoded && (DecodedWidth == ImageSize.X) && (DecodedHeight == ImageSize.Y)
+        && (FMemory::Memcmp(DecodedPixels.GetData(), BenchmarkPixelData.GetPixels(), DecodedPixels.Num()) == 0);
+
+    const float PNGSizeRatio = (float)PNGData.Num() / BenchmarkPixelData.GetPixelsByteSize();
+    const float QOISizeRatio = (float)QOIData.Num() / BenchmarkPixelData.GetPixelsByteSize();
+    UE_LOG(LogNVSceneCapturer, Display, TEXT("QOI benchmark BGRA8 %dx%d (%.2f MB): PNG encode %.1f MB/s (size ratio %.3f) - QOI encode %.1f MB/s (size ratio %.3f), decode %.1f MB/s, %s"),
+        ImageSize.X, ImageSize.Y, RawMegaBytes,
+        RawMegaBytes / FMath::Max(PNGDuration, SMALL_NUMBER), PNGSizeRatio,
+        RawMegaBytes / FMath::Max(QOIDuration, SMALL_NUMBER), QOISizeRatio,
+        RawMegaBytes / FMath::Max(DecodeDuration, SMALL_NUMBER), bQOIValid ? TEXT("valid") : TEXT("INVALID"));
+}
+
+static FAutoConsoleCommand BenchmarkQOIEncoderCommand(
+    TEXT("NV.BenchmarkQOIEncoder"),
+    TEXT("Compare the QOI encoder with the PNG encoder on a synthetic frame. Usage: NV.BenchmarkQOIEncoder [Width] [Height] [IterationCount]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+    {
+        const int32 Width = (Args.Num() > 0) ? FCString::Atoi(*Args[0]) : 3840;
+        const int32 Height = (Args.Num() > 1) ? FCString::Atoi(*Args[1]) : 2160;
+        const int32 IterationCount = (Args.Num() > 2) ? FCString::Atoi(*Args[2]) : 5;
+        FNVImageExporter::BenchmarkQOIEncoder(FIntPoint(Width, Height), IterationCount);
+    })
+);
+
+static FAutoConsoleCommand BenchmarkPNGEncodersCommand(
+    TEXT("NV.BenchmarkPNGEncoders"),
+    TEXT("Compare the single thread and the parallel PNG encoders on synthetic frames. Usage: NV.BenchmarkPNGEncoders [Width] [Height] [IterationCount]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+    {
+        const int32 Width = (Args.Num() > 0) ? FCString::Atoi(*Args[0]) : 3840;
+        const int32 Height = (Args.Num() > 1) ? FCString::Atoi(*Args[1]) : 2160;
+        const int32 IterationCount = (Args.Num() > 2) ? FCString::Atoi(*Args[2]) : 5;
+        IImageWrapperModule* ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+        FNVImageExporter::BenchmarkPNGEncoders(ImageWrapperModule, FIntPoint(Width, Height), IterationCount);
+    })
+);
+
+//====================================== FNVImageExporterSettings ==========================================
+FNVImageExporterSettings::FNVImageExporterSettings()
+{
+    NumberOfWorkerThreads = 0;
+    MaxQueuedImageCount = 64;
+    WorkerThreadAffinityMask = 0;
+    bPinEachWorkerToOneCore = false;
+    ParallelPNGCompressionMinSizeKB = 2048;
+    MemoryBudgetMB = 2048;
+    MemoryBudgetHighWatermark = 0.9f;
+    MemoryBudgetLowWatermark = 0.6f;
+}
+
+int64 FNVImageExporterSettings::GetMemoryBudgetByteSize() const
+{
+    return (int64)FMath::Max(MemoryBudgetMB, 0) * 1024 * 1024;
+}
+
+int32 FNVImageExporterSettings::GetNumberOfWorkerThreads() const
+{
+    if (NumberOfWorkerThreads > 0)
+    {
+        return NumberOfWorkerThreads;
+    }
+
+    // Leave some cores for the game, rendering and the engine's task graph
+    return FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 2);
+}
+
+uint64 FNVImageExporterSettings::GetWorkerThreadAffinityMask(int32 WorkerIndex) const
+{
+    const uint64 AffinityMask = (uint64)WorkerThreadAffinityMask;
+    if (AffinityMask == 0)
+    {
+        return FPlatformAffinity::GetNoAffinityMask();
+    }
+
+    if (!bPinEachWorkerToOneCore)
+    {
+        return AffinityMask;
+    }
+
+    // Pick the cores in the mask in round-robin order
+    const int32 CoreCount = FMath::CountBits(AffinityMask);
+    int32 CoreOrder = WorkerIndex % CoreCount;
+    for (int32 BitIndex = 0; BitIndex < 64; BitIndex++)
+    {
+        const uint64 CoreBit = (uint64)1 << BitIndex;
+        if (AffinityMask & CoreBit)
+        {
+            if (CoreOrder == 0)
+            {
+                return CoreBit;
+            }
+            CoreOrder--;
+        }
+    }
+    return AffinityMask;
+}
+
+//====================================== FNVMemoryBudgetState ==========================================
+FNVMemoryBudgetState::FNVMemoryBudgetState()
+{
+    State = ENVMemoryBudgetState::Accepting;
+    RawByteSize = 0;
+    EncodedByteSize = 0;
+    BudgetByteSize = 0;
+    HighWatermarkByteSize = 0;
+    LowWatermarkByteSize = 0;
+    PendingItemCount = 0;
+}
+
+//====================================== FNVImageExporterStats ==========================================
+FNVImageExporterStats::FNVImageExporterStats()
+{
+    QueuedImageCount = 0;
+    PeakQueuedImageCount = 0;
+    ExportingImageCount = 0;
+    ExportedImageCount = 0;
+    AverageQueuedTime = 0.f;
+    AverageExportTime = 0.f;
+    MaxExportTime = 0.f;
+    BlockedTime = 0.f;
+    PixelsBufferCount = 0;
+    PeakMemoryInFlightMB = 0.f;
+    ThrottledCount = 0;
+}
+
+//====================================== FNVImageExporter_Thread ==========================================
+FNVImageExporter_Thread::FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule,
+        const FNVImageExporterSettings& InSettings /*= FNVImageExporterSettings()*/,
+        FNVEncodedDataWriter InEncodedDataWriter /*= nullptr*/)
+    : Settings(InSettings), EncodedDataWriter(InEncodedDataWriter), ImageWrapperModule(InImageWrapperModule)
+{
+    ensure(ImageWrapperModule);
 
-    ExportingImageCounterPtr = MakeShareable(new FThreadSafeCounter());
-    ExportingImageCounterPtr->Reset();
+    bIsRunning = true;
+
+    PendingImageCounter.Reset();
+    ExportingImageCounter.Reset();
+    RawByteSizeInFlight.Reset();
+    EncodedByteSizeInFlight.Reset();
+    bOverMemoryBudget = false;
 
     QueuedImageData.Empty();
 
-    HavePendingImageEvent = FPlatformProcess::GetSynchEventFromPool();
+    TotalQueuedTime = 0.0;
+    TotalExportTime = 0.0;
+    TotalBlockedTime = 0.0;
+
+    // NOTE: The events are auto-reset so each trigger only wake up one waiting thread
+    HavePendingImageEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    QueueHasSpaceEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    ImageExportedEvent = FPlatformProcess::GetSynchEventFromPool(false);
 
-    // TODO: May move this Thread to a Start function
-    // Create the thread for this task to run
-    static int32 ThreadIndex = 0;
-    const FString& ThreadName = FString::Printf(TEXT("NVSaveImageToFileThread_%d"), ++ThreadIndex);
+    // Create the worker threads
+    static int32 ExporterIndex = 0;
+    ++ExporterIndex;
+    const int32 WorkerCount = Settings.GetNumberOfWorkerThreads();
     const uint32 ThreadStackSize = 0;
-    const EThreadPriority& ThreadPriority = EThreadPriority::TPri_TimeCritical;
-    const uint64 ThreadAffinityMask = FPlatformAffinity::GetNoAffinityMask();
-    Thread = FRunnableThread::Create(this, *ThreadName, ThreadStackSize, ThreadPriority, ThreadAffinityMask);
+    // NOTE: The workers shouldn't take priority over the game and rendering threads
+    const EThreadPriority& ThreadPriority = EThreadPriority::TPri_BelowNormal;
+    for (int32 i = 0; i < WorkerCount; i++)
+    {
+        const FString& ThreadName = FString::Printf(TEXT("NVSaveImageToFileThread_%d_%d"), ExporterIndex, i);
+        const uint64 ThreadAffinityMask = Settings.GetWorkerThreadAffinityMask(i);
+
+        FNVImageExporter_Worker* NewWorker = new FNVImageExporter_Worker(this);
+        FRunnableThread* NewWorkerThread = FRunnableThread::Create(NewWorker, *ThreadName, ThreadStackSize, ThreadPriority, ThreadAffinityMask);
+        if (NewWorkerThread)
+        {
+            Workers.Add(NewWorker);
+            WorkerThreads.Add(NewWorkerThread);
+        }
+        else
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't create the image exporter thread: %s"), *ThreadName);
+            delete NewWorker;
+        }
+    }
 }
 
 FNVImageExporter_Thread::~FNVImageExporter_Thread()
 {
-    ImageWrapperModule = nullptr;
     Kill();
+    ImageWrapperModule = nullptr;
+
+    FPlatformProcess::ReturnSynchEventToPool(HavePendingImageEvent);
+    HavePendingImageEvent = nullptr;
+    FPlatformProcess::ReturnSynchEventToPool(QueueHasSpaceEvent);
+    QueueHasSpaceEvent = nullptr;
+    FPlatformProcess::ReturnSynchEventToPool(ImageExportedEvent);
+    ImageExportedEvent = nullptr;
 }
 
-bool FNVImageExporter_Thread::ExportImage(const FNVTexturePixelData& ExportPixelData, const FString& ExportFilePath, const ENVImageFormat ExportImageFormat/*= ENVImageFormat::PNG*/)
+bool FNVImageExporter_Thread::ExportImage(const FNVTexturePixelData& ExportPixelData, const FString& ExportFilePath, const ENVImageFormat ExportImageFormat/*= ENVImageFormat::PNG*/, int32 FrameIndex/*= INDEX_NONE*/, const FNVCaptureCreditPtr& CaptureCredit/*= nullptr*/)
 {
-    FNVImageExporterData NewImageExporterData = FNVImageExporterData(ExportPixelData, ExportFilePath, ExportImageFormat);
-    QueuedImageData.Enqueue(MoveTemp(NewImageExporterData));
-    PendingImageCounter.Increment();
+    // TODO: Check whether the image data are valid or not
+    FNVImageExporterData NewExporterData(ExportPixelData, ExportFilePath, ExportImageFormat, FrameIndex);
+    NewExporterData.CaptureCredit = CaptureCredit;
+    return EnqueueExporterData(MoveTemp(NewExporterData));
+}
 
-    if (HavePendingImageEvent)
+bool FNVImageExporter_Thread::ExportEncodedData(const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& EncodedData, const FString& ExportFilePath, int32 FrameIndex/*= INDEX_NONE*/, const FNVCaptureCreditPtr& CaptureCredit/*= nullptr*/)
+{
+    ensure(EncodedData.IsValid());
+    if (!EncodedData.IsValid())
     {
-        HavePendingImageEvent->Trigger();
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return false;
     }
 
-    // TODO: Check whether the image data are valid or not
+    FNVImageExporterData NewExporterData;
+    NewExporterData.EncodedData = EncodedData;
+    NewExporterData.ExportFilePath = ExportFilePath;
+    NewExporterData.FrameIndex = FrameIndex;
+    NewExporterData.CaptureCredit = CaptureCredit;
+    return EnqueueExporterData(MoveTemp(NewExporterData));
+}
+
+bool FNVImageExporter_Thread::EnqueueExporterData(FNVImageExporterData&& NewExporterData)
+{
+    if (!bIsRunning || (WorkerThreads.Num() == 0))
+    {
+        return false;
+    }
+
+    // Reserve a slot in the queue before adding the data so the producers (game thread and readback tasks) can't overshoot the bound together
+    // NOTE: The slot is taken with an atomic increment, a producer going over the bound give its slot back and wait for the workers to make room
+    const double StartBlockedTime = FPlatformTime::Seconds();
+    bool bBlocked = false;
+    int32 QueuedImageCount = PendingImageCounter.Increment();
+    while (bIsRunning && (Settings.MaxQueuedImageCount > 0) && (QueuedImageCount > Settings.MaxQueuedImageCount))
+    {
+        PendingImageCounter.Decrement();
+        bBlocked = true;
+        QueueHasSpaceEvent->Wait(10);
+        QueuedImageCount = PendingImageCounter.Increment();
+    }
+    if (bBlocked)
+    {
+        FScopeLock StatsScopeLock(&StatsLock);
+        TotalBlockedTime += FPlatformTime::Seconds() - StartBlockedTime;
+    }
+    if (!bIsRunning)
+    {
+        // The exporter stopped while the producer was waiting, release its slot
+        PendingImageCounter.Decrement();
+        return false;
+    }
+
+    NewExporterData.QueuedTimestamp = FPlatformTime::Seconds();
+    // NOTE: The data is counted before it's queued so a worker can't finish it before it's counted
+    UpdateByteSizeInFlight(GetRawByteSize(NewExporterData), GetEncodedByteSize(NewExporterData));
+    QueuedImageData.Enqueue(MoveTemp(NewExporterData));
+    {
+        FScopeLock StatsScopeLock(&StatsLock);
+        Stats.PeakQueuedImageCount = FMath::Max(Stats.PeakQueuedImageCount, QueuedImageCount);
+    }
+
+    HavePendingImageEvent->Trigger();
     return true;
 }
 
-uint32 FNVImageExporter_Thread::Run()
+bool FNVImageExporter_Thread::DequeueImageData(FNVImageExporterData& OutImageData)
 {
-    bIsRunning = true;
+    FScopeLock DequeueScopeLock(&DequeueLock);
+    if (QueuedImageData.Dequeue(OutImageData))
+    {
+        // NOTE: Increase the exporting counter before decrease the pending one so the image is always counted
+        ExportingImageCounter.Increment();
+        PendingImageCounter.Decrement();
+        return true;
+    }
+    return false;
+}
 
-    // How to run each exporting tasks
-    const EAsyncExecution AsyncExecution = EAsyncExecution::ThreadPool;
+void FNVImageExporter_Thread::ProcessQueuedImages()
+{
+    FNVImageExporterData TmpImageData;
+    while (bIsRunning && DequeueImageData(TmpImageData))
+    {
+        QueueHasSpaceEvent->Trigger();
+        // Wake up another worker if there are still images in the queue
+        if (!QueuedImageData.IsEmpty())
+        {
+            HavePendingImageEvent->Trigger();
+        }
+
+        const double StartExportTime = FPlatformTime::Seconds();
+        ExportQueuedData(TmpImageData);
+        const double EndExportTime = FPlatformTime::Seconds();
 
-    while (bIsRunning)
+        OnImageExported(StartExportTime - TmpImageData.QueuedTimestamp, EndExportTime - StartExportTime);
+        UpdateByteSizeInFlight(-GetRawByteSize(TmpImageData), -GetEncodedByteSize(TmpImageData));
+        // Release the exported data right away, this may retire the credit of its frame and let the capturer capture a new one
+        TmpImageData = FNVImageExporterData();
+        ExportingImageCounter.Decrement();
+        ImageExportedEvent->Trigger();
+    }
+}
+
+bool FNVImageExporter_Thread::ExportQueuedData(const FNVImageExporterData& ExporterData)
+{
+    if (ExporterData.EncodedData.IsValid())
     {
-        // Process all the queued frame data
-        while (!QueuedImageData.IsEmpty())
+        if (EncodedDataWriter)
+        {
+            return EncodedDataWriter(ExporterData, *ExporterData.EncodedData);
+        }
+
+        const bool bResult = FFileHelper::SaveArrayToFile(*ExporterData.EncodedData, *ExporterData.ExportFilePath);
+        if (!bResult)
         {
-            FNVImageExporterData TmpImageData;
-            QueuedImageData.Dequeue(TmpImageData);
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *ExporterData.ExportFilePath);
+        }
+        return bResult;
+    }
 
-            PendingImageCounter.Decrement();
+    // NOTE: The bitmaps are written straight from the raw pixels
+    if (!EncodedDataWriter && (ExporterData.ExportImageFormat == ENVImageFormat::BMP))
+    {
+        return FNVImageExporter::ExportImage(ImageWrapperModule, ExporterData, &Settings);
+    }
 
-            // TODO: Limit the number of exporting threads running at the same time
-            // Need to check if ExportingImageCounterPtr < ThreadThreshold
-            ExportingImageCounterPtr->Increment();
-            auto TempExportingImageCounterPtr = ExportingImageCounterPtr;
-            auto TempImageWrapperModule = ImageWrapperModule;
-            Async<void>(AsyncExecution, [TempExportingImageCounterPtr, TempImageWrapperModule, CheckImageData = MoveTemp(TmpImageData)]
+    bool bResult = false;
+    const uint8 CompressedQuality = 100;
+    const TArray<uint8>& CompressedData = FNVImageExporter::CompressImage(ImageWrapperModule, ExporterData.PixelDataToBeExported,
+                                          ExporterData.ExportImageFormat, CompressedQuality, &Settings);
+    if (CompressedData.Num() > 0)
+    {
+        // The compressed image is in flight too until it's written
+        const int64 CompressedByteSize = CompressedData.Num();
+        UpdateByteSizeInFlight(0, CompressedByteSize);
+        if (EncodedDataWriter)
+        {
+            bResult = EncodedDataWriter(ExporterData, CompressedData);
+        }
+        else
+        {
+            bResult = FFileHelper::SaveArrayToFile(CompressedData, *ExporterData.ExportFilePath);
+            if (!bResult)
             {
-                FNVImageExporter::ExportImage(TempImageWrapperModule, CheckImageData);
-                if (TempExportingImageCounterPtr.IsValid())
-                {
-                    TempExportingImageCounterPtr->Decrement();
-                }
-            });
+                UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to save image to file.  Check permissions. File is %s"), *ExporterData.ExportFilePath);
+            }
         }
+        UpdateByteSizeInFlight(0, -CompressedByteSize);
+    }
+    return bResult;
+}
+
+int64 FNVImageExporter_Thread::GetRawByteSize(const FNVImageExporterData& ExporterData)
+{
+    return ExporterData.EncodedData.IsValid() ? 0 : ExporterData.PixelDataToBeExported.GetPixelsByteSize();
+}
+
+int64 FNVImageExporter_Thread::GetEncodedByteSize(const FNVImageExporterData& ExporterData)
+{
+    return ExporterData.EncodedData.IsValid() ? ExporterData.EncodedData->Num() : 0;
+}
+
+void FNVImageExporter_Thread::UpdateByteSizeInFlight(int64 RawByteSizeDelta, int64 EncodedByteSizeDelta)
+{
+    const int64 NewRawByteSize = RawByteSizeInFlight.Add(RawByteSizeDelta) + RawByteSizeDelta;
+    const int64 NewEncodedByteSize = EncodedByteSizeInFlight.Add(EncodedByteSizeDelta) + EncodedByteSizeDelta;
+    const int64 NewByteSizeInFlight = NewRawByteSize + NewEncodedByteSize;
+
+    const int64 BudgetByteSize = Settings.GetMemoryBudgetByteSize();
+    const float PeakMemoryInFlightMB = (float)((double)NewByteSizeInFlight / (1024.0 * 1024.0));
 
-        if (HavePendingImageEvent)
+    FScopeLock MemoryBudgetScopeLock(&MemoryBudgetLock);
+    bool bStartThrottling = false;
+    if (BudgetByteSize > 0)
+    {
+        // NOTE: The state only change when crossing the watermarks so the capturer doesn't toggle every frame around one limit
+        if (!bOverMemoryBudget && (NewByteSizeInFlight >= (int64)(BudgetByteSize * Settings.MemoryBudgetHighWatermark)))
         {
-            HavePendingImageEvent->Wait();
+            bOverMemoryBudget = true;
+            bStartThrottling = true;
         }
-        else
+        else if (bOverMemoryBudget && (NewByteSizeInFlight <= (int64)(BudgetByteSize * FMath::Min(Settings.MemoryBudgetLowWatermark, Settings.MemoryBudgetHighWatermark))))
         {
-            FPlatformProcess::Sleep(0.1f);
+            bOverMemoryBudget = false;
         }
     }
+    else
+    {
+        bOverMemoryBudget = false;
+    }
 
-    return 0;
+    FScopeLock StatsScopeLock(&StatsLock);
+    Stats.PeakMemoryInFlightMB = FMath::Max(Stats.PeakMemoryInFlightMB, PeakMemoryInFlightMB);
+    Stats.ThrottledCount += bStartThrottling ? 1 : 0;
 }
 
-void FNVImageExporter_Thread::Stop()
+void FNVImageExporter_Thread::OnImageExported(double QueuedTime, double ExportTime)
 {
-    bIsRunning = false;
-    QueuedImageData.Empty();
-    if (HavePendingImageEvent)
+    FScopeLock StatsScopeLock(&StatsLock);
+    Stats.ExportedImageCount++;
+    Stats.MaxExportTime = FMath::Max(Stats.MaxExportTime, (float)ExportTime);
+    TotalQueuedTime += QueuedTime;
+    TotalExportTime += ExportTime;
+}
+
+void FNVImageExporter_Thread::WaitUntilAllExported()
+{
+    while (bIsRunning && (WorkerThreads.Num() > 0) && (GetPendingImagesCount() > 0))
+    {
+        ImageExportedEvent->Wait(10);
+    }
+}
+
+void FNVImageExporter_Thread::DropQueuedData()
+{
+    // NOTE: Each dropped data is uncounted like an exported one, a producer may still be adding data so the counter can't just be reset
+    FScopeLock DequeueScopeLock(&DequeueLock);
+    FNVImageExporterData DroppedData;
+    while (QueuedImageData.Dequeue(DroppedData))
     {
-        // Trigger the event so the thread doesn't wait anymore
-        HavePendingImageEvent->Trigger();
-        // HavePendingImageEvent->Reset();
+        // The dropped data are not in flight anymore
+        UpdateByteSizeInFlight(-GetRawByteSize(DroppedData), -GetEncodedByteSize(DroppedData));
+        PendingImageCounter.Decrement();
     }
 }
 
+void FNVImageExporter_Thread::Stop()
+{
+    bIsRunning = false;
+    DropQueuedData();
+
+    // Trigger the events so the threads don't wait anymore
+    // NOTE: Each worker trigger the event again when it exit so the next one wake up too
+    HavePendingImageEvent->Trigger();
+    QueueHasSpaceEvent->Trigger();
+}
+
 void FNVImageExporter_Thread::Kill()
 {
-    if (Thread)
+    Stop();
+
+    for (FRunnableThread* CheckThread : WorkerThreads)
+    {
+        if (CheckThread)
+        {
+            CheckThread->Kill(true);
+            delete CheckThread;
+        }
+    }
+    WorkerThreads.Reset();
+
+    for (FNVImageExporter_Worker* CheckWorker : Workers)
     {
-        Thread->Kill(true);
-        Thread = nullptr;
+        delete CheckWorker;
     }
+    Workers.Reset();
+
+    // The workers exited, drop what the producers queued while they were stopping before resetting the count
+    DropQueuedData();
+    PendingImageCounter.Reset();
 }
 
 uint32 FNVImageExporter_Thread::GetPendingImagesCount() const
 {
-    return PendingImageCounter.GetValue() + (ExportingImageCounterPtr.IsValid() ? ExportingImageCounterPtr->GetValue() : 0);
+    return PendingImageCounter.GetValue() + ExportingImageCounter.GetValue();
 }
 
 bool FNVImageExporter_Thread::IsExportingImage() const
 {
-    return ExportingImageCounterPtr.IsValid() && (ExportingImageCounterPtr->GetValue() > 0);
+    return (GetPendingImagesCount() > 0);
+}
+
+void FNVImageExporter_Thread::UpdateExternalByteSizeInFlight(int64 ByteSizeDelta)
+{
+    UpdateByteSizeInFlight(0, ByteSizeDelta);
+}
+
+FNVMemoryBudgetState FNVImageExporter_Thread::GetMemoryBudgetState() const
+{
+    FNVMemoryBudgetState BudgetState;
+    BudgetState.RawByteSize = RawByteSizeInFlight.GetValue();
+    BudgetState.EncodedByteSize = EncodedByteSizeInFlight.GetValue();
+    BudgetState.BudgetByteSize = Settings.GetMemoryBudgetByteSize();
+    BudgetState.HighWatermarkByteSize = (int64)(BudgetState.BudgetByteSize * Settings.MemoryBudgetHighWatermark);
+    BudgetState.LowWatermarkByteSize = (int64)(BudgetState.BudgetByteSize * FMath::Min(Settings.MemoryBudgetLowWatermark, Settings.MemoryBudgetHighWatermark));
+    BudgetState.PendingItemCount = GetPendingImagesCount();
+
+    FScopeLock MemoryBudgetScopeLock(&MemoryBudgetLock);
+    BudgetState.State = bOverMemoryBudget ? ENVMemoryBudgetState::Throttled : ENVMemoryBudgetState::Accepting;
+    return BudgetState;
+}
+
+FNVImageExporterStats FNVImageExporter_Thread::GetStats() const
+{
+    FScopeLock StatsScopeLock(&StatsLock);
+    FNVImageExporterStats CurrentStats = Stats;
+    CurrentStats.QueuedImageCount = PendingImageCounter.GetValue();
+    CurrentStats.ExportingImageCount = ExportingImageCounter.GetValue();
+    if (Stats.ExportedImageCount > 0)
+    {
+        CurrentStats.AverageQueuedTime = (float)(TotalQueuedTime / Stats.ExportedImageCount);
+        CurrentStats.AverageExportTime = (float)(TotalExportTime / Stats.ExportedImageCount);
+    }
+    CurrentStats.BlockedTime = (float)TotalBlockedTime;
+    CurrentStats.PixelsBufferCount = FNVTexturePixelData::GetPixelsBufferCount();
+    return CurrentStats;
+}
+
+//====================================== FNVImageExporter_Worker ==========================================
+FNVImageExporter_Thread::FNVImageExporter_Worker::FNVImageExporter_Worker(FNVImageExporter_Thread* InOwner)
+    : Owner(InOwner)
+{
+    check(Owner);
+}
+
+uint32 FNVImageExporter_Thread::FNVImageExporter_Worker::Run()
+{
+    while (Owner->bIsRunning)
+    {
+        Owner->ProcessQueuedImages();
+
+        if (Owner->bIsRunning)
+        {
+            Owner->HavePendingImageEvent->Wait();
+        }
+    }
+
+    // Pass the stop signal along to the other workers
+    Owner->HavePendingImageEvent->Trigger();
+    return 0;
 }
 
 //====================================== FNVImageExporterData ==========================================
@@ -460,11 +1293,15 @@ FNVImageExporterData::FNVImageExporterData()
 {
     ExportFilePath = TEXT("");
 	ExportImageFormat = ENVImageFormat::PNG;
+    FrameIndex = INDEX_NONE;
+    QueuedTimestamp = 0.0;
 }
 
-FNVImageExporterData::FNVImageExporterData(const FNVTexturePixelData& InPixelDataToBeExported, const FString InExportFilePath, ENVImageFormat InExportImageFormat /*= ENVImageFormat::PNG*/)
+FNVImageExporterData::FNVImageExporterData(const FNVTexturePixelData& InPixelDataToBeExported, const FString InExportFilePath, ENVImageFormat InExportImageFormat /*= ENVImageFormat::PNG*/, int32 InFrameIndex /*= INDEX_NONE*/)
 	: PixelDataToBeExported(InPixelDataToBeExported),
 	ExportFilePath(InExportFilePath),
-	ExportImageFormat(InExportImageFormat)
+	ExportImageFormat(InExportImageFormat),
+	FrameIndex(InFrameIndex),
+	QueuedTimestamp(0.0)
 {
 }
@@ -0,0 +1,556 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVJsonStreamWriter.h"
+#include "NVSceneCapturerUtils.h"
+#include "HAL/IConsoleManager.h"
+
+//====================================== FNVJsonStreamWriter ==========================================
+FNVJsonStreamWriter::FNVJsonStreamWriter(int32 InitialBufferSize /*= 4096*/)
+{
+    Buffer.Reserve(InitialBufferSize);
+    PreviousTokenWritten = EJsonToken::None;
+    IndentLevel = 0;
+}
+
+TArray<uint8> FNVJsonStreamWriter::ReleaseBuffer()
+{
+    PreviousTokenWritten = EJsonToken::None;
+    IndentLevel = 0;
+    return MoveTemp(Buffer);
+}
+
+void FNVJsonStreamWriter::WriteObjectStart()
+{
+    if (PreviousTokenWritten != EJsonToken::None)
+    {
+        WriteCommaIfNeeded();
+        WriteLineTerminator();
+        WriteTabs();
+    }
+
+    AppendChar('{');
+    ++IndentLevel;
+    PreviousTokenWritten = EJsonToken::CurlyOpen;
+}
+
+void FNVJsonStreamWriter::WriteObjectStart(const TCHAR* Identifier)
+{
+    WriteIdentifier(Identifier);
+
+    WriteLineTerminator();
+    WriteTabs();
+    AppendChar('{');
+    ++IndentLevel;
+    PreviousTokenWritten = EJsonToken::CurlyOpen;
+}
+
+void FNVJsonStreamWriter::WriteObjectEnd()
+{
+    WriteLineTerminator();
+    --IndentLevel;
+    WriteTabs();
+    AppendChar('}');
+    PreviousTokenWritten = EJsonToken::CurlyClose;
+}
+
+void FNVJsonStreamWriter::WriteArrayStart()
+{
+    if (PreviousTokenWritten != EJsonToken::None)
+    {
+        WriteCommaIfNeeded();
+        WriteLineTerminator();
+        WriteTabs();
+    }
+
+    AppendChar('[');
+    ++IndentLevel;
+    PreviousTokenWritten = EJsonToken::SquareOpen;
+}
+
+void FNVJsonStreamWriter::WriteArrayStart(const TCHAR* Identifier)
+{
+    WriteIdentifier(Identifier);
+
+    AppendChar(' ');
+    AppendChar('[');
+    ++IndentLevel;
+    PreviousTokenWritten = EJsonToken::SquareOpen;
+}
+
+void FNVJsonStreamWriter::WriteArrayEnd()
+{
+    --IndentLevel;
+    if ((PreviousTokenWritten == EJsonToken::SquareClose) || (PreviousTokenWritten == EJsonToken::CurlyClose) || (PreviousTokenWritten == EJsonToken::String))
+    {
+        WriteLineTerminator();
+        WriteTabs();
+    }
+    else if (PreviousTokenWritten != EJsonToken::SquareOpen)
+    {
+        AppendChar(' ');
+    }
+
+    AppendChar(']');
+    PreviousTokenWritten = EJsonToken::SquareClose;
+}
+
+void FNVJsonStreamWriter::WriteNumber(double Value)
+{
+    PrepareArrayValue();
+    AppendNumber(Value);
+    PreviousTokenWritten = EJsonToken::Number;
+}
+
+void FNVJsonStreamWriter::WriteBool(bool bValue)
+{
+    PrepareArrayValue();
+    const ANSICHAR* BoolString = bValue ? "true" : "false";
+    Buffer.Append((const uint8*)BoolString, FCStringAnsi::Strlen(BoolString));
+    PreviousTokenWritten = bValue ? EJsonToken::True : EJsonToken::False;
+}
+
+void FNVJsonStreamWriter::WriteString(const FString& Value)
+{
+    // NOTE: Unlike the other values, the strings in an array are always written on their own line
+    WriteCommaIfNeeded();
+    WriteLineTerminator();
+    WriteTabs();
+    AppendEscapedString(*Value);
+    PreviousTokenWritten = EJsonToken::String;
+}
+
+void FNVJsonStreamWriter::WriteNull()
+{
+    PrepareArrayValue();
+    Buffer.Append((const uint8*)"null", 4);
+    PreviousTokenWritten = EJsonToken::Null;
+}
+
+void FNVJsonStreamWriter::WriteNumber(const TCHAR* Identifier, double Value)
+{
+    WriteIdentifier(Identifier);
+    AppendChar(' ');
+    AppendNumber(Value);
+    PreviousTokenWritten = EJsonToken::Number;
+}
+
+void FNVJsonStreamWriter::WriteBool(const TCHAR* Identifier, bool bValue)
+{
+    WriteIdentifier(Identifier);
+    AppendChar(' ');
+    const ANSICHAR* BoolString = bValue ? "true" : "false";
+    Buffer.Append((const uint8*)BoolString, FCStringAnsi::Strlen(BoolString));
+    PreviousTokenWritten = bValue ? EJsonToken::True : EJsonToken::False;
+}
+
+void FNVJsonStreamWriter::WriteString(const TCHAR* Identifier, const FString& Value)
+{
+    WriteIdentifier(Identifier);
+    AppendChar(' ');
+    AppendEscapedString(*Value);
+    PreviousTokenWritten = EJsonToken::String;
+}
+
+void FNVJsonStreamWriter::WriteNull(const TCHAR* Identifier)
+{
+    WriteIdentifier(Identifier);
+    AppendChar(' ');
+    Buffer.Append((const uint8*)"null", 4);
+    PreviousTokenWritten = EJsonToken::Null;
+}
+
+void FNVJsonStreamWriter::WriteJsonValue(const TSharedPtr<FJsonValue>& Value)
+{
+    if (!Value.IsValid())
+    {
+        WriteNull();
+        return;
+    }
+
+    switch (Value->Type)
+    {
+        case EJson::String:
+            WriteString(Value->AsString());
+            break;
+        case EJson::Number:
+            WriteNumber(Value->AsNumber());
+            break;
+        case EJson::Boolean:
+            WriteBool(Value->AsBool());
+            break;
+        case EJson::Array:
+            WriteArrayStart();
+            for (const TSharedPtr<FJsonValue>& ElementValue : Value->AsArray())
+            {
+                WriteJsonValue(ElementValue);
+            }
+            WriteArrayEnd();
+            break;
+        case EJson::Object:
+            WriteObjectStart();
+            WriteJsonObjectFields(Value->AsObject());
+            WriteObjectEnd();
+            break;
+        default:
+            WriteNull();
+            break;
+    }
+}
+
+void FNVJsonStreamWriter::WriteJsonValue(const TCHAR* Identifier, const TSharedPtr<FJsonValue>& Value)
+{
+    if (!Value.IsValid())
+    {
+        WriteNull(Identifier);
+        return;
+    }
+
+    switch (Value->Type)
+    {
+        case EJson::String:
+            WriteString(Identifier, Value->AsString());
+            break;
+        case EJson::Number:
+            WriteNumber(Identifier, Value->AsNumber());
+            break;
+        case EJson::Boolean:
+            WriteBool(Identifier, Value->AsBool());
+            break;
+        case EJson::Array:
+            WriteArrayStart(Identifier);
+            for (const TSharedPtr<FJsonValue>& ElementValue : Value->AsArray())
+            {
+                WriteJsonValue(ElementValue);
+            }
+            WriteArrayEnd();
+            break;
+        case EJson::Object:
+            WriteObjectStart(Identifier);
+            WriteJsonObjectFields(Value->AsObject());
+            WriteObjectEnd();
+            break;
+        default:
+            WriteNull(Identifier);
+            break;
+    }
+}
+
+void FNVJsonStreamWriter::WriteJsonObjectFields(const TSharedPtr<FJsonObject>& JsonObject)
+{
+    if (JsonObject.IsValid())
+    {
+        for (const auto& FieldIt : JsonObject->Values)
+        {
+            WriteJsonValue(*FieldIt.Key, FieldIt.Value);
+        }
+    }
+}
+
+void FNVJsonStreamWriter::WriteVector(const TCHAR* Identifier, const FVector& Value)
+{
+    WriteArrayStart(Identifier);
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Z));
+    WriteArrayEnd();
+}
+
+void FNVJsonStreamWriter::WriteVector(const FVector& Value)
+{
+    WriteArrayStart();
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Z));
+    WriteArrayEnd();
+}
+
+void FNVJsonStreamWriter::WriteVector2D(const TCHAR* Identifier, const FVector2D& Value)
+{
+    WriteArrayStart(Identifier);
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteArrayEnd();
+}
+
+void FNVJsonStreamWriter::WriteVector2D(const FVector2D& Value)
+{
+    WriteArrayStart();
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteArrayEnd();
+}
+
+void FNVJsonStreamWriter::WriteQuat(const TCHAR* Identifier, const FQuat& Value)
+{
+    WriteArrayStart(Identifier);
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Z));
+    WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.W));
+    WriteArrayEnd();
+}
+
+void FNVJsonStreamWriter::WriteMatrix(const TCHAR* Identifier, const FMatrix& Value)
+{
+    WriteArrayStart(Identifier);
+    for (int i = 0; i < 4; i++)
+    {
+        WriteArrayStart();
+        for (int j = 0; j < 4; j++)
+        {
+            WriteNumber(NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.M[i][j]));
+        }
+        WriteArrayEnd();
+    }
+    WriteArrayEnd();
+}
+
+void FNVJsonStreamWriter::WriteFloatWithPrecision4(const TCHAR* Identifier, float Value)
+{
+    WriteNumber(Identifier, NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value));
+}
+
+void FNVJsonStreamWriter::WriteCommaIfNeeded()
+{
+    if ((PreviousTokenWritten != EJsonToken::CurlyOpen) && (PreviousTokenWritten != EJsonToken::SquareOpen))
+    {
+        AppendChar(',');
+    }
+}
+
+void FNVJsonStreamWriter::WriteIdentifier(const TCHAR* Identifier)
+{
+    WriteCommaIfNeeded();
+    WriteLineTerminator();
+    WriteTabs();
+    AppendEscapedString(Identifier);
+    AppendChar(':');
+}
+
+void FNVJsonStreamWriter::PrepareArrayValue()
+{
+    WriteCommaIfNeeded();
+
+    // The short values (numbers, booleans and null) are written on the same line
+    if ((PreviousTokenWritten == EJsonToken::SquareOpen) || IsShortValue(PreviousTokenWritten))
+    {
+        AppendChar(' ');
+    }
+    else
+    {
+        WriteLineTerminator();
+        WriteTabs();
+    }
+}
+
+void FNVJsonStreamWriter::WriteLineTerminator()
+{
+    for (const TCHAR* CharPtr = LINE_TERMINATOR; *CharPtr; CharPtr++)
+    {
+        AppendChar((ANSICHAR)*CharPtr);
+    }
+}
+
+void FNVJsonStreamWriter::WriteTabs()
+{
+    for (int32 i = 0; i < IndentLevel; i++)
+    {
+        AppendChar('\t');
+    }
+}
+
+void FNVJsonStreamWriter::AppendNumber(double Value)
+{
+    // Fast path for the integer values, e.g: the ids and the 0 and 1 in the matrixes, they are printed the same by "%.17g"
+    // NOTE: -0 is printed as "-0" so it must go through the slow path
+    static const double MaxFastIntegerValue = 1e15;
+    if ((Value == FMath::FloorToDouble(Value)) && (FMath::Abs(Value) < MaxFastIntegerValue) && !((Value == 0.0) && FMath::IsNegativeDouble(Value)))
+    {
+        ANSICHAR Digits[24];
+        int32 DigitCount = 0;
+        int64 IntValue = (int64)Value;
+        const bool bIsNegative = (IntValue < 0);
+        uint64 AbsValue = bIsNegative ? (uint64)(-IntValue) : (uint64)IntValue;
+        do
+        {
+            Digits[DigitCount++] = '0' + (AbsValue % 10);
+            AbsValue /= 10;
+        } while (AbsValue > 0);
+
+        if (bIsNegative)
+        {
+            AppendChar('-');
+        }
+        while (DigitCount > 0)
+        {
+            AppendChar(Digits[--DigitCount]);
+        }
+        return;
+    }
+
+    // Specify 17 significant digits, the same as the engine's json writer
+    ANSICHAR NumberString[32];
+    const int32 NumberLength = FCStringAnsi::Snprintf(NumberString, sizeof(NumberString), "%.17g", Value);
+    if (NumberLength > 0)
+    {
+        Buffer.Append((const uint8*)NumberString, FMath::Min<int32>(NumberLength, sizeof(NumberString) - 1));
+    }
+}
+
+void FNVJsonStreamWriter::AppendEscapedString(const TCHAR* Value)
+{
+    AppendChar('"');
+    for (const TCHAR* CharPtr = Value; *CharPtr; CharPtr++)
+    {
+        uint32 CodePoint = (uint32)*CharPtr;
+        switch (CodePoint)
+        {
+            case '\\': AppendChar('\\'); AppendChar('\\'); continue;
+            case '\n': AppendChar('\\'); AppendChar('n'); continue;
+            case '\t': AppendChar('\\'); AppendChar('t'); continue;
+            case '\b': AppendChar('\\'); AppendChar('b'); continue;
+            case '\f': AppendChar('\\'); AppendChar('f'); continue;
+            case '\r': AppendChar('\\'); AppendChar('r'); continue;
+            case '\"': AppendChar('\\'); AppendChar('"'); continue;
+            default:
+                break;
+        }
+
+        if (CodePoint < 32)
+        {
+            // Must escape the control characters
+            ANSICHAR EscapedChar[8];
+            FCStringAnsi::Snprintf(EscapedChar, sizeof(EscapedChar), "\\u%04x", CodePoint);
+            Buffer.Append((const uint8*)EscapedChar, 6);
+        }
+        else if (CodePoint < 0x80)
+        {
+            AppendChar((ANSICHAR)CodePoint);
+        }
+        else
+        {
+            // Combine the UTF-16 surrogate pairs
+            if ((CodePoint >= 0xD800) && (CodePoint <= 0xDBFF))
+            {
+                const uint32 NextCodeUnit = (uint32)*(CharPtr + 1);
+                if ((NextCodeUnit >= 0xDC00) && (NextCodeUnit <= 0xDFFF))
+                {
+                    CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (NextCodeUnit - 0xDC00);
+                    CharPtr++;
+                }
+            }
+
+            if (CodePoint < 0x800)
+            {
+                AppendChar((ANSICHAR)(0xC0 | (CodePoint >> 6)));
+                AppendChar((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+            }
+            else if (CodePoint < 0x10000)
+            {
+                AppendChar((ANSICHAR)(0xE0 | (CodePoint >> 12)));
+                AppendChar((ANSICHAR)(0x80 | ((CodePoint >> 6) & 0x3F)));
+                AppendChar((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+            }
+            else
+            {
+                AppendChar((ANSICHAR)(0xF0 | (CodePoint >> 18)));
+                AppendChar((ANSICHAR)(0x80 | ((CodePoint >> 12) & 0x3F)));
+                AppendChar((ANSICHAR)(0x80 | ((CodePoint >> 6) & 0x3F)));
+                AppendChar((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+            }
+        }
+    }
+    AppendChar('"');
+}
+
+void FNVJsonStreamWriter::BenchmarkCapturedSceneData(int32 ObjectCount, int32 IterationCount)
+{
+    if ((ObjectCount < 0) || (IterationCount <= 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
+
+    FRandomStream RandomStream(ObjectCount);
+    FCapturedSceneData SceneData;
+    SceneData.camera_data.location_worldframe = RandomStream.VRand() * 500.f;
+    SceneData.camera_data.quaternion_xyzw_worldframe = FQuat(RandomStream.VRand(), RandomStream.FRand());
+    for (int32 i = 0; i < ObjectCount; i++)
+    {
+        FCapturedObjectData ObjectData;
+        ObjectData.Class = FString::Printf(TEXT("object_class_%d"), i % 8);
+        ObjectData.instance_id = RandomStream.RandHelper(MAX_int32);
+        ObjectData.visibility = RandomStream.FRand();
+        ObjectData.location = RandomStream.VRand() * 1000.f;
+        ObjectData.quaternion_xyzw = FQuat(RandomStream.VRand(), RandomStream.FRand() * PI);
+        ObjectData.pose_transform = FTransform(ObjectData.quaternion_xyzw, ObjectData.location).ToMatrixWithScale();
+        ObjectData.cuboid_centroid = ObjectData.location;
+        ObjectData.projected_cuboid_centroid = FVector2D(RandomStream.FRand() * 640.f, RandomStream.FRand() * 480.f);
+        ObjectData.bounding_box = FNVBox2D(FBox2D(FVector2D(RandomStream.FRand(), RandomStream.FRand()) * 200.f, FVector2D(RandomStream.FRand(), RandomStream.FRand()) * 400.f));
+        for (int32 VertexIndex = 0; VertexIndex < FNVCuboidData::TotalVertexesCount; VertexIndex++)
+        {
+            ObjectData.cuboid.Add(RandomStream.VRand() * 100.f);
+            ObjectData.projected_cuboid.Add(FVector2D(RandomStream.FRand() * 640.f, -RandomStream.FRand() * 480.f));
+        }
+        if ((i % 4) == 0)
+        {
+            ObjectData.custom_data = MakeShareable(new FJsonObject());
+            ObjectData.custom_data->SetStringField(TEXT("name"), FString::Printf(TEXT("object \"%d\""), i));
+            ObjectData.custom_data->SetNumberField(TEXT("value"), RandomStream.FRand());
+            ObjectData.custom_data->SetBoolField(TEXT("flag"), (i % 8) == 0);
+        }
+        SceneData.Objects.Add(ObjectData);
+    }
+
+    // The FJsonObject path, the same as the annotation extractor used to do
+    TArray<uint8> JsonObjectData;
+    const double JsonObjectStartTime = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < IterationCount; Iteration++)
+    {
+        TSharedPtr<FJsonObject> SceneDataJsonObj = NVSceneCapturerUtils::UStructToJsonObject(SceneData, 0, 0);
+        const TArray< TSharedPtr<FJsonValue> >& JsonObjectArrayData = SceneDataJsonObj->GetArrayField(TEXT("objects"));
+        for (int32 i = 0; i < SceneData.Objects.Num(); i++)
+        {
+            if (SceneData.Objects[i].custom_data.IsValid())
+            {
+                JsonObjectArrayData[i]->AsObject()->SetObjectField(TEXT("custom_data"), SceneData.Objects[i].custom_data);
+            }
+        }
+
+        FString JsonString;
+        NVSceneCapturerUtils::SerializeJsonObjectToString(SceneDataJsonObj, JsonString);
+        FTCHARToUTF8 JsonStringUTF8(*JsonString);
+        JsonObjectData.Reset();
+        JsonObjectData.Append((const uint8*)JsonStringUTF8.Get(), JsonStringUTF8.Length());
+    }
+    const double JsonObjectDuration = (FPlatformTime::Seconds() - JsonObjectStartTime) / IterationCount;
+
+    FNVJsonBufferPtr StreamData;
+    const double StreamStartTime = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < IterationCount; Iteration++)
+    {
+        StreamData = SceneData.ToJsonBuffer();
+    }
+    const double StreamDuration = (FPlatformTime::Seconds() - StreamStartTime) / IterationCount;
+
+    const bool bIsIdentical = StreamData.IsValid() && (*StreamData == JsonObjectData);
+    UE_LOG(LogNVSceneCapturer, Display, TEXT("Annotation json with %d objects (%d bytes): FJsonObject %.3fms - stream writer %.3fms (x%.2f) - output %s"),
+        ObjectCount, JsonObjectData.Num(), JsonObjectDuration * 1000.0, StreamDuration * 1000.0,
+        JsonObjectDuration / FMath::Max(StreamDuration, (double)SMALL_NUMBER), bIsIdentical ? TEXT("identical") : TEXT("DIFFERENT"));
+}
+
+static FAutoConsoleCommand BenchmarkAnnotationJsonWriterCommand(
+    TEXT("NV.BenchmarkAnnotationJsonWriter"),
+    TEXT("Compare the streaming json writer with the FJsonObject path on a synthetic scene. Usage: NV.BenchmarkAnnotationJsonWriter [ObjectCount] [IterationCount]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+    {
+        const int32 ObjectCount = (Args.Num() > 0) ? FCString::Atoi(*Args[0]) : 50;
+        const int32 IterationCount = (Args.Num() > 1) ? FCString::Atoi(*Args[1]) : 100;
+        FNVJsonStreamWriter::BenchmarkCapturedSceneData(ObjectCount, IterationCount);
+    })
+);
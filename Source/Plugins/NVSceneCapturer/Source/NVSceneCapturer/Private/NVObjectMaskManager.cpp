@@ -231,6 +231,27 @@ void UNVObjectMaskMananger::ScanActors(UWorld* World)
     }
 }
 
+void UNVObjectMaskMananger::UpdateActorMask(AActor* CheckActor)
+{
+    ensure(CheckActor != nullptr);
+    if (!CheckActor)
+    {
+        UE_LOG(LogNVObjectMaskManager, Error, TEXT("invalid argument."));
+    }
+    else
+    {
+        // NOTE: The hidden actors are ignored, the same as when the actors are scanned
+        if (ShouldCheckActorMask(CheckActor) && !GetActorMaskName(CheckActor).IsEmpty())
+        {
+            AllMaskActors.AddUnique(CheckActor);
+        }
+        else
+        {
+            AllMaskActors.Remove(CheckActor);
+        }
+    }
+}
+
 //================================== UNVObjectMaskMananger_Stencil ==================================
 UNVObjectMaskMananger_Stencil::UNVObjectMaskMananger_Stencil() : Super()
 {
@@ -302,6 +323,20 @@ void UNVObjectMaskMananger_Stencil::ScanActors(UWorld* World)
     }
 }
 
+void UNVObjectMaskMananger_Stencil::UpdateActorMask(AActor* CheckActor)
+{
+    Super::UpdateActorMask(CheckActor);
+
+    if (CheckActor && AllMaskActors.Contains(CheckActor))
+    {
+        const uint8 ActorMaskId = GetMaskId(CheckActor);
+        if (ActorMaskId > 0)
+        {
+            ApplyStencilMaskToActor(CheckActor, ActorMaskId);
+        }
+    }
+}
+
 uint8 UNVObjectMaskMananger_Stencil::GetMaskId(const FString& MaskName) const
 {
     return (!MaskName.IsEmpty() && MaskNameIdMap.Contains(MaskName))?
@@ -334,6 +369,21 @@ UNVObjectMaskMananger_VertexColor::UNVObjectMaskMananger_VertexColor() : Super()
 	ActorMaskNameType = ENVActorMaskNameType::UseActorMeshName;
 }
 
+void UNVObjectMaskMananger_VertexColor::UpdateActorMask(AActor* CheckActor)
+{
+    Super::UpdateActorMask(CheckActor);
+
+    if (CheckActor && AllMaskActors.Contains(CheckActor))
+    {
+        // NOTE: The vertex colors must be applied again when the actor's mesh changed
+        const uint32 ActorMaskId = GetMaskId(CheckActor);
+        if (ActorMaskId > 0)
+        {
+            ApplyVertexColorMaskToActor(CheckActor, ActorMaskId);
+        }
+    }
+}
+
 uint32 UNVObjectMaskMananger_VertexColor::GetMaskId(const FString& MaskName) const
 {
     if (!MaskName.IsEmpty() && MaskNameIdMap.Contains(MaskName))
@@ -457,6 +507,14 @@ void FNVObjectSegmentation_Instance::ScanActors(UWorld* World)
 	VertexColorMaskManager->ScanActors(World);
 }
 
+void FNVObjectSegmentation_Instance::UpdateActorMask(AActor* CheckActor)
+{
+	if (VertexColorMaskManager)
+	{
+		VertexColorMaskManager->UpdateActorMask(CheckActor);
+	}
+}
+
 //================================== FNVObjectSegmentation_Class ==================================
 FNVObjectSegmentation_Class::FNVObjectSegmentation_Class()
 {
@@ -504,3 +562,11 @@ void FNVObjectSegmentation_Class::ScanActors(UWorld* World)
 	check(StencilMaskManager != nullptr);
 	StencilMaskManager->ScanActors(World);
 }
+
+void FNVObjectSegmentation_Class::UpdateActorMask(AActor* CheckActor)
+{
+	if (StencilMaskManager)
+	{
+		StencilMaskManager->UpdateActorMask(CheckActor);
+	}
+}
\ No newline at end of file
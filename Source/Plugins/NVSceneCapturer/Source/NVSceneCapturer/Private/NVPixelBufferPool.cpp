@@ -0,0 +1,190 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVPixelBufferPool.h"
+#include "Misc/ScopeLock.h"
+
+//================================== FNVPixelBufferPoolStats ==================================
+FNVPixelBufferPoolStats::FNVPixelBufferPoolStats()
+{
+    AcquiredCount = 0;
+    HitCount = 0;
+    MissCount = 0;
+    DiscardedCount = 0;
+    PooledBufferCount = 0;
+    PooledByteSize = 0;
+    MaxPooledByteSize = 0;
+}
+
+//================================== FNVPixelBufferPool ==================================
+FNVPixelBufferPool::FNVPixelBufferPool()
+{
+    // Keep up to 512MB of free buffers by default
+    Stats.MaxPooledByteSize = 512 * 1024 * 1024;
+    NextReleaseIndex = 0;
+}
+
+FNVPixelBufferPool::~FNVPixelBufferPool()
+{
+    Empty();
+}
+
+FNVPixelBufferPool& FNVPixelBufferPool::Get()
+{
+    // NOTE: The pool is kept in a shared pointer so the buffers released after it's destroyed can detect it and free themselves
+    static TSharedRef<FNVPixelBufferPool, ESPMode::ThreadSafe> GlobalPixelBufferPool = MakeShareable(new FNVPixelBufferPool());
+    return GlobalPixelBufferPool.Get();
+}
+
+TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> FNVPixelBufferPool::AcquireBuffer(EPixelFormat PixelFormat, const FIntPoint& ImageSize, int32 BufferByteSize)
+{
+    ensure(BufferByteSize > 0);
+    if (BufferByteSize <= 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    FNVPixelBufferKey BufferKey;
+    BufferKey.PixelFormat = PixelFormat;
+    BufferKey.ImageSize = ImageSize;
+    BufferKey.BufferByteSize = BufferByteSize;
+
+    TArray<uint8>* NewBuffer = nullptr;
+    {
+        FScopeLock PoolScopeLock(&PoolLock);
+        Stats.AcquiredCount++;
+
+        TArray<FNVPooledBuffer>* BucketBuffers = FreeBuffers.Find(BufferKey);
+        if (BucketBuffers && (BucketBuffers->Num() > 0))
+        {
+            NewBuffer = BucketBuffers->Pop(false).Buffer;
+            Stats.HitCount++;
+            Stats.PooledBufferCount--;
+            Stats.PooledByteSize -= BufferByteSize;
+        }
+        else
+        {
+            Stats.MissCount++;
+        }
+    }
+
+    if (!NewBuffer)
+    {
+        NewBuffer = new TArray<uint8>();
+        NewBuffer->SetNumUninitialized(BufferByteSize);
+    }
+
+    TWeakPtr<FNVPixelBufferPool, ESPMode::ThreadSafe> WeakPool = AsShared();
+    return TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe>(NewBuffer, [WeakPool, BufferKey](TArray<uint8>* ReleasedBuffer)
+    {
+        TSharedPtr<FNVPixelBufferPool, ESPMode::ThreadSafe> OwnerPool = WeakPool.Pin();
+        if (OwnerPool.IsValid())
+        {
+            OwnerPool->ReleaseBuffer(BufferKey, ReleasedBuffer);
+        }
+        else
+        {
+            delete ReleasedBuffer;
+        }
+    });
+}
+
+void FNVPixelBufferPool::ReleaseBuffer(const FNVPixelBufferKey& BufferKey, TArray<uint8>* ReleasedBuffer)
+{
+    if (!ReleasedBuffer)
+    {
+        return;
+    }
+
+    {
+        FScopeLock PoolScopeLock(&PoolLock);
+        // NOTE: The buffer may have been resized by its user, don't put it back in the wrong bucket
+        const bool bCanRecycle = (ReleasedBuffer->Num() == BufferKey.BufferByteSize);
+        if (bCanRecycle)
+        {
+            // The returned buffer is the most likely to be acquired again soon, make room for it by freeing the oldest ones instead
+            FNVPooledBuffer PooledBuffer;
+            PooledBuffer.Buffer = ReleasedBuffer;
+            PooledBuffer.ReleaseIndex = NextReleaseIndex++;
+            FreeBuffers.FindOrAdd(BufferKey).Push(PooledBuffer);
+            Stats.PooledBufferCount++;
+            Stats.PooledByteSize += BufferKey.BufferByteSize;
+            TrimPool();
+            return;
+        }
+
+        Stats.DiscardedCount++;
+    }
+
+    delete ReleasedBuffer;
+}
+
+void FNVPixelBufferPool::SetMaxPooledByteSize(int64 NewMaxPooledByteSize)
+{
+    FScopeLock PoolScopeLock(&PoolLock);
+    Stats.MaxPooledByteSize = FMath::Max<int64>(NewMaxPooledByteSize, 0);
+    TrimPool();
+}
+
+void FNVPixelBufferPool::TrimPool()
+{
+    // NOTE: PoolLock must be locked by the caller
+    while (Stats.PooledByteSize > Stats.MaxPooledByteSize)
+    {
+        // The oldest buffer of each bucket is at its front, free the oldest of them
+        // NOTE: There are only a few buckets (one per captured pixel format and resolution) so they are just scanned
+        FNVPixelBufferKey OldestBufferKey;
+        TArray<FNVPooledBuffer>* OldestBucketBuffers = nullptr;
+        for (auto& BucketIt : FreeBuffers)
+        {
+            TArray<FNVPooledBuffer>& BucketBuffers = BucketIt.Value;
+            if ((BucketBuffers.Num() > 0) && (!OldestBucketBuffers || (BucketBuffers[0].ReleaseIndex < (*OldestBucketBuffers)[0].ReleaseIndex)))
+            {
+                OldestBufferKey = BucketIt.Key;
+                OldestBucketBuffers = &BucketBuffers;
+            }
+        }
+        if (!OldestBucketBuffers)
+        {
+            break;
+        }
+
+        TArray<uint8>* OldestBuffer = (*OldestBucketBuffers)[0].Buffer;
+        OldestBucketBuffers->RemoveAt(0, 1, false);
+        if (OldestBucketBuffers->Num() == 0)
+        {
+            FreeBuffers.Remove(OldestBufferKey);
+        }
+
+        Stats.PooledBufferCount--;
+        Stats.PooledByteSize -= OldestBufferKey.BufferByteSize;
+        Stats.DiscardedCount++;
+        delete OldestBuffer;
+    }
+}
+
+void FNVPixelBufferPool::Empty()
+{
+    FScopeLock PoolScopeLock(&PoolLock);
+    for (auto& BucketIt : FreeBuffers)
+    {
+        for (const FNVPooledBuffer& PooledBuffer : BucketIt.Value)
+        {
+            delete PooledBuffer.Buffer;
+        }
+    }
+    FreeBuffers.Empty();
+    Stats.PooledBufferCount = 0;
+    Stats.PooledByteSize = 0;
+}
+
+FNVPixelBufferPoolStats FNVPixelBufferPool::GetStats() const
+{
+    FScopeLock PoolScopeLock(&PoolLock);
+    return Stats;
+}
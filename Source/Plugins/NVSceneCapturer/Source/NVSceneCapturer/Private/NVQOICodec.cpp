@@ -0,0 +1,302 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVQOICodec.h"
+
+namespace NVQOICodec
+{
+    // QOI chunk tags
+    static const uint8 OP_INDEX = 0x00;
+    static const uint8 OP_DIFF = 0x40;
+    static const uint8 OP_LUMA = 0x80;
+    static const uint8 OP_RUN = 0xC0;
+    static const uint8 OP_RGB = 0xFE;
+    static const uint8 OP_RGBA = 0xFF;
+    static const uint8 OP_MASK = 0xC0;
+
+    static const int32 MaxRunLength = 62;
+    static const uint8 EndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    // NOTE: The pixels are kept in RGBA order
+    union FQOIPixel
+    {
+        struct
+        {
+            uint8 R, G, B, A;
+        } Channels;
+        uint32 Value;
+    };
+
+    FORCEINLINE uint32 GetPixelHash(const FQOIPixel& Pixel)
+    {
+        return (Pixel.Channels.R * 3 + Pixel.Channels.G * 5 + Pixel.Channels.B * 7 + Pixel.Channels.A * 11) % 64;
+    }
+
+    FORCEINLINE void WriteBigEndianUInt32(uint8* OutPtr, uint32 Value)
+    {
+        OutPtr[0] = (Value >> 24) & 0xFF;
+        OutPtr[1] = (Value >> 16) & 0xFF;
+        OutPtr[2] = (Value >> 8) & 0xFF;
+        OutPtr[3] = Value & 0xFF;
+    }
+
+    FORCEINLINE uint32 ReadBigEndianUInt32(const uint8* InPtr)
+    {
+        return ((uint32)InPtr[0] << 24) | ((uint32)InPtr[1] << 16) | ((uint32)InPtr[2] << 8) | (uint32)InPtr[3];
+    }
+
+    TArray<uint8> Encode(const uint8* Pixels, int32 Width, int32 Height, bool bIsBGRA)
+    {
+        TArray<uint8> CompressedData;
+        ensure(Pixels);
+        if (!Pixels || (Width <= 0) || (Height <= 0))
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+            return CompressedData;
+        }
+
+        const int64 PixelCount = (int64)Width * Height;
+        // Worst case: every pixel take 5 bytes (OP_RGBA)
+        const int64 MaxCompressedSize = HeaderByteSize + PixelCount * 5 + sizeof(EndMarker);
+        if (MaxCompressedSize > MAX_int32)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("The image is too big to be compressed to QOI."));
+            return CompressedData;
+        }
+        CompressedData.SetNumUninitialized(MaxCompressedSize);
+        uint8* OutPtr = CompressedData.GetData();
+
+        // Header
+        OutPtr[0] = 'q';
+        OutPtr[1] = 'o';
+        OutPtr[2] = 'i';
+        OutPtr[3] = 'f';
+        WriteBigEndianUInt32(OutPtr + 4, Width);
+        WriteBigEndianUInt32(OutPtr + 8, Height);
+        // 4 channels, sRGB with linear alpha
+        OutPtr[12] = 4;
+        OutPtr[13] = 0;
+        OutPtr += HeaderByteSize;
+
+        FQOIPixel SeenPixels[64];
+        FMemory::Memzero(SeenPixels, sizeof(SeenPixels));
+
+        FQOIPixel PrevPixel;
+        PrevPixel.Channels.R = 0;
+        PrevPixel.Channels.G = 0;
+        PrevPixel.Channels.B = 0;
+        PrevPixel.Channels.A = 255;
+
+        const int32 RedOffset = bIsBGRA ? 2 : 0;
+        const int32 BlueOffset = bIsBGRA ? 0 : 2;
+
+        int32 RunLength = 0;
+        const uint8* SrcPtr = Pixels;
+        for (int64 PixelIndex = 0; PixelIndex < PixelCount; PixelIndex++, SrcPtr += 4)
+        {
+            FQOIPixel Pixel;
+            Pixel.Channels.R = SrcPtr[RedOffset];
+            Pixel.Channels.G = SrcPtr[1];
+            Pixel.Channels.B = SrcPtr[BlueOffset];
+            Pixel.Channels.A = SrcPtr[3];
+
+            if (Pixel.Value == PrevPixel.Value)
+            {
+                RunLength++;
+                if ((RunLength == MaxRunLength) || (PixelIndex == PixelCount - 1))
+                {
+                    *OutPtr++ = OP_RUN | (RunLength - 1);
+                    RunLength = 0;
+                }
+                continue;
+            }
+
+            if (RunLength > 0)
+            {
+                *OutPtr++ = OP_RUN | (RunLength - 1);
+                RunLength = 0;
+            }
+
+            const uint32 HashIndex = GetPixelHash(Pixel);
+            if (SeenPixels[HashIndex].Value == Pixel.Value)
+            {
+                *OutPtr++ = OP_INDEX | HashIndex;
+            }
+            else
+            {
+                SeenPixels[HashIndex] = Pixel;
+
+                if (Pixel.Channels.A == PrevPixel.Channels.A)
+                {
+                    const int8 DiffR = (int8)(Pixel.Channels.R - PrevPixel.Channels.R);
+                    const int8 DiffG = (int8)(Pixel.Channels.G - PrevPixel.Channels.G);
+                    const int8 DiffB = (int8)(Pixel.Channels.B - PrevPixel.Channels.B);
+                    const int8 DiffRG = DiffR - DiffG;
+                    const int8 DiffBG = DiffB - DiffG;
+
+                    if ((DiffR > -3) && (DiffR < 2) && (DiffG > -3) && (DiffG < 2) && (DiffB > -3) && (DiffB < 2))
+                    {
+                        *OutPtr++ = OP_DIFF | ((DiffR + 2) << 4) | ((DiffG + 2) << 2) | (DiffB + 2);
+                    }
+                    else if ((DiffRG > -9) && (DiffRG < 8) && (DiffG > -33) && (DiffG < 32) && (DiffBG > -9) && (DiffBG < 8))
+                    {
+                        *OutPtr++ = OP_LUMA | (DiffG + 32);
+                        *OutPtr++ = ((DiffRG + 8) << 4) | (DiffBG + 8);
+                    }
+                    else
+                    {
+                        *OutPtr++ = OP_RGB;
+                        *OutPtr++ = Pixel.Channels.R;
+                        *OutPtr++ = Pixel.Channels.G;
+                        *OutPtr++ = Pixel.Channels.B;
+                    }
+                }
+                else
+                {
+                    *OutPtr++ = OP_RGBA;
+                    *OutPtr++ = Pixel.Channels.R;
+                    *OutPtr++ = Pixel.Channels.G;
+                    *OutPtr++ = Pixel.Channels.B;
+                    *OutPtr++ = Pixel.Channels.A;
+                }
+            }
+
+            PrevPixel = Pixel;
+        }
+
+        FMemory::Memcpy(OutPtr, EndMarker, sizeof(EndMarker));
+        OutPtr += sizeof(EndMarker);
+
+        CompressedData.SetNum(OutPtr - CompressedData.GetData(), false);
+        return CompressedData;
+    }
+
+    bool Decode(const uint8* CompressedData, int32 CompressedSize, TArray<uint8>& OutPixels, int32& OutWidth, int32& OutHeight, bool bOutputBGRA)
+    {
+        OutPixels.Reset();
+        OutWidth = 0;
+        OutHeight = 0;
+
+        if (!CompressedData || (CompressedSize < HeaderByteSize + (int32)sizeof(EndMarker)))
+        {
+            return false;
+        }
+
+        if ((CompressedData[0] != 'q') || (CompressedData[1] != 'o') || (CompressedData[2] != 'i') || (CompressedData[3] != 'f'))
+        {
+            return false;
+        }
+
+        const uint32 Width = ReadBigEndianUInt32(CompressedData + 4);
+        const uint32 Height = ReadBigEndianUInt32(CompressedData + 8);
+        const uint8 ChannelCount = CompressedData[12];
+        const uint8 ColorSpace = CompressedData[13];
+        if ((Width == 0) || (Height == 0) || (ChannelCount < 3) || (ChannelCount > 4) || (ColorSpace > 1))
+        {
+            return false;
+        }
+
+        const int64 PixelCount = (int64)Width * Height;
+        if (PixelCount * 4 > MAX_int32)
+        {
+            return false;
+        }
+
+        OutPixels.SetNumUninitialized(PixelCount * 4);
+        uint8* DestPtr = OutPixels.GetData();
+
+        FQOIPixel SeenPixels[64];
+        FMemory::Memzero(SeenPixels, sizeof(SeenPixels));
+
+        FQOIPixel Pixel;
+        Pixel.Channels.R = 0;
+        Pixel.Channels.G = 0;
+        Pixel.Channels.B = 0;
+        Pixel.Channels.A = 255;
+
+        const int32 RedOffset = bOutputBGRA ? 2 : 0;
+        const int32 BlueOffset = bOutputBGRA ? 0 : 2;
+
+        const int32 ChunksEnd = CompressedSize - sizeof(EndMarker);
+        int32 ReadPos = HeaderByteSize;
+        int32 RunLength = 0;
+        for (int64 PixelIndex = 0; PixelIndex < PixelCount; PixelIndex++, DestPtr += 4)
+        {
+            if (RunLength > 0)
+            {
+                RunLength--;
+            }
+            else if (ReadPos < ChunksEnd)
+            {
+                const uint8 Tag = CompressedData[ReadPos++];
+                if (Tag == OP_RGB)
+                {
+                    if (ReadPos + 3 > ChunksEnd)
+                    {
+                        return false;
+                    }
+                    Pixel.Channels.R = CompressedData[ReadPos++];
+                    Pixel.Channels.G = CompressedData[ReadPos++];
+                    Pixel.Channels.B = CompressedData[ReadPos++];
+                }
+                else if (Tag == OP_RGBA)
+                {
+                    if (ReadPos + 4 > ChunksEnd)
+                    {
+                        return false;
+                    }
+                    Pixel.Channels.R = CompressedData[ReadPos++];
+                    Pixel.Channels.G = CompressedData[ReadPos++];
+                    Pixel.Channels.B = CompressedData[ReadPos++];
+                    Pixel.Channels.A = CompressedData[ReadPos++];
+                }
+                else if ((Tag & OP_MASK) == OP_INDEX)
+                {
+                    Pixel = SeenPixels[Tag];
+                }
+                else if ((Tag & OP_MASK) == OP_DIFF)
+                {
+                    Pixel.Channels.R += ((Tag >> 4) & 0x03) - 2;
+                    Pixel.Channels.G += ((Tag >> 2) & 0x03) - 2;
+                    Pixel.Channels.B += (Tag & 0x03) - 2;
+                }
+                else if ((Tag & OP_MASK) == OP_LUMA)
+                {
+                    if (ReadPos + 1 > ChunksEnd)
+                    {
+                        return false;
+                    }
+                    const uint8 SecondByte = CompressedData[ReadPos++];
+                    const int32 DiffG = (Tag & 0x3F) - 32;
+                    Pixel.Channels.R += DiffG - 8 + ((SecondByte >> 4) & 0x0F);
+                    Pixel.Channels.G += DiffG;
+                    Pixel.Channels.B += DiffG - 8 + (SecondByte & 0x0F);
+                }
+                else
+                {
+                    RunLength = (Tag & 0x3F);
+                }
+
+                SeenPixels[GetPixelHash(Pixel)] = Pixel;
+            }
+            else
+            {
+                // The chunks ended before all the pixels are decoded
+                return false;
+            }
+
+            DestPtr[RedOffset] = Pixel.Channels.R;
+            DestPtr[1] = Pixel.Channels.G;
+            DestPtr[BlueOffset] = Pixel.Channels.B;
+            DestPtr[3] = Pixel.Channels.A;
+        }
+
+        OutWidth = Width;
+        OutHeight = Height;
+        return true;
+    }
+};
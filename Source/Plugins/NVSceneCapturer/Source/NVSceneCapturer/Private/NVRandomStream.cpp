@@ -0,0 +1,816 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVRandomStream.h"
+#include "NVSceneCapturerUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    int32 RandomStreamMasterSeed = 0;
+    int32 RandomStreamEpoch = 0;
+
+    // Philox4x32-10 constants
+    const uint32 PhiloxM0 = 0xD2511F53;
+    const uint32 PhiloxM1 = 0xCD9E8D57;
+    const uint32 PhiloxW0 = 0x9E3779B9;
+    const uint32 PhiloxW1 = 0xBB67AE85;
+    const int32 PhiloxRoundCount = 10;
+    // The last word of the counter, the other words are the block index and the epoch
+    const uint32 PhiloxCounterTag = 0x4E565253;
+
+    // Number of values the batches draw at a time, it's a multiple of 2, 3 and 4 so the items never straddle 2 chunks
+    const int32 BatchChunkSize = 384;
+
+    // Ziggurat tables for the normal distribution, with 128 layers
+    // Reference: G. Marsaglia and W. W. Tsang, "The Ziggurat Method for Generating Random Variables", 2000
+    const float ZigguratR = 3.442620f;
+    struct FZigguratTables
+    {
+        uint32 Kn[128];
+        float Wn[128];
+        float Fn[128];
+
+        FZigguratTables()
+        {
+            const double M1 = 2147483648.0;
+            const double Vn = 9.91256303526217e-3;
+            double Dn = 3.442619855899;
+            double Tn = Dn;
+            // NOTE: The tables are computed in double precision, FMath only has the float versions
+            const double Q = Vn / exp(-0.5 * Dn * Dn);
+
+            Kn[0] = (uint32)((Dn / Q) * M1);
+            Kn[1] = 0;
+            Wn[0] = (float)(Q / M1);
+            Wn[127] = (float)(Dn / M1);
+            Fn[0] = 1.f;
+            Fn[127] = (float)exp(-0.5 * Dn * Dn);
+            for (int32 i = 126; i >= 1; i--)
+            {
+                Dn = sqrt(-2.0 * log(Vn / Dn + exp(-0.5 * Dn * Dn)));
+                Kn[i + 1] = (uint32)((Dn / Tn) * M1);
+                Tn = Dn;
+                Fn[i] = (float)exp(-0.5 * Dn * Dn);
+                Wn[i] = (float)(Dn / M1);
+            }
+        }
+    };
+    const FZigguratTables ZigguratTables;
+
+    FORCEINLINE bool IsInsideZigguratLayer(int32 Hz, uint32 Layer)
+    {
+        return (uint32)FMath::Abs((int64)Hz) < ZigguratTables.Kn[Layer];
+    }
+
+    FAutoConsoleCommand TestRandomStreamCommand(
+        TEXT("NV.TestRandomStream"),
+        TEXT("Check the random streams' reference values, determinism and distributions"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FNVRandomStream::RunSelfTest();
+        }));
+
+    FAutoConsoleCommand BenchmarkRandomStreamCommand(
+        TEXT("NV.BenchmarkRandomStream"),
+        TEXT("Print the throughput of the random streams. Usage: NV.BenchmarkRandomStream [SampleCount]"),
+        FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+        {
+            const int32 SampleCount = (Args.Num() > 0) ? FCString::Atoi(*Args[0]) : (1 << 22);
+            FNVRandomStream::RunThroughputTest(SampleCount);
+        }));
+}
+
+//================================== FNVRandomStream ==================================
+// NOTE: The constants are passed by reference, e.g: to FMath::Min
+const int32 FNVRandomStream::BlockLaneCount;
+const int32 FNVRandomStream::BufferSize;
+
+FNVRandomStream::FNVRandomStream()
+{
+    bInitialized = false;
+    bEpochPinned = false;
+    StreamId = 0;
+    StreamMasterSeed = RandomStreamMasterSeed;
+    StreamEpoch = RandomStreamEpoch;
+    ResetCounter();
+}
+
+FNVRandomStream::FNVRandomStream(const FString& StreamName) : FNVRandomStream()
+{
+    Initialize(StreamName);
+}
+
+void FNVRandomStream::Initialize(const FString& StreamName)
+{
+    StreamId = FCrc::StrCrc32(*StreamName);
+    bInitialized = true;
+    bEpochPinned = false;
+
+    StreamMasterSeed = RandomStreamMasterSeed;
+    StreamEpoch = RandomStreamEpoch;
+    ResetCounter();
+}
+
+void FNVRandomStream::SetMasterSeed(int32 InMasterSeed, int32 InEpoch/*= 0*/)
+{
+    RandomStreamMasterSeed = InMasterSeed;
+    RandomStreamEpoch = InEpoch;
+}
+
+int32 FNVRandomStream::GetMasterSeed()
+{
+    return RandomStreamMasterSeed;
+}
+
+int32 FNVRandomStream::GetEpoch()
+{
+    return RandomStreamEpoch;
+}
+
+void FNVRandomStream::PinEpoch(int32 InMasterSeed, int32 InEpoch)
+{
+    bEpochPinned = true;
+    StreamMasterSeed = InMasterSeed;
+    StreamEpoch = InEpoch;
+    ResetCounter();
+}
+
+void FNVRandomStream::SyncMasterSeed()
+{
+    if (!bEpochPinned && ((StreamMasterSeed != RandomStreamMasterSeed) || (StreamEpoch != RandomStreamEpoch)))
+    {
+        StreamMasterSeed = RandomStreamMasterSeed;
+        StreamEpoch = RandomStreamEpoch;
+        ResetCounter();
+    }
+}
+
+void FNVRandomStream::ResetCounter()
+{
+    BlockIndex = 0;
+    BufferIndex = BufferSize;
+}
+
+void FNVRandomStream::Philox4x32(const uint32 Counter[4], const uint32 Key[2], uint32 OutValues[4])
+{
+    uint32 C0 = Counter[0];
+    uint32 C1 = Counter[1];
+    uint32 C2 = Counter[2];
+    uint32 C3 = Counter[3];
+    uint32 K0 = Key[0];
+    uint32 K1 = Key[1];
+    for (int32 Round = 0; Round < PhiloxRoundCount; Round++)
+    {
+        const uint64 P0 = (uint64)PhiloxM0 * C0;
+        const uint64 P1 = (uint64)PhiloxM1 * C2;
+        C0 = (uint32)(P1 >> 32) ^ C1 ^ K0;
+        C1 = (uint32)P1;
+        C2 = (uint32)(P0 >> 32) ^ C3 ^ K1;
+        C3 = (uint32)P0;
+        K0 += PhiloxW0;
+        K1 += PhiloxW1;
+    }
+    OutValues[0] = C0;
+    OutValues[1] = C1;
+    OutValues[2] = C2;
+    OutValues[3] = C3;
+}
+
+void FNVRandomStream::GenerateBlocks(uint32* OutValues, int32 BlockCount)
+{
+    // NOTE: Same rounds as Philox4x32 but on BlockLaneCount counters at a time, stored as separated arrays so each step is a vector operation
+    uint32 C0[BlockLaneCount];
+    uint32 C1[BlockLaneCount];
+    uint32 C2[BlockLaneCount];
+    uint32 C3[BlockLaneCount];
+    for (int32 FirstBlock = 0; FirstBlock < BlockCount; FirstBlock += BlockLaneCount)
+    {
+        for (int32 Lane = 0; Lane < BlockLaneCount; Lane++)
+        {
+            const uint64 LaneBlockIndex = BlockIndex + Lane;
+            C0[Lane] = (uint32)LaneBlockIndex;
+            C1[Lane] = (uint32)(LaneBlockIndex >> 32);
+            C2[Lane] = (uint32)StreamEpoch;
+            C3[Lane] = PhiloxCounterTag;
+        }
+
+        uint32 K0 = (uint32)StreamMasterSeed;
+        uint32 K1 = StreamId;
+        for (int32 Round = 0; Round < PhiloxRoundCount; Round++)
+        {
+            for (int32 Lane = 0; Lane < BlockLaneCount; Lane++)
+            {
+                const uint64 P0 = (uint64)PhiloxM0 * C0[Lane];
+                const uint64 P1 = (uint64)PhiloxM1 * C2[Lane];
+                const uint32 NewC0 = (uint32)(P1 >> 32) ^ C1[Lane] ^ K0;
+                const uint32 NewC2 = (uint32)(P0 >> 32) ^ C3[Lane] ^ K1;
+                C0[Lane] = NewC0;
+                C1[Lane] = (uint32)P1;
+                C2[Lane] = NewC2;
+                C3[Lane] = (uint32)P0;
+            }
+            K0 += PhiloxW0;
+            K1 += PhiloxW1;
+        }
+
+        const int32 GroupBlockCount = FMath::Min(BlockLaneCount, BlockCount - FirstBlock);
+        uint32* GroupValues = OutValues + FirstBlock * 4;
+        for (int32 Lane = 0; Lane < GroupBlockCount; Lane++)
+        {
+            GroupValues[Lane * 4 + 0] = C0[Lane];
+            GroupValues[Lane * 4 + 1] = C1[Lane];
+            GroupValues[Lane * 4 + 2] = C2[Lane];
+            GroupValues[Lane * 4 + 3] = C3[Lane];
+        }
+        BlockIndex += GroupBlockCount;
+    }
+}
+
+uint32 FNVRandomStream::GetUnsignedInt()
+{
+    SyncMasterSeed();
+    if (BufferIndex >= BufferSize)
+    {
+        GenerateBlocks(Buffer, BlockLaneCount);
+        BufferIndex = 0;
+    }
+    return Buffer[BufferIndex++];
+}
+
+float FNVRandomStream::GetFraction()
+{
+    return ToFraction(GetUnsignedInt());
+}
+
+int32 FNVRandomStream::RandHelper(int32 Count)
+{
+    // NOTE: Scale the value instead of using a modulo, the low bits don't get more weight
+    return (Count > 0) ? (int32)(((uint64)GetUnsignedInt() * (uint64)Count) >> 32) : 0;
+}
+
+int32 FNVRandomStream::RandRange(int32 Min, int32 Max)
+{
+    const int32 Range = (Max - Min) + 1;
+    return Min + RandHelper(Range);
+}
+
+float FNVRandomStream::FRandRange(float Min, float Max)
+{
+    return Min + (Max - Min) * GetFraction();
+}
+
+float FNVRandomStream::Gaussian(float Mean/*= 0.f*/, float StdDev/*= 1.f*/)
+{
+    // NOTE: The layer is chosen with another value than the one scaled in the layer, they would be correlated otherwise
+    const int32 Hz = (int32)GetUnsignedInt();
+    const uint32 Layer = GetUnsignedInt() & 127;
+    const float Value = IsInsideZigguratLayer(Hz, Layer) ? (Hz * ZigguratTables.Wn[Layer]) : GaussianSlowPath(Hz, Layer);
+    return Mean + Value * StdDev;
+}
+
+float FNVRandomStream::GaussianSlowPath(int32 Hz, uint32 Layer)
+{
+    for (;;)
+    {
+        float X = Hz * ZigguratTables.Wn[Layer];
+        // The base layer: sample from the tail
+        if (Layer == 0)
+        {
+            float Y = 0.f;
+            do
+            {
+                X = -FMath::Loge(1.f - GetFraction()) / ZigguratR;
+                Y = -FMath::Loge(1.f - GetFraction());
+            } while (Y + Y < X * X);
+            return (Hz > 0) ? (ZigguratR + X) : (-ZigguratR - X);
+        }
+
+        // The wedge of the layer: accept if it's under the curve
+        const float LayerFn = ZigguratTables.Fn[Layer];
+        if (LayerFn + GetFraction() * (ZigguratTables.Fn[Layer - 1] - LayerFn) < FMath::Exp(-0.5f * X * X))
+        {
+            return X;
+        }
+
+        Hz = (int32)GetUnsignedInt();
+        Layer = GetUnsignedInt() & 127;
+        if (IsInsideZigguratLayer(Hz, Layer))
+        {
+            return Hz * ZigguratTables.Wn[Layer];
+        }
+    }
+}
+
+FVector FNVRandomStream::PointInBox(const FBox& Box)
+{
+    const float X = GetFraction();
+    const float Y = GetFraction();
+    const float Z = GetFraction();
+    return Box.Min + (Box.Max - Box.Min) * FVector(X, Y, Z);
+}
+
+FVector FNVRandomStream::UnitVector()
+{
+    const float Z = 2.f * GetFraction() - 1.f;
+    const float Phi = 2.f * PI * GetFraction();
+    const float Radius = FMath::Sqrt(FMath::Max(1.f - Z * Z, 0.f));
+    return FVector(Radius * FMath::Cos(Phi), Radius * FMath::Sin(Phi), Z);
+}
+
+FVector FNVRandomStream::VRandCone(const FVector& Dir, float ConeHalfAngleRad)
+{
+    if (ConeHalfAngleRad > 0.f)
+    {
+        const float RandU = GetFraction();
+        const float RandV = GetFraction();
+
+        // Get spherical coords that have an even distribution over the unit sphere
+        // Method described at http://mathworld.wolfram.com/SpherePointPicking.html
+        const float Theta = 2.f * PI * RandU;
+        float Phi = FMath::Acos((2.f * RandV) - 1.f);
+
+        // restrict phi to [0, ConeHalfAngleRad]
+        // this gives an even distribution of points on the surface of the cone
+        // centered at the origin, pointing upward (z), with the desired angle
+        Phi = FMath::Fmod(Phi, ConeHalfAngleRad);
+
+        // get axes we need to rotate around
+        const FMatrix DirMat = FRotationMatrix(Dir.Rotation());
+        // note the axis translation, since we want the variation to be around X
+        const FVector DirZ = DirMat.GetScaledAxis(EAxis::X);
+        const FVector DirY = DirMat.GetScaledAxis(EAxis::Y);
+
+        FVector Result = Dir.RotateAngleAxis(Phi * 180.f / PI, DirY);
+        Result = Result.RotateAngleAxis(Theta * 180.f / PI, DirZ);
+        return Result.GetSafeNormal();
+    }
+    return Dir.GetSafeNormal();
+}
+
+FQuat FNVRandomStream::Rotation()
+{
+    // Reference: K. Shoemake, "Uniform Random Rotations", Graphics Gems III, 1992
+    const float U1 = GetFraction();
+    const float Theta2 = 2.f * PI * GetFraction();
+    const float Theta3 = 2.f * PI * GetFraction();
+    const float S1 = FMath::Sqrt(1.f - U1);
+    const float S2 = FMath::Sqrt(U1);
+    return FQuat(S1 * FMath::Sin(Theta2), S1 * FMath::Cos(Theta2), S2 * FMath::Sin(Theta3), S2 * FMath::Cos(Theta3));
+}
+
+void FNVRandomStream::FillUnsignedInts(TArrayView<uint32> OutValues)
+{
+    SyncMasterSeed();
+
+    uint32* DestValues = OutValues.GetData();
+    int32 RemainingCount = OutValues.Num();
+
+    // Use the values left in the current blocks first, so the batch continue the stream's sequence
+    while ((RemainingCount > 0) && (BufferIndex < BufferSize))
+    {
+        *DestValues++ = Buffer[BufferIndex++];
+        RemainingCount--;
+    }
+
+    const int32 BlockCount = RemainingCount / 4;
+    if (BlockCount > 0)
+    {
+        GenerateBlocks(DestValues, BlockCount);
+        DestValues += BlockCount * 4;
+        RemainingCount -= BlockCount * 4;
+    }
+
+    while (RemainingCount > 0)
+    {
+        *DestValues++ = GetUnsignedInt();
+        RemainingCount--;
+    }
+}
+
+void FNVRandomStream::FillUniform(TArrayView<float> OutValues, float Min/*= 0.f*/, float Max/*= 1.f*/)
+{
+    uint32 ChunkValues[BatchChunkSize];
+    const float Range = Max - Min;
+    for (int32 FirstIndex = 0; FirstIndex < OutValues.Num(); FirstIndex += BatchChunkSize)
+    {
+        const int32 ChunkCount = FMath::Min(BatchChunkSize, OutValues.Num() - FirstIndex);
+        FillUnsignedInts(TArrayView<uint32>(ChunkValues, ChunkCount));
+
+        float* DestValues = OutValues.GetData() + FirstIndex;
+        for (int32 i = 0; i < ChunkCount; i++)
+        {
+            DestValues[i] = Min + Range * ToFraction(ChunkValues[i]);
+        }
+    }
+}
+
+void FNVRandomStream::FillGaussian(TArrayView<float> OutValues, float Mean/*= 0.f*/, float StdDev/*= 1.f*/)
+{
+    // NOTE: Each value use 2 values of the chunk, the few values outside of the layers' rectangles draw more values from the stream
+    uint32 ChunkValues[BatchChunkSize];
+    const int32 ChunkItemCount = BatchChunkSize / 2;
+    for (int32 FirstIndex = 0; FirstIndex < OutValues.Num(); FirstIndex += ChunkItemCount)
+    {
+        const int32 ItemCount = FMath::Min(ChunkItemCount, OutValues.Num() - FirstIndex);
+        FillUnsignedInts(TArrayView<uint32>(ChunkValues, ItemCount * 2));
+
+        float* DestValues = OutValues.GetData() + FirstIndex;
+        for (int32 i = 0; i < ItemCount; i++)
+        {
+            const int32 Hz = (int32)ChunkValues[i * 2];
+            const uint32 Layer = ChunkValues[i * 2 + 1] & 127;
+            const float Value = IsInsideZigguratLayer(Hz, Layer) ? (Hz * ZigguratTables.Wn[Layer]) : GaussianSlowPath(Hz, Layer);
+            DestValues[i] = Mean + Value * StdDev;
+        }
+    }
+}
+
+void FNVRandomStream::FillPointsInBox(TArrayView<FVector> OutPoints, const FBox& Box)
+{
+    uint32 ChunkValues[BatchChunkSize];
+    const int32 ChunkItemCount = BatchChunkSize / 3;
+    const FVector BoxSize = Box.Max - Box.Min;
+    for (int32 FirstIndex = 0; FirstIndex < OutPoints.Num(); FirstIndex += ChunkItemCount)
+    {
+        const int32 ItemCount = FMath::Min(ChunkItemCount, OutPoints.Num() - FirstIndex);
+        FillUnsignedInts(TArrayView<uint32>(ChunkValues, ItemCount * 3));
+
+        FVector* DestPoints = OutPoints.GetData() + FirstIndex;
+        for (int32 i = 0; i < ItemCount; i++)
+        {
+            DestPoints[i].X = Box.Min.X + BoxSize.X * ToFraction(ChunkValues[i * 3 + 0]);
+            DestPoints[i].Y = Box.Min.Y + BoxSize.Y * ToFraction(ChunkValues[i * 3 + 1]);
+            DestPoints[i].Z = Box.Min.Z + BoxSize.Z * ToFraction(ChunkValues[i * 3 + 2]);
+        }
+    }
+}
+
+void FNVRandomStream::FillUnitVectors(TArrayView<FVector> OutVectors)
+{
+    uint32 ChunkValues[BatchChunkSize];
+    const int32 ChunkItemCount = BatchChunkSize / 2;
+    for (int32 FirstIndex = 0; FirstIndex < OutVectors.Num(); FirstIndex += ChunkItemCount)
+    {
+        const int32 ItemCount = FMath::Min(ChunkItemCount, OutVectors.Num() - FirstIndex);
+        FillUnsignedInts(TArrayView<uint32>(ChunkValues, ItemCount * 2));
+
+        FVector* DestVectors = OutVectors.GetData() + FirstIndex;
+        for (int32 i = 0; i < ItemCount; i++)
+        {
+            const float Z = 2.f * ToFraction(ChunkValues[i * 2]) - 1.f;
+            const float Phi = 2.f * PI * ToFraction(ChunkValues[i * 2 + 1]);
+            const float Radius = FMath::Sqrt(FMath::Max(1.f - Z * Z, 0.f));
+            DestVectors[i] = FVector(Radius * FMath::Cos(Phi), Radius * FMath::Sin(Phi), Z);
+        }
+    }
+}
+
+void FNVRandomStream::FillRotations(TArrayView<FQuat> OutRotations)
+{
+    uint32 ChunkValues[BatchChunkSize];
+    const int32 ChunkItemCount = BatchChunkSize / 3;
+    for (int32 FirstIndex = 0; FirstIndex < OutRotations.Num(); FirstIndex += ChunkItemCount)
+    {
+        const int32 ItemCount = FMath::Min(ChunkItemCount, OutRotations.Num() - FirstIndex);
+        FillUnsignedInts(TArrayView<uint32>(ChunkValues, ItemCount * 3));
+
+        FQuat* DestRotations = OutRotations.GetData() + FirstIndex;
+        for (int32 i = 0; i < ItemCount; i++)
+        {
+            const float U1 = ToFraction(ChunkValues[i * 3 + 0]);
+            const float Theta2 = 2.f * PI * ToFraction(ChunkValues[i * 3 + 1]);
+            const float Theta3 = 2.f * PI * ToFraction(ChunkValues[i * 3 + 2]);
+            const float S1 = FMath::Sqrt(1.f - U1);
+            const float S2 = FMath::Sqrt(U1);
+            DestRotations[i] = FQuat(S1 * FMath::Sin(Theta2), S1 * FMath::Cos(Theta2), S2 * FMath::Sin(Theta3), S2 * FMath::Cos(Theta3));
+        }
+    }
+}
+
+bool FNVRandomStream::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Random stream"), LogNVSceneCapturer);
+
+    const int32 SavedMasterSeed = RandomStreamMasterSeed;
+    const int32 SavedEpoch = RandomStreamEpoch;
+    SetMasterSeed(1234, 0);
+
+    // Known answers of Philox4x32-10 from the Random123 library
+    {
+        const uint32 ZeroCounter[4] = { 0, 0, 0, 0 };
+        const uint32 ZeroKey[2] = { 0, 0 };
+        const uint32 ZeroExpected[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+        const uint32 PiCounter[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 };
+        const uint32 PiKey[2] = { 0xa4093822, 0x299f31d0 };
+        const uint32 PiExpected[4] = { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 };
+        uint32 Values[4];
+        Philox4x32(ZeroCounter, ZeroKey, Values);
+        TestResult.Check(FMemory::Memcmp(Values, ZeroExpected, sizeof(Values)) == 0, TEXT("Philox known answer (zero)"));
+        Philox4x32(PiCounter, PiKey, Values);
+        TestResult.Check(FMemory::Memcmp(Values, PiExpected, sizeof(Values)) == 0, TEXT("Philox known answer (pi)"));
+
+        // The vectorized blocks are the same as the reference bijection
+        FNVRandomStream TestStream(TEXT("Test.Blocks"));
+        uint32 BlockValues[4 * (BlockLaneCount + 3)];
+        TestStream.GenerateBlocks(BlockValues, BlockLaneCount + 3);
+        bool bBlocksMatch = true;
+        for (int32 i = 0; i < BlockLaneCount + 3; i++)
+        {
+            const uint32 Counter[4] = { (uint32)i, 0, 0, PhiloxCounterTag };
+            const uint32 Key[2] = { 1234, TestStream.GetStreamId() };
+            Philox4x32(Counter, Key, Values);
+            bBlocksMatch &= (FMemory::Memcmp(Values, BlockValues + i * 4, sizeof(Values)) == 0);
+        }
+        TestResult.Check(bBlocksMatch, TEXT("vectorized blocks don't match the reference"));
+    }
+
+    // Determinism: a stream's values only depend on the master seed, its name, the epoch and their index
+    {
+        FNVRandomStream StreamA(TEXT("Test.A"));
+        FNVRandomStream StreamA2(TEXT("Test.A"));
+        FNVRandomStream StreamB(TEXT("Test.B"));
+        TArray<uint32> ValuesA, ValuesB;
+        for (int32 i = 0; i < 100; i++)
+        {
+            ValuesA.Add(StreamA.GetUnsignedInt());
+            ValuesB.Add(StreamB.GetUnsignedInt());
+            // Drawing from another stream doesn't change this one's values
+            StreamB.GetUnsignedInt();
+        }
+        bool bSameValues = true;
+        for (int32 i = 0; i < 100; i++)
+        {
+            bSameValues &= (StreamA2.GetUnsignedInt() == ValuesA[i]);
+        }
+        TestResult.Check(bSameValues, TEXT("streams with the same name have different values"));
+        TestResult.Check(ValuesA != ValuesB, TEXT("streams with different names have the same values"));
+
+        // The streams restart when the epoch change, and come back to the same values with the same epoch
+        SetMasterSeed(1234, 1);
+        const uint32 Epoch1Value = StreamA.GetUnsignedInt();
+        SetMasterSeed(1234, 0);
+        TestResult.Check(StreamA.GetUnsignedInt() == ValuesA[0], TEXT("stream didn't restart with the epoch"));
+        TestResult.Check(Epoch1Value != ValuesA[0], TEXT("different epochs have the same values"));
+        SetMasterSeed(4321, 0);
+        TestResult.Check(StreamA.GetUnsignedInt() != ValuesA[0], TEXT("different master seeds have the same values"));
+        SetMasterSeed(1234, 0);
+
+        // A pinned stream draw the values of its epoch and ignore the master seed's changes
+        FNVRandomStream PinnedStream(TEXT("Test.A"));
+        PinnedStream.PinEpoch(1234, 1);
+        SetMasterSeed(4321, 7);
+        TestResult.Check(PinnedStream.GetUnsignedInt() == Epoch1Value, TEXT("pinned stream doesn't draw its epoch's values"));
+        SetMasterSeed(1234, 0);
+
+        // A batch continue the sequence of the single values
+        FNVRandomStream BatchStream(TEXT("Test.A"));
+        TArray<uint32> BatchValues;
+        BatchValues.SetNumUninitialized(97);
+        BatchStream.GetUnsignedInt();
+        BatchStream.FillUnsignedInts(TArrayView<uint32>(BatchValues.GetData(), 97));
+        bool bBatchMatch = true;
+        for (int32 i = 0; i < 97; i++)
+        {
+            bBatchMatch &= (BatchValues[i] == ValuesA[i + 1]);
+        }
+        TestResult.Check(bBatchMatch && (BatchStream.GetUnsignedInt() == ValuesA[98]), TEXT("batch doesn't continue the stream's sequence"));
+
+        FNVRandomStream PointStream(TEXT("Test.Points")), PointStream2(TEXT("Test.Points"));
+        const FBox TestBox(FVector(-10.f, 0.f, 5.f), FVector(10.f, 1.f, 6.f));
+        TArray<FVector> BatchPoints;
+        BatchPoints.SetNumUninitialized(200);
+        PointStream.FillPointsInBox(BatchPoints, TestBox);
+        bool bPointsMatch = true;
+        for (const FVector& BatchPoint : BatchPoints)
+        {
+            bPointsMatch &= BatchPoint.Equals(PointStream2.PointInBox(TestBox), 1e-4f) && TestBox.IsInsideOrOn(BatchPoint);
+        }
+        TestResult.Check(bPointsMatch, TEXT("batched points in box don't match the single points"));
+
+        // The components' streams don't share any state: drawing them on worker threads at the same time give the same values as drawing them in turn
+        const int32 ParallelStreamCount = 8;
+        const int32 ParallelValueCount = 4096;
+        TArray<TArray<uint32>> ParallelValues;
+        ParallelValues.SetNum(ParallelStreamCount);
+        ParallelFor(ParallelStreamCount, [&ParallelValues](int32 StreamIndex)
+        {
+            FNVRandomStream ParallelStream(FString::Printf(TEXT("Test.Parallel%d"), StreamIndex));
+            ParallelValues[StreamIndex].SetNumUninitialized(ParallelValueCount);
+            ParallelStream.FillUnsignedInts(ParallelValues[StreamIndex]);
+        });
+        bool bParallelMatch = true;
+        for (int32 StreamIndex = 0; StreamIndex < ParallelStreamCount; StreamIndex++)
+        {
+            FNVRandomStream SequentialStream(FString::Printf(TEXT("Test.Parallel%d"), StreamIndex));
+            for (int32 i = 0; i < ParallelValueCount; i++)
+            {
+                bParallelMatch &= (SequentialStream.GetUnsignedInt() == ParallelValues[StreamIndex][i]);
+            }
+        }
+        TestResult.Check(bParallelMatch, TEXT("streams drawn on worker threads have different values"));
+    }
+
+    // Distributions
+    const int32 SampleCount = 1 << 20;
+    {
+        FNVRandomStream UniformStream(TEXT("Test.Uniform"));
+        TArray<float> Samples;
+        Samples.SetNumUninitialized(SampleCount);
+        UniformStream.FillUniform(Samples);
+
+        const int32 BinCount = 64;
+        int32 Bins[BinCount] = { 0 };
+        double Sum = 0.0;
+        bool bInRange = true;
+        for (const float Sample : Samples)
+        {
+            bInRange &= (Sample >= 0.f) && (Sample < 1.f);
+            Sum += Sample;
+            Bins[FMath::Min((int32)(Sample * BinCount), BinCount - 1)]++;
+        }
+        double ChiSquare = 0.0;
+        const double ExpectedBinCount = (double)SampleCount / BinCount;
+        for (int32 i = 0; i < BinCount; i++)
+        {
+            ChiSquare += FMath::Square(Bins[i] - ExpectedBinCount) / ExpectedBinCount;
+        }
+        const double Mean = Sum / SampleCount;
+        TestResult.Check(bInRange, TEXT("uniform value out of [0, 1)"));
+        TestResult.Check(FMath::Abs(Mean - 0.5) < 5.0 * FMath::Sqrt(1.0 / 12.0 / SampleCount), TEXT("uniform mean"));
+        // NOTE: The 99.99% quantile of the chi-square distribution with 63 degrees of freedom is about 113
+        TestResult.Check(ChiSquare < 113.0, TEXT("uniform chi-square"));
+
+        // The streams of different components aren't correlated
+        FNVRandomStream OtherStream(TEXT("Test.Uniform2"));
+        TArray<float> OtherSamples;
+        OtherSamples.SetNumUninitialized(SampleCount);
+        OtherStream.FillUniform(OtherSamples);
+        double Covariance = 0.0;
+        for (int32 i = 0; i < SampleCount; i++)
+        {
+            Covariance += (Samples[i] - 0.5) * (OtherSamples[i] - 0.5);
+        }
+        const double Correlation = (Covariance / SampleCount) * 12.0;
+        TestResult.Check(FMath::Abs(Correlation) < 5.0 / FMath::Sqrt((double)SampleCount), TEXT("streams are correlated"));
+
+        int32 IntBins[10] = { 0 };
+        bool bIntInRange = true;
+        for (int32 i = 0; i < 100000; i++)
+        {
+            const int32 Value = UniformStream.RandRange(3, 12);
+            bIntInRange &= (Value >= 3) && (Value <= 12);
+            IntBins[FMath::Clamp(Value - 3, 0, 9)]++;
+        }
+        double IntChiSquare = 0.0;
+        for (int32 i = 0; i < 10; i++)
+        {
+            IntChiSquare += FMath::Square(IntBins[i] - 10000.0) / 10000.0;
+        }
+        TestResult.Check(bIntInRange, TEXT("integer out of range"));
+        // NOTE: The 99.99% quantile with 9 degrees of freedom is about 33.7
+        TestResult.Check(IntChiSquare < 33.7, TEXT("integer chi-square"));
+    }
+
+    {
+        FNVRandomStream GaussianStream(TEXT("Test.Gaussian"));
+        TArray<float> Samples;
+        Samples.SetNumUninitialized(SampleCount);
+        GaussianStream.FillGaussian(Samples);
+        double Sum = 0.0, SquareSum = 0.0;
+        int32 InOneSigmaCount = 0, OutThreeSigmaCount = 0;
+        for (const float Sample : Samples)
+        {
+            Sum += Sample;
+            SquareSum += Sample * Sample;
+            InOneSigmaCount += (FMath::Abs(Sample) < 1.f) ? 1 : 0;
+            OutThreeSigmaCount += (FMath::Abs(Sample) > 3.f) ? 1 : 0;
+        }
+        const double Mean = Sum / SampleCount;
+        const double Variance = SquareSum / SampleCount - Mean * Mean;
+        TestResult.Check(FMath::Abs(Mean) < 5.0 / FMath::Sqrt((double)SampleCount), TEXT("gaussian mean"));
+        TestResult.Check(FMath::Abs(Variance - 1.0) < 5.0 * FMath::Sqrt(2.0 / SampleCount), TEXT("gaussian variance"));
+        TestResult.Check(FMath::Abs((double)InOneSigmaCount / SampleCount - 0.682689) < 0.003, TEXT("gaussian values within 1 sigma"));
+        TestResult.Check(FMath::Abs((double)OutThreeSigmaCount / SampleCount - 0.002700) < 0.0003, TEXT("gaussian values beyond 3 sigma"));
+
+        const float SingleValue = GaussianStream.Gaussian(10.f, 0.5f);
+        TestResult.Check(FMath::IsFinite(SingleValue) && FMath::Abs(SingleValue - 10.f) < 5.f, TEXT("single gaussian value"));
+    }
+
+    {
+        FNVRandomStream SphereStream(TEXT("Test.Sphere"));
+        TArray<FVector> Directions;
+        Directions.SetNumUninitialized(SampleCount);
+        SphereStream.FillUnitVectors(Directions);
+        FVector Sum = FVector::ZeroVector;
+        bool bNormalized = true;
+        for (const FVector& Direction : Directions)
+        {
+            bNormalized &= FMath::IsNearlyEqual(Direction.SizeSquared(), 1.f, 1e-4f);
+            Sum += Direction;
+        }
+        TestResult.Check(bNormalized, TEXT("unit vector isn't normalized"));
+        TestResult.Check((Sum / SampleCount).Size() < 5.f * FMath::Sqrt(1.f / 3.f / SampleCount) * 2.f, TEXT("unit vectors mean"));
+
+        TArray<FQuat> Rotations;
+        Rotations.SetNumUninitialized(SampleCount / 4);
+        SphereStream.FillRotations(Rotations);
+        FVector RotatedSum = FVector::ZeroVector;
+        bNormalized = true;
+        for (const FQuat& Rotation : Rotations)
+        {
+            bNormalized &= Rotation.IsNormalized();
+            RotatedSum += Rotation.RotateVector(FVector::ForwardVector);
+        }
+        TestResult.Check(bNormalized, TEXT("rotation isn't normalized"));
+        TestResult.Check((RotatedSum / Rotations.Num()).Size() < 5.f * FMath::Sqrt(1.f / 3.f / Rotations.Num()) * 2.f, TEXT("rotated directions mean"));
+
+        const FVector ConeDir = SphereStream.VRandCone(FVector::UpVector, FMath::DegreesToRadians(10.f));
+        TestResult.Check(FVector::DotProduct(ConeDir, FVector::UpVector) >= FMath::Cos(FMath::DegreesToRadians(10.5f)), TEXT("direction outside of the cone"));
+    }
+
+    SetMasterSeed(SavedMasterSeed, SavedEpoch);
+
+    return TestResult.Finish();
+}
+
+void FNVRandomStream::RunThroughputTest(int32 SampleCount)
+{
+    SampleCount = FMath::Max(SampleCount, 1);
+
+    TArray<float> FloatValues;
+    FloatValues.SetNumUninitialized(SampleCount);
+    TArray<FVector> VectorValues;
+    VectorValues.SetNumUninitialized(SampleCount);
+    TArray<FQuat> QuatValues;
+    QuatValues.SetNumUninitialized(SampleCount);
+
+    auto LogThroughput = [SampleCount](const TCHAR* Description, double StartTime)
+    {
+        const double ElapsedSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1e-9);
+        UE_LOG(LogNVSceneCapturer, Display, TEXT("%-32s %8.1f M values/s"), Description, SampleCount / ElapsedSeconds / 1e6);
+    };
+
+    FNVRandomStream TestStream(TEXT("Benchmark"));
+
+    double StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < SampleCount; i++)
+    {
+        FloatValues[i] = FMath::FRand();
+    }
+    LogThroughput(TEXT("FMath::FRand"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < SampleCount; i++)
+    {
+        FloatValues[i] = TestStream.GetFraction();
+    }
+    LogThroughput(TEXT("GetFraction"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    TestStream.FillUniform(FloatValues);
+    LogThroughput(TEXT("FillUniform"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < SampleCount; i++)
+    {
+        FloatValues[i] = TestStream.Gaussian();
+    }
+    LogThroughput(TEXT("Gaussian"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    TestStream.FillGaussian(FloatValues);
+    LogThroughput(TEXT("FillGaussian"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < SampleCount; i++)
+    {
+        VectorValues[i] = FMath::RandPointInBox(FBox(FVector(-1.f), FVector(1.f)));
+    }
+    LogThroughput(TEXT("FMath::RandPointInBox"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    TestStream.FillPointsInBox(VectorValues, FBox(FVector(-1.f), FVector(1.f)));
+    LogThroughput(TEXT("FillPointsInBox"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < SampleCount; i++)
+    {
+        VectorValues[i] = FMath::VRand();
+    }
+    LogThroughput(TEXT("FMath::VRand"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    TestStream.FillUnitVectors(VectorValues);
+    LogThroughput(TEXT("FillUnitVectors"), StartTime);
+
+    StartTime = FPlatformTime::Seconds();
+    TestStream.FillRotations(QuatValues);
+    LogThroughput(TEXT("FillRotations"), StartTime);
+}
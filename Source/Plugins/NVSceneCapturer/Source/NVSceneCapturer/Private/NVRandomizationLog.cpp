@@ -0,0 +1,608 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVRandomizationLog.h"
+#include "NVSceneCapturerUtils.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Package.h"
+#include "UObject/SoftObjectPath.h"
+
+namespace
+{
+    TMap<TWeakObjectPtr<const UWorld>, TSharedPtr<FNVRandomizationLog>> WorldRandomizationLogs;
+
+    FAutoConsoleCommand TestRandomizationLogCommand(
+        TEXT("NV.TestRandomizationLog"),
+        TEXT("Check that a replayed randomization log restore the recorded states"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FNVRandomizationLog::RunSelfTest();
+        }));
+
+    const uint32 RandomizationLogMagic = 0x4C52564E; // 'NVRL'
+    const int32 RandomizationLogVersion = 1;
+    const TCHAR* RandomizationLogFileSuffix = TEXT(".randomization.bin");
+}
+
+//================================== FNVRandomizationLogStats ==================================
+FNVRandomizationLogStats::FNVRandomizationLogStats()
+{
+    RecordedFrameCount = 0;
+    RecordedStateCount = 0;
+    RecordedByteCount = 0;
+    AppliedStateCount = 0;
+}
+
+//================================== FNVRandomizationLog ==================================
+FNVRandomizationLog::FNVRandomizationLog()
+{
+    bReplaying = false;
+    ReplayRecordCursor = 0;
+    ReplayedFrameIndex = INDEX_NONE;
+}
+
+FNVRandomizationLog::~FNVRandomizationLog()
+{
+    StopRecording();
+}
+
+FNVRandomizationLog* FNVRandomizationLog::Get(UWorld* World)
+{
+    ensure(World);
+    if (!World)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    check(IsInGameThread());
+
+    const TSharedPtr<FNVRandomizationLog>* ExistingLogPtr = WorldRandomizationLogs.Find(World);
+    if (ExistingLogPtr)
+    {
+        return ExistingLogPtr->Get();
+    }
+
+    // Drop the logs of the worlds which are already destroyed
+    for (auto It = WorldRandomizationLogs.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    TSharedPtr<FNVRandomizationLog> NewLog = MakeShareable(new FNVRandomizationLog());
+    WorldRandomizationLogs.Add(World, NewLog);
+    return NewLog.Get();
+}
+
+FNVRandomizationLog* FNVRandomizationLog::Find(const UWorld* World)
+{
+    const TSharedPtr<FNVRandomizationLog>* ExistingLogPtr = World ? WorldRandomizationLogs.Find(World) : nullptr;
+    return ExistingLogPtr ? ExistingLogPtr->Get() : nullptr;
+}
+
+bool FNVRandomizationLog::IsReplaying(const UWorld* World)
+{
+    const FNVRandomizationLog* WorldLog = Find(World);
+    return WorldLog && WorldLog->IsReplaying();
+}
+
+FString FNVRandomizationLog::GetLogFileName(int32 FirstFrameIndex)
+{
+    // NOTE: The frame range shards' merge move the files prefixed by a frame index, so each shard's log end up in the merged directory
+    return FString::Printf(TEXT("%06i%s"), FirstFrameIndex, RandomizationLogFileSuffix);
+}
+
+void FNVRandomizationLog::RegisterSource(const FNVRandomizationLogSource& NewSource)
+{
+    ensure(NewSource.SourceObject.IsValid() && NewSource.GetKey && NewSource.SerializeState);
+    if (!NewSource.SourceObject.IsValid() || !NewSource.GetKey || !NewSource.SerializeState)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
+
+    Sources.Add(NewSource);
+}
+
+void FNVRandomizationLog::UnregisterSource(const UObject* SourceObject)
+{
+    Sources.RemoveAll([SourceObject](const FNVRandomizationLogSource& CheckSource)
+    {
+        return !CheckSource.SourceObject.IsValid() || (CheckSource.SourceObject.Get() == SourceObject);
+    });
+}
+
+void FNVRandomizationLog::SerializeSourceState(const FNVRandomizationLogSource& Source, TArray<uint8>& OutState)
+{
+    OutState.Reset();
+    FMemoryWriter StateWriter(OutState);
+    Source.SerializeState(StateWriter);
+}
+
+bool FNVRandomizationLog::StartRecording(const FString& InRecordingFilePath)
+{
+    StopRecording();
+
+    RecordWriter = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*InRecordingFilePath));
+    if (!RecordWriter.IsValid())
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't create the randomization log file: '%s'"), *InRecordingFilePath);
+        return false;
+    }
+
+    RecordingFilePath = InRecordingFilePath;
+    // NOTE: The first record of the file must have the states of all the sources so the file can be replayed on its own
+    RecordedStates.Reset();
+    RecordedKeyIndexes.Reset();
+    Stats.RecordedFrameCount = 0;
+    Stats.RecordedStateCount = 0;
+
+    uint32 Magic = RandomizationLogMagic;
+    int32 Version = RandomizationLogVersion;
+    *RecordWriter << Magic;
+    *RecordWriter << Version;
+    Stats.RecordedByteCount = RecordWriter->Tell();
+    return true;
+}
+
+void FNVRandomizationLog::RecordFrame(int32 FrameIndex)
+{
+    if (!RecordWriter.IsValid())
+    {
+        return;
+    }
+
+    TArray<FString> NewKeys;
+    TArray<int32> ChangedKeyIndexes;
+    TArray<TArray<uint8>> ChangedStates;
+    TArray<uint8> SourceState;
+    for (const FNVRandomizationLogSource& CheckSource : Sources)
+    {
+        if (!CheckSource.SourceObject.IsValid())
+        {
+            continue;
+        }
+
+        const FString SourceKey = CheckSource.GetKey();
+        SerializeSourceState(CheckSource, SourceState);
+        if (SourceKey.IsEmpty() || (SourceState.Num() == 0))
+        {
+            continue;
+        }
+
+        TArray<uint8>* LastRecordedState = RecordedStates.Find(SourceKey);
+        if (LastRecordedState && (*LastRecordedState == SourceState))
+        {
+            continue;
+        }
+
+        int32 KeyIndex = INDEX_NONE;
+        const int32* ExistingKeyIndexPtr = RecordedKeyIndexes.Find(SourceKey);
+        if (ExistingKeyIndexPtr)
+        {
+            KeyIndex = *ExistingKeyIndexPtr;
+        }
+        else
+        {
+            KeyIndex = RecordedKeyIndexes.Num();
+            RecordedKeyIndexes.Add(SourceKey, KeyIndex);
+            NewKeys.Add(SourceKey);
+        }
+
+        ChangedKeyIndexes.Add(KeyIndex);
+        ChangedStates.Add(SourceState);
+        RecordedStates.Add(SourceKey, SourceState);
+    }
+
+    // NOTE: A frame without any change still has a record so the replay know which frames the log cover
+    int32 RecordFrameIndex = FrameIndex;
+    int32 NewKeyCount = NewKeys.Num();
+    int32 ChangedStateCount = ChangedStates.Num();
+    *RecordWriter << RecordFrameIndex;
+    *RecordWriter << NewKeyCount;
+    for (FString& NewKey : NewKeys)
+    {
+        *RecordWriter << NewKey;
+    }
+    *RecordWriter << ChangedStateCount;
+    for (int32 i = 0; i < ChangedStateCount; i++)
+    {
+        *RecordWriter << ChangedKeyIndexes[i];
+        *RecordWriter << ChangedStates[i];
+    }
+    // Keep the log usable even if the process is killed before it stop recording
+    RecordWriter->Flush();
+
+    Stats.RecordedFrameCount++;
+    Stats.RecordedStateCount += ChangedStateCount;
+    Stats.RecordedByteCount = RecordWriter->Tell();
+}
+
+void FNVRandomizationLog::StopRecording()
+{
+    if (RecordWriter.IsValid())
+    {
+        const bool bWriteFailed = RecordWriter->IsError();
+        RecordWriter->Close();
+        RecordWriter.Reset();
+
+        if (bWriteFailed)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Failed to write the randomization log file: '%s'"), *RecordingFilePath);
+        }
+        else
+        {
+            UE_LOG(LogNVSceneCapturer, Log, TEXT("Randomization log '%s': %d frames, %d states, %lld bytes."),
+                   *RecordingFilePath, Stats.RecordedFrameCount, Stats.RecordedStateCount, Stats.RecordedByteCount);
+        }
+    }
+}
+
+bool FNVRandomizationLog::LoadReplay(const FString& ReplayPath)
+{
+    StopReplaying();
+
+    IFileManager& FileManager = IFileManager::Get();
+    TArray<FString> LogFilePaths;
+    if (FileManager.DirectoryExists(*ReplayPath))
+    {
+        TArray<FString> LogFileNames;
+        FileManager.FindFiles(LogFileNames, *FPaths::Combine(ReplayPath, FString(TEXT("*")) + RandomizationLogFileSuffix), true, false);
+        LogFileNames.Sort();
+        for (const FString& LogFileName : LogFileNames)
+        {
+            LogFilePaths.Add(FPaths::Combine(ReplayPath, LogFileName));
+        }
+    }
+    else
+    {
+        LogFilePaths.Add(ReplayPath);
+    }
+
+    for (const FString& LogFilePath : LogFilePaths)
+    {
+        if (!LoadReplayFile(LogFilePath))
+        {
+            StopReplaying();
+            return false;
+        }
+    }
+
+    if (ReplayRecords.Num() == 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("There's no randomization log to replay in: '%s'"), *ReplayPath);
+        return false;
+    }
+
+    // NOTE: The records of the same frame keep the order of their files
+    ReplayRecords.StableSort([](const FReplayRecord& A, const FReplayRecord& B)
+    {
+        return A.FrameIndex < B.FrameIndex;
+    });
+
+    bReplaying = true;
+    UE_LOG(LogNVSceneCapturer, Log, TEXT("Replaying the randomization log '%s': frames [%d, %d), %d keys."),
+           *ReplayPath, GetReplayFirstFrame(), GetReplayEndFrame(), ReplayKeys.Num());
+    return true;
+}
+
+bool FNVRandomizationLog::LoadReplayFile(const FString& FilePath)
+{
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+    if (!Reader.IsValid())
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't open the randomization log file: '%s'"), *FilePath);
+        return false;
+    }
+
+    uint32 Magic = 0;
+    int32 Version = 0;
+    *Reader << Magic;
+    *Reader << Version;
+    if (Reader->IsError() || (Magic != RandomizationLogMagic) || (Version != RandomizationLogVersion))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("'%s' is not a supported randomization log file."), *FilePath);
+        return false;
+    }
+
+    // The keys are indexed per file, remap them to the keys of all the loaded files
+    TArray<int32> FileKeyIndexes;
+    while (!Reader->AtEnd())
+    {
+        FReplayRecord NewRecord;
+        int32 NewKeyCount = 0;
+        *Reader << NewRecord.FrameIndex;
+        *Reader << NewKeyCount;
+        for (int32 i = 0; (i < NewKeyCount) && !Reader->IsError(); i++)
+        {
+            FString NewKey;
+            *Reader << NewKey;
+
+            int32 ReplayKeyIndex = INDEX_NONE;
+            const int32* ExistingKeyIndexPtr = ReplayKeyIndexes.Find(NewKey);
+            if (ExistingKeyIndexPtr)
+            {
+                ReplayKeyIndex = *ExistingKeyIndexPtr;
+            }
+            else
+            {
+                ReplayKeyIndex = ReplayKeys.Add(NewKey);
+                ReplayKeyIndexes.Add(NewKey, ReplayKeyIndex);
+            }
+            FileKeyIndexes.Add(ReplayKeyIndex);
+        }
+
+        int32 StateCount = 0;
+        *Reader << StateCount;
+        for (int32 i = 0; (i < StateCount) && !Reader->IsError(); i++)
+        {
+            int32 FileKeyIndex = INDEX_NONE;
+            TArray<uint8> State;
+            *Reader << FileKeyIndex;
+            *Reader << State;
+            if (!FileKeyIndexes.IsValidIndex(FileKeyIndex))
+            {
+                Reader->SetError();
+                break;
+            }
+            NewRecord.States.Emplace(FileKeyIndexes[FileKeyIndex], MoveTemp(State));
+        }
+
+        if (Reader->IsError() || (NewKeyCount < 0) || (StateCount < 0))
+        {
+            // NOTE: The last record may be truncated if the recording process was killed, the records before it are still valid
+            UE_LOG(LogNVSceneCapturer, Warning, TEXT("The randomization log file '%s' is truncated after frame %d."),
+                   *FilePath, (ReplayRecords.Num() > 0) ? ReplayRecords.Last().FrameIndex : INDEX_NONE);
+            break;
+        }
+        ReplayRecords.Add(MoveTemp(NewRecord));
+    }
+    return true;
+}
+
+void FNVRandomizationLog::ApplyFrame(int32 FrameIndex)
+{
+    if (!bReplaying)
+    {
+        return;
+    }
+
+    // Accumulate the latest state of each key up to the frame
+    if (FrameIndex < ReplayedFrameIndex)
+    {
+        ReplayedStates.Reset();
+        ReplayRecordCursor = 0;
+    }
+    while (ReplayRecords.IsValidIndex(ReplayRecordCursor) && (ReplayRecords[ReplayRecordCursor].FrameIndex <= FrameIndex))
+    {
+        for (const TPair<int32, TArray<uint8>>& RecordState : ReplayRecords[ReplayRecordCursor].States)
+        {
+            ReplayedStates.Add(RecordState.Key, RecordState.Value);
+        }
+        ReplayRecordCursor++;
+    }
+    ReplayedFrameIndex = FrameIndex;
+
+    // Restore the sources by increasing priority. Restoring a source may register or unregister other sources
+    // (e.g: a group manager spawning its actors) so the sources are checked again before each priority
+    bool bAppliedAnyPriority = false;
+    int32 LastAppliedPriority = 0;
+    TArray<uint8> CurrentState;
+    while (true)
+    {
+        bool bFoundPriority = false;
+        int32 NextPriority = 0;
+        for (const FNVRandomizationLogSource& CheckSource : Sources)
+        {
+            if (CheckSource.SourceObject.IsValid()
+                && (!bAppliedAnyPriority || (CheckSource.Priority > LastAppliedPriority))
+                && (!bFoundPriority || (CheckSource.Priority < NextPriority)))
+            {
+                NextPriority = CheckSource.Priority;
+                bFoundPriority = true;
+            }
+        }
+        if (!bFoundPriority)
+        {
+            break;
+        }
+
+        const TArray<FNVRandomizationLogSource> PrioritySources = Sources.FilterByPredicate([NextPriority](const FNVRandomizationLogSource& CheckSource)
+        {
+            return CheckSource.Priority == NextPriority;
+        });
+        for (const FNVRandomizationLogSource& CheckSource : PrioritySources)
+        {
+            if (!CheckSource.SourceObject.IsValid())
+            {
+                continue;
+            }
+
+            const int32* KeyIndexPtr = ReplayKeyIndexes.Find(CheckSource.GetKey());
+            const TArray<uint8>* ReplayedState = KeyIndexPtr ? ReplayedStates.Find(*KeyIndexPtr) : nullptr;
+            if (!ReplayedState)
+            {
+                continue;
+            }
+
+            // Only restore the sources which are not already in their logged state
+            SerializeSourceState(CheckSource, CurrentState);
+            if (CurrentState == *ReplayedState)
+            {
+                continue;
+            }
+
+            FMemoryReader StateReader(*ReplayedState);
+            CheckSource.SerializeState(StateReader);
+            if (StateReader.IsError())
+            {
+                UE_LOG(LogNVSceneCapturer, Warning, TEXT("Can't restore the state of '%s' in frame %d."), *CheckSource.GetKey(), FrameIndex);
+            }
+            Stats.AppliedStateCount++;
+        }
+
+        bAppliedAnyPriority = true;
+        LastAppliedPriority = NextPriority;
+    }
+}
+
+void FNVRandomizationLog::StopReplaying()
+{
+    bReplaying = false;
+    ReplayKeys.Reset();
+    ReplayKeyIndexes.Reset();
+    ReplayRecords.Reset();
+    ReplayedStates.Reset();
+    ReplayRecordCursor = 0;
+    ReplayedFrameIndex = INDEX_NONE;
+}
+
+int32 FNVRandomizationLog::GetReplayFirstFrame() const
+{
+    return (ReplayRecords.Num() > 0) ? ReplayRecords[0].FrameIndex : 0;
+}
+
+int32 FNVRandomizationLog::GetReplayEndFrame() const
+{
+    return (ReplayRecords.Num() > 0) ? (ReplayRecords.Last().FrameIndex + 1) : 0;
+}
+
+void FNVRandomizationLog::SerializeObjectReference(FArchive& Ar, UObject*& ObjectRef)
+{
+    FString ObjectPath;
+    if (Ar.IsSaving() && ObjectRef)
+    {
+        ObjectPath = FSoftObjectPath(ObjectRef).ToString();
+    }
+    Ar << ObjectPath;
+    if (Ar.IsLoading())
+    {
+        ObjectRef = ObjectPath.IsEmpty() ? nullptr : FSoftObjectPath(ObjectPath).TryLoad();
+    }
+}
+
+bool FNVRandomizationLog::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Randomization log"), LogNVSceneCapturer);
+
+    // 2 fake sources: a spawner (priority 0) changing every 4 frames, and a transform (priority 1) changing every frame
+    // NOTE: Both sources only need an object which stay valid during the test
+    const UObject* TestSourceObject = GetTransientPackage();
+    int32 SpawnCount = 0;
+    FVector Location = FVector::ZeroVector;
+    TArray<FString> ApplyOrder;
+    auto SimulateFrame = [&SpawnCount, &Location](int32 FrameIndex)
+    {
+        SpawnCount = 1 + (FrameIndex / 4);
+        Location = FVector(FrameIndex * 3.f, -FrameIndex, 0.5f);
+    };
+
+    FNVRandomizationLog TestLog;
+    FNVRandomizationLogSource TransformSource;
+    TransformSource.SourceObject = TestSourceObject;
+    TransformSource.Priority = 1;
+    TransformSource.GetKey = []() { return FString(TEXT("Actor.Transform")); };
+    TransformSource.SerializeState = [&Location, &ApplyOrder](FArchive& Ar)
+    {
+        Ar << Location;
+        if (Ar.IsLoading())
+        {
+            ApplyOrder.Add(TEXT("Transform"));
+        }
+    };
+    FNVRandomizationLogSource SpawnerSource;
+    SpawnerSource.SourceObject = TestSourceObject;
+    SpawnerSource.Priority = 0;
+    SpawnerSource.GetKey = []() { return FString(TEXT("Spawner")); };
+    SpawnerSource.SerializeState = [&SpawnCount, &ApplyOrder](FArchive& Ar)
+    {
+        Ar << SpawnCount;
+        if (Ar.IsLoading())
+        {
+            ApplyOrder.Add(TEXT("Spawner"));
+        }
+    };
+    TestLog.RegisterSource(TransformSource);
+    TestLog.RegisterSource(SpawnerSource);
+
+    // Record the frames in 2 files, like 2 frame range shards
+    const int32 TestFrameCount = 10;
+    const int32 SplitFrameIndex = 5;
+    const FString TestDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("NVRandomizationLogTest"));
+    IFileManager& FileManager = IFileManager::Get();
+    FileManager.DeleteDirectory(*TestDirectory, false, true);
+
+    int32 TotalRecordedStateCount = 0;
+    for (int32 FrameIndex = 0; FrameIndex < TestFrameCount; FrameIndex++)
+    {
+        if ((FrameIndex == 0) || (FrameIndex == SplitFrameIndex))
+        {
+            TotalRecordedStateCount += TestLog.GetStats().RecordedStateCount;
+            TestResult.Check(TestLog.StartRecording(FPaths::Combine(TestDirectory, GetLogFileName(FrameIndex))), TEXT("can't start recording"));
+        }
+        SimulateFrame(FrameIndex);
+        TestLog.RecordFrame(FrameIndex);
+    }
+    TotalRecordedStateCount += TestLog.GetStats().RecordedStateCount;
+    TestLog.StopRecording();
+    // Transform: 10 states, spawner: frames 0, 4, 8 + the keyframe of the 2nd file
+    TestResult.Check(TotalRecordedStateCount == 14, TEXT("the unchanged states were not skipped"));
+    TestResult.Check(!TestLog.IsRecording(), TEXT("still recording"));
+
+    // The log must stay far smaller than the captured images: even a tiny 64x64 BGRA8 image is 16KB per frame
+    TArray<FString> LogFileNames;
+    FileManager.FindFiles(LogFileNames, *FPaths::Combine(TestDirectory, FString(TEXT("*")) + RandomizationLogFileSuffix), true, false);
+    int64 TotalLogByteCount = 0;
+    for (const FString& LogFileName : LogFileNames)
+    {
+        TotalLogByteCount += FileManager.FileSize(*FPaths::Combine(TestDirectory, LogFileName));
+    }
+    TestResult.Check(LogFileNames.Num() == 2, TEXT("the log files of the 2 recordings were not written"));
+    TestResult.Check((TotalLogByteCount > 0) && (TotalLogByteCount / TestFrameCount < 1024), TEXT("the log take more than 1KB per frame"));
+
+    // Replay the frames in any order, from the merged directory
+    TestResult.Check(TestLog.LoadReplay(TestDirectory), TEXT("can't load the log files"));
+    TestResult.Check(TestLog.IsReplaying(), TEXT("not replaying"));
+    TestResult.Check((TestLog.GetReplayFirstFrame() == 0) && (TestLog.GetReplayEndFrame() == TestFrameCount), TEXT("replay frame range"));
+
+    const int32 ReplayFrames[] = { 7, 2, 3, 9, 0, 5, 4 };
+    for (const int32 FrameIndex : ReplayFrames)
+    {
+        SpawnCount = -1;
+        Location = FVector(-1.f);
+        TestLog.ApplyFrame(FrameIndex);
+
+        const int32 RestoredSpawnCount = SpawnCount;
+        const FVector RestoredLocation = Location;
+        SimulateFrame(FrameIndex);
+        TestResult.Check(RestoredSpawnCount == SpawnCount, TEXT("the spawner state is not restored"));
+        TestResult.Check(RestoredLocation == Location, TEXT("the transform state is not restored"));
+    }
+
+    // The lower priority is restored first, and the sources already in their logged state are skipped
+    ApplyOrder.Reset();
+    SpawnCount = -1;
+    Location = FVector(-1.f);
+    TestLog.ApplyFrame(6);
+    TestResult.Check((ApplyOrder.Num() == 2) && (ApplyOrder[0] == TEXT("Spawner")), TEXT("the sources are not restored by priority"));
+    const int32 AppliedStateCount = TestLog.GetStats().AppliedStateCount;
+    TestLog.ApplyFrame(6);
+    TestResult.Check(TestLog.GetStats().AppliedStateCount == AppliedStateCount, TEXT("the sources already in their logged state were restored"));
+
+    TestLog.StopReplaying();
+    FileManager.DeleteDirectory(*TestDirectory, false, true);
+
+    return TestResult.Finish();
+}
@@ -24,6 +24,7 @@ UNVSceneCaptureComponent2D::UNVSceneCaptureComponent2D(const FObjectInitializer&
     TextureTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
     OverrideTexturePixelFormat = EPixelFormat::PF_Unknown;
     bIgnoreReadbackAlpha = false;
+    ReadbackRingDepth = 3;
 }
 
 void UNVSceneCaptureComponent2D::BeginPlay()
@@ -32,10 +33,15 @@ void UNVSceneCaptureComponent2D::BeginPlay()
 
     InitTextureRenderTarget();
     RenderTargetReader.SetTextureRenderTarget(TextureTarget);
+    RenderTargetReader.SetReadbackRingDepth(ReadbackRingDepth);
 }
 
 void UNVSceneCaptureComponent2D::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+    // Don't leave the last frames' pixels in the readback ring
+    // NOTE: Their callbacks use this component, the capturer and its data handler so they must be finished before any of them go away
+    RenderTargetReader.WaitForPendingCallbacks();
+
     Super::EndPlay(EndPlayReason);
 }
 
@@ -44,6 +50,9 @@ void UNVSceneCaptureComponent2D::TickComponent(float DeltaTime, enum ELevelTick
     // NOTE: We don't call the Super function so we can override the conditions to whether we should capture this frame or not
     USceneCaptureComponent::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+    // Complete the readbacks which are old enough even if there is no new capture to push them out of the ring
+    RenderTargetReader.UpdatePendingReadbacks();
+
     if (ShouldCaptureCurrentFrame())
     {
         CaptureSceneDeferred();
@@ -305,6 +314,16 @@ void UNVSceneCaptureComponent2D::StopCapturing()
     bCaptureEveryFrame = false;
 }
 
+FNVTextureReadbackRingStats UNVSceneCaptureComponent2D::GetReadbackStats() const
+{
+    return RenderTargetReader.GetReadbackStats();
+}
+
+void UNVSceneCaptureComponent2D::FlushPendingReadbacks()
+{
+    RenderTargetReader.FlushPendingReadbacks();
+}
+
 bool UNVSceneCaptureComponent2D::ShouldCaptureCurrentFrame() const
 {
     // TODO: Add more condition check here
@@ -12,7 +12,13 @@
 #include "NVSceneManager.h"
 #include "NVAnnotatedActor.h"
 #include "NVSceneDataHandler.h"
+#include "NVTextureReader.h"
+#include "NVSceneCaptureComponent2D.h"
+#include "NVCaptureClock.h"
+#include "NVFrameRangeShard.h"
+#include "NVRandomizationLog.h"
 #include "Engine.h"
+#include "Misc/App.h"
 #include "JsonObjectConverter.h"
 #if WITH_EDITOR
 #include "Factories/FbxAssetImportData.h"
@@ -43,6 +49,13 @@ ANVSceneCapturerActor::ANVSceneCapturerActor(const FObjectInitializer& ObjectIni
     CurrentState = ENVSceneCapturerState::Active;
     bAutoStartCapturing = false;
     bPauseGameLogicWhenFlushing = true;
+    bUseFixedStepCaptureClock = true;
+    bAnnotationOnly = false;
+    bUseFixedRandomSeed = false;
+    RandomSeed = 0;
+    bRecordRandomizationLog = true;
+    CaptureCreditWaitWarningTime = 5.f;
+    MaxCaptureCreditWaitTime = 300.f;
 
     MaxNumberOfFramesToCapture = 0;
     NumberOfFramesToCapture = MaxNumberOfFramesToCapture;
@@ -56,6 +69,12 @@ ANVSceneCapturerActor::ANVSceneCapturerActor(const FObjectInitializer& ObjectIni
     bTakingOverViewport = false;
     bSkipFirstFrame = false;
 
+    bUsingFixedCaptureTimeStep = false;
+    bSavedUseFixedTimeStep = false;
+    SavedFixedDeltaTime = 0.0;
+    FrameRangeShardLaunchCount = 0;
+    ReplayStartFrame = 0;
+
 #if WITH_EDITORONLY_DATA
     USelection::SelectObjectEvent.AddUObject(this, &ANVSceneCapturerActor::OnActorSelected);
 #endif //WITH_EDITORONLY_DATA
@@ -73,6 +92,13 @@ void ANVSceneCapturerActor::Tick(float DeltaTime)
     Super::Tick(DeltaTime);
 
     CheckCaptureScene();
+
+    if (FrameRangeShardLauncher.IsValid() && FrameRangeShardLauncher->Update())
+    {
+        FrameRangeShardLauncher.Reset();
+        // NOTE: The launcher process only launch and merge the shards, it has nothing else to do
+        FPlatformMisc::RequestExit(false);
+    }
 }
 
 void ANVSceneCapturerActor::UpdateSettingsFromCommandLine()
@@ -100,6 +126,81 @@ void ANVSceneCapturerActor::UpdateSettingsFromCommandLine()
         bAutoStartCapturing = true;
     }
 
+    int32 RandomSeedOverride = 0;
+    if (FParse::Value(CommandLine, TEXT("-RandomSeed="), RandomSeedOverride))
+    {
+        RandomSeed = RandomSeedOverride;
+        bUseFixedRandomSeed = true;
+    }
+
+    // Split the frames between multiple capturer processes
+    int32 ShardCount = 0;
+    if (FParse::Value(CommandLine, TEXT("-ShardCount="), ShardCount) && (ShardCount > 1))
+    {
+        int32 ShardIndex = INDEX_NONE;
+        if (FParse::Value(CommandLine, TEXT("-ShardIndex="), ShardIndex))
+        {
+            if (FNVFrameRangeShard::ParseCommandLine(CommandLine, NumberOfFramesToCapture, RandomSeed, FrameRangeShard))
+            {
+                // NOTE: The capturer start at 0 and fast forward to the shard's first frame (or start right there when skipping the leading frames)
+                // and stop after its last one
+                NumberOfFramesToCapture = FrameRangeShard.GetEndFrame();
+                bUseFixedRandomSeed = true;
+                UE_LOG(LogNVSceneCapturer, Log, TEXT("Capturing frame range shard %d / %d - frames [%d, %d) - seed %d - skip leading frames: %s."),
+                    FrameRangeShard.ShardIndex, FrameRangeShard.ShardCount, FrameRangeShard.FrameOffset, FrameRangeShard.GetEndFrame(), FrameRangeShard.GetShardSeed(),
+                    FrameRangeShard.bSkipLeadingFrames ? TEXT("yes") : TEXT("no"));
+            }
+        }
+        else if (NumberOfFramesToCapture > 0)
+        {
+            // This process only launch the shards' processes and merge their outputs
+            FrameRangeShardLaunchCount = ShardCount;
+            bAutoStartCapturing = false;
+            if (!bUseFixedRandomSeed)
+            {
+                RandomSeed = (int32)FPlatformTime::Cycles();
+                bUseFixedRandomSeed = true;
+            }
+        }
+        else
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("The frames can only be split between %d processes when -NumberOfFrame= is set."), ShardCount);
+        }
+    }
+
+    // Re-render the frames of a randomization log instead of randomizing them again
+    FString ReplayRandomizationPath;
+    if (FParse::Value(CommandLine, TEXT("-ReplayRandomization="), ReplayRandomizationPath))
+    {
+        FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Get(GetWorld());
+        if (FrameRangeShard.IsValid() || (FrameRangeShardLaunchCount > 0))
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("The randomization log can't be replayed when the frames are split between multiple processes."));
+        }
+        else if (RandomizationLog)
+        {
+            if (FPaths::IsRelative(ReplayRandomizationPath))
+            {
+                ReplayRandomizationPath = FPaths::Combine(FPaths::ProjectDir(), ReplayRandomizationPath);
+            }
+            if (RandomizationLog->LoadReplay(ReplayRandomizationPath))
+            {
+                // Only the logged frames can be re-rendered, optionally a sub range of them
+                ReplayStartFrame = RandomizationLog->GetReplayFirstFrame();
+                int32 ReplayEndFrame = RandomizationLog->GetReplayEndFrame();
+                FParse::Value(CommandLine, TEXT("-ReplayStartFrame="), ReplayStartFrame);
+                FParse::Value(CommandLine, TEXT("-ReplayEndFrame="), ReplayEndFrame);
+                NumberOfFramesToCapture = ReplayEndFrame;
+                bAutoStartCapturing = true;
+            }
+        }
+    }
+
+    if (FParse::Param(CommandLine, TEXT("AnnotationOnly")))
+    {
+        bAnnotationOnly = true;
+    }
+
     FString SettingsFilePath;
     if (FParse::Value(CommandLine, TEXT("-SettingsPath="), SettingsFilePath))
     {
@@ -139,6 +240,11 @@ void ANVSceneCapturerActor::BeginPlay()
     }
 #endif
 
+    if (FrameRangeShardLaunchCount > 0)
+    {
+        LaunchFrameRangeShards();
+    }
+
     bTakingOverViewport = bTakeOverGameViewport;
     if (bTakeOverGameViewport)
     {
@@ -150,12 +256,29 @@ void ANVSceneCapturerActor::BeginPlay()
 
     UpdateViewpointList();
 
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Get(World);
+    if (RandomizationLog)
+    {
+        FNVRandomizationLogSource CapturerSource;
+        CapturerSource.SourceObject = this;
+        // NOTE: The capturer's settings don't depend on the other sources, they are restored last
+        CapturerSource.Priority = 100;
+        CapturerSource.GetKey = [this]() { return GetName(); };
+        CapturerSource.SerializeState = [this](FArchive& Ar) { SerializeRandomizationState(Ar); };
+        RandomizationLog->RegisterSource(CapturerSource);
+    }
+
     // Create the feature extractors for each viewpoint
+    const bool bOnlyCaptureAnnotation = IsAnnotationOnly();
+    if (bOnlyCaptureAnnotation)
+    {
+        UE_LOG(LogNVSceneCapturer, Log, TEXT("Capturer %s only capture the annotation data, the pixels feature extractors are skipped."), *GetName());
+    }
     for (UNVSceneCapturerViewpointComponent* CheckViewpointComp : ViewpointList)
     {
         if (CheckViewpointComp && CheckViewpointComp->IsEnabled())
         {
-            CheckViewpointComp->SetupFeatureExtractors();
+            CheckViewpointComp->SetupFeatureExtractors(bOnlyCaptureAnnotation);
         }
     }
 
@@ -184,6 +307,14 @@ void ANVSceneCapturerActor::BeginPlay()
 void ANVSceneCapturerActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
     GetWorldTimerManager().ClearTimer(TimeHandle_StartCapturingDelay);
+    EndFixedCaptureTimeStep();
+
+    StopRecordingRandomizationLog();
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Find(GetWorld());
+    if (RandomizationLog)
+    {
+        RandomizationLog->UnregisterSource(this);
+    }
 
     Super::EndPlay(EndPlayReason);
 }
@@ -244,7 +375,8 @@ void ANVSceneCapturerActor::CheckCaptureScene()
     {
         const float CurrentTime = GetWorld()->GetTimeSeconds();
         const float TimeSinceLastCapture = CurrentTime - LastCaptureTimestamp;
-        if (TimeSinceLastCapture >= TimeBetweenSceneCapture)
+        // NOTE: With the fixed step capture clock, each frame advance the simulation by exactly the time between the captures
+        if (bUsingFixedCaptureTimeStep || (TimeSinceLastCapture >= TimeBetweenSceneCapture))
         {
             bNeedToExportScene = true;
         }
@@ -258,31 +390,216 @@ void ANVSceneCapturerActor::CheckCaptureScene()
     ANVSceneManager* ANVSceneManagerPtr = ANVSceneManager::GetANVSceneManagerPtr();
     // if ANVSceneManagerPtr is nullptr, then there's no scene manager and it's assumed the scene is static and thus ready, else check with the scene manager
     const bool bSceneIsReady = !ANVSceneManagerPtr || ANVSceneManagerPtr->GetState()== ENVSceneManagerState::Ready;
-    UWorld* World = GetWorld();
-    AGameModeBase* CurrentGameMode = World ? World->GetAuthGameMode() : nullptr;
 
     if (bNeedToExportScene && bSceneIsReady)
     {
-        if (CanHandleMoreSceneData())
+        const int32 CurrentFrameIndex = CapturedFrameCounter.GetTotalFrameCount();
+        const bool bFinishedCapturing = (NumberOfFramesToCapture > 0) && (CurrentFrameIndex >= NumberOfFramesToCapture);
+        if (bFinishedCapturing)
         {
-            // Must unpause the game in this frame first before resuming capturing it
-            if (CurrentGameMode && CurrentGameMode->IsPaused())
-            {
-                CurrentGameMode->ClearPause();
-            }
-            else
+            // Only check whether all the captured data are handled, there's no new frame to capture
+            CaptureSceneToPixelsData(nullptr);
+        }
+        else if (FrameRangeShard.IsFastForwardFrame(CurrentFrameIndex))
+        {
+            // The frame is before the shard's range, it only need to be simulated
+            CaptureSceneToPixelsData(nullptr);
+            UpdateCapturerSettings();
+        }
+        else
+        {
+            // NOTE: The handler only retire a frame's credit when all of its data are handled, so the capturer never get more than
+            // MaxCapturedFramesInFlight frames ahead of it and doesn't need to pause the game
+            const FNVCaptureCreditPtr CaptureCredit = AcquireCaptureCredit();
+            if (CaptureCredit.IsValid())
             {
-                CaptureSceneToPixelsData();
+                CaptureSceneToPixelsData(CaptureCredit);
                 // Update the capturer settings at the end of the frame after we already captured data of this frame
                 UpdateCapturerSettings();
             }
         }
-        if (!CanHandleMoreSceneData())
+    }
+}
+
+FNVCaptureCreditPtr ANVSceneCapturerActor::AcquireCaptureCredit()
+{
+    if (!SceneDataHandler)
+    {
+        return nullptr;
+    }
+
+    const int32 CurrentFrameIndex = CapturedFrameCounter.GetTotalFrameCount();
+    FNVCaptureCreditPtr CaptureCredit = SceneDataHandler->AcquireCaptureCredit(CurrentFrameIndex);
+    if (CaptureCredit.IsValid() || !bPauseGameLogicWhenFlushing)
+    {
+        return CaptureCredit;
+    }
+
+    TInlineComponentArray<UNVSceneCaptureComponent2D*> CaptureComponents;
+    if (!IsAnnotationOnly())
+    {
+        GetComponents(CaptureComponents);
+    }
+
+    // Block the game thread, and so the simulation and the capture clock, until the handler retire the credit of an older frame
+    // NOTE: The frame is never skipped, skipping it would let the world tick without capturing it. If the handler doesn't retire
+    // any credit in MaxCaptureCreditWaitTime, it's stuck and the capture is stopped instead
+    const double StartWaitTime = FPlatformTime::Seconds();
+    const double MaxWaitEndTime = StartWaitTime + FMath::Max(MaxCaptureCreditWaitTime, 1.f);
+    double NextWarningTime = StartWaitTime + CaptureCreditWaitWarningTime;
+    while (!CaptureCredit.IsValid())
+    {
+        // The frames in flight may be waiting in the readback rings for newer frames to push them out, complete them right away
+        // NOTE: Flush on each try, a readback issued by the rendering thread after the previous flush would keep its frame's credit too
+        if (CaptureComponents.Num() > 0)
         {
-            // Pause the game logic if we can't handle more scene data right now
-            if (bPauseGameLogicWhenFlushing && CurrentGameMode && !CurrentGameMode->IsPaused())
+            for (UNVSceneCaptureComponent2D* CaptureComp : CaptureComponents)
             {
-                CurrentGameMode->SetPause(World->GetFirstPlayerController());
+                CaptureComp->FlushPendingReadbacks();
+            }
+            FlushRenderingCommands();
+        }
+
+        SceneDataHandler->WaitForCaptureCredit(0.01f);
+        CaptureCredit = SceneDataHandler->AcquireCaptureCredit(CurrentFrameIndex);
+        if (CaptureCredit.IsValid())
+        {
+            break;
+        }
+
+        const double CurrentTime = FPlatformTime::Seconds();
+        if (CurrentTime >= MaxWaitEndTime)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Waited %.3fs for a capture credit for frame %d, the scene data handler doesn't retire any frame. Stop capturing."),
+                   CurrentTime - StartWaitTime, CurrentFrameIndex);
+            StopCapturing();
+            return nullptr;
+        }
+        if (CurrentTime >= NextWarningTime)
+        {
+            UE_LOG(LogNVSceneCapturer, Warning, TEXT("Waited %.3fs for a capture credit for frame %d, still waiting for the scene data handler."), CurrentTime - StartWaitTime, CurrentFrameIndex);
+            NextWarningTime = CurrentTime + FMath::Max(CaptureCreditWaitWarningTime, 1.f);
+        }
+    }
+    return CaptureCredit;
+}
+
+void ANVSceneCapturerActor::BeginFixedCaptureTimeStep()
+{
+    if (!bUsingFixedCaptureTimeStep)
+    {
+        bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+        SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+        bUsingFixedCaptureTimeStep = true;
+    }
+
+    FApp::SetUseFixedTimeStep(true);
+    if (TimeBetweenSceneCapture > 0.f)
+    {
+        FApp::SetFixedDeltaTime(TimeBetweenSceneCapture);
+    }
+
+    FNVCaptureClock* CaptureClock = FNVCaptureClock::Get(GetWorld());
+    if (CaptureClock)
+    {
+        CaptureClock->Start((float)FApp::GetFixedDeltaTime());
+    }
+}
+
+void ANVSceneCapturerActor::EndFixedCaptureTimeStep()
+{
+    if (bUsingFixedCaptureTimeStep)
+    {
+        FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+        FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+        bUsingFixedCaptureTimeStep = false;
+
+        FNVCaptureClock* CaptureClock = FNVCaptureClock::Find(GetWorld());
+        if (CaptureClock)
+        {
+            CaptureClock->Stop();
+        }
+    }
+}
+
+bool ANVSceneCapturerActor::ShouldUseFixedCaptureTimeStep() const
+{
+    // NOTE: The frame range shards only reproduce the frames of a single process when the simulation advance by the same steps
+    return bUseFixedStepCaptureClock || IsAnnotationOnly() || FrameRangeShard.IsValid();
+}
+
+void ANVSceneCapturerActor::SeedFrameRandomization(int32 FrameIndex)
+{
+    if (bUseFixedRandomSeed)
+    {
+        FNVFrameRangeShard::SeedFrameRandomStreams(RandomSeed, FrameIndex);
+    }
+}
+
+void ANVSceneCapturerActor::LaunchFrameRangeShards()
+{
+    UNVSceneDataExporter* CurrentSceneDataExporter = Cast<UNVSceneDataExporter>(SceneDataHandler);
+    if (!CurrentSceneDataExporter)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Capturer %s can't launch the frame range shards, only a scene data exporter can merge them."), *GetName());
+        return;
+    }
+
+    const FString MergedDirectory = CurrentSceneDataExporter->GetConfiguredOutputDirectoryPath();
+    FrameRangeShardLauncher = MakeShareable(new FNVFrameRangeShardLauncher(NumberOfFramesToCapture, FrameRangeShardLaunchCount, RandomSeed, MergedDirectory));
+    if (!FrameRangeShardLauncher->Launch(FCommandLine::Get()))
+    {
+        FrameRangeShardLauncher.Reset();
+    }
+}
+
+bool ANVSceneCapturerActor::IsReplayingRandomization() const
+{
+    return FNVRandomizationLog::IsReplaying(GetWorld());
+}
+
+void ANVSceneCapturerActor::StartRecordingRandomizationLog()
+{
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Get(GetWorld());
+    const UNVSceneDataExporter* CurrentSceneDataExporter = Cast<UNVSceneDataExporter>(SceneDataHandler);
+    if (!RandomizationLog || !CurrentSceneDataExporter)
+    {
+        return;
+    }
+
+    // NOTE: A frame range shard only record the frames in its range
+    const int32 FirstFrameIndex = FrameRangeShard.IsValid() ? FrameRangeShard.FrameOffset : 0;
+    const FString LogFilePath = FPaths::Combine(CurrentSceneDataExporter->GetFullOutputDirectoryPath(), FNVRandomizationLog::GetLogFileName(FirstFrameIndex));
+    RandomizationLog->StartRecording(LogFilePath);
+}
+
+void ANVSceneCapturerActor::StopRecordingRandomizationLog()
+{
+    FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Find(GetWorld());
+    if (RandomizationLog)
+    {
+        RandomizationLog->StopRecording();
+    }
+}
+
+void ANVSceneCapturerActor::SerializeRandomizationState(FArchive& Ar)
+{
+    Ar << CapturerSettings.FOVAngle;
+    for (UNVSceneCapturerViewpointComponent* ViewpointComp : ViewpointList)
+    {
+        if (ViewpointComp)
+        {
+            Ar << ViewpointComp->Settings.CaptureSettings.FOVAngle;
+        }
+    }
+
+    if (Ar.IsLoading())
+    {
+        for (UNVSceneCapturerViewpointComponent* ViewpointComp : ViewpointList)
+        {
+            if (ViewpointComp)
+            {
+                ViewpointComp->UpdateCapturerSettings(false);
             }
         }
     }
@@ -293,44 +610,77 @@ void ANVSceneCapturerActor::ResetCounter()
     CapturedFrameCounter.Reset();
 }
 
-void ANVSceneCapturerActor::CaptureSceneToPixelsData()
+void ANVSceneCapturerActor::CaptureSceneToPixelsData(const FNVCaptureCreditPtr& CaptureCredit)
 {
     const int32 CurrentFrameIndex = CapturedFrameCounter.GetTotalFrameCount();
 
     bool bFinishedCapturing = (NumberOfFramesToCapture > 0) && (CurrentFrameIndex >= NumberOfFramesToCapture);
 
     const float CurrentTime = GetWorld()->GetTimeSeconds();
-    const float TimePassSinceLastCapture = CurrentTime - LastCaptureTimestamp;
+    FNVCaptureClock* CaptureClock = FNVCaptureClock::FindRunning(GetWorld());
+    // NOTE: The simulated time between the captured frames is always the clock's step when it's running
+    const float TimePassSinceLastCapture = CaptureClock ? CaptureClock->GetFixedStepSeconds() : (CurrentTime - LastCaptureTimestamp);
 
     // Let all the child exporter components know it need to export the scene
     if (!bFinishedCapturing)
     {
+        const bool bOnlyCaptureAnnotation = IsAnnotationOnly();
+        const bool bFastForwarding = FrameRangeShard.IsFastForwardFrame(CurrentFrameIndex);
+
+        // Restore the frame's logged randomization, or log it
+        FNVRandomizationLog* RandomizationLog = FNVRandomizationLog::Find(GetWorld());
+        if (RandomizationLog && !bFastForwarding)
+        {
+            if (RandomizationLog->IsReplaying())
+            {
+                RandomizationLog->ApplyFrame(CurrentFrameIndex);
+            }
+            else
+            {
+                RandomizationLog->RecordFrame(CurrentFrameIndex);
+            }
+        }
+
+        // The actors may have moved since the last captured frame
+        WorldSnapshot.Invalidate();
         for (UNVSceneCapturerViewpointComponent* ViewpointComp : ViewpointList)
         {
-            if (ViewpointComp && ViewpointComp->IsEnabled())
+            if (ViewpointComp && ViewpointComp->IsEnabled() && !bFastForwarding)
             {
-                ViewpointComp->CaptureSceneToPixelsData(
-                    [this, CurrentFrameIndex](const FNVTexturePixelData& CapturedPixelData, UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint)
+                // NOTE: The pixel data feature extractors are not setup in annotation only mode
+                if (!bOnlyCaptureAnnotation)
                 {
-                    if (SceneDataHandler)
-                    {
-                        SceneDataHandler->HandleScenePixelsData(CapturedPixelData,
-                                                                CapturedFeatureExtractor,
-                                                                CapturedViewpoint,
-                                                                CurrentFrameIndex);
-                    }
-
-                    if (SceneDataVisualizer)
+                    // NOTE: The handlers resolve how to handle the pixels here on the game thread, only the resolved functions run on the readback workers
+                    ViewpointComp->CaptureSceneToPixelsData(
+                        [this, CurrentFrameIndex, CaptureCredit](UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint)
+                            -> UNVSceneCapturerViewpointComponent::OnFinishedCaptureScenePixelsDataCallback
                     {
-                        SceneDataVisualizer->HandleScenePixelsData(CapturedPixelData,
-                                CapturedFeatureExtractor,
-                                CapturedViewpoint,
-                                CurrentFrameIndex);
-                    }
-                });
+                        UNVSceneDataHandler::FNVScenePixelsDataHandler DataHandlerFunc = SceneDataHandler ?
+                                SceneDataHandler->PrepareScenePixelsData(CapturedFeatureExtractor, CapturedViewpoint, CurrentFrameIndex) : nullptr;
+                        UNVSceneDataHandler::FNVScenePixelsDataHandler VisualizerFunc = SceneDataVisualizer ?
+                                SceneDataVisualizer->PrepareScenePixelsData(CapturedFeatureExtractor, CapturedViewpoint, CurrentFrameIndex) : nullptr;
+                        if (!DataHandlerFunc && !VisualizerFunc)
+                        {
+                            return nullptr;
+                        }
+
+                        // NOTE: The callback keep the frame's credit until the handlers take over the pixels
+                        return [DataHandlerFunc, VisualizerFunc, CaptureCredit](const FNVTexturePixelData& CapturedPixelData)
+                        {
+                            if (DataHandlerFunc)
+                            {
+                                DataHandlerFunc(CapturedPixelData);
+                            }
+                            if (VisualizerFunc)
+                            {
+                                VisualizerFunc(CapturedPixelData);
+                            }
+                        };
+                    });
+                }
 
                 ViewpointComp->CaptureSceneAnnotationData(
-                    [this, CurrentFrameIndex](const TSharedPtr<FJsonObject>& CapturedData, UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint)
+                    [this, CurrentFrameIndex, CaptureCredit](const FNVJsonBufferPtr& CapturedData, UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint)
                 {
                     if (SceneDataHandler)
                     {
@@ -352,12 +702,21 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
             CapturedFrameCounter.IncreaseFrameCount();
         }
         CapturedFrameCounter.AddFrameDuration(TimePassSinceLastCapture);
+
+        // Let the randomization timers of the next frame know this frame was captured
+        FNVCaptureClock* WorldClock = FNVCaptureClock::Get(GetWorld());
+        if (WorldClock)
+        {
+            WorldClock->AdvanceFrame();
+        }
+        SeedFrameRandomization(CapturedFrameCounter.GetTotalFrameCount());
     }
     else
     {
-        bool bFinishedProcessingData = true;
+        // Make sure all the pixels readbacks still in flight are completed
+        bool bFinishedProcessingData = (FNVTextureReader::GetInFlightReadbackCount() == 0);
         // Make sure all the captured scene data are processed
-        if (SceneDataHandler)
+        if (bFinishedProcessingData && SceneDataHandler)
         {
             bFinishedProcessingData = !SceneDataHandler->IsHandlingData();
         }
@@ -374,10 +733,15 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
 
 void ANVSceneCapturerActor::UpdateCapturerSettings()
 {
-    CapturerSettings.RandomizeSettings();
+    // NOTE: While replaying, the settings are restored from the randomization log before each frame
+    const bool bRandomizeSettings = !IsReplayingRandomization();
+    if (bRandomizeSettings)
+    {
+        CapturerSettings.RandomizeSettings();
+    }
     for (auto* ViewpointComp : ViewpointList)
     {
-        ViewpointComp->UpdateCapturerSettings();
+        ViewpointComp->UpdateCapturerSettings(bRandomizeSettings);
     }
 }
 
@@ -445,6 +809,9 @@ void ANVSceneCapturerActor::StartCapturing_Internal()
             }
 
             // Now we can start capture.
+            // NOTE: A frame range shard fast forward the frames before it, unless it skip them and start right at its first frame
+            const int32 StartFrameIndex = FrameRangeShard.GetStartFrame();
+            SeedFrameRandomization(StartFrameIndex);
             UpdateCapturerSettings();
 
             OnStartedEvent.Broadcast(this);
@@ -455,6 +822,15 @@ void ANVSceneCapturerActor::StartCapturing_Internal()
 
             // Reset the counter and stats
             ResetCounter();
+            CapturedFrameCounter.SetFrameCount(StartFrameIndex);
+            if (IsReplayingRandomization())
+            {
+                CapturedFrameCounter.SetFrameCount(ReplayStartFrame);
+            }
+            else if (bRecordRandomizationLog)
+            {
+                StartRecordingRandomizationLog();
+            }
             // bIsActive is public. we need to copy bIsActive state into the protected value.
             CurrentState = ENVSceneCapturerState::Running;
             // NOTE: Make it wait till the next frame to start exporting since the scene capturer only just start capturing now
@@ -466,6 +842,12 @@ void ANVSceneCapturerActor::StartCapturing_Internal()
             {
                 ViewpointComp->StartCapturing();
             }
+
+            // NOTE: Without rendering, the frames are captured as fast as the CPU allows so the simulation must advance by a fixed step
+            if (ShouldUseFixedCaptureTimeStep())
+            {
+                BeginFixedCaptureTimeStep();
+            }
         }
     }
 }
@@ -484,6 +866,8 @@ void ANVSceneCapturerActor::StopCapturing()
     }
 
     CurrentState = ENVSceneCapturerState::Active;
+    EndFixedCaptureTimeStep();
+    StopRecordingRandomizationLog();
 
     OnStoppedEvent.Broadcast(this);
 
@@ -526,6 +910,8 @@ void ANVSceneCapturerActor::OnCompleted()
         }
 
         CurrentState = ENVSceneCapturerState::Completed;
+        EndFixedCaptureTimeStep();
+        StopRecordingRandomizationLog();
 
         if (SceneDataHandler)
         {
@@ -693,7 +1079,24 @@ void ANVSceneCapturerActor::UpdateViewpointList()
     }
 }
 
+bool ANVSceneCapturerActor::IsAnnotationOnly() const
+{
+    return bAnnotationOnly || !FApp::CanEverRender();
+}
+
 bool ANVSceneCapturerActor::CanHandleMoreSceneData() const
 {
-    return (SceneDataHandler && SceneDataHandler->CanHandleMoreData());
+    return GetSceneDataMemoryBudgetState().CanAcceptMoreData();
+}
+
+FNVMemoryBudgetState ANVSceneCapturerActor::GetSceneDataMemoryBudgetState() const
+{
+    if (SceneDataHandler)
+    {
+        return SceneDataHandler->GetMemoryBudgetState();
+    }
+
+    FNVMemoryBudgetState NoHandlerBudgetState;
+    NoHandlerBudgetState.State = ENVMemoryBudgetState::Throttled;
+    return NoHandlerBudgetState;
 }
\ No newline at end of file
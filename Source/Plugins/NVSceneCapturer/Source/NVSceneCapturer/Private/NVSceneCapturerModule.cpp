@@ -5,6 +5,7 @@
 */
 
 #include "NVSceneCapturerModule.h"
+#include "NVRandomStream.h"
 
 IMPLEMENT_MODULE(INVSceneCapturerModule, NVSceneCapturer)
 
@@ -14,6 +15,9 @@ DEFINE_LOG_CATEGORY(LogNVSceneCapturer);
 void INVSceneCapturerModule::StartupModule()
 {
     UE_LOG(LogNVSceneCapturer, Warning, TEXT("Loaded NVSceneCapturer module"));
+
+    // NOTE: The named random streams vary between the runs like the engine's global random stream, until a capturer use a fixed seed
+    FNVRandomStream::SetMasterSeed(FMath::Rand());
 }
 
 void INVSceneCapturerModule::ShutdownModule()
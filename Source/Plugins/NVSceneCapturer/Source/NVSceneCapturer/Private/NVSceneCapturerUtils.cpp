@@ -6,6 +6,8 @@
 
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCapturerUtils.h"
+#include "NVJsonStreamWriter.h"
+#include "NVCapturableActorIndex.h"
 #include "Engine.h"
 #include "EngineUtils.h"
 #include "IImageWrapper.h"
@@ -117,6 +119,88 @@ void FNVCuboidData::BuildFromOOBB(const FBox& OOBB, const FTransform& LocalTrans
     Rotation = LocalTransform.GetRotation();
 }
 
+//================================== FNVBox2D ==================================
+void FNVBox2D::WriteJson(FNVJsonStreamWriter& JsonWriter) const
+{
+    JsonWriter.WriteVector2D(TEXT("top_left"), top_left);
+    JsonWriter.WriteVector2D(TEXT("bottom_right"), bottom_right);
+}
+
+//================================== FCapturedObjectData ==================================
+void FCapturedObjectData::WriteJson(FNVJsonStreamWriter& JsonWriter) const
+{
+    // NOTE: The names are standardized the same way FJsonObjectConverter does: the first letter is lower case
+    JsonWriter.WriteString(TEXT("class"), Class);
+    JsonWriter.WriteNumber(TEXT("instance_id"), instance_id);
+    JsonWriter.WriteFloatWithPrecision4(TEXT("visibility"), visibility);
+    JsonWriter.WriteVector(TEXT("location"), location);
+    JsonWriter.WriteQuat(TEXT("quaternion_xyzw"), quaternion_xyzw);
+    JsonWriter.WriteMatrix(TEXT("pose_transform"), pose_transform);
+    JsonWriter.WriteVector(TEXT("cuboid_centroid"), cuboid_centroid);
+    JsonWriter.WriteVector2D(TEXT("projected_cuboid_centroid"), projected_cuboid_centroid);
+
+    JsonWriter.WriteObjectStart(TEXT("bounding_box"));
+    bounding_box.WriteJson(JsonWriter);
+    JsonWriter.WriteObjectEnd();
+
+    JsonWriter.WriteArrayStart(TEXT("cuboid"));
+    for (const FVector& CuboidVertex : cuboid)
+    {
+        JsonWriter.WriteVector(CuboidVertex);
+    }
+    JsonWriter.WriteArrayEnd();
+
+    JsonWriter.WriteArrayStart(TEXT("projected_cuboid"));
+    for (const FVector2D& ProjectedCuboidVertex : projected_cuboid)
+    {
+        JsonWriter.WriteVector2D(ProjectedCuboidVertex);
+    }
+    JsonWriter.WriteArrayEnd();
+
+    if (custom_data.IsValid())
+    {
+        JsonWriter.WriteObjectStart(TEXT("custom_data"));
+        JsonWriter.WriteJsonObjectFields(custom_data);
+        JsonWriter.WriteObjectEnd();
+    }
+}
+
+//================================== FCapturedViewpointData ==================================
+void FCapturedViewpointData::WriteJson(FNVJsonStreamWriter& JsonWriter) const
+{
+    JsonWriter.WriteVector(TEXT("location_worldframe"), location_worldframe);
+    JsonWriter.WriteQuat(TEXT("quaternion_xyzw_worldframe"), quaternion_xyzw_worldframe);
+}
+
+//================================== FCapturedSceneData ==================================
+void FCapturedSceneData::WriteJson(FNVJsonStreamWriter& JsonWriter) const
+{
+    JsonWriter.WriteObjectStart(TEXT("camera_data"));
+    camera_data.WriteJson(JsonWriter);
+    JsonWriter.WriteObjectEnd();
+
+    JsonWriter.WriteArrayStart(TEXT("objects"));
+    for (const FCapturedObjectData& ObjectData : Objects)
+    {
+        JsonWriter.WriteObjectStart();
+        ObjectData.WriteJson(JsonWriter);
+        JsonWriter.WriteObjectEnd();
+    }
+    JsonWriter.WriteArrayEnd();
+}
+
+FNVJsonBufferPtr FCapturedSceneData::ToJsonBuffer() const
+{
+    // Reserve enough space for the objects so the buffer rarely need to grow
+    static const int32 EstimatedObjectByteSize = 2048;
+    FNVJsonStreamWriter JsonWriter(1024 + Objects.Num() * EstimatedObjectByteSize);
+    JsonWriter.WriteObjectStart();
+    WriteJson(JsonWriter);
+    JsonWriter.WriteObjectEnd();
+
+    return MakeShareable(new TArray<uint8>(JsonWriter.ReleaseBuffer()));
+}
+
 //================================== ENVImageFormat ==================================
 EImageFormat ConvertExportFormatToImageFormat(ENVImageFormat ExportFormat)
 {
@@ -130,6 +214,9 @@ EImageFormat ConvertExportFormatToImageFormat(ENVImageFormat ExportFormat)
             return EImageFormat::GrayscaleJPEG;
         case ENVImageFormat::PNG:
             return EImageFormat::PNG;
+        // NOTE: The engine doesn't support QOI, it's handled by the NVQOICodec instead
+        case ENVImageFormat::QOI:
+            return EImageFormat::Invalid;
         default:
             return EImageFormat::BMP;
     }
@@ -140,6 +227,7 @@ FString GetExportImageExtension(ENVImageFormat ExportFormat)
     static const FString BMP_Extension = TEXT(".bmp");
     static const FString JPEG_Extension = TEXT(".jpg");
     static const FString PNG_Extension = TEXT(".png");
+    static const FString QOI_Extension = TEXT(".qoi");
 
     switch (ExportFormat)
     {
@@ -150,6 +238,8 @@ FString GetExportImageExtension(ENVImageFormat ExportFormat)
             return JPEG_Extension;
         case ENVImageFormat::PNG:
             return PNG_Extension;
+        case ENVImageFormat::QOI:
+            return QOI_Extension;
         default:
             return BMP_Extension;
     }
@@ -173,6 +263,58 @@ ETextureRenderTargetFormat ConvertCapturedFormatToRenderTargetFormat(ENVCaptured
 	}
 }
 
+//================================ FNVTexturePixelData ================================
+static FThreadSafeCounter PixelsBufferCounter;
+
+FNVTexturePixelData::FNVTexturePixelData()
+{
+    PixelBuffer = nullptr;
+    PixelFormat = EPixelFormat::PF_Unknown;
+    RowStride = 0;
+    PixelSize = FIntPoint::ZeroValue;
+}
+
+void FNVTexturePixelData::SetPixelData(TArray<uint8>&& NewPixelData)
+{
+    PixelBuffer = MakeShareable(new TArray<uint8>(MoveTemp(NewPixelData)));
+    PixelsBufferCounter.Increment();
+}
+
+void FNVTexturePixelData::SetPixelBuffer(const FNVPixelBufferPtr& NewPixelBuffer)
+{
+    PixelBuffer = NewPixelBuffer;
+    if (PixelBuffer.IsValid())
+    {
+        PixelsBufferCounter.Increment();
+    }
+}
+
+const TArray<uint8>& FNVTexturePixelData::GetPixelData() const
+{
+    static const TArray<uint8> EmptyPixelData;
+    return PixelBuffer.IsValid() ? *PixelBuffer : EmptyPixelData;
+}
+
+const uint8* FNVTexturePixelData::GetPixels() const
+{
+    return PixelBuffer.IsValid() ? PixelBuffer->GetData() : nullptr;
+}
+
+int32 FNVTexturePixelData::GetPixelsByteSize() const
+{
+    return PixelBuffer.IsValid() ? PixelBuffer->Num() : 0;
+}
+
+int32 FNVTexturePixelData::GetPixelsBufferCount()
+{
+    return PixelsBufferCounter.GetValue();
+}
+
+void FNVTexturePixelData::ResetPixelsBufferCount()
+{
+    PixelsBufferCounter.Reset();
+}
+
 //================================ FNVFrameCounter ================================
 FNVFrameCounter::FNVFrameCounter()
 {
@@ -229,6 +371,34 @@ void FNVFrameCounter::UpdateFPS()
     }
 }
 
+//=========================== FNVSelfTestResult ===========================
+FNVSelfTestResult::FNVSelfTestResult(const TCHAR* InTestName, const FLogCategoryBase& InLogCategory)
+    : TestName(InTestName), LogCategory(InLogCategory)
+{
+    bPassed = true;
+}
+
+void FNVSelfTestResult::Check(bool bCondition, const TCHAR* Description)
+{
+    if (!bCondition)
+    {
+        if (!LogCategory.IsSuppressed(ELogVerbosity::Error))
+        {
+            FMsg::Logf(__FILE__, __LINE__, LogCategory.GetCategoryName(), ELogVerbosity::Error, TEXT("%s test failed: %s"), *TestName, Description);
+        }
+        bPassed = false;
+    }
+}
+
+bool FNVSelfTestResult::Finish() const
+{
+    if (!LogCategory.IsSuppressed(ELogVerbosity::Log))
+    {
+        FMsg::Logf(__FILE__, __LINE__, LogCategory.GetCategoryName(), ELogVerbosity::Log, TEXT("%s test %s."), *TestName, bPassed ? TEXT("passed") : TEXT("failed"));
+    }
+    return bPassed;
+}
+
 //=========================== FNVSceneCapturerSettings ===========================
 FNVSceneCapturerSettings::FNVSceneCapturerSettings()
 {
@@ -275,6 +445,30 @@ void FNVSceneCapturerSettings::PostEditChangeProperty(struct FPropertyChangedEve
 }
 #endif //WITH_EDITORONLY_DATA
 
+//================================== UNVCapturableActorTag ==================================
+void UNVCapturableActorTag::BeginPlay()
+{
+    Super::BeginPlay();
+
+    UWorld* World = GetWorld();
+    FNVCapturableActorIndex* ActorIndex = World ? FNVCapturableActorIndex::Get(World) : nullptr;
+    if (ActorIndex)
+    {
+        ActorIndex->RegisterTag(this);
+    }
+}
+
+void UNVCapturableActorTag::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    FNVCapturableActorIndex* ActorIndex = FNVCapturableActorIndex::Find(GetWorld());
+    if (ActorIndex)
+    {
+        ActorIndex->UnregisterTag(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 //================================== Helper functions ==================================
 namespace NVSceneCapturerUtils
 {
@@ -424,6 +618,20 @@ namespace NVSceneCapturerUtils
         return nullptr;
     }
 
+    bool SerializeJsonObjectToString(const TSharedPtr<FJsonObject>& JsonObjData, FString& OutJsonString)
+    {
+        OutJsonString = TEXT("");
+        if (!JsonObjData.IsValid())
+        {
+            return false;
+        }
+
+        auto JsonWriter = TJsonWriterFactory<>::Create(&OutJsonString, 0);
+        bool bSuccess = FJsonSerializer::Serialize(JsonObjData.ToSharedRef(), JsonWriter);
+        JsonWriter->Close();
+        return bSuccess;
+    }
+
     bool SaveJsonObjectToFile(const TSharedPtr<FJsonObject>& JsonObjData, const FString& Filename)
     {
         bool bResult = false;
@@ -431,9 +639,7 @@ namespace NVSceneCapturerUtils
         if (JsonObjData.IsValid())
         {
             FString OutJsonString = TEXT("");
-            auto JsonWriter = TJsonWriterFactory<>::Create(&OutJsonString, 0);
-            bool bSuccess = FJsonSerializer::Serialize(JsonObjData.ToSharedRef(), JsonWriter);
-            JsonWriter->Close();
+            SerializeJsonObjectToString(JsonObjData, OutJsonString);
 
             if (!FFileHelper::SaveStringToFile(OutJsonString, *Filename))
             {
@@ -33,7 +33,7 @@ UNVSceneCapturerViewpointComponent::UNVSceneCapturerViewpointComponent(const FOb
     bAutoActivate = true;
 }
 
-void UNVSceneCapturerViewpointComponent::SetupFeatureExtractors()
+void UNVSceneCapturerViewpointComponent::SetupFeatureExtractors(bool bAnnotationOnly/*= false*/)
 {
     UpdateCapturerSettings();
     const auto& FeatureExtractorSettings = GetFeatureExtractorSettings();
@@ -43,6 +43,12 @@ void UNVSceneCapturerViewpointComponent::SetupFeatureExtractors()
         if (FeatureExtractor && FeatureExtractor->IsEnabled())
         {
             UClass* ExtractorClass = FeatureExtractor->GetClass();
+            // The pixels feature extractors create scene capture components and render targets which are useless without rendering
+            if (bAnnotationOnly && ExtractorClass->IsChildOf(UNVSceneFeatureExtractor_PixelData::StaticClass()))
+            {
+                continue;
+            }
+
             FName NewExtractorName = FName(*FString::Printf(TEXT("%s.%s"), *this->GetName(), *FeatureExtractor->GetDisplayName()));
             NewExtractorName = MakeUniqueObjectName(this, ExtractorClass, NewExtractorName);
             UNVSceneFeatureExtractor* NewSubFeatureExtractor = NewObject<UNVSceneFeatureExtractor>(GetOwner(),
@@ -55,9 +61,9 @@ void UNVSceneCapturerViewpointComponent::SetupFeatureExtractors()
     }
 }
 
-void UNVSceneCapturerViewpointComponent::UpdateCapturerSettings()
+void UNVSceneCapturerViewpointComponent::UpdateCapturerSettings(bool bRandomizeSettings /*= true*/)
 {
-    if (Settings.bOverrideCaptureSettings)
+    if (Settings.bOverrideCaptureSettings && bRandomizeSettings)
     {
         Settings.CaptureSettings.RandomizeSettings();
     }
@@ -106,12 +112,12 @@ FString UNVSceneCapturerViewpointComponent::GetDisplayName() const
     return (Settings.DisplayName.IsEmpty() ? GetName() : Settings.DisplayName);
 }
 
-bool UNVSceneCapturerViewpointComponent::CaptureSceneToPixelsData(UNVSceneCapturerViewpointComponent::OnFinishedCaptureScenePixelsDataCallback ViewpointCallback)
+bool UNVSceneCapturerViewpointComponent::CaptureSceneToPixelsData(UNVSceneCapturerViewpointComponent::OnPrepareCaptureScenePixelsDataCallback PrepareCallback)
 {
     bool bResults = false;
 
-    ensure(ViewpointCallback);
-    if (!ViewpointCallback)
+    ensure(PrepareCallback);
+    if (!PrepareCallback)
     {
         UE_LOG(LogNVSceneCapturerViewpointComponent, Error, TEXT("invalid argument."));
     }
@@ -123,10 +129,15 @@ bool UNVSceneCapturerViewpointComponent::CaptureSceneToPixelsData(UNVSceneCaptur
             UNVSceneFeatureExtractor_PixelData* FeatureExtractorScenePixels = Cast<UNVSceneFeatureExtractor_PixelData>(SceneFeatureExtractor);
             if (FeatureExtractorScenePixels)
             {
+                // NOTE: The pixels are read back on a worker thread, the callback handling them must not access this viewpoint or its feature extractors
+                OnFinishedCaptureScenePixelsDataCallback Callback = PrepareCallback(FeatureExtractorScenePixels, this);
                 bResults = bResults && FeatureExtractorScenePixels->CaptureSceneToPixelsData(
-                               [this, Callback = ViewpointCallback](const FNVTexturePixelData& CapturedPixelData, UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor)
+                               [Callback](const FNVTexturePixelData& CapturedPixelData, UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor)
                 {
-                    Callback(CapturedPixelData, CapturedFeatureExtractor, this);
+                    if (Callback)
+                    {
+                        Callback(CapturedPixelData);
+                    }
                 });
             }
         }
@@ -152,7 +163,7 @@ bool UNVSceneCapturerViewpointComponent::CaptureSceneAnnotationData(UNVSceneCapt
             if (FeatureExtractorAnnotationData)
             {
 				bResults = bResults && FeatureExtractorAnnotationData->CaptureSceneAnnotationData(
-                               [this, Callback = ViewpointCallback](TSharedPtr<FJsonObject> CapturedData, UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor)
+                               [this, Callback = ViewpointCallback](const FNVJsonBufferPtr& CapturedData, UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor)
                 {
                     Callback(CapturedData, CapturedFeatureExtractor, this);
                 });
@@ -8,11 +8,14 @@
 #include "NVSceneCapturerUtils.h"
 #include "NVSceneDataHandler.h"
 #include "NVImageExporter.h"
+#include "NVPixelBufferPool.h"
+#include "NVTextureReadbackRing.h"
 #include "NVSceneCapturerViewpointComponent.h"
 #include "NVSceneFeatureExtractor.h"
 #include "NVSceneCapturerActor.h"
 #include "NVAnnotatedActor.h"
 #include "NVSceneManager.h"
+#include "NVCapturableActorIndex.h"
 #include "Engine.h"
 #include "JsonObjectConverter.h"
 #if WITH_EDITOR
@@ -21,8 +24,53 @@
 #include "Editor/UnrealEdEngine.h"
 #endif
 
-//================================== UNVSceneDataExporter ==================================//
 DEFINE_LOG_CATEGORY(LogNVSceneDataHandler);
+
+//================================== UNVSceneDataHandler ==================================//
+UNVSceneDataHandler::UNVSceneDataHandler() : Super()
+{
+    MaxCapturedFramesInFlight = 4;
+}
+
+FNVMemoryBudgetState UNVSceneDataHandler::GetMemoryBudgetState() const
+{
+    FNVMemoryBudgetState BudgetState;
+    BudgetState.State = CanHandleMoreData() ? ENVMemoryBudgetState::Accepting : ENVMemoryBudgetState::Throttled;
+    return BudgetState;
+}
+
+FNVCaptureCreditPtr UNVSceneDataHandler::AcquireCaptureCredit(int32 FrameIndex)
+{
+    if (!CaptureCreditPool.IsValid())
+    {
+        CaptureCreditPool = MakeShareable(new FNVCaptureCreditPool(MaxCapturedFramesInFlight));
+    }
+    CaptureCreditPool->SetMaxCreditCount(MaxCapturedFramesInFlight);
+
+    // The frames in flight must also fit in the handler's memory budget
+    if (!CanHandleMoreData())
+    {
+        return nullptr;
+    }
+    return CaptureCreditPool->TryAcquireCredit(FrameIndex);
+}
+
+FNVCaptureCreditPtr UNVSceneDataHandler::FindCaptureCredit(int32 FrameIndex) const
+{
+    return CaptureCreditPool.IsValid() ? CaptureCreditPool->FindFrameCredit(FrameIndex) : nullptr;
+}
+
+bool UNVSceneDataHandler::WaitForCaptureCredit(float TimeOutSeconds)
+{
+    return CaptureCreditPool.IsValid() ? CaptureCreditPool->WaitForRetiredCredit(TimeOutSeconds) : false;
+}
+
+FNVCaptureCreditStats UNVSceneDataHandler::GetCaptureCreditStats() const
+{
+    return CaptureCreditPool.IsValid() ? CaptureCreditPool->GetStats() : FNVCaptureCreditStats();
+}
+
+//================================== UNVSceneDataExporter ==================================//
 const FString UNVSceneDataExporter::DefaultDataOutputFolder = TEXT("NVCapturedData/");
 
 UNVSceneDataExporter::UNVSceneDataExporter() : Super(),
@@ -34,12 +82,31 @@ UNVSceneDataExporter::UNVSceneDataExporter() : Super(),
     bUseMapNameForCapturedDirectory = true;
     bAutoOpenExportedDirectory = false;
     MaxSaveImageAsyncCount = 100;
+    MaxPooledPixelsBufferSizeMB = 512;
 }
 
 bool UNVSceneDataExporter::CanHandleMoreData() const
 {
-    return ImageExporterThread &&
-            ((MaxSaveImageAsyncCount <= 0) || (ImageExporterThread->GetPendingImagesCount() <= MaxSaveImageAsyncCount / 2));
+    return GetMemoryBudgetState().CanAcceptMoreData();
+}
+
+FNVMemoryBudgetState UNVSceneDataExporter::GetMemoryBudgetState() const
+{
+    FNVMemoryBudgetState BudgetState;
+    if (!ImageExporterThread)
+    {
+        BudgetState.State = ENVMemoryBudgetState::Throttled;
+        return BudgetState;
+    }
+
+    BudgetState = ImageExporterThread->GetMemoryBudgetState();
+    // Without a memory budget, only the number of pending items is limited
+    if ((BudgetState.BudgetByteSize <= 0) && (MaxSaveImageAsyncCount > 0)
+            && (BudgetState.PendingItemCount > (int32)(MaxSaveImageAsyncCount / 2)))
+    {
+        BudgetState.State = ENVMemoryBudgetState::Throttled;
+    }
+    return BudgetState;
 }
 
 bool UNVSceneDataExporter::IsHandlingData() const
@@ -47,30 +114,40 @@ bool UNVSceneDataExporter::IsHandlingData() const
     return ImageExporterThread && ImageExporterThread->IsExportingImage();
 }
 
-bool UNVSceneDataExporter::HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData, UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
+UNVSceneDataHandler::FNVScenePixelsDataHandler UNVSceneDataExporter::PrepareScenePixelsData(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
 {
-    bool bResult = false;
-    if (ImageExporterThread && CapturedFeatureExtractor && CapturedViewpoint)
+    if (!ImageExporterThread.IsValid() || !CapturedFeatureExtractor || !CapturedViewpoint)
     {
-		ENVImageFormat ExportImageFormat = ENVImageFormat::PNG;
-
-        const FString NewExportFilePath = GetExportFilePath(CapturedFeatureExtractor, CapturedViewpoint, FrameIndex, GetExportImageExtension(ExportImageFormat));
-        ImageExporterThread->ExportImage(CapturedPixelData, NewExportFilePath, ExportImageFormat);
-        bResult = true;
+        return nullptr;
     }
-    return bResult;
+
+    // NOTE: The pixels are handled on a worker thread, keep the current exporter alive with them even if the capture restart meanwhile:
+    // a killed exporter refuse the late pixels instead of exporting them to the new output directory
+    const TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> CurrentExporterThread = ImageExporterThread;
+    const ENVImageFormat RequestedImageFormat = GetPixelsExportImageFormat(CapturedFeatureExtractor);
+    // The extension depend on the pixels' format, it's added when they are read back
+    const FString ExportFilePathNoExtension = GetExportFilePath(CapturedFeatureExtractor, CapturedViewpoint, FrameIndex, TEXT(""));
+    const FNVCaptureCreditPtr CaptureCredit = FindCaptureCredit(FrameIndex);
+
+    return [CurrentExporterThread, RequestedImageFormat, ExportFilePathNoExtension, FrameIndex, CaptureCredit](const FNVTexturePixelData& CapturedPixelData)
+    {
+        const ENVImageFormat ExportImageFormat = FNVImageExporter::GetSupportedExportImageFormat(RequestedImageFormat, CapturedPixelData.PixelFormat);
+        const FString NewExportFilePath = ExportFilePathNoExtension + GetExportImageExtension(ExportImageFormat);
+        return CurrentExporterThread->ExportImage(CapturedPixelData, NewExportFilePath, ExportImageFormat, FrameIndex, CaptureCredit);
+    };
 }
 
-bool UNVSceneDataExporter::HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData, class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor, class UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
+bool UNVSceneDataExporter::HandleSceneAnnotationData(const FNVJsonBufferPtr& CapturedData, class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor, class UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
 {
     bool bResult = false;
-    if (CapturedFeatureExtractor && CapturedViewpoint)
+    const TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> CurrentExporterThread = GetImageExporterThread();
+    if (CurrentExporterThread.IsValid() && CapturedData.IsValid() && CapturedFeatureExtractor && CapturedViewpoint)
     {
         static const FString JsonExtension = TEXT(".json");
 
+        // NOTE: The annotation files are written by the exporter's workers so a slow disk doesn't stall the game thread
         const FString NewExportFilePath = GetExportFilePath(CapturedFeatureExtractor, CapturedViewpoint, FrameIndex, JsonExtension);
-        return NVSceneCapturerUtils::SaveJsonObjectToFile(CapturedData, NewExportFilePath);
-        bResult = true;
+        bResult = CurrentExporterThread->ExportEncodedData(CapturedData, NewExportFilePath, FrameIndex, FindCaptureCredit(FrameIndex));
     }
     return bResult;
 }
@@ -78,16 +155,20 @@ bool UNVSceneDataExporter::HandleSceneAnnotationData(const TSharedPtr<FJsonObjec
 void UNVSceneDataExporter::OnStartCapturingSceneData()
 {
     // Make sure the image exporter thread from the previous session is stopped and killed so we can spin up a new one
-    if (ImageExporterThread.IsValid())
+    // NOTE: The pixels still in flight keep a reference to the old exporter, it's only deleted after them but it refuse their data once killed
     {
-        ImageExporterThread->Kill();
-        ImageExporterThread = nullptr;
+        FScopeLock ExporterScopeLock(&ImageExporterThreadLock);
+        if (ImageExporterThread.IsValid())
+        {
+            // Kill join the workers so no thread is still running in the exporter when it's released
+            ImageExporterThread->Kill();
+            ImageExporterThread.Reset();
+        }
     }
 
-    if (!ImageExporterThread.IsValid())
-    {
-        ImageExporterThread = TUniquePtr<FNVImageExporter_Thread>(new FNVImageExporter_Thread(ImageWrapperModule));
-    }
+    FNVPixelBufferPool::Get().SetMaxPooledByteSize((int64)FMath::Max(MaxPooledPixelsBufferSizeMB, 0) * 1024 * 1024);
+    // The exporter's stats only count the pixels buffers of this capture
+    FNVTexturePixelData::ResetPixelsBufferCount();
 
     // Prepare the output directory before capturing
     FullOutputDirectoryPath = GetConfiguredOutputDirectoryPath();
@@ -117,9 +198,35 @@ void UNVSceneDataExporter::OnStartCapturingSceneData()
         }
     }
 
+    // NOTE: Only create the exporter thread after the output directory is prepared so it's safe for it to write there
+    if (!ImageExporterThread.IsValid())
+    {
+        TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> NewExporterThread = CreateImageExporterThread();
+
+        FScopeLock ExporterScopeLock(&ImageExporterThreadLock);
+        ImageExporterThread = NewExporterThread;
+    }
+
     ExportCapturerSettings();
 }
 
+TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> UNVSceneDataExporter::CreateImageExporterThread()
+{
+    return MakeShareable(new FNVImageExporter_Thread(ImageWrapperModule, ImageExporterSettings));
+}
+
+TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> UNVSceneDataExporter::GetImageExporterThread() const
+{
+    FScopeLock ExporterScopeLock(&ImageExporterThreadLock);
+    return ImageExporterThread;
+}
+
+ENVImageFormat UNVSceneDataExporter::GetPixelsExportImageFormat(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor) const
+{
+    ensure(CapturedFeatureExtractor);
+    return CapturedFeatureExtractor ? CapturedFeatureExtractor->GetExportImageFormat() : ENVImageFormat::PNG;
+}
+
 void UNVSceneDataExporter::ExportCapturerSettings()
 {
     ANVSceneCapturerActor* OwnerSceneCapturer = Cast<ANVSceneCapturerActor>(GetOuter());
@@ -150,13 +257,15 @@ void UNVSceneDataExporter::ExportCapturerSettings()
         ActorClassNames.Reset();
 
 	    ANVSceneManager* SceneManager = ANVSceneManager::GetANVSceneManagerPtr();
-        // NOTE: We should keep a list of all the actors that we want to annotate
-        for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+        // NOTE: Only the tagged actors can be annotated and they are all registered in the world's actor index
+        FNVCapturableActorIndex* ActorIndex = FNVCapturableActorIndex::Get(World);
+        const TArray<FNVCapturableActorEntry> ActorEntries = ActorIndex ? ActorIndex->GetEntries() : TArray<FNVCapturableActorEntry>();
+        for (const FNVCapturableActorEntry& ActorEntry : ActorEntries)
         {
-            AActor* CheckActor = *ActorIt;
+            AActor* CheckActor = ActorEntry.Actor.Get();
             if (CheckActor)
             {
-                UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
+                UNVCapturableActorTag* Tag = ActorEntry.Tag.Get();
                 bool bShouldExport = (Tag && Tag->bIncludeMe);
                 if (bShouldExport)
                 {
@@ -290,6 +399,32 @@ void UNVSceneDataExporter::OnStopCapturingSceneData()
 {
     if (ImageExporterThread.IsValid())
     {
+        // The annotations of the last frames are only queued, let the workers write them (and the images) before stopping them
+        ImageExporterThread->WaitUntilAllExported();
+
+        const FNVImageExporterStats& ExporterStats = ImageExporterThread->GetStats();
+        UE_LOG(LogNVSceneDataHandler, Log, TEXT("Image exporter stats: exported %d images - peak queue depth: %d - avg queued time: %.4fs - avg export time: %.4fs - max export time: %.4fs - blocked time: %.4fs - pixels buffers: %d - peak memory in flight: %.1fMB - throttled: %d times"),
+            ExporterStats.ExportedImageCount, ExporterStats.PeakQueuedImageCount, ExporterStats.AverageQueuedTime,
+            ExporterStats.AverageExportTime, ExporterStats.MaxExportTime, ExporterStats.BlockedTime,
+            ExporterStats.PixelsBufferCount,
+            ExporterStats.PeakMemoryInFlightMB, ExporterStats.ThrottledCount);
+
+        const FNVPixelBufferPoolStats& PoolStats = FNVPixelBufferPool::Get().GetStats();
+        UE_LOG(LogNVSceneDataHandler, Log, TEXT("Pixels buffer pool stats: acquired %d buffers - hits: %d - misses: %d - discarded: %d - pooled: %d buffers (%lld / %lld bytes)"),
+            PoolStats.AcquiredCount, PoolStats.HitCount, PoolStats.MissCount, PoolStats.DiscardedCount,
+            PoolStats.PooledBufferCount, PoolStats.PooledByteSize, PoolStats.MaxPooledByteSize);
+
+        const FNVTextureReadbackRingStats ReadbackStats = FNVTextureReadbackRing::GetGlobalStats();
+        UE_LOG(LogNVSceneDataHandler, Log, TEXT("Texture readback stats: issued %d readbacks - completed: %d - flushed: %d - pending: %d - mapped: %d - staging textures: %d - total map wait: %.4fs - max map wait: %.4fs - release wait: %.4fs"),
+            ReadbackStats.IssuedReadbackCount, ReadbackStats.CompletedReadbackCount, ReadbackStats.FlushedReadbackCount,
+            ReadbackStats.PendingReadbackCount, ReadbackStats.MappedReadbackCount, ReadbackStats.StagingTextureAllocationCount,
+            ReadbackStats.TotalMapWaitTime, ReadbackStats.MaxMapWaitTime, ReadbackStats.TotalReleaseWaitTime);
+
+        const FNVCaptureCreditStats CreditStats = GetCaptureCreditStats();
+        UE_LOG(LogNVSceneDataHandler, Log, TEXT("Capture credit stats: granted %d credits - retired: %d - outstanding: %d / %d - peak outstanding: %d - denied: %d - avg credit lifetime: %.4fs - total wait: %.4fs"),
+            CreditStats.GrantedCreditCount, CreditStats.RetiredCreditCount, CreditStats.OutstandingCreditCount, CreditStats.MaxCreditCount,
+            CreditStats.PeakOutstandingCreditCount, CreditStats.DeniedRequestCount, CreditStats.AverageCreditLifetime, CreditStats.TotalWaitTime);
+
         ImageExporterThread->Stop();
     }
 }
@@ -401,6 +536,109 @@ uint32 UNVSceneDataExporter::GetPendingToExportImagesCount() const
     return 0;
 }
 
+FNVImageExporterStats UNVSceneDataExporter::GetImageExporterStats() const
+{
+    if (ImageExporterThread.IsValid())
+    {
+        return ImageExporterThread->GetStats();
+    }
+    return FNVImageExporterStats();
+}
+
+//=================================== UNVSceneDataShardExporter ===================================
+UNVSceneDataShardExporter::UNVSceneDataShardExporter() : Super()
+{
+}
+
+void UNVSceneDataShardExporter::OnStopCapturingSceneData()
+{
+    Super::OnStopCapturingSceneData();
+
+    CloseShardWriter();
+}
+
+void UNVSceneDataShardExporter::OnCapturingCompleted()
+{
+    // All the captured data are handled, finish the last shard before the output directory is opened
+    CloseShardWriter();
+
+    Super::OnCapturingCompleted();
+}
+
+int32 UNVSceneDataShardExporter::GetShardCount() const
+{
+    return ShardWriter.IsValid() ? ShardWriter->GetShardCount() : 0;
+}
+
+TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> UNVSceneDataShardExporter::CreateImageExporterThread()
+{
+    CloseShardWriter();
+
+    // A frame keep its capture credit until all its data are exported, the writer check it to not close a shard while its frames still have files to come
+    if (!CaptureCreditPool.IsValid())
+    {
+        CaptureCreditPool = MakeShareable(new FNVCaptureCreditPool(MaxCapturedFramesInFlight));
+    }
+    TWeakPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> WeakCreditPool = CaptureCreditPool;
+    FNVTarShardWriter::FNVIsFramePendingCallback IsFramePending = [WeakCreditPool](int32 FrameIndex)
+    {
+        TSharedPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> CreditPool = WeakCreditPool.Pin();
+        return CreditPool.IsValid() && CreditPool->FindFrameCredit(FrameIndex).IsValid();
+    };
+    ShardWriter = MakeShareable(new FNVTarShardWriter(GetFullOutputDirectoryPath(), ShardWriterSettings, IsFramePending));
+
+    // NOTE: The workers only keep a weak reference to the writer so it can be closed while they are still running
+    TWeakPtr<FNVTarShardWriter, ESPMode::ThreadSafe> WeakShardWriter = ShardWriter;
+    FNVEncodedDataWriter ShardDataWriter = [WeakShardWriter](const FNVImageExporterData& ExporterData, const TArray<uint8>& EncodedData)
+    {
+        TSharedPtr<FNVTarShardWriter, ESPMode::ThreadSafe> CurrentShardWriter = WeakShardWriter.Pin();
+        if (!CurrentShardWriter.IsValid())
+        {
+            return false;
+        }
+        const FString EntryName = FPaths::GetCleanFilename(ExporterData.ExportFilePath);
+        return CurrentShardWriter->AddEntry(EntryName, ExporterData.FrameIndex, EncodedData);
+    };
+
+    TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> NewExporterThread = MakeShareable(new FNVImageExporter_Thread(ImageWrapperModule, ImageExporterSettings, ShardDataWriter));
+
+    // The files the writer keep for the next shard are still in memory, count them in the exporter's budget so the capturer is throttled
+    TWeakPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> WeakExporterThread = NewExporterThread;
+    ShardWriter->SetDeferredSizeChangedCallback([WeakExporterThread](int64 ByteSizeDelta)
+    {
+        TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> CurrentExporterThread = WeakExporterThread.Pin();
+        if (CurrentExporterThread.IsValid())
+        {
+            CurrentExporterThread->UpdateExternalByteSizeInFlight(ByteSizeDelta);
+        }
+    });
+
+    return NewExporterThread;
+}
+
+ENVImageFormat UNVSceneDataShardExporter::GetPixelsExportImageFormat(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor) const
+{
+    const ENVImageFormat ExportImageFormat = Super::GetPixelsExportImageFormat(CapturedFeatureExtractor);
+    // NOTE: BMP files are written directly by the engine so they can't be packed into the shards, use the lossless PNG instead
+    return (ExportImageFormat == ENVImageFormat::BMP) ? ENVImageFormat::PNG : ExportImageFormat;
+}
+
+void UNVSceneDataShardExporter::CloseShardWriter()
+{
+    // Let the workers write all the queued images and annotations to the shard before it's closed and its index exported
+    if (ImageExporterThread.IsValid())
+    {
+        ImageExporterThread->WaitUntilAllExported();
+        ImageExporterThread->Kill();
+    }
+
+    // NOTE: Keep the closed writer around so its shard count can still be queried
+    if (ShardWriter.IsValid())
+    {
+        ShardWriter->Close();
+    }
+}
+
 //=================================== UNVSceneDataVisualizer ===================================
 UNVSceneDataVisualizer::UNVSceneDataVisualizer()
 {
@@ -448,19 +686,13 @@ bool UNVSceneDataVisualizer::IsHandlingData() const
     return false;
 }
 
-bool UNVSceneDataVisualizer::HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData, UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
+UNVSceneDataHandler::FNVScenePixelsDataHandler UNVSceneDataVisualizer::PrepareScenePixelsData(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
 {
-    if (!CapturedFeatureExtractor || !CapturedViewpoint)
-    {
-        return false;
-    }
-
-    // NOTE: May want to update debug text on the HUD?
-
-    return true;
+    // NOTE: May want to update debug text on the HUD? The visualizer only show the textures of the feature extractors, it doesn't need their pixels
+    return nullptr;
 }
 
-bool UNVSceneDataVisualizer::HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData, class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor, class UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
+bool UNVSceneDataVisualizer::HandleSceneAnnotationData(const FNVJsonBufferPtr& CapturedData, class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor, class UNVSceneCapturerViewpointComponent* CapturedViewpoint, int32 FrameIndex)
 {
     // TODO: Need to handle general data, annotation, not just the pixels data
     return false;
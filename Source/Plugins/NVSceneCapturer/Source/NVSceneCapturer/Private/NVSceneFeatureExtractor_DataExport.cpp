@@ -11,6 +11,8 @@
 #include "NVSceneCaptureComponent2D.h"
 #include "NVAnnotatedActor.h"
 #include "NVSceneManager.h"
+#include "NVCapturableActorIndex.h"
+#include "NVSceneWorldSnapshot.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/StaticMesh.h"
@@ -49,7 +51,7 @@ bool UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnnotationData(UNVScen
 {
     if (Callback)
     {
-        TSharedPtr<FJsonObject> CapturedData = CaptureSceneAnnotationData();
+        FNVJsonBufferPtr CapturedData = CaptureSceneAnnotationData();
         if (CapturedData.IsValid())
         {
             Callback(CapturedData, this);
@@ -59,9 +61,9 @@ bool UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnnotationData(UNVScen
     return false;
 }
 
-TSharedPtr<FJsonObject> UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnnotationData()
+FNVJsonBufferPtr UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnnotationData()
 {
-    TSharedPtr<FJsonObject> SceneDataJsonObj = nullptr;
+    FNVJsonBufferPtr SceneDataJsonBuffer = nullptr;
     if (OwnerViewpoint)
     {
         const auto& CapturerSettings = OwnerViewpoint->GetCapturerSettings();
@@ -82,39 +84,51 @@ TSharedPtr<FJsonObject> UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnn
         ViewpointData.ProjectionMatrix = ProjectionMatrix;
         ViewpointData.ViewProjectionMatrix = ViewProjectionMatrix;
 
+        // All the viewpoints of the capturer share the same world snapshot so the camera independent data of the actors are only calculated once per frame
+        FNVSceneWorldSnapshot* WorldSnapshot = OwnerCapturer ? &OwnerCapturer->GetWorldSnapshot() : nullptr;
+        if (!WorldSnapshot)
+        {
+            LocalWorldSnapshot.Invalidate();
+            WorldSnapshot = &LocalWorldSnapshot;
+        }
+
         UWorld* World = GetWorld();
         ensure(World);
         if (World)
         {
-            // TODO: Should create a TrainingActor class to handle actors we want to export
-            // Let those actor register with the exporter so we don't need to do a loop through all the actor like this every time we export
-            // NOTE: Can keep 1 relevant actor list on the exporter actor and all the exporter components can use it too
-            for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+            // NOTE: When the hidden actors are not ignored, any visible actor can be exported even without a tag so we still need to check all the actors in the world
+            // Otherwise only the tagged actors can be exported and they are all registered in the world's actor index
+            FNVCapturableActorIndex* ActorIndex = ProtectedDataExportSettings.bIgnoreHiddenActor ? FNVCapturableActorIndex::Get(World) : nullptr;
+            if (ActorIndex)
             {
-                const AActor* CheckActor = *ActorIt;
-                FCapturedObjectData ActorData;
-                if (GatherActorData(CheckActor, ActorData))
+                for (const FNVCapturableActorEntry& ActorEntry : ActorIndex->GetEntries())
                 {
-                    SceneData.Objects.Add(ActorData);
+                    const FNVActorWorldSnapshot* ActorSnapshot = WorldSnapshot->GetActorSnapshot(ActorEntry.Actor.Get());
+                    FCapturedObjectData ActorData;
+                    if (ActorSnapshot && GatherActorData(*ActorSnapshot, ActorData))
+                    {
+                        SceneData.Objects.Add(ActorData);
+                    }
                 }
             }
-        }
-
-        SceneDataJsonObj = NVSceneCapturerUtils::UStructToJsonObject(SceneData, 0, 0);
-        // TODO: This code is a bit messy. Should implement a ToJsonObject function in the FCapturedSceneData struct
-        for (int i = 0; i < SceneData.Objects.Num(); i++)
-        {
-            const FCapturedObjectData& CheckObjectData = SceneData.Objects[i];
-            const TArray< TSharedPtr<FJsonValue> >& JsonObjectArrayData = SceneDataJsonObj->GetArrayField(TEXT("objects"));
-            const TSharedPtr<FJsonObject>& JsonObjectData = JsonObjectArrayData[i]->AsObject();
-            const TSharedPtr<FJsonObject>& CustomDataJsonObj = CheckObjectData.custom_data;
-            if (CustomDataJsonObj.IsValid() && JsonObjectData.IsValid())
+            else
             {
-                JsonObjectData->SetObjectField(TEXT("custom_data"), CustomDataJsonObj);
+                for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+                {
+                    const FNVActorWorldSnapshot* ActorSnapshot = WorldSnapshot->GetActorSnapshot(*ActorIt);
+                    FCapturedObjectData ActorData;
+                    if (ActorSnapshot && GatherActorData(*ActorSnapshot, ActorData))
+                    {
+                        SceneData.Objects.Add(ActorData);
+                    }
+                }
             }
         }
+
+        // NOTE: Stream the data straight to json instead of building a FJsonObject tree with UStructToJsonObject, the output is the same
+        SceneDataJsonBuffer = SceneData.ToJsonBuffer();
     }
-    return SceneDataJsonObj;
+    return SceneDataJsonBuffer;
 }
 
 void UNVSceneFeatureExtractor_AnnotationData::UpdateProjectionMatrix()
@@ -139,17 +153,20 @@ void UNVSceneFeatureExtractor_AnnotationData::UpdateProjectionMatrix()
         {
             ViewProjectionMatrix = UNVSceneCaptureComponent2D::BuildViewProjectionMatrix(ViewTransform, CaptureImageSize, ProjectionMode, FOVAngle, OrthoWidth, ProjectionMatrix);
         }
+
+        GetViewFrustumBounds(ViewFrustum, ViewProjectionMatrix, true);
     }
 }
 
-bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* CheckActor, FCapturedObjectData& ActorData)
+bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const FNVActorWorldSnapshot& ActorSnapshot, FCapturedObjectData& ActorData)
 {
-    if (!OwnerViewpoint || !CheckActor || !ShouldExportActor(CheckActor))
+    if (!OwnerViewpoint || !ShouldExportActor(ActorSnapshot))
     {
         return false;
     }
 
-    const FString& ObjectName = CheckActor->GetName();
+    const AActor* CheckActor = ActorSnapshot.GetActor();
+    const FNVActorWorldExportData& ActorExportData = ActorSnapshot.GetExportData();
 
     UWorld* World = GetWorld();
     ensure(World);
@@ -160,9 +177,9 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         const FMatrix& WorldToCameraMatrix_UE4 = WorldToCameraTransform.ToMatrixNoScale();
         const FMatrix& WorldToCameraMatrix_OpenCV = WorldToCameraMatrix_UE4 * NVSceneCapturerUtils::UE4ToOpenCVMatrix;
 
-        const FTransform& ActorToWorldTransform = CheckActor->GetActorTransform();
-        const FMatrix& ActorToWorldMatrix_UE4 = ActorToWorldTransform.ToMatrixWithScale();
-        const FMatrix& ActorToWorldMatrix_OpenCV = ActorToWorldMatrix_UE4 * NVSceneCapturerUtils::UE4ToOpenCVMatrix;
+        const FTransform& ActorToWorldTransform = ActorExportData.ActorToWorldTransform;
+        const FMatrix& ActorToWorldMatrix_UE4 = ActorExportData.ActorToWorldMatrix_UE4;
+        const FMatrix& ActorToWorldMatrix_OpenCV = ActorExportData.ActorToWorldMatrix_OpenCV;
         const FMatrix& ActorToCameraMatrix_UE4 = ActorToWorldMatrix_UE4 * WorldToCameraMatrix_UE4;
         const FMatrix& ActorToCameraMatrix_OpenCV = ActorToWorldMatrix_UE4 * WorldToCameraMatrix_UE4 * NVSceneCapturerUtils::UE4ToOpenCVMatrix;
 
@@ -170,32 +187,19 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         const FTransform& ActorToCameraTransform_OpenCV = FTransform(ActorToCameraMatrix_OpenCV);
 
 
-        const FVector& ActorLocation = CheckActor->GetActorLocation();
-        const FVector& ActorForwardDir = ActorToWorldTransform.GetRotation().Vector();
+        const FVector& ActorLocation = ActorExportData.Location;
+        const FVector& ActorForwardDir = ActorExportData.ForwardDirection;
 
         ActorData.location_worldspace = NVSceneCapturerUtils::UE4ToOpenCVMatrix.TransformPosition(ActorLocation);
         ActorData.location = WorldToCameraMatrix_OpenCV.TransformPosition(ActorLocation);
 
-        const UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
         // Fill in actor's data
-        ActorData.Name = ObjectName;
-        ActorData.Class = Tag ? Tag->Tag : ObjectName;
-        ANVSceneManager* NVSceneManagerPtr = ANVSceneManager::GetANVSceneManagerPtr();
-        if (NVSceneManagerPtr)
-        {
-            ActorData.instance_id = NVSceneManagerPtr->ObjectInstanceSegmentation.GetInstanceId(CheckActor);
-        }
-        else
-        {
-            ActorData.instance_id = 0;
-        }
-        const FQuat& ActorQuaternion_UE4 = ActorToWorldTransform.GetRotation();
-        const FRotator& ActorRotator_UE4 = ActorToWorldTransform.Rotator();
+        ActorData.Name = ActorExportData.Name;
+        ActorData.Class = ActorExportData.Class;
+        ActorData.instance_id = ActorExportData.InstanceId;
 
         // OpenCV coordinate system
-        // NOTE: The actor transform matrix may included scaling, if we just use ToQuat(), UE4 will just return [0, 0, 0, 1] when the rotation matrix is not an identity matrix
-        // => we need to convert it first using GetMatrixWithoutScale
-        ActorData.quaternion_worldspace = NVSceneCapturerUtils::ConvertQuaternionToOpenCVCoordinateSystem(ActorToWorldMatrix_UE4.GetMatrixWithoutScale().ToQuat());
+        ActorData.quaternion_worldspace = ActorExportData.Quaternion_OpenCV;
         ActorData.rotation_worldspace = ActorData.quaternion_worldspace.Rotator();
 
         const FQuat& ActorCamQuat_OpenCV = ActorToCameraMatrix_OpenCV.GetMatrixWithoutScale().ToQuat();
@@ -208,29 +212,14 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         ActorData.actor_to_world_matrix_ue4 = ActorToWorldMatrix_UE4;
         ActorData.actor_to_world_matrix_opencv = ActorToWorldMatrix_OpenCV;
 
-        UMeshComponent* ValidMeshComp = NVSceneCapturerUtils::GetFirstValidMeshComponent(CheckActor);
+        UMeshComponent* ValidMeshComp = ActorSnapshot.GetFirstValidMeshComponent();
         if (!ValidMeshComp)
         {
             return false;
         }
 
         // Find the actor's cuboid
-        FNVCuboidData ActorCuboid;
-        switch (ProtectedDataExportSettings.BoundsType)
-        {
-            case ENVBoundsGenerationType::VE_OOBB:
-                // TODO: Right now some of the mesh's collision components are quite different from its mesh => just don't use the collision component for now
-                // May be later we can just use the cuboid from the AAnnotatedActor which are only calculated once
-                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_OOBB_Simple(CheckActor, false);
-                break;
-            case ENVBoundsGenerationType::VE_TightOOBB:
-                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_OOBB_Complex(CheckActor);
-                break;
-            default:
-            case ENVBoundsGenerationType::VE_AABB:
-                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_AABB(CheckActor);
-                break;
-        }
+        const FNVCuboidData& ActorCuboid = ActorSnapshot.GetCuboid(ProtectedDataExportSettings.BoundsType);
         for (const FVector& CuboidVertex : ActorCuboid.Vertexes)
         {
             const FVector VertexImgPoint = ProjectWorldPositionToImagePosition(CuboidVertex);
@@ -276,7 +265,7 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
             ActorData.distance_scale = (ActorDistanceToViewpoint >= MaxDist) ? 1.f : 0.f;
         }
 
-        FBox2D ActorBB2D = GetBoundingBox2D(CheckActor, false);
+        FBox2D ActorBB2D = GetBoundingBox2D(ActorSnapshot, false);
         // Calculate Truncated
         FBox2D ClampedActorBB2D = ActorBB2D;
         ClampedActorBB2D.Min.X = FMath::Clamp(ActorBB2D.Min.X, 0.f, 1.f);
@@ -311,8 +300,7 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
 
         // TODO: Trace against a 3d voxelized volume of the target actor
         // Find the 3d bounding box in the camera coordinate
-        const UMeshComponent* ActorMesh = NVSceneCapturerUtils::GetFirstValidMeshComponent(CheckActor);
-        TArray<FVector> MeshBoundVertexes = NVSceneCapturerUtils::GetSimpleCollisionVertexes(ActorMesh);
+        const TArray<FVector>& MeshBoundVertexes = ActorSnapshot.GetSimpleCollisionVertexes();
         FBox CameraSpaceBoundingBox(EForceInit::ForceInitToZero);
         const FTransform& CameraTransform = OwnerViewpoint->GetComponentTransform();
         // Find the nearest and farthest vertexes
@@ -396,65 +384,34 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         ActorData.truncated = (FullArea > 0.f) ? (1.f - (ClampedArea / FullArea)) : 1.f;
 
         // Gather the socket data
-        if (Tag)
+        for (const FNVSocketWorldData& SocketWorldData : ActorSnapshot.GetSockets())
         {
-            TArray<UMeshComponent*> MeshComponents;
-            CheckActor->GetComponents(MeshComponents);
-
-            bool bNeedExportSockets = Tag->bExportAllMeshSocketInfo || (Tag->SocketNameToExportList.Num() > 0);
-            if (bNeedExportSockets)
-            {
-                for (UMeshComponent* CheckMeshComp : MeshComponents)
-                {
-                    if (CheckMeshComp)
-                    {
-                        const TArray<FName>& AllSocketNames = CheckMeshComp->GetAllSocketNames();
-                        for (const FName CheckSocketName : AllSocketNames)
-                        {
-                            bool bShouldExportSocket = Tag->bExportAllMeshSocketInfo || Tag->SocketNameToExportList.Contains(CheckSocketName);
-                            if (bShouldExportSocket)
-                            {
-                                const FVector& SocketWorldLocation = CheckMeshComp->GetSocketLocation(CheckSocketName);
-                                const FVector& SocketScreenPosition = ProjectWorldPositionToImagePosition(SocketWorldLocation);
-                                const FVector2D& SocketLocation = FVector2D(SocketScreenPosition.X, SocketScreenPosition.Y);
+            const FVector& SocketScreenPosition = ProjectWorldPositionToImagePosition(SocketWorldData.WorldLocation);
 
-                                FNVSocketData NewSocketData;
-                                NewSocketData.SocketName = CheckSocketName.ToString();
-                                NewSocketData.SocketLocation = SocketLocation;
+            FNVSocketData NewSocketData;
+            NewSocketData.SocketName = SocketWorldData.SocketName;
+            NewSocketData.SocketLocation = FVector2D(SocketScreenPosition.X, SocketScreenPosition.Y);
 
-                                ActorData.socket_data.Add(NewSocketData);
-                            }
-                        }
-                    }
-                }
-            }
+            ActorData.socket_data.Add(NewSocketData);
         }
 
-        const ANVAnnotatedActor* AnnotatedActor = Cast<ANVAnnotatedActor>(CheckActor);
-        if (AnnotatedActor)
-        {
-            ActorData.custom_data = AnnotatedActor->GetCustomAnnotatedData();
-        }
+        ActorData.custom_data = ActorSnapshot.GetCustomData();
     }
     return true;
 }
 
-bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActor(const AActor* CheckActor) const
+bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActor(const FNVActorWorldSnapshot& ActorSnapshot) const
 {
     bool bShouldExport = false;
-    const auto& CapturerSettings = OwnerViewpoint->GetCapturerSettings();
 
     // Only care about valid actor
-    if (CheckActor)
+    if (ActorSnapshot.GetActor())
     {
         if (ProtectedDataExportSettings.bIgnoreHiddenActor)
         {
-            FConvexVolume ViewFrustum;
-            GetViewFrustumBounds(ViewFrustum, ViewProjectionMatrix, true);
-
             // The actor is considered as hidden if it's not rendered in the game
             // or it doesn't appear on the viewport
-            if (CheckActor->bHidden || !IsActorInViewFrustum(ViewFrustum, CheckActor))
+            if (ActorSnapshot.bHidden || !IsActorInViewFrustum(ViewFrustum, ActorSnapshot))
             {
                 return bShouldExport;
             }
@@ -462,21 +419,18 @@ bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActor(const AActor* Ch
 
         //Check if it's flagged
         //TODO (OS): Implement ENVIncludeObjects::MatchesTag
-        UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
-        bShouldExport |= (!ProtectedDataExportSettings.bIgnoreHiddenActor) && (!CheckActor->bHidden);
+        const UNVCapturableActorTag* Tag = ActorSnapshot.GetTag();
+        bShouldExport |= (!ProtectedDataExportSettings.bIgnoreHiddenActor) && (!ActorSnapshot.bHidden);
         bShouldExport |= ((ProtectedDataExportSettings.IncludeObjectsType == ENVIncludeObjects::AllTaggedObjects) && Tag && (Tag->bIncludeMe /* || IncludeAll*/));
 
         if (bShouldExport)
         {
             bShouldExport = false;
             // Ensure the actor have a mesh
-            TArray<UMeshComponent*> MeshComponents;
-            CheckActor->GetComponents(MeshComponents);
-            if (MeshComponents.Num() != 0)
+            if (ActorSnapshot.bHasMeshComponent)
             {
                 // Check if the actor actually have a valid bound
-                const FBox ActorBounds = CheckActor->GetComponentsBoundingBox(true); // true means all subcomponents
-                const FVector BoxExtent = ActorBounds.GetExtent();
+                const FVector BoxExtent = ActorSnapshot.ComponentsBoundingBox.GetExtent();
                 if (!BoxExtent.IsZero())
                 {
                     bShouldExport = true;
@@ -488,15 +442,10 @@ bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActor(const AActor* Ch
     return bShouldExport;
 }
 
-bool UNVSceneFeatureExtractor_AnnotationData::IsActorInViewFrustum(const FConvexVolume& ViewFrustum, const AActor* CheckActor) const
+bool UNVSceneFeatureExtractor_AnnotationData::IsActorInViewFrustum(const FConvexVolume& CheckViewFrustum, const FNVActorWorldSnapshot& ActorSnapshot) const
 {
-    if (!CheckActor)
-    {
-        return false;
-    }
-
     //Check if Bounds are > 0
-    const FBox ActorBounds = CheckActor->GetComponentsBoundingBox(true); //true means all non-colliding subcomponents
+    const FBox& ActorBounds = ActorSnapshot.ComponentsBoundingBox;
     const FVector Origin = ActorBounds.GetCenter();
     const FVector BoxExtent = ActorBounds.GetExtent();
 
@@ -508,7 +457,7 @@ bool UNVSceneFeatureExtractor_AnnotationData::IsActorInViewFrustum(const FConvex
 
     // NOTE: The Frustum's intersect test may not be too cheap, can just get the cuboid of the actor and project them into the 2d image to see if any of them in range
     // NOTE: this test is conservative.  If any part of the box extents intersect the frustum, actor is considered as in the view frustum
-    return ViewFrustum.IntersectBox(Origin, BoxExtent);
+    return CheckViewFrustum.IntersectBox(Origin, BoxExtent);
 }
 
 FVector UNVSceneFeatureExtractor_AnnotationData::ProjectWorldPositionToImagePosition(const FVector& WorldPosition) const
@@ -546,25 +495,13 @@ FVector UNVSceneFeatureExtractor_AnnotationData::ProjectWorldPositionToImagePosi
     return ImagePos;
 }
 
-FBox2D UNVSceneFeatureExtractor_AnnotationData::GetBoundingBox2D(const AActor* CheckActor, bool bClampToImage /*= true*/) const
+FBox2D UNVSceneFeatureExtractor_AnnotationData::GetBoundingBox2D(const FNVActorWorldSnapshot& ActorSnapshot, bool bClampToImage /*= true*/) const
 {
-    FBox2D ActorBB2D(EForceInit::ForceInitToZero);
-
-    if (CheckActor)
-    {
-        TArray<UMeshComponent*> MeshComponents;
-        CheckActor->GetComponents(MeshComponents);
-
-        for (const UMeshComponent* MeshComp : MeshComponents)
-        {
-            if (MeshComp)
-            {
-                ActorBB2D += Calculate2dAABB_MeshComplexCollision(MeshComp, bClampToImage);
-            }
-        }
+    // NOTE: The box of all the meshes' vertexes is the same as the union of each mesh's box
+    // so we can use the vertexes gathered once in the snapshot for all the viewpoints
+    FBox2D ActorBB2D = Calculate2dAABB(ActorSnapshot.GetMeshCollisionVertexes(), bClampToImage);
 
-        // TODO: Fallback to use the actor's cuboid vertexes in case the mesh doesn't have valid collision body set up
-    }
+    // TODO: Fallback to use the actor's cuboid vertexes in case the mesh doesn't have valid collision body set up
 
     // Mark the bounding box as invalid if its area is empty
     if (ActorBB2D.GetArea() <= 0.f)
@@ -575,7 +512,7 @@ FBox2D UNVSceneFeatureExtractor_AnnotationData::GetBoundingBox2D(const AActor* C
     return ActorBB2D;
 }
 
-FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB(TArray<FVector> Vertexes, bool bClampToImage /*= true*/) const
+FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB(const TArray<FVector>& Vertexes, bool bClampToImage /*= true*/) const
 {
     FBox2D BBox2D(EForceInit::ForceInitToZero);
 
@@ -599,70 +536,7 @@ FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB_MeshComplexColli
     FBox2D BBox2D(EForceInit::ForceInitToZero);
 
     TArray<FVector> BoundVertexes;
-
-    const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(CheckMeshComp);
-    if (StaticMeshComp)
-    {
-        const FTransform& MeshTransform = StaticMeshComp->GetComponentTransform();
-        const UStaticMesh* CheckMesh = StaticMeshComp->GetStaticMesh();
-        if (CheckMesh && CheckMesh->BodySetup)
-        {
-            const FKAggregateGeom& MeshGeom = CheckMesh->BodySetup->AggGeom;
-
-            for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
-            {
-                for (const FVector& CheckVertex : ConvexElem.VertexData)
-                {
-                    const FVector& VertexWorldLocation = MeshTransform.TransformPosition(CheckVertex);
-                    BoundVertexes.Add(VertexWorldLocation);
-                }
-            }
-        }
-
-        bool bHaveBodyVertexData = (BoundVertexes.Num() > 0);
-        // Fallback to use the mesh's render data if it doesn't have a valid body setup
-        if (!bHaveBodyVertexData && CheckMesh && CheckMesh->RenderData)
-        {
-            const FPositionVertexBuffer& MeshVertexBuffer = CheckMesh->RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
-            const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
-            for (uint32 i = 0; i < VertexesCount; i++)
-            {
-                const FVector& VertexPosition = MeshTransform.TransformPosition(MeshVertexBuffer.VertexPosition(i));
-                BoundVertexes.Add(VertexPosition);
-            }
-        }
-    }
-    else
-    {
-        const USkeletalMeshComponent* SkeletalMeshComp = Cast<USkeletalMeshComponent>(CheckMeshComp);
-        if (SkeletalMeshComp)
-        {
-            const USkeletalMesh* SkeletalMesh = SkeletalMeshComp ? SkeletalMeshComp->SkeletalMesh : nullptr;
-            if (SkeletalMesh)
-            {
-                const UPhysicsAsset* MeshPhysicsAsset = SkeletalMesh->PhysicsAsset;
-                if (MeshPhysicsAsset)
-                {
-                    const FTransform& MeshTransform = SkeletalMeshComp->GetComponentTransform();
-                    for (const USkeletalBodySetup* CheckSkeletalBodySetup : MeshPhysicsAsset->SkeletalBodySetups)
-                    {
-                        if (CheckSkeletalBodySetup)
-                        {
-                            const FKAggregateGeom& MeshGeom = CheckSkeletalBodySetup->AggGeom;
-                            for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
-                            {
-                                for (const FVector& CheckVertex : ConvexElem.VertexData)
-                                {
-                                    const FVector& VertexWorldLocation = MeshTransform.TransformPosition(CheckVertex);
-                                    BoundVertexes.Add(VertexWorldLocation);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+    FNVActorWorldSnapshot::GatherMeshCollisionVertexes(CheckMeshComp, BoundVertexes);
 
     if (BoundVertexes.Num() > 0)
     {
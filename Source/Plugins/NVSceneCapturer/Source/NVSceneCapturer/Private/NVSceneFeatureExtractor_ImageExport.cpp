@@ -9,6 +9,7 @@
 #include "NVSceneFeatureExtractor_ImageExport.h"
 #include "NVSceneCapturerActor.h"
 #include "NVSceneCaptureComponent2D.h"
+#include "NVCapturableActorIndex.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/StaticMesh.h"
@@ -93,19 +94,14 @@ UNVSceneCaptureComponent2D* UNVSceneFeatureExtractor_PixelData::CreateSceneCaptu
             {
                 UWorld* World = GetWorld();
 
-                // TODO: Should create a TrainingActor class to handle actors we want to export
-                // Let those actor register with the exporter so we don't need to do a loop through all the actor like this every time we export
-                // NOTE: Can keep 1 relevant actor list on the exporter actor and all the exporter components can use it too
-                for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+                FNVCapturableActorIndex* ActorIndex = World ? FNVCapturableActorIndex::Get(World) : nullptr;
+                if (ActorIndex)
                 {
-                    AActor* CheckActor = *ActorIt;
-                    if (CheckActor)
+                    TArray<AActor*> TrainingActors;
+                    ActorIndex->GetIncludedActors(TrainingActors);
+                    for (AActor* CheckActor : TrainingActors)
                     {
-                        UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
-                        if (Tag && Tag->bIncludeMe)
-                        {
-                            NewSceneCaptureComp2D->ShowOnlyActorComponents(CheckActor);
-                        }
+                        NewSceneCaptureComp2D->ShowOnlyActorComponents(CheckActor);
                     }
                 }
             }
@@ -135,6 +131,16 @@ UTextureRenderTarget2D* UNVSceneFeatureExtractor_PixelData::GetRenderTarget() co
     return SceneCaptureComponent ? SceneCaptureComponent->TextureTarget : nullptr;
 }
 
+ENVImageFormat UNVSceneFeatureExtractor_PixelData::GetExportImageFormat() const
+{
+    if (bOverrideExportImageType)
+    {
+        return ExportImageFormat;
+    }
+
+    return OwnerViewpoint ? OwnerViewpoint->GetCapturerSettings().ExportImageFormat : ENVImageFormat::PNG;
+}
+
 void UNVSceneFeatureExtractor_PixelData::UpdateMaterial()
 {
     PostProcessMaterialInstance = nullptr;
@@ -0,0 +1,278 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVSceneWorldSnapshot.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVAnnotatedActor.h"
+#include "NVSceneManager.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "StaticMeshResources.h"
+#include "PhysicsEngine/AggregateGeom.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+
+//================================== FNVActorWorldSnapshot ==================================
+FNVActorWorldSnapshot::FNVActorWorldSnapshot(const AActor* InActor)
+    : Actor(InActor)
+{
+    check(Actor);
+
+    // NOTE: Only gather the data needed to decide whether the actor should be exported here
+    Tag = Cast<UNVCapturableActorTag>(Actor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
+    bHidden = Actor->bHidden;
+
+    TArray<UMeshComponent*> MeshComponents;
+    Actor->GetComponents(MeshComponents);
+    bHasMeshComponent = (MeshComponents.Num() != 0);
+
+    ComponentsBoundingBox = Actor->GetComponentsBoundingBox(true); // true means all non-colliding subcomponents
+
+    bExportDataCached = false;
+    bValidMeshComponentCached = false;
+    FirstValidMeshComponent = nullptr;
+    CachedCuboidFlags = 0;
+    bSimpleCollisionVertexesCached = false;
+    bMeshCollisionVertexesCached = false;
+    bSocketsCached = false;
+    bCustomDataCached = false;
+}
+
+const FNVActorWorldExportData& FNVActorWorldSnapshot::GetExportData() const
+{
+    if (!bExportDataCached)
+    {
+        ExportData.Name = Actor->GetName();
+        ExportData.Class = Tag ? Tag->Tag : ExportData.Name;
+
+        ANVSceneManager* NVSceneManagerPtr = ANVSceneManager::GetANVSceneManagerPtr();
+        ExportData.InstanceId = NVSceneManagerPtr ? NVSceneManagerPtr->ObjectInstanceSegmentation.GetInstanceId(Actor) : 0;
+
+        ExportData.ActorToWorldTransform = Actor->GetActorTransform();
+        ExportData.ActorToWorldMatrix_UE4 = ExportData.ActorToWorldTransform.ToMatrixWithScale();
+        ExportData.ActorToWorldMatrix_OpenCV = ExportData.ActorToWorldMatrix_UE4 * NVSceneCapturerUtils::UE4ToOpenCVMatrix;
+        ExportData.Location = Actor->GetActorLocation();
+        ExportData.ForwardDirection = ExportData.ActorToWorldTransform.GetRotation().Vector();
+        // NOTE: The actor transform matrix may included scaling, if we just use ToQuat(), UE4 will just return [0, 0, 0, 1] when the rotation matrix is not an identity matrix
+        // => we need to convert it first using GetMatrixWithoutScale
+        ExportData.Quaternion_OpenCV = NVSceneCapturerUtils::ConvertQuaternionToOpenCVCoordinateSystem(ExportData.ActorToWorldMatrix_UE4.GetMatrixWithoutScale().ToQuat());
+
+        bExportDataCached = true;
+    }
+    return ExportData;
+}
+
+UMeshComponent* FNVActorWorldSnapshot::GetFirstValidMeshComponent() const
+{
+    if (!bValidMeshComponentCached)
+    {
+        FirstValidMeshComponent = NVSceneCapturerUtils::GetFirstValidMeshComponent(Actor);
+        bValidMeshComponentCached = true;
+    }
+    return FirstValidMeshComponent;
+}
+
+const FNVCuboidData& FNVActorWorldSnapshot::GetCuboid(ENVBoundsGenerationType BoundsType) const
+{
+    uint8 CuboidIndex = (uint8)BoundsType;
+    if (CuboidIndex >= ARRAY_COUNT(Cuboids))
+    {
+        CuboidIndex = (uint8)ENVBoundsGenerationType::VE_AABB;
+    }
+
+    const uint8 CuboidFlag = (1 << CuboidIndex);
+    if (!(CachedCuboidFlags & CuboidFlag))
+    {
+        FNVCuboidData& ActorCuboid = Cuboids[CuboidIndex];
+        switch ((ENVBoundsGenerationType)CuboidIndex)
+        {
+            case ENVBoundsGenerationType::VE_OOBB:
+                // TODO: Right now some of the mesh's collision components are quite different from its mesh => just don't use the collision component for now
+                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_OOBB_Simple(Actor, false);
+                break;
+            case ENVBoundsGenerationType::VE_TightOOBB:
+                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_OOBB_Complex(Actor);
+                break;
+            default:
+            case ENVBoundsGenerationType::VE_AABB:
+                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_AABB(Actor);
+                break;
+        }
+        CachedCuboidFlags |= CuboidFlag;
+    }
+    return Cuboids[CuboidIndex];
+}
+
+const TArray<FVector>& FNVActorWorldSnapshot::GetSimpleCollisionVertexes() const
+{
+    if (!bSimpleCollisionVertexesCached)
+    {
+        SimpleCollisionVertexes = NVSceneCapturerUtils::GetSimpleCollisionVertexes(GetFirstValidMeshComponent());
+        bSimpleCollisionVertexesCached = true;
+    }
+    return SimpleCollisionVertexes;
+}
+
+const TArray<FVector>& FNVActorWorldSnapshot::GetMeshCollisionVertexes() const
+{
+    if (!bMeshCollisionVertexesCached)
+    {
+        MeshCollisionVertexes.Reset();
+
+        TArray<UMeshComponent*> MeshComponents;
+        Actor->GetComponents(MeshComponents);
+        for (const UMeshComponent* MeshComp : MeshComponents)
+        {
+            if (MeshComp)
+            {
+                GatherMeshCollisionVertexes(MeshComp, MeshCollisionVertexes);
+            }
+        }
+        bMeshCollisionVertexesCached = true;
+    }
+    return MeshCollisionVertexes;
+}
+
+const TArray<FNVSocketWorldData>& FNVActorWorldSnapshot::GetSockets() const
+{
+    if (!bSocketsCached)
+    {
+        Sockets.Reset();
+
+        const bool bNeedExportSockets = Tag && (Tag->bExportAllMeshSocketInfo || (Tag->SocketNameToExportList.Num() > 0));
+        if (bNeedExportSockets)
+        {
+            TArray<UMeshComponent*> MeshComponents;
+            Actor->GetComponents(MeshComponents);
+            for (UMeshComponent* CheckMeshComp : MeshComponents)
+            {
+                if (CheckMeshComp)
+                {
+                    const TArray<FName>& AllSocketNames = CheckMeshComp->GetAllSocketNames();
+                    for (const FName CheckSocketName : AllSocketNames)
+                    {
+                        bool bShouldExportSocket = Tag->bExportAllMeshSocketInfo || Tag->SocketNameToExportList.Contains(CheckSocketName);
+                        if (bShouldExportSocket)
+                        {
+                            FNVSocketWorldData NewSocketData;
+                            NewSocketData.SocketName = CheckSocketName.ToString();
+                            NewSocketData.WorldLocation = CheckMeshComp->GetSocketLocation(CheckSocketName);
+                            Sockets.Add(NewSocketData);
+                        }
+                    }
+                }
+            }
+        }
+        bSocketsCached = true;
+    }
+    return Sockets;
+}
+
+TSharedPtr<FJsonObject> FNVActorWorldSnapshot::GetCustomData() const
+{
+    if (!bCustomDataCached)
+    {
+        const ANVAnnotatedActor* AnnotatedActor = Cast<ANVAnnotatedActor>(Actor);
+        CustomData = AnnotatedActor ? AnnotatedActor->GetCustomAnnotatedData() : nullptr;
+        bCustomDataCached = true;
+    }
+    return CustomData;
+}
+
+void FNVActorWorldSnapshot::GatherMeshCollisionVertexes(const UMeshComponent* CheckMeshComp, TArray<FVector>& OutVertexes)
+{
+    const int32 StartVertexCount = OutVertexes.Num();
+
+    const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(CheckMeshComp);
+    if (StaticMeshComp)
+    {
+        const FTransform& MeshTransform = StaticMeshComp->GetComponentTransform();
+        const UStaticMesh* CheckMesh = StaticMeshComp->GetStaticMesh();
+        if (CheckMesh && CheckMesh->BodySetup)
+        {
+            const FKAggregateGeom& MeshGeom = CheckMesh->BodySetup->AggGeom;
+
+            for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
+            {
+                for (const FVector& CheckVertex : ConvexElem.VertexData)
+                {
+                    const FVector& VertexWorldLocation = MeshTransform.TransformPosition(CheckVertex);
+                    OutVertexes.Add(VertexWorldLocation);
+                }
+            }
+        }
+
+        bool bHaveBodyVertexData = (OutVertexes.Num() > StartVertexCount);
+        // Fallback to use the mesh's render data if it doesn't have a valid body setup
+        if (!bHaveBodyVertexData && CheckMesh && CheckMesh->RenderData)
+        {
+            const FPositionVertexBuffer& MeshVertexBuffer = CheckMesh->RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
+            const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
+            OutVertexes.Reserve(OutVertexes.Num() + VertexesCount);
+            for (uint32 i = 0; i < VertexesCount; i++)
+            {
+                const FVector& VertexPosition = MeshTransform.TransformPosition(MeshVertexBuffer.VertexPosition(i));
+                OutVertexes.Add(VertexPosition);
+            }
+        }
+    }
+    else
+    {
+        const USkeletalMeshComponent* SkeletalMeshComp = Cast<USkeletalMeshComponent>(CheckMeshComp);
+        const USkeletalMesh* SkeletalMesh = SkeletalMeshComp ? SkeletalMeshComp->SkeletalMesh : nullptr;
+        const UPhysicsAsset* MeshPhysicsAsset = SkeletalMesh ? SkeletalMesh->PhysicsAsset : nullptr;
+        if (MeshPhysicsAsset)
+        {
+            const FTransform& MeshTransform = SkeletalMeshComp->GetComponentTransform();
+            for (const USkeletalBodySetup* CheckSkeletalBodySetup : MeshPhysicsAsset->SkeletalBodySetups)
+            {
+                if (CheckSkeletalBodySetup)
+                {
+                    const FKAggregateGeom& MeshGeom = CheckSkeletalBodySetup->AggGeom;
+                    for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
+                    {
+                        for (const FVector& CheckVertex : ConvexElem.VertexData)
+                        {
+                            const FVector& VertexWorldLocation = MeshTransform.TransformPosition(CheckVertex);
+                            OutVertexes.Add(VertexWorldLocation);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+//================================== FNVSceneWorldSnapshot ==================================
+FNVSceneWorldSnapshot::FNVSceneWorldSnapshot()
+{
+    ActorSnapshots.Reset();
+}
+
+void FNVSceneWorldSnapshot::Invalidate()
+{
+    // NOTE: Keep the map's memory since the same actors are captured again in the next frame
+    ActorSnapshots.Reset();
+}
+
+const FNVActorWorldSnapshot* FNVSceneWorldSnapshot::GetActorSnapshot(const AActor* CheckActor)
+{
+    if (!CheckActor)
+    {
+        return nullptr;
+    }
+
+    TUniquePtr<FNVActorWorldSnapshot>& ActorSnapshot = ActorSnapshots.FindOrAdd(CheckActor);
+    if (!ActorSnapshot.IsValid())
+    {
+        ActorSnapshot = MakeUnique<FNVActorWorldSnapshot>(CheckActor);
+    }
+    return ActorSnapshot.Get();
+}
@@ -0,0 +1,330 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVTarShardWriter.h"
+#include "NVSceneCapturerUtils.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+    // The tar archive is made of 512 bytes blocks
+    const int64 TarBlockSize = 512;
+    const uint8 TarZeroBlock[TarBlockSize] = { 0 };
+
+    // Write a number as a NUL terminated octal string filling the whole field
+    void WriteTarOctalField(uint8* FieldPtr, int32 FieldSize, uint64 Value)
+    {
+        FieldPtr[FieldSize - 1] = 0;
+        for (int32 i = FieldSize - 2; i >= 0; i--)
+        {
+            FieldPtr[i] = '0' + (Value & 7);
+            Value >>= 3;
+        }
+    }
+
+    void WriteTarStringField(uint8* FieldPtr, int32 FieldSize, const char* Value)
+    {
+        const int32 ValueLength = FMath::Min<int32>(FCStringAnsi::Strlen(Value), FieldSize);
+        FMemory::Memcpy(FieldPtr, Value, ValueLength);
+    }
+}
+
+//================================== FNVShardWriterSettings ==================================
+FNVShardWriterSettings::FNVShardWriterSettings()
+{
+    ShardFileNamePrefix = TEXT("shard");
+    MaxShardSizeMB = 1024;
+    MaxFramesPerShard = 1000;
+    MaxDeferredSizeMB = 512;
+    bWriteFileTimestamps = false;
+}
+
+//================================== FNVTarShardWriter ==================================
+FNVTarShardWriter::FNVTarShardWriter(const FString& InOutputDirectoryPath, const FNVShardWriterSettings& InSettings, FNVIsFramePendingCallback InIsFramePending /*= nullptr*/)
+    : OutputDirectoryPath(InOutputDirectoryPath), Settings(InSettings), IsFramePending(InIsFramePending)
+{
+    bIsClosed = false;
+    ShardFileHandle = nullptr;
+    ShardCount = 0;
+    ShardByteSize = 0;
+    DeferredByteSize = 0;
+}
+
+FNVTarShardWriter::~FNVTarShardWriter()
+{
+    Close();
+}
+
+bool FNVTarShardWriter::AddEntry(const FString& EntryName, int32 FrameIndex, const TArray<uint8>& Data)
+{
+    return AddEntry(EntryName, FrameIndex, Data.GetData(), Data.Num());
+}
+
+bool FNVTarShardWriter::AddEntry(const FString& EntryName, int32 FrameIndex, const uint8* Data, int64 DataSize)
+{
+    ensure(Data || (DataSize == 0));
+    if (EntryName.IsEmpty() || (!Data && (DataSize != 0)) || (DataSize < 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return false;
+    }
+
+    FScopeLock WriterScopeLock(&WriterLock);
+    if (bIsClosed)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't add '%s', the shard writer is already closed."), *EntryName);
+        return false;
+    }
+
+    // Only roll over to a new shard at frame boundaries so all the files of a frame end up in the same shard
+    // NOTE: The files are added in the order the workers finish them, a late file of a frame already in the shard must still find it opened
+    if (ShardFileHandle && !ShardFrameIndexes.Contains(FrameIndex) && ((DeferredEntries.Num() > 0) || IsCurrentShardFull()))
+    {
+        const int64 MaxDeferredByteSize = (int64)FMath::Max(Settings.MaxDeferredSizeMB, 0) * 1024 * 1024;
+        const bool bTooMuchDeferred = (MaxDeferredByteSize > 0) && (DeferredByteSize + DataSize > MaxDeferredByteSize);
+        if (!CanRollOverShard())
+        {
+            if (!bTooMuchDeferred)
+            {
+                FNVDeferredEntry& NewDeferredEntry = DeferredEntries[DeferredEntries.AddDefaulted()];
+                NewDeferredEntry.EntryName = EntryName;
+                NewDeferredEntry.FrameIndex = FrameIndex;
+                NewDeferredEntry.Data.Append(Data, (int32)DataSize);
+                DeferredByteSize += DataSize;
+                if (DeferredSizeChanged)
+                {
+                    DeferredSizeChanged(DataSize);
+                }
+                return true;
+            }
+
+            // Don't keep the files of every new frame in memory while a frame is stalled, its late files will go to the next shard
+            UE_LOG(LogNVSceneCapturer, Warning, TEXT("Shard '%s' rolled over with pending frames, %lld bytes of files were waiting for it."),
+                *ShardIndexData.shard_name, DeferredByteSize);
+        }
+
+        if (!RollOverShard())
+        {
+            return false;
+        }
+    }
+
+    if (!ShardFileHandle && !OpenNextShard())
+    {
+        return false;
+    }
+
+    return WriteEntry(EntryName, FrameIndex, Data, DataSize);
+}
+
+bool FNVTarShardWriter::IsCurrentShardFull() const
+{
+    // NOTE: WriterLock must be locked by the caller
+    const int64 MaxShardByteSize = (int64)FMath::Max(Settings.MaxShardSizeMB, 0) * 1024 * 1024;
+    const bool bShardIsFull = (MaxShardByteSize > 0) && (ShardByteSize >= MaxShardByteSize);
+    const bool bShardHasAllFrames = (Settings.MaxFramesPerShard > 0) && (ShardFrameIndexes.Num() >= Settings.MaxFramesPerShard);
+    return bShardIsFull || bShardHasAllFrames;
+}
+
+bool FNVTarShardWriter::CanRollOverShard() const
+{
+    // NOTE: WriterLock must be locked by the caller
+    if (IsFramePending)
+    {
+        for (const int32 ShardFrameIndex : ShardFrameIndexes)
+        {
+            if (IsFramePending(ShardFrameIndex))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool FNVTarShardWriter::RollOverShard()
+{
+    // NOTE: WriterLock must be locked by the caller
+    CloseCurrentShard();
+    if (!OpenNextShard())
+    {
+        ResetDeferredEntries();
+        return false;
+    }
+
+    bool bResult = true;
+    for (const FNVDeferredEntry& DeferredEntry : DeferredEntries)
+    {
+        bResult &= WriteEntry(DeferredEntry.EntryName, DeferredEntry.FrameIndex, DeferredEntry.Data.GetData(), DeferredEntry.Data.Num());
+    }
+    ResetDeferredEntries();
+    return bResult;
+}
+
+void FNVTarShardWriter::ResetDeferredEntries()
+{
+    // NOTE: WriterLock must be locked by the caller
+    DeferredEntries.Reset();
+    if (DeferredSizeChanged && (DeferredByteSize != 0))
+    {
+        DeferredSizeChanged(-DeferredByteSize);
+    }
+    DeferredByteSize = 0;
+}
+
+bool FNVTarShardWriter::WriteEntry(const FString& EntryName, int32 FrameIndex, const uint8* Data, int64 DataSize)
+{
+    // NOTE: WriterLock must be locked by the caller and the shard must be opened
+    if (!WriteEntryHeader(EntryName, DataSize))
+    {
+        return false;
+    }
+
+    const int64 DataOffset = ShardByteSize;
+    const int64 PaddingSize = Align(DataSize, TarBlockSize) - DataSize;
+    if (((DataSize > 0) && !ShardFileHandle->Write(Data, DataSize))
+        || ((PaddingSize > 0) && !ShardFileHandle->Write(TarZeroBlock, PaddingSize)))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't write '%s' to the shard '%s'."), *EntryName, *ShardIndexData.shard_name);
+        return false;
+    }
+    ShardByteSize += DataSize + PaddingSize;
+
+    FNVTarShardIndexEntry NewIndexEntry;
+    NewIndexEntry.name = EntryName;
+    NewIndexEntry.frame_index = FrameIndex;
+    NewIndexEntry.offset = DataOffset;
+    NewIndexEntry.size = DataSize;
+    ShardIndexData.entries.Add(NewIndexEntry);
+    ShardFrameIndexes.Add(FrameIndex);
+
+    return true;
+}
+
+bool FNVTarShardWriter::WriteEntryHeader(const FString& EntryName, int64 DataSize)
+{
+    // NOTE: Only the ustar name field is used, the exported file names are short so we don't need the prefix field or the GNU long name extension
+    FTCHARToUTF8 EntryNameUTF8(*EntryName);
+    static const int32 MaxEntryNameLength = 100;
+    // The size field only have 11 octal digits
+    static const int64 MaxEntryDataSize = 077777777777ll;
+    if ((EntryNameUTF8.Length() > MaxEntryNameLength) || (DataSize > MaxEntryDataSize))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't add '%s' to the shard, its name or size is too big for the tar format."), *EntryName);
+        return false;
+    }
+
+    uint8 Header[TarBlockSize];
+    FMemory::Memzero(Header, sizeof(Header));
+    FMemory::Memcpy(Header, EntryNameUTF8.Get(), EntryNameUTF8.Length());
+    WriteTarStringField(Header + 100, 8, "0000644");
+    WriteTarStringField(Header + 108, 8, "0000000");
+    WriteTarStringField(Header + 116, 8, "0000000");
+    WriteTarOctalField(Header + 124, 12, DataSize);
+    const int64 ModificationTime = Settings.bWriteFileTimestamps ? FMath::Max<int64>(FDateTime::UtcNow().ToUnixTimestamp(), 0) : 0;
+    WriteTarOctalField(Header + 136, 12, ModificationTime);
+    // Regular file
+    Header[156] = '0';
+    WriteTarStringField(Header + 257, 6, "ustar");
+    WriteTarStringField(Header + 263, 2, "00");
+
+    // The checksum is calculated with the checksum field filled with spaces
+    FMemory::Memset(Header + 148, ' ', 8);
+    uint32 Checksum = 0;
+    for (int32 i = 0; i < TarBlockSize; i++)
+    {
+        Checksum += Header[i];
+    }
+    WriteTarOctalField(Header + 148, 7, Checksum);
+
+    if (!ShardFileHandle->Write(Header, TarBlockSize))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't write '%s' to the shard '%s'."), *EntryName, *ShardIndexData.shard_name);
+        return false;
+    }
+    ShardByteSize += TarBlockSize;
+    return true;
+}
+
+bool FNVTarShardWriter::OpenNextShard()
+{
+    // NOTE: WriterLock must be locked by the caller
+    ShardIndexData = FNVTarShardIndexData();
+    ShardIndexData.shard_name = FString::Printf(TEXT("%s_%06d.tar"), *Settings.ShardFileNamePrefix, ShardCount);
+    ShardByteSize = 0;
+    ShardFrameIndexes.Reset();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*OutputDirectoryPath);
+    const FString ShardFilePath = FPaths::Combine(OutputDirectoryPath, ShardIndexData.shard_name);
+    ShardFileHandle = PlatformFile.OpenWrite(*ShardFilePath);
+    if (!ShardFileHandle)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *ShardFilePath);
+        return false;
+    }
+
+    ShardCount++;
+    return true;
+}
+
+void FNVTarShardWriter::CloseCurrentShard()
+{
+    // NOTE: WriterLock must be locked by the caller
+    if (!ShardFileHandle)
+    {
+        return;
+    }
+
+    // The end of the archive is marked by 2 empty blocks
+    ShardFileHandle->Write(TarZeroBlock, TarBlockSize);
+    ShardFileHandle->Write(TarZeroBlock, TarBlockSize);
+    delete ShardFileHandle;
+    ShardFileHandle = nullptr;
+
+    ShardIndexData.frame_count = ShardFrameIndexes.Num();
+    ShardIndexData.byte_size = ShardByteSize + 2 * TarBlockSize;
+
+    const FString IndexFileName = FPaths::GetBaseFilename(ShardIndexData.shard_name) + TEXT(".index.json");
+    TSharedPtr<FJsonObject> IndexJsonObj = NVSceneCapturerUtils::UStructToJsonObject(ShardIndexData);
+    if (IndexJsonObj.IsValid())
+    {
+        NVSceneCapturerUtils::SaveJsonObjectToFile(IndexJsonObj, FPaths::Combine(OutputDirectoryPath, IndexFileName));
+    }
+}
+
+void FNVTarShardWriter::Close()
+{
+    FScopeLock WriterScopeLock(&WriterLock);
+    // All the files were added, the deferred frames are complete
+    if (DeferredEntries.Num() > 0)
+    {
+        RollOverShard();
+    }
+    CloseCurrentShard();
+    bIsClosed = true;
+}
+
+int32 FNVTarShardWriter::GetShardCount() const
+{
+    FScopeLock WriterScopeLock(&WriterLock);
+    return ShardCount;
+}
+
+void FNVTarShardWriter::SetDeferredSizeChangedCallback(FNVDeferredSizeChangedCallback InDeferredSizeChanged)
+{
+    FScopeLock WriterScopeLock(&WriterLock);
+    DeferredSizeChanged = InDeferredSizeChanged;
+}
+
+int64 FNVTarShardWriter::GetDeferredByteSize() const
+{
+    FScopeLock WriterScopeLock(&WriterLock);
+    return DeferredByteSize;
+}
@@ -0,0 +1,519 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVTextureReadbackRing.h"
+#include "NVSceneCapturerUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/PlatformProcess.h"
+
+namespace
+{
+    // Stats of all the rings together
+    FCriticalSection GlobalStatsLock;
+    FNVTextureReadbackRingStats GlobalStats;
+    FThreadSafeCounter GlobalPendingReadbackCounter;
+    FThreadSafeCounter GlobalMappedReadbackCounter;
+
+    FAutoConsoleCommand TestTextureReadbackRingCommand(
+        TEXT("NV.TestTextureReadbackRing"),
+        TEXT("Check the ordering and retirement of the texture readback ring with fake staging textures"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FNVTextureReadbackRing::RunSelfTest();
+        }));
+}
+
+//================================== FNVTextureReadbackRingStats ==================================
+FNVTextureReadbackRingStats::FNVTextureReadbackRingStats()
+{
+    RingDepth = 0;
+    PendingReadbackCount = 0;
+    MappedReadbackCount = 0;
+    IssuedReadbackCount = 0;
+    CompletedReadbackCount = 0;
+    FlushedReadbackCount = 0;
+    StagingTextureAllocationCount = 0;
+    TotalMapWaitTime = 0.0;
+    MaxMapWaitTime = 0.0;
+    TotalReleaseWaitTime = 0.0;
+}
+
+//================================== FNVMappedReadback ==================================
+FNVMappedReadback::FNVMappedReadback(uint8* InPixelData, EPixelFormat InPixelFormat, const FIntPoint& InMappedSize)
+{
+    PixelData = InPixelData;
+    PixelFormat = InPixelFormat;
+    MappedSize = InMappedSize;
+    // NOTE: Manual reset so the event stay triggered once the readback is released
+    ReleasedEvent = FPlatformProcess::GetSynchEventFromPool(true);
+}
+
+FNVMappedReadback::~FNVMappedReadback()
+{
+    FPlatformProcess::ReturnSynchEventToPool(ReleasedEvent);
+    ReleasedEvent = nullptr;
+}
+
+void FNVMappedReadback::Release()
+{
+    ReleasedCounter.Set(1);
+    ReleasedEvent->Trigger();
+}
+
+void FNVMappedReadback::WaitUntilReleased()
+{
+    ReleasedEvent->Wait();
+}
+
+bool FNVMappedReadback::IsReleased() const
+{
+    return (ReleasedCounter.GetValue() != 0);
+}
+
+//================================== FNVTextureReadbackRing ==================================
+FNVTextureReadbackRing::FNVTextureReadbackRing(const TSharedRef<INVTextureReadbackStaging, ESPMode::ThreadSafe>& InStaging, int32 InRingDepth)
+    : Staging(InStaging)
+{
+    RingDepth = FMath::Max(InRingDepth, 1);
+    Slots.SetNum(RingDepth);
+    for (FNVReadbackSlot& CheckSlot : Slots)
+    {
+        CheckSlot.TextureSize = FIntPoint::ZeroValue;
+        CheckSlot.PixelFormat = PF_Unknown;
+        CheckSlot.bAllocated = false;
+        CheckSlot.bPending = false;
+        CheckSlot.FrameNumber = 0;
+    }
+    NextSlotIndex = 0;
+    OldestSlotIndex = 0;
+    Stats.RingDepth = RingDepth;
+
+    FScopeLock GlobalStatsScopeLock(&GlobalStatsLock);
+    GlobalStats.RingDepth = FMath::Max(GlobalStats.RingDepth, RingDepth);
+}
+
+FNVTextureReadbackRing::~FNVTextureReadbackRing()
+{
+    // NOTE: The ring may be destroyed on any thread so we can't map the pending readbacks here, they must be retired before
+    const int32 DroppedReadbackCount = PendingReadbackCounter.GetValue();
+    if (DroppedReadbackCount > 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Warning, TEXT("Texture readback ring destroyed with %d pending readbacks, their pixels are dropped."), DroppedReadbackCount);
+        GlobalPendingReadbackCounter.Subtract(DroppedReadbackCount);
+    }
+    const int32 MappedReadbackCount = MappedReadbackCounter.GetValue();
+    if (MappedReadbackCount > 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Warning, TEXT("Texture readback ring destroyed with %d mapped readbacks."), MappedReadbackCount);
+        GlobalMappedReadbackCounter.Subtract(MappedReadbackCount);
+    }
+
+    for (int32 i = 0; i < Slots.Num(); i++)
+    {
+        if (Slots[i].bAllocated)
+        {
+            Staging->ReleaseStagingTexture(i);
+        }
+    }
+}
+
+void FNVTextureReadbackRing::IssueReadback(const FIntPoint& TextureSize, EPixelFormat PixelFormat, uint64 FrameNumber,
+                                           TFunctionRef<void(int32)> CopyToStaging, OnReadbackCompletedCallback Callback)
+{
+    // The pixels are only read during the callback so the readback can be released right after it
+    IssueMappedReadback(TextureSize, PixelFormat, FrameNumber, CopyToStaging,
+        [Callback](const FNVMappedReadbackRef& MappedReadback)
+    {
+        if (Callback)
+        {
+            Callback(MappedReadback->GetPixelData(), MappedReadback->GetPixelFormat(), MappedReadback->GetMappedSize());
+        }
+        MappedReadback->Release();
+    });
+}
+
+void FNVTextureReadbackRing::IssueMappedReadback(const FIntPoint& TextureSize, EPixelFormat PixelFormat, uint64 FrameNumber,
+                                                 TFunctionRef<void(int32)> CopyToStaging, OnReadbackMappedCallback Callback)
+{
+    UnmapReleasedReadbacks();
+
+    // The ring is never full here since the oldest readback is retired as soon as all the slots are used
+    FNVReadbackSlot& NewSlot = Slots[NextSlotIndex];
+    check(!NewSlot.bPending);
+    // The pixels of the previous readback in this slot may still be read by another thread
+    if (NewSlot.MappedReadback.IsValid())
+    {
+        WaitForMappedReadback(NextSlotIndex);
+    }
+
+    // Only recreate the staging texture if the size or format changed
+    if (!NewSlot.bAllocated || (NewSlot.TextureSize != TextureSize) || (NewSlot.PixelFormat != PixelFormat))
+    {
+        Staging->AllocateStagingTexture(NextSlotIndex, TextureSize, PixelFormat);
+        NewSlot.TextureSize = TextureSize;
+        NewSlot.PixelFormat = PixelFormat;
+        NewSlot.bAllocated = true;
+
+        FScopeLock StatsScopeLock(&StatsLock);
+        Stats.StagingTextureAllocationCount++;
+        FScopeLock GlobalStatsScopeLock(&GlobalStatsLock);
+        GlobalStats.StagingTextureAllocationCount++;
+    }
+
+    CopyToStaging(NextSlotIndex);
+
+    NewSlot.bPending = true;
+    NewSlot.FrameNumber = FrameNumber;
+    NewSlot.Callback = MoveTemp(Callback);
+    NextSlotIndex = (NextSlotIndex + 1) % RingDepth;
+    PendingReadbackCounter.Increment();
+    GlobalPendingReadbackCounter.Increment();
+    {
+        FScopeLock StatsScopeLock(&StatsLock);
+        Stats.IssuedReadbackCount++;
+        FScopeLock GlobalStatsScopeLock(&GlobalStatsLock);
+        GlobalStats.IssuedReadbackCount++;
+    }
+
+    // The oldest readback is ready to be mapped once RingDepth - 1 other readbacks were issued after it
+    while (PendingReadbackCounter.GetValue() >= RingDepth)
+    {
+        RetireOldestReadback(false);
+    }
+}
+
+void FNVTextureReadbackRing::RetireStaleReadbacks(uint64 CurrentFrameNumber)
+{
+    UnmapReleasedReadbacks();
+
+    while (PendingReadbackCounter.GetValue() > 0)
+    {
+        const FNVReadbackSlot& OldestSlot = Slots[OldestSlotIndex];
+        if (OldestSlot.FrameNumber + (RingDepth - 1) > CurrentFrameNumber)
+        {
+            break;
+        }
+        RetireOldestReadback(false);
+    }
+}
+
+void FNVTextureReadbackRing::RetireAllReadbacks()
+{
+    while (PendingReadbackCounter.GetValue() > 0)
+    {
+        RetireOldestReadback(true);
+    }
+
+    for (int32 i = 0; i < Slots.Num(); i++)
+    {
+        if (Slots[i].MappedReadback.IsValid())
+        {
+            WaitForMappedReadback(i);
+        }
+    }
+}
+
+void FNVTextureReadbackRing::UnmapReleasedReadbacks()
+{
+    if (MappedReadbackCounter.GetValue() > 0)
+    {
+        for (int32 i = 0; i < Slots.Num(); i++)
+        {
+            const FNVReadbackSlot& CheckSlot = Slots[i];
+            if (CheckSlot.MappedReadback.IsValid() && CheckSlot.MappedReadback->IsReleased())
+            {
+                UnmapSlot(i);
+            }
+        }
+    }
+}
+
+void FNVTextureReadbackRing::WaitForMappedReadback(int32 SlotIndex)
+{
+    FNVReadbackSlot& WaitSlot = Slots[SlotIndex];
+    check(WaitSlot.MappedReadback.IsValid());
+
+    if (!WaitSlot.MappedReadback->IsReleased())
+    {
+        const double WaitStartTime = FPlatformTime::Seconds();
+        WaitSlot.MappedReadback->WaitUntilReleased();
+        const double ReleaseWaitTime = FPlatformTime::Seconds() - WaitStartTime;
+
+        FScopeLock StatsScopeLock(&StatsLock);
+        Stats.TotalReleaseWaitTime += ReleaseWaitTime;
+        FScopeLock GlobalStatsScopeLock(&GlobalStatsLock);
+        GlobalStats.TotalReleaseWaitTime += ReleaseWaitTime;
+    }
+
+    UnmapSlot(SlotIndex);
+}
+
+void FNVTextureReadbackRing::UnmapSlot(int32 SlotIndex)
+{
+    Staging->UnmapStagingTexture(SlotIndex);
+    Slots[SlotIndex].MappedReadback.Reset();
+    MappedReadbackCounter.Decrement();
+    GlobalMappedReadbackCounter.Decrement();
+}
+
+void FNVTextureReadbackRing::RetireOldestReadback(bool bFlushed)
+{
+    FNVReadbackSlot& OldestSlot = Slots[OldestSlotIndex];
+    check(OldestSlot.bPending);
+
+    const double MapStartTime = FPlatformTime::Seconds();
+    FIntPoint MappedSize = FIntPoint::ZeroValue;
+    void* MappedData = Staging->MapStagingTexture(OldestSlotIndex, MappedSize);
+    const double MapWaitTime = FPlatformTime::Seconds() - MapStartTime;
+
+    const int32 MappedSlotIndex = OldestSlotIndex;
+    OnReadbackMappedCallback Callback = MoveTemp(OldestSlot.Callback);
+    OldestSlot.bPending = false;
+    OldestSlot.Callback = nullptr;
+    OldestSlot.MappedReadback = MakeShared<FNVMappedReadback, ESPMode::ThreadSafe>((uint8*)MappedData, OldestSlot.PixelFormat, MappedSize);
+    OldestSlotIndex = (OldestSlotIndex + 1) % RingDepth;
+    MappedReadbackCounter.Increment();
+    GlobalMappedReadbackCounter.Increment();
+    PendingReadbackCounter.Decrement();
+    GlobalPendingReadbackCounter.Decrement();
+
+    const FNVMappedReadbackRef MappedReadback = OldestSlot.MappedReadback.ToSharedRef();
+    if (MappedData && Callback)
+    {
+        Callback(MappedReadback);
+    }
+    else
+    {
+        MappedReadback->Release();
+    }
+
+    // Don't keep the staging texture mapped if the callback already finished with it
+    if (MappedReadback->IsReleased())
+    {
+        UnmapSlot(MappedSlotIndex);
+    }
+
+    FScopeLock StatsScopeLock(&StatsLock);
+    Stats.CompletedReadbackCount++;
+    Stats.FlushedReadbackCount += bFlushed ? 1 : 0;
+    Stats.TotalMapWaitTime += MapWaitTime;
+    Stats.MaxMapWaitTime = FMath::Max(Stats.MaxMapWaitTime, MapWaitTime);
+
+    FScopeLock GlobalStatsScopeLock(&GlobalStatsLock);
+    GlobalStats.CompletedReadbackCount++;
+    GlobalStats.FlushedReadbackCount += bFlushed ? 1 : 0;
+    GlobalStats.TotalMapWaitTime += MapWaitTime;
+    GlobalStats.MaxMapWaitTime = FMath::Max(GlobalStats.MaxMapWaitTime, MapWaitTime);
+}
+
+FNVTextureReadbackRingStats FNVTextureReadbackRing::GetStats() const
+{
+    FScopeLock StatsScopeLock(&StatsLock);
+    FNVTextureReadbackRingStats CurrentStats = Stats;
+    CurrentStats.PendingReadbackCount = PendingReadbackCounter.GetValue();
+    CurrentStats.MappedReadbackCount = MappedReadbackCounter.GetValue();
+    return CurrentStats;
+}
+
+FNVTextureReadbackRingStats FNVTextureReadbackRing::GetGlobalStats()
+{
+    FScopeLock GlobalStatsScopeLock(&GlobalStatsLock);
+    FNVTextureReadbackRingStats CurrentStats = GlobalStats;
+    CurrentStats.PendingReadbackCount = GlobalPendingReadbackCounter.GetValue();
+    CurrentStats.MappedReadbackCount = GlobalMappedReadbackCounter.GetValue();
+    return CurrentStats;
+}
+
+int32 FNVTextureReadbackRing::GetTotalPendingReadbackCount()
+{
+    return GlobalPendingReadbackCounter.GetValue() + GlobalMappedReadbackCounter.GetValue();
+}
+
+//================================== Self test ==================================
+namespace
+{
+    // Staging textures kept in memory, the copy write the frame number to the texture so the test can check which frame is read back
+    class FNVFakeTextureReadbackStaging : public INVTextureReadbackStaging
+    {
+    public:
+        FNVFakeTextureReadbackStaging(int32 SlotCount)
+        {
+            SlotTextures.SetNum(SlotCount);
+            SlotSizes.SetNum(SlotCount);
+            bMapWhileMapped = false;
+            bUnmapWhileUnmapped = false;
+        }
+
+        virtual void AllocateStagingTexture(int32 SlotIndex, const FIntPoint& TextureSize, EPixelFormat PixelFormat) override
+        {
+            SlotSizes[SlotIndex] = TextureSize;
+            SlotTextures[SlotIndex].SetNumZeroed(FMath::Max(TextureSize.X * TextureSize.Y, 1) * sizeof(uint64));
+        }
+        virtual void ReleaseStagingTexture(int32 SlotIndex) override
+        {
+            SlotTextures[SlotIndex].Empty();
+        }
+        virtual void* MapStagingTexture(int32 SlotIndex, FIntPoint& OutMappedSize) override
+        {
+            bMapWhileMapped |= MappedSlots.Contains(SlotIndex);
+            MappedSlots.Add(SlotIndex);
+            OutMappedSize = SlotSizes[SlotIndex];
+            return SlotTextures[SlotIndex].GetData();
+        }
+        virtual void UnmapStagingTexture(int32 SlotIndex) override
+        {
+            bUnmapWhileUnmapped |= (MappedSlots.Remove(SlotIndex) == 0);
+        }
+
+        void WriteFrame(int32 SlotIndex, uint64 FrameNumber)
+        {
+            FMemory::Memcpy(SlotTextures[SlotIndex].GetData(), &FrameNumber, sizeof(FrameNumber));
+        }
+
+    public:
+        TArray<TArray<uint8>> SlotTextures;
+        TArray<FIntPoint> SlotSizes;
+        TSet<int32> MappedSlots;
+        bool bMapWhileMapped;
+        bool bUnmapWhileUnmapped;
+    };
+}
+
+bool FNVTextureReadbackRing::RunSelfTest()
+{
+    FNVSelfTestResult TestResult(TEXT("Texture readback ring"), LogNVSceneCapturer);
+
+    for (int32 TestRingDepth = 1; TestRingDepth <= 4; TestRingDepth++)
+    {
+        TSharedRef<FNVFakeTextureReadbackStaging, ESPMode::ThreadSafe> FakeStaging = MakeShareable(new FNVFakeTextureReadbackStaging(TestRingDepth));
+        TSharedPtr<FNVTextureReadbackRing> TestRing = MakeShareable(new FNVTextureReadbackRing(FakeStaging, TestRingDepth));
+
+        TArray<uint64> CompletedFrames;
+        const FIntPoint TestSize(4, 2);
+        static const int32 TestFrameCount = 10;
+        for (int32 FrameIndex = 0; FrameIndex < TestFrameCount; FrameIndex++)
+        {
+            // Change the size in the middle of the test to check the staging textures are recreated
+            const FIntPoint FrameSize = (FrameIndex < TestFrameCount / 2) ? TestSize : TestSize * 2;
+            TestRing->IssueReadback(FrameSize, PF_B8G8R8A8, FrameIndex,
+                [&FakeStaging, FrameIndex](int32 SlotIndex)
+                {
+                    FakeStaging->WriteFrame(SlotIndex, FrameIndex);
+                },
+                [&CompletedFrames](uint8* PixelData, EPixelFormat PixelFormat, FIntPoint PixelSize)
+                {
+                    uint64 ReadFrameNumber = 0;
+                    FMemory::Memcpy(&ReadFrameNumber, PixelData, sizeof(ReadFrameNumber));
+                    CompletedFrames.Add(ReadFrameNumber);
+                });
+
+            // Frame K must be completed right after frame K + RingDepth - 1 is issued and not before
+            const int32 ExpectedCompletedCount = FMath::Max(FrameIndex - TestRingDepth + 2, 0);
+            TestResult.Check(CompletedFrames.Num() == ExpectedCompletedCount, TEXT("readback retired at the wrong time"));
+            TestResult.Check(TestRing->GetPendingReadbackCount() == (FrameIndex + 1 - ExpectedCompletedCount), TEXT("wrong pending readback count"));
+        }
+
+        // Let the frames pass without issuing new readbacks, the pending ones must be retired once they are old enough
+        const uint64 LastFrameNumber = TestFrameCount - 1;
+        TestRing->RetireStaleReadbacks(LastFrameNumber);
+        TestResult.Check(TestRing->GetPendingReadbackCount() == FMath::Min(TestRingDepth - 1, TestFrameCount), TEXT("stale readbacks retired too early"));
+        TestRing->RetireStaleReadbacks(LastFrameNumber + TestRingDepth - 1);
+        TestResult.Check(TestRing->GetPendingReadbackCount() == 0, TEXT("stale readbacks not retired"));
+
+        TestResult.Check(CompletedFrames.Num() == TestFrameCount, TEXT("missing readbacks"));
+        for (int32 i = 0; i < CompletedFrames.Num(); i++)
+        {
+            TestResult.Check(CompletedFrames[i] == (uint64)i, TEXT("readbacks completed out of order"));
+        }
+        TestResult.Check(!FakeStaging->bMapWhileMapped, TEXT("staging texture mapped twice"));
+        TestResult.Check(!FakeStaging->bUnmapWhileUnmapped, TEXT("staging texture unmapped while not mapped"));
+        TestResult.Check(FakeStaging->MappedSlots.Num() == 0, TEXT("staging texture left mapped"));
+
+        const FNVTextureReadbackRingStats RingStats = TestRing->GetStats();
+        // The staging textures are created once for each size
+        const int32 ExpectedAllocationCount = FMath::Min(TestRingDepth, TestFrameCount / 2) * 2;
+        TestResult.Check(RingStats.StagingTextureAllocationCount == ExpectedAllocationCount, TEXT("wrong staging texture allocation count"));
+        TestResult.Check(RingStats.IssuedReadbackCount == TestFrameCount, TEXT("wrong issued readback count"));
+        TestResult.Check(RingStats.CompletedReadbackCount == TestFrameCount, TEXT("wrong completed readback count"));
+        TestResult.Check(RingStats.FlushedReadbackCount == 0, TEXT("wrong flushed readback count"));
+
+        // Flushing complete everything right away
+        CompletedFrames.Reset();
+        for (int32 FrameIndex = 0; FrameIndex < TestRingDepth; FrameIndex++)
+        {
+            TestRing->IssueReadback(TestSize, PF_B8G8R8A8, TestFrameCount + FrameIndex,
+                [&FakeStaging, FrameIndex](int32 SlotIndex)
+                {
+                    FakeStaging->WriteFrame(SlotIndex, FrameIndex);
+                },
+                [&CompletedFrames](uint8* PixelData, EPixelFormat PixelFormat, FIntPoint PixelSize)
+                {
+                    uint64 ReadFrameNumber = 0;
+                    FMemory::Memcpy(&ReadFrameNumber, PixelData, sizeof(ReadFrameNumber));
+                    CompletedFrames.Add(ReadFrameNumber);
+                });
+        }
+        TestRing->RetireAllReadbacks();
+        TestResult.Check((CompletedFrames.Num() == TestRingDepth) && (TestRing->GetPendingReadbackCount() == 0), TEXT("flush didn't complete all the readbacks"));
+        for (int32 i = 0; i < CompletedFrames.Num(); i++)
+        {
+            TestResult.Check(CompletedFrames[i] == (uint64)i, TEXT("flushed readbacks completed out of order"));
+        }
+
+        // A readback kept by its callback must stay mapped until it's released
+        TArray<FNVMappedReadbackRef> KeptReadbacks;
+        bool bKeepReadbacks = true;
+        int32 ReleasedReadbackCount = 0;
+        const uint64 KeptFrameNumber = TestFrameCount + TestRingDepth;
+        for (int32 FrameIndex = 0; FrameIndex < TestRingDepth; FrameIndex++)
+        {
+            TestRing->IssueMappedReadback(TestSize, PF_B8G8R8A8, KeptFrameNumber + FrameIndex,
+                [&FakeStaging, FrameIndex](int32 SlotIndex)
+                {
+                    FakeStaging->WriteFrame(SlotIndex, FrameIndex);
+                },
+                [&KeptReadbacks, &bKeepReadbacks, &ReleasedReadbackCount](const FNVMappedReadbackRef& MappedReadback)
+                {
+                    if (bKeepReadbacks)
+                    {
+                        KeptReadbacks.Add(MappedReadback);
+                    }
+                    else
+                    {
+                        MappedReadback->Release();
+                        ReleasedReadbackCount++;
+                    }
+                });
+        }
+        TestResult.Check(KeptReadbacks.Num() == 1, TEXT("kept readback not mapped"));
+        if (KeptReadbacks.Num() == 1)
+        {
+            uint64 ReadFrameNumber = INDEX_NONE;
+            FMemory::Memcpy(&ReadFrameNumber, KeptReadbacks[0]->GetPixelData(), sizeof(ReadFrameNumber));
+            TestResult.Check(ReadFrameNumber == 0, TEXT("kept readback has the wrong pixels"));
+        }
+        TestResult.Check(TestRing->GetMappedReadbackCount() == 1, TEXT("kept readback unmapped before it's released"));
+        TestRing->UnmapReleasedReadbacks();
+        TestResult.Check(TestRing->GetMappedReadbackCount() == 1, TEXT("kept readback unmapped before it's released"));
+        for (const FNVMappedReadbackRef& KeptReadback : KeptReadbacks)
+        {
+            KeptReadback->Release();
+        }
+        TestRing->UnmapReleasedReadbacks();
+        TestResult.Check(TestRing->GetMappedReadbackCount() == 0, TEXT("released readback not unmapped"));
+
+        // Release the rest of the readbacks as soon as they are mapped, the flush wait for them to be released
+        bKeepReadbacks = false;
+        TestRing->RetireAllReadbacks();
+        TestResult.Check(ReleasedReadbackCount == TestRingDepth - 1, TEXT("kept readbacks not flushed"));
+        TestResult.Check((TestRing->GetPendingReadbackCount() == 0) && (TestRing->GetMappedReadbackCount() == 0), TEXT("kept readbacks not unmapped"));
+        TestResult.Check(!FakeStaging->bMapWhileMapped && !FakeStaging->bUnmapWhileUnmapped && (FakeStaging->MappedSlots.Num() == 0), TEXT("kept readbacks mapped in the wrong order"));
+    }
+
+    return TestResult.Finish();
+}
@@ -7,6 +7,7 @@
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCapturerUtils.h"
 #include "NVTextureReader.h"
+#include "NVPixelBufferPool.h"
 #include "RHIStaticStates.h"
 #include "Shader.h"
 #include "GlobalShader.h"
@@ -17,18 +18,118 @@
 #include "RendererInterface.h"
 #include "StaticBoundShaderState.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "Async/TaskGraphInterfaces.h"
 
 DEFINE_LOG_CATEGORY(LogNVTextureReader);
 
+namespace
+{
+    /// Number of async readbacks enqueued on the game thread which are not issued on the rendering thread yet
+    FThreadSafeCounter QueuedReadbackCounter;
+    /// Number of mapped readbacks whose pixels are being copied out and passed to the callback on a worker thread
+    FThreadSafeCounter ProcessingReadbackCounter;
+
+    const int32 DefaultReadbackRingDepth = 3;
+}
+
+//======================= FNVRHITextureReadbackStaging =======================//
+/// The staging textures of a readback ring, created with the RHI
+/// NOTE: Only used on the rendering thread
+class FNVRHITextureReadbackStaging : public INVTextureReadbackStaging
+{
+public:
+    FTexture2DRHIRef& GetStagingTexture(int32 SlotIndex)
+    {
+        check(StagingTextures.IsValidIndex(SlotIndex));
+        return StagingTextures[SlotIndex];
+    }
+
+    virtual void AllocateStagingTexture(int32 SlotIndex, const FIntPoint& TextureSize, EPixelFormat PixelFormat) override
+    {
+        check(IsInRenderingThread());
+        if (SlotIndex >= StagingTextures.Num())
+        {
+            StagingTextures.SetNum(SlotIndex + 1);
+        }
+
+        FRHIResourceCreateInfo CreateInfo(FClearValueBinding::None);
+        StagingTextures[SlotIndex] = RHICreateTexture2D(
+                                         TextureSize.X,
+                                         TextureSize.Y,
+                                         PixelFormat,
+                                         1,
+                                         1,
+                                         TexCreate_CPUReadback,
+                                         CreateInfo
+                                     );
+    }
+
+    virtual void ReleaseStagingTexture(int32 SlotIndex) override
+    {
+        if (StagingTextures.IsValidIndex(SlotIndex))
+        {
+            StagingTextures[SlotIndex].SafeRelease();
+        }
+    }
+
+    virtual void* MapStagingTexture(int32 SlotIndex, FIntPoint& OutMappedSize) override
+    {
+        check(IsInRenderingThread());
+        void* PixelDataBuffer = nullptr;
+        OutMappedSize = FIntPoint::ZeroValue;
+        FTexture2DRHIRef& StagingTexture = GetStagingTexture(SlotIndex);
+        if (StagingTexture)
+        {
+            FRHICommandListExecutor::GetImmediateCommandList().MapStagingSurface(StagingTexture, PixelDataBuffer, OutMappedSize.X, OutMappedSize.Y);
+        }
+        return PixelDataBuffer;
+    }
+
+    virtual void UnmapStagingTexture(int32 SlotIndex) override
+    {
+        check(IsInRenderingThread());
+        FTexture2DRHIRef& StagingTexture = GetStagingTexture(SlotIndex);
+        if (StagingTexture)
+        {
+            FRHICommandListExecutor::GetImmediateCommandList().UnmapStagingSurface(StagingTexture);
+        }
+    }
+
+protected:
+    TArray<FTexture2DRHIRef> StagingTextures;
+};
+
+//======================= FNVPixelsTaskChain =======================//
+/// NOTE: Only used on the rendering thread
+struct FNVPixelsTaskChain
+{
+    FGraphEventRef LastTask;
+};
+
 //======================= FNVTextureReader =======================//
 FNVTextureReader::FNVTextureReader()
 {
     SourceTexture = nullptr;
+    ReadbackRingDepth = DefaultReadbackRingDepth;
 }
 
 FNVTextureReader::~FNVTextureReader()
 {
     SourceTexture = nullptr;
+
+    if (ReadbackRing.IsValid())
+    {
+        // NOTE: The pending readbacks are completed before the ring is released on the rendering thread
+        TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> OldReadbackRing = ReadbackRing;
+        ReadbackRing.Reset();
+        ReadbackStaging.Reset();
+        ENQUEUE_RENDER_COMMAND(ReleaseTextureReadbackRing)(
+            [OldReadbackRing](FRHICommandListImmediate& RHICmdList) mutable
+            {
+                OldReadbackRing->RetireAllReadbacks();
+                OldReadbackRing.Reset();
+            });
+    }
 }
 
 FNVTextureReader& FNVTextureReader::operator=(const FNVTextureReader& OtherReader)
@@ -37,10 +138,110 @@ FNVTextureReader& FNVTextureReader::operator=(const FNVTextureReader& OtherReade
     SourceRect = OtherReader.SourceRect;
     ReadbackPixelFormat = OtherReader.ReadbackPixelFormat;
     ReadbackSize = OtherReader.ReadbackSize;
+    // NOTE: The readback ring is not shared between readers, each of them create its own when it need it
+    SetReadbackRingDepth(OtherReader.ReadbackRingDepth);
 
     return (*this);
 }
 
+void FNVTextureReader::SetReadbackRingDepth(int32 NewRingDepth)
+{
+    NewRingDepth = FMath::Max(NewRingDepth, 1);
+    if (NewRingDepth != ReadbackRingDepth)
+    {
+        ReadbackRingDepth = NewRingDepth;
+
+        // The ring will be recreated with the new depth on the next readback
+        if (ReadbackRing.IsValid())
+        {
+            TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> OldReadbackRing = ReadbackRing;
+            ReadbackRing.Reset();
+            ReadbackStaging.Reset();
+            ENQUEUE_RENDER_COMMAND(FlushTextureReadbackRing)(
+                [OldReadbackRing](FRHICommandListImmediate& RHICmdList) mutable
+                {
+                    OldReadbackRing->RetireAllReadbacks();
+                    OldReadbackRing.Reset();
+                });
+        }
+    }
+}
+
+void FNVTextureReader::InitReadbackRing()
+{
+    if (!ReadbackRing.IsValid())
+    {
+        ReadbackStaging = MakeShared<FNVRHITextureReadbackStaging, ESPMode::ThreadSafe>();
+        ReadbackRing = MakeShared<FNVTextureReadbackRing, ESPMode::ThreadSafe>(ReadbackStaging.ToSharedRef(), ReadbackRingDepth);
+    }
+    if (!PixelsTaskChain.IsValid())
+    {
+        PixelsTaskChain = MakeShared<FNVPixelsTaskChain, ESPMode::ThreadSafe>();
+    }
+}
+
+void FNVTextureReader::UpdatePendingReadbacks()
+{
+    // NOTE: The released readbacks must be unmapped too
+    if (ReadbackRing.IsValid() && ((ReadbackRing->GetPendingReadbackCount() > 0) || (ReadbackRing->GetMappedReadbackCount() > 0)))
+    {
+        TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> CurrentReadbackRing = ReadbackRing;
+        ENQUEUE_RENDER_COMMAND(RetireStaleTextureReadbacks)(
+            [CurrentReadbackRing](FRHICommandListImmediate& RHICmdList)
+            {
+                CurrentReadbackRing->RetireStaleReadbacks(GFrameNumberRenderThread);
+            });
+    }
+}
+
+void FNVTextureReader::FlushPendingReadbacks()
+{
+    if (ReadbackRing.IsValid())
+    {
+        TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> CurrentReadbackRing = ReadbackRing;
+        ENQUEUE_RENDER_COMMAND(FlushTextureReadbacks)(
+            [CurrentReadbackRing](FRHICommandListImmediate& RHICmdList)
+            {
+                CurrentReadbackRing->RetireAllReadbacks();
+            });
+    }
+}
+
+void FNVTextureReader::WaitForPendingCallbacks()
+{
+    if (ReadbackRing.IsValid() && PixelsTaskChain.IsValid())
+    {
+        // Map all the readbacks in flight so the tasks of their callbacks are all dispatched
+        FlushPendingReadbacks();
+        FlushRenderingCommands();
+
+        // NOTE: The chain is only updated on the rendering thread which is done with our readbacks after the flush
+        // and each task wait for the previous one so the last task finish after all the others
+        const FGraphEventRef LastTask = PixelsTaskChain->LastTask;
+        if (LastTask.IsValid())
+        {
+            FTaskGraphInterface::Get().WaitUntilTaskCompletes(LastTask);
+        }
+    }
+}
+
+FNVTextureReadbackRingStats FNVTextureReader::GetReadbackStats() const
+{
+    if (ReadbackRing.IsValid())
+    {
+        return ReadbackRing->GetStats();
+    }
+
+    FNVTextureReadbackRingStats EmptyStats;
+    EmptyStats.RingDepth = ReadbackRingDepth;
+    return EmptyStats;
+}
+
+int32 FNVTextureReader::GetInFlightReadbackCount()
+{
+    return QueuedReadbackCounter.GetValue() + FNVTextureReadbackRing::GetTotalPendingReadbackCount() + ProcessingReadbackCounter.GetValue();
+}
+
 void FNVTextureReader::SetSourceTexture(FTexture2DRHIRef NewSourceTexture,
                                         const FIntRect& NewSourceRect /*= FIntRect()*/,
                                         EPixelFormat NewReadbackPixelFormat /*= EPixelFormat::PF_Unknown*/,
@@ -140,11 +341,31 @@ bool FNVTextureReader::ReadPixelsData(OnFinishedReadingPixelsDataCallback Callba
     {
         if (SourceTexture)
         {
-            bResult = ReadPixelsRaw(SourceTexture,
+            InitReadbackRing();
+            const FIntPoint TargetSize = ReadbackSize;
+            TSharedPtr<FNVPixelsTaskChain, ESPMode::ThreadSafe> TaskChain = PixelsTaskChain;
+            bResult = ReadPixelsRaw(ReadbackRing, ReadbackStaging, SourceTexture,
                 SourceRect, ReadbackPixelFormat, ReadbackSize, bIgnoreAlpha,
-                [=](uint8* PixelData, EPixelFormat PixelFormat, FIntPoint PixelSize)
+                [TaskChain, TargetSize, Callback](const FNVMappedReadbackRef& MappedReadback)
             {
-                Callback(BuildPixelData(PixelData, PixelFormat, PixelSize, ReadbackSize));
+                // NOTE: The rows of the mapped pixels are copied out on a worker thread so the rendering thread can keep submitting the next captures
+                ProcessingReadbackCounter.Increment();
+
+                FGraphEventArray Prerequisites;
+                if (TaskChain->LastTask.IsValid())
+                {
+                    Prerequisites.Add(TaskChain->LastTask);
+                }
+                TaskChain->LastTask = FFunctionGraphTask::CreateAndDispatchWhenReady(
+                    [MappedReadback, TargetSize, Callback]()
+                {
+                    FNVTexturePixelData PixelsData = BuildPixelData(MappedReadback->GetPixelData(), MappedReadback->GetPixelFormat(), MappedReadback->GetMappedSize(), TargetSize);
+                    // The pixels are copied, let the rendering thread unmap the staging texture
+                    MappedReadback->Release();
+
+                    Callback(PixelsData);
+                    ProcessingReadbackCounter.Decrement();
+                }, TStatId(), &Prerequisites, ENamedThreads::AnyBackgroundThreadNormalTask);
             });
         }
     }
@@ -163,17 +384,22 @@ bool FNVTextureReader::ReadPixelsData(OnFinishedReadingPixelsDataCallback Callba
     return ReadPixelsData(Callback, bIgnoreAlpha);
 }
 
-bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, const FIntRect& SourceRect,
-                                     EPixelFormat TargetPixelFormat, const FIntPoint& TargetSize, bool bIgnoreAlpha, OnFinishedReadingRawPixelsCallback Callback)
+bool FNVTextureReader::ReadPixelsRaw(const TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe>& ReadbackRing,
+                                     const TSharedPtr<FNVRHITextureReadbackStaging, ESPMode::ThreadSafe>& ReadbackStaging,
+                                     const FTexture2DRHIRef& NewSourceTexture, const FIntRect& SourceRect,
+                                     EPixelFormat TargetPixelFormat, const FIntPoint& TargetSize, bool bIgnoreAlpha, FNVTextureReadbackRing::OnReadbackMappedCallback Callback)
 {
     bool bResult = false;
 
     // Make sure the source render target and area settings are valid
+    ensure(ReadbackRing.IsValid() && ReadbackStaging.IsValid());
     ensure(NewSourceTexture);
     ensure(SourceRect.Area() != 0);
     ensure(TargetSize != FIntPoint::ZeroValue);
     ensure(Callback);
-    if (!NewSourceTexture
+    if (!ReadbackRing.IsValid()
+            || !ReadbackStaging.IsValid()
+            || !NewSourceTexture
             || (SourceRect.Area() == 0)
             || (TargetSize == FIntPoint::ZeroValue)
             || (!Callback))
@@ -187,41 +413,25 @@ bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, c
         IRendererModule* RendererModule = &FModuleManager::GetModuleChecked<IRendererModule>(RendererModuleName);
         check(RendererModule);
 
+        QueuedReadbackCounter.Increment();
+
         // NOTE: This approach almost identical to function FViewportSurfaceReader::ResolveRenderTarget in FrameGrabber.cpp
         // The main different is we reading the pixels back from a render target instead of a viewport
+        // and the staging texture is only mapped a few frames later, when the GPU already finished copying to it
         ENQUEUE_RENDER_COMMAND(ReadPixelsFromTexture)(
             [=](FRHICommandListImmediate& RHICmdList)
             {
-                FRHIResourceCreateInfo CreateInfo(FClearValueBinding::None);
-                // TODO: Can cache the ReadbackTexture and reuse it if the format and size doesn't change instead of creating it everytime we read like this
-                // Need to be careful with reusing the ReadbackTexture: need to make sure the texture is already finished reading
-                FTexture2DRHIRef ReadbackTexture = RHICreateTexture2D(
-                                                       TargetSize.X,
-                                                       TargetSize.Y,
-                                                       TargetPixelFormat,
-                                                       1,
-                                                       1,
-                                                       TexCreate_CPUReadback,
-                                                       CreateInfo
-                                                   );
-
-                bool bOverwriteAlpha = !bIgnoreAlpha;
-                // Copy the source texture to the readback texture so we can read it back later even after the source texture is modified
-                CopyTexture2d(RendererModule, RHICmdList, NewSourceTexture, SourceRect, ReadbackTexture, FIntRect(FIntPoint::ZeroValue, TargetSize), bOverwriteAlpha);
-
-                // Stage the texture to read back its pixels data
-                FIntPoint PixelSize = FIntPoint::ZeroValue;
-                void* PixelDataBuffer = nullptr;
-                RHICmdList.MapStagingSurface(ReadbackTexture, PixelDataBuffer, PixelSize.X, PixelSize.Y);
-
-                if (PixelDataBuffer)
+                const bool bOverwriteAlpha = !bIgnoreAlpha;
+                ReadbackRing->IssueMappedReadback(TargetSize, TargetPixelFormat, GFrameNumberRenderThread,
+                    [&](int32 SlotIndex)
                 {
-                    Callback((uint8*)PixelDataBuffer, TargetPixelFormat, PixelSize);
-                }
-
-                RHICmdList.UnmapStagingSurface(ReadbackTexture);
+                    // Copy the source texture to the staging texture so we can read it back later even after the source texture is modified
+                    FTexture2DRHIRef& StagingTexture = ReadbackStaging->GetStagingTexture(SlotIndex);
+                    CopyTexture2d(RendererModule, RHICmdList, NewSourceTexture, SourceRect, StagingTexture, FIntRect(FIntPoint::ZeroValue, TargetSize), bOverwriteAlpha);
+                },
+                    Callback);
 
-                ReadbackTexture.SafeRelease();
+                QueuedReadbackCounter.Decrement();
             });
         bResult = true;
     }
@@ -365,10 +575,15 @@ void FNVTextureReader::BuildPixelData(FNVTexturePixelData& OutPixelsData, uint8*
         // NOTE: We don't support pixel format that use less than 1 byte for now, e.g: grayscale 1, 2 or 4 bit
         const uint8 PixelByteSize = NVSceneCapturerUtils::GetPixelByteSize(PixelFormat);
         const uint32 PixelBufferSize = PixelByteSize * PixelCount;
-        OutPixelsData.PixelData.InsertUninitialized(0, PixelBufferSize);
+        // Reuse a buffer of the same format and size from the pool instead of allocating a new one every time
+        TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> NewPixelBuffer = FNVPixelBufferPool::Get().AcquireBuffer(PixelFormat, TargetSize, PixelBufferSize);
+        if (!NewPixelBuffer.IsValid())
+        {
+            return;
+        }
 
         uint8* SrcPixelBuffer = RawPixelsData;
-        uint8* Dest = &OutPixelsData.PixelData[0];
+        uint8* Dest = NewPixelBuffer->GetData();
         // NOTE: The 2d size of the read back pixel buffer (PixelSize) may be different than the target size that we want (ReadbackSize)
         // So we must make sure to only copy the minimum part of it
         const int32 MinWidth = FMath::Min(TargetSize.X, ImageSize.X);
@@ -383,6 +598,9 @@ void FNVTextureReader::BuildPixelData(FNVTexturePixelData& OutPixelsData, uint8*
             SrcPixelBuffer += SourceWidthByteSize;
             Dest += TargetWidthByteSize;
         }
+
+        // NOTE: This is the only copy of the pixels in the capturing pipeline, the buffer is shared from now on
+        OutPixelsData.SetPixelBuffer(NewPixelBuffer);
     }
 }
 
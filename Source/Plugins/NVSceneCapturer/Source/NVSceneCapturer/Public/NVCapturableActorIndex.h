@@ -0,0 +1,62 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UWorld;
+class UNVCapturableActorTag;
+
+/// An actor registered in the capturable actor index with the tag component which registered it
+struct NVSCENECAPTURER_API FNVCapturableActorEntry
+{
+public:
+    TWeakObjectPtr<AActor> Actor;
+    TWeakObjectPtr<UNVCapturableActorTag> Tag;
+};
+
+///
+/// Per world list of the actors which have a UNVCapturableActorTag component
+/// The tag components register themselves on BeginPlay and unregister on EndPlay so the exporters
+/// don't need to loop through all the actors in the world every frame to find the ones they care about
+/// NOTE: The list keep the registration order so the exported data is always in the same order
+///
+class NVSCENECAPTURER_API FNVCapturableActorIndex
+{
+public:
+    FNVCapturableActorIndex();
+
+    /// Get the index of a world, it's created the first time it's requested
+    /// NOTE: The new index is filled with the tagged actors already in the world so the actors which didn't begin play yet are not missed
+    static FNVCapturableActorIndex* Get(UWorld* World);
+    /// Get the index of a world only if it was already created
+    static FNVCapturableActorIndex* Find(const UWorld* World);
+
+    void RegisterTag(UNVCapturableActorTag* Tag);
+    void UnregisterTag(UNVCapturableActorTag* Tag);
+
+    /// All the registered actors, some of them may be invalid or have bIncludeMe turned off
+    const TArray<FNVCapturableActorEntry>& GetEntries() const
+    {
+        return Entries;
+    }
+
+    /// Get the valid registered actors whose tag have bIncludeMe turned on
+    void GetIncludedActors(TArray<AActor*>& OutActors) const;
+
+    int32 Num() const
+    {
+        return Entries.Num();
+    }
+
+protected:
+    int32 FindActorEntryIndex(const AActor* CheckActor) const;
+
+protected:
+    TArray<FNVCapturableActorEntry> Entries;
+};
@@ -0,0 +1,104 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+///
+/// Per world clock advancing by a fixed simulated step for each frame the capturer captured
+/// The randomization timers and the capturer use its frame counter instead of the world's time while it's running,
+/// so the captured simulation states don't depend on how fast the machine render and export the frames
+/// NOTE: The clock is only accessed on the game thread
+///
+class NVSCENECAPTURER_API FNVCaptureClock
+{
+public:
+    FNVCaptureClock();
+
+    /// Get the clock of a world, it's created the first time it's requested
+    static FNVCaptureClock* Get(UWorld* World);
+    /// Get the clock of a world only if it was already created
+    static FNVCaptureClock* Find(const UWorld* World);
+    /// Get the clock of a world only if it's running
+    static FNVCaptureClock* FindRunning(const UWorld* World);
+
+    /// Start counting the captured frames from 0
+    /// @param InFixedStepSeconds   The simulated time (in seconds) between 2 captured frames
+    void Start(float InFixedStepSeconds);
+    void Stop();
+
+    /// Advance the clock by one step, called by the capturer after each captured frame
+    /// NOTE: The captured frames are counted even when the clock isn't running, only the clock's steps need it to run
+    void AdvanceFrame();
+
+    bool IsRunning() const
+    {
+        return bRunning;
+    }
+    int32 GetFrameCount() const
+    {
+        return FrameCount;
+    }
+    /// Number of frames the capturer captured in the world, whether the clock was running or not
+    int32 GetCapturedFrameCount() const
+    {
+        return CapturedFrameCount;
+    }
+    float GetFixedStepSeconds() const
+    {
+        return FixedStepSeconds;
+    }
+    /// The simulated time since the clock started, calculated from the frame counter so it doesn't drift
+    double GetSimulatedSeconds() const
+    {
+        return (double)FrameCount * FixedStepSeconds;
+    }
+
+    /// Convert a duration to the number of steps it last, at least 1 step
+    int32 SecondsToFrameCount(float DurationSeconds) const;
+
+protected:
+    bool bRunning;
+    int32 FrameCount;
+    int32 CapturedFrameCount;
+    float FixedStepSeconds;
+};
+
+///
+/// A countdown which run on the world's capture clock while it's running, or on the world's delta time otherwise
+/// NOTE: The duration is converted to a number of capture clock steps, so the countdown always expire on the same captured frame
+///
+struct NVSCENECAPTURER_API FNVCaptureClockCountdown
+{
+public:
+    FNVCaptureClockCountdown();
+
+    /// Start counting down from a duration (in seconds)
+    void Start(const UWorld* World, float DurationSeconds);
+    void Stop();
+    bool IsActive() const;
+
+    /// Advance the countdown, return true when it expired
+    /// @param DeltaTime - The world's delta time, only used when the capture clock is not running
+    bool Tick(const UWorld* World, float DeltaTime);
+
+    /// Check the capture clock countdowns expire on the expected frames, whatever the number of ticks between them, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    /// @param WorldClock - The world's capture clock, it may be stopped or nullptr
+    void StartOnClock(const FNVCaptureClock* WorldClock, float DurationSeconds);
+    bool TickOnClock(const FNVCaptureClock* WorldClock, float DeltaTime);
+
+protected:
+    /// The remaining time (in seconds) when the countdown run on the world's delta time, < 0 if the countdown is not active
+    float RemainingSeconds;
+    /// The capture clock's frame when the countdown expire, INDEX_NONE if the countdown doesn't run on the capture clock
+    int32 ExpireFrame;
+};
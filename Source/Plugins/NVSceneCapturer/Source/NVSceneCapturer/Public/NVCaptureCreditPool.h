@@ -0,0 +1,102 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Event.h"
+
+/// Statistics of a capture credit pool
+struct NVSCENECAPTURER_API FNVCaptureCreditStats
+{
+public:
+    FNVCaptureCreditStats();
+
+public:
+    /// Maximum number of captured frames which can be in flight at the same time
+    int32 MaxCreditCount;
+    /// Number of credits granted and not retired yet
+    int32 OutstandingCreditCount;
+    /// Highest number of credits outstanding at the same time
+    int32 PeakOutstandingCreditCount;
+    /// Number of credits granted
+    int32 GrantedCreditCount;
+    /// Number of credits retired, all the data of their frame were handled
+    int32 RetiredCreditCount;
+    /// Number of requests which were denied because all the credits were outstanding
+    int32 DeniedRequestCount;
+    /// Average time (in seconds) between granting a credit and retiring it
+    double AverageCreditLifetime;
+    /// Total time (in seconds) spent waiting for a credit to be retired
+    double TotalWaitTime;
+};
+
+/// A credit to capture one frame
+/// The credit is retired and given back to its pool when the last reference to it is released
+/// NOTE: The capturer's callbacks and the exporter's queued data of the frame keep a reference to it
+struct NVSCENECAPTURER_API FNVCaptureCredit
+{
+public:
+    /// Index of the frame the credit was granted for
+    int32 FrameIndex;
+    /// Time (in seconds) when the credit was granted
+    double GrantedTimestamp;
+};
+
+typedef TSharedPtr<FNVCaptureCredit, ESPMode::ThreadSafe> FNVCaptureCreditPtr;
+
+///
+/// Pool of credits letting a capturer have a bounded number of captured frames in flight
+/// The capturer take a credit before capturing a frame and the credit only come back to the pool
+/// after the data handler retired all the data of the frame, so the capturer run exactly as fast as the handler can export
+/// NOTE: All the functions are thread safe
+///
+class NVSCENECAPTURER_API FNVCaptureCreditPool : public TSharedFromThis<FNVCaptureCreditPool, ESPMode::ThreadSafe>
+{
+public:
+    FNVCaptureCreditPool(int32 InMaxCreditCount);
+    ~FNVCaptureCreditPool();
+
+    /// Take a credit to capture a frame
+    /// return nullptr if all the credits are outstanding
+    FNVCaptureCreditPtr TryAcquireCredit(int32 FrameIndex);
+
+    /// Find the outstanding credit granted for a frame, return nullptr if there's none
+    FNVCaptureCreditPtr FindFrameCredit(int32 FrameIndex) const;
+
+    /// Wait until a credit is retired or the time out is reached
+    /// return true if a credit was retired
+    bool WaitForRetiredCredit(float TimeOutSeconds);
+
+    /// Change the number of credits, the outstanding credits are not affected
+    void SetMaxCreditCount(int32 NewMaxCreditCount);
+    int32 GetMaxCreditCount() const;
+    int32 GetAvailableCreditCount() const;
+    int32 GetOutstandingCreditCount() const;
+
+    FNVCaptureCreditStats GetStats() const;
+
+    /// Check the credit accounting, and that a slow exporter make the capturer wait without skipping frames, without rendering anything
+    /// the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    void RetireCredit(FNVCaptureCredit* RetiredCredit);
+
+protected:
+    mutable FCriticalSection CreditLock;
+
+    /// The outstanding credits of each frame
+    /// NOTE: The pool doesn't keep the credits alive, only the users of the frame's data do
+    TMap<int32, TWeakPtr<FNVCaptureCredit, ESPMode::ThreadSafe>> FrameCredits;
+
+    /// Triggered every time a credit is retired
+    FEvent* CreditRetiredEvent;
+
+    FNVCaptureCreditStats Stats;
+    double TotalCreditLifetime;
+};
@@ -0,0 +1,184 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "NVFrameRangeShard.generated.h"
+
+/// The range of frames a capturer process captured, exported in the merged directory's manifest
+USTRUCT()
+struct NVSCENECAPTURER_API FNVFrameRangeShardData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY()
+    int32 shard_index;
+
+    UPROPERTY()
+    int32 frame_offset;
+
+    UPROPERTY()
+    int32 frame_count;
+
+    /// Seed of the shard's first frame
+    UPROPERTY()
+    int32 shard_seed;
+};
+
+/// Manifest of a dataset merged from the outputs of multiple capturer processes
+USTRUCT()
+struct NVSCENECAPTURER_API FNVFrameRangeMergeData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY()
+    int32 total_frame_count;
+
+    UPROPERTY()
+    int32 random_seed;
+
+    UPROPERTY()
+    TArray<FNVFrameRangeShardData> shards;
+
+    /// Number of frames which have at least one file in the merged directory
+    UPROPERTY()
+    int32 merged_frame_count;
+
+    /// Frames in [0, total_frame_count) which none of the shards produced
+    UPROPERTY()
+    TArray<int32> missing_frames;
+};
+
+///
+/// A contiguous range of frames captured by one capturer process when a dataset is split between multiple processes
+/// Every frame's randomization is seeded from the dataset's seed and the frame's index, so a shard draw the same random values
+/// as a single process for each of its frames
+/// NOTE: The shard simulate (without capturing) the frames before its range so the state carried from frame to frame
+/// (e.g: the randomization timers, the movements) is the same as a single process's too, unless bSkipLeadingFrames is set
+/// NOTE: The shards export their files with the dataset's frame indexes, so merging them doesn't need to rename the frames
+///
+struct NVSCENECAPTURER_API FNVFrameRangeShard
+{
+public:
+    FNVFrameRangeShard();
+
+    /// Split TotalFrameCount frames into ShardCount contiguous ranges, the first ranges get 1 more frame when it doesn't divide evenly
+    static FNVFrameRangeShard MakeShard(int32 TotalFrameCount, int32 ShardCount, int32 ShardIndex, int32 RandomSeed);
+
+    /// Read -ShardCount=, -ShardIndex= and -ShardSkipLeadingFrames from the command line
+    /// return true if the command line ask for capturing one shard of the dataset
+    static bool ParseCommandLine(const TCHAR* CommandLine, int32 TotalFrameCount, int32 RandomSeed, FNVFrameRangeShard& OutShard);
+
+    /// The seed of a frame's randomization, only depend on the dataset's seed and the frame's index
+    static int32 GetFrameSeed(int32 RandomSeed, int32 FrameIndex);
+    /// Seed the engine's global random streams (FMath::Rand, FMath::SRand) and the named random streams the randomization components use
+    static void SeedFrameRandomStreams(int32 RandomSeed, int32 FrameIndex);
+
+    bool IsValid() const
+    {
+        return (ShardCount > 0);
+    }
+    /// Whether the frame is fast forwarded before the shard's range: it must be simulated but not captured
+    bool IsFastForwardFrame(int32 FrameIndex) const
+    {
+        return IsValid() && !bSkipLeadingFrames && (FrameIndex < FrameOffset);
+    }
+    /// The first frame the capturer run: 0 when the frames before the shard are fast forwarded, otherwise the shard's first frame
+    int32 GetStartFrame() const
+    {
+        return (IsValid() && bSkipLeadingFrames) ? FrameOffset : 0;
+    }
+    /// The frame after the shard's last frame
+    int32 GetEndFrame() const
+    {
+        return FrameOffset + FrameCount;
+    }
+    int32 GetShardSeed() const
+    {
+        return GetFrameSeed(RandomSeed, FrameOffset);
+    }
+
+    FNVFrameRangeShardData GetShardData() const;
+
+    /// Merge the output directories of the shards into a single directory with a contiguous frame index
+    /// The frames' files are moved, the settings files must be the same in all the shards and are only copied once
+    /// return true if all the frames were merged and the settings are consistent
+    static bool MergeShardOutputs(const TArray<FNVFrameRangeShard>& Shards,
+                                  const TArray<FString>& ShardDirectories,
+                                  const FString& MergedDirectory,
+                                  FNVFrameRangeMergeData& OutMergeData);
+
+    /// Check that the shards reproduce the same range of frames of a single run, with and without skipping the leading frames, and the merge of their outputs
+    /// the result is printed to the log
+    static bool RunSelfTest();
+
+public:
+    int32 ShardIndex;
+    /// Number of shards the dataset is split into, 0 if the dataset isn't split
+    int32 ShardCount;
+    int32 TotalFrameCount;
+    /// Index of the shard's first frame in the dataset
+    int32 FrameOffset;
+    /// Number of frames in the shard's range
+    int32 FrameCount;
+    /// Seed of the whole dataset, the frames' seeds are derived from it
+    int32 RandomSeed;
+    /// If true, the shard start right at its first frame instead of simulating (without capturing) the frames before its range
+    /// NOTE: Faster for the last shards, but the state carried from frame to frame start over in the shard: only the random values drawn
+    /// in each frame match a single run's, e.g. the timed randomizations and the movements don't. Only set by -ShardSkipLeadingFrames
+    bool bSkipLeadingFrames;
+};
+
+///
+/// Launch a child capturer process for each shard of a dataset and merge their outputs when they all exited
+/// The children run with the launcher's command line and their own -ShardIndex=, -RandomSeed= and -OutputPath=
+/// NOTE: Only used on the game thread
+///
+class NVSCENECAPTURER_API FNVFrameRangeShardLauncher
+{
+public:
+    FNVFrameRangeShardLauncher(int32 InTotalFrameCount, int32 InShardCount, int32 InRandomSeed, const FString& InMergedDirectory);
+    ~FNVFrameRangeShardLauncher();
+
+    /// Start the child processes
+    /// @param BaseCommandLine  The launcher's command line, its sharding arguments are replaced for each child
+    bool Launch(const FString& BaseCommandLine);
+
+    /// Check whether the child processes exited and merge their outputs when they all did
+    /// return true when the launcher is finished
+    bool Update();
+
+    bool IsRunning() const
+    {
+        return bRunning;
+    }
+    bool HasSucceeded() const
+    {
+        return bSucceeded;
+    }
+
+    /// The directory a shard's child process export to
+    FString GetShardDirectory(int32 ShardIndex) const;
+
+    /// Make the command line of a shard's child process
+    static FString MakeChildCommandLine(const FString& BaseCommandLine, const FNVFrameRangeShard& Shard, const FString& ShardDirectory);
+
+protected:
+    void MergeShardOutputs();
+
+protected:
+    TArray<FNVFrameRangeShard> Shards;
+    TArray<FProcHandle> ChildProcesses;
+    TArray<int32> ChildReturnCodes;
+    FString MergedDirectory;
+    bool bRunning;
+    bool bSucceeded;
+    double LaunchTimestamp;
+};
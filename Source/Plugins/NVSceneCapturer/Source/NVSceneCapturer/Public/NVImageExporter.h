@@ -7,7 +7,9 @@
 #pragma once
 
 #include "NVSceneCapturerUtils.h"
+#include "NVCaptureCreditPool.h"
 #include "HAL/Runnable.h"
+#include "HAL/ThreadSafeCounter64.h"
 #include "IImageWrapper.h"
 #include "NVImageExporter.generated.h"
 
@@ -20,17 +22,185 @@ public:
     UPROPERTY()
     FNVTexturePixelData PixelDataToBeExported;
 
+    /// Already encoded data (e.g: the annotation json) written to the file as is, used instead of the pixels if it's valid
+    TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> EncodedData;
+
     UPROPERTY()
     FString ExportFilePath;
 
 	UPROPERTY()
 	ENVImageFormat ExportImageFormat;
 
+    /// Index of the frame when the image was captured
+    UPROPERTY()
+    int32 FrameIndex;
+
+    /// Time (in seconds) when this data was queued to be exported
+    double QueuedTimestamp;
+
+    /// Credit of the captured frame, kept until the data is exported so the capturer can't get too far ahead of the exporter
+    FNVCaptureCreditPtr CaptureCredit;
+
 public:
 	FNVImageExporterData();
     FNVImageExporterData(const FNVTexturePixelData& InPixelDataToBeExported,
 						const FString InExportFilePath,
-						ENVImageFormat InExportImageFormat = ENVImageFormat::PNG);
+						ENVImageFormat InExportImageFormat = ENVImageFormat::PNG,
+						int32 InFrameIndex = INDEX_NONE);
+};
+
+/// Settings for the pool of worker threads which compress and write the captured images to disk
+USTRUCT(BlueprintType)
+struct NVSCENECAPTURER_API FNVImageExporterSettings
+{
+    GENERATED_BODY()
+
+public:
+    FNVImageExporterSettings();
+
+    /// Get the actual number of worker threads to create
+    int32 GetNumberOfWorkerThreads() const;
+
+    /// Get the affinity mask of a worker thread
+    uint64 GetWorkerThreadAffinityMask(int32 WorkerIndex) const;
+
+    /// Get the memory budget in bytes, 0 mean there's no budget
+    int64 GetMemoryBudgetByteSize() const;
+
+public: // Editor properties
+    /// Number of worker threads used to export the images
+    /// NOTE: If NumberOfWorkerThreads <= 0, the number of workers is picked based on the number of cores of the machine
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export")
+    int32 NumberOfWorkerThreads;
+
+    /// Maximum number of images waiting in the queue for a free worker, ExportImage (and ExportEncodedData) will block until a worker picks up an image
+    /// NOTE: If MaxQueuedImageCount <= 0 the queue is unbounded and only the memory budget limit the data in flight
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export")
+    int32 MaxQueuedImageCount;
+
+    /// Bit mask of the CPU cores the worker threads are allowed to run on
+    /// NOTE: 0 mean the workers can run on any cores
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export")
+    int64 WorkerThreadAffinityMask;
+
+    /// If true, each worker thread is pinned to only one core, picked in round-robin order from WorkerThreadAffinityMask
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export")
+    bool bPinEachWorkerToOneCore;
+
+    /// Images whose raw size (in KB) is at least this big are split into bands of rows which are compressed to PNG in parallel
+    /// NOTE: 0 mean the images are always compressed by the single thread PNG encoder
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export", meta = (UIMin = 0))
+    int32 ParallelPNGCompressionMinSizeKB;
+
+    /// Maximum size (in MB) of the data in flight in the exporter: the raw pixels and encoded data waiting in the queue or being exported
+    /// and the compressed images being written
+    /// NOTE: 0 mean the exporter doesn't have a memory budget
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export", meta = (UIMin = 0))
+    int32 MemoryBudgetMB;
+
+    /// When the data in flight reach this ratio of the memory budget, the exporter stop accepting new data
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export", meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+    float MemoryBudgetHighWatermark;
+
+    /// After it stopped accepting new data, the exporter only accept them again when the data in flight drop to this ratio of the memory budget
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Export", meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+    float MemoryBudgetLowWatermark;
+};
+
+/// Whether a data handler can take more captured data
+enum class ENVMemoryBudgetState : uint8
+{
+    /// The handler can take more data
+    Accepting,
+    /// The handler is over its budget, no more data should be sent until it's accepting again
+    Throttled,
+};
+
+/// State of the memory budget of the image exporter, or any other data handler
+struct NVSCENECAPTURER_API FNVMemoryBudgetState
+{
+public:
+    FNVMemoryBudgetState();
+
+    bool CanAcceptMoreData() const
+    {
+        return (State == ENVMemoryBudgetState::Accepting);
+    }
+
+    int64 GetByteSizeInFlight() const
+    {
+        return RawByteSize + EncodedByteSize;
+    }
+
+public:
+    ENVMemoryBudgetState State;
+    /// Size (in bytes) of the raw pixels waiting to be exported or being compressed
+    int64 RawByteSize;
+    /// Size (in bytes) of the encoded data (e.g: the annotations, the compressed images) waiting to be written or being written
+    int64 EncodedByteSize;
+    /// Size (in bytes) of the memory budget, 0 mean there's no budget
+    int64 BudgetByteSize;
+    /// The handler is throttled when the data in flight reach the high watermark, until it drop to the low watermark
+    int64 HighWatermarkByteSize;
+    int64 LowWatermarkByteSize;
+    /// Number of images and data files waiting to be exported or being exported
+    int32 PendingItemCount;
+};
+
+/// Runtime statistics of the image exporter, used to size the worker pool for each machine
+/// NOTE: The encoded data files (e.g: the annotations) go through the same queue and are counted as images
+USTRUCT(BlueprintType)
+struct NVSCENECAPTURER_API FNVImageExporterStats
+{
+    GENERATED_BODY()
+
+public:
+    FNVImageExporterStats();
+
+public:
+    /// Number of images waiting in the queue for a worker
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    int32 QueuedImageCount;
+
+    /// Highest number of images waiting in the queue at the same time
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    int32 PeakQueuedImageCount;
+
+    /// Number of images being compressed and written by the workers
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    int32 ExportingImageCount;
+
+    /// Total number of images the workers finished exporting
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    int32 ExportedImageCount;
+
+    /// Average time (in seconds) an image waited in the queue before a worker picked it up
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    float AverageQueuedTime;
+
+    /// Average time (in seconds) a worker took to compress and write an image
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    float AverageExportTime;
+
+    /// Longest time (in seconds) a worker took to compress and write an image
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    float MaxExportTime;
+
+    /// Total time (in seconds) the producers were blocked because the queue was full
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    float BlockedTime;
+
+    /// Number of pixels buffers built from the read back textures (in all the capturers) since the capture started
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    int32 PixelsBufferCount;
+
+    /// Highest size (in MB) of the data in flight at the same time
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    float PeakMemoryInFlightMB;
+
+    /// Number of times the exporter went over the high watermark of its memory budget
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+    int32 ThrottledCount;
 };
 
 struct NVSCENECAPTURER_API FNVImageExporter
@@ -45,19 +215,46 @@ public:
     /// result   The compressed data in bytes
     static TArray<uint8> CompressImagePNG(const FNVTexturePixelData& SourcePixelData);
 
+    /// Compress a source image data to PNG format using multiple threads
+    /// The image is split into bands of rows, each band is filtered and deflated in parallel
+    /// then the compressed bands are stitched together into one valid PNG stream
+    /// @param SourcePixelData       The source, raw pixel data
+    /// @param NumberOfBands         The number of bands to split the image into, <= 0 mean using the number of cores
+    /// result                       The compressed data in bytes
+    static TArray<uint8> CompressImagePNG_Parallel(const FNVTexturePixelData& SourcePixelData, int32 NumberOfBands = 0);
+
+    /// Compress a source image data to QOI format
+    /// NOTE: QOI only support 8 bits per channel images, use GetSupportedExportImageFormat to check the pixel format first
+    /// result   The compressed data in bytes
+    static TArray<uint8> CompressImageQOI(const FNVTexturePixelData& SourcePixelData);
+
+    /// Get the image format an image with a pixel format can actually be exported to
+    /// The image is exported as PNG if its pixel format can't be represented by the requested image format
+    static ENVImageFormat GetSupportedExportImageFormat(ENVImageFormat RequestedImageFormat, EPixelFormat ImagePixelFormat);
+
     /// Compress a source image to a certain image type
     /// @param ImageWrapperModule    Reference to the ImageWrapper module
     /// @param SourcePixelData       The source, raw pixel data
     /// @param ImageFormat           The type of the image to compress to
     /// @param CompressionQuality    The quality of the compression
+    /// @param ExporterSettings      The settings of the exporter, nullptr mean using the default settings
     /// result                       The compressed data in bytes
     static TArray<uint8> CompressImage(IImageWrapperModule* ImageWrapperModule,
                                        const FNVTexturePixelData& SourcePixelData,
                                        ENVImageFormat ImageFormat,
-                                       uint8 CompressionQuality = 100);
+                                       uint8 CompressionQuality = 100,
+                                       const FNVImageExporterSettings* ExporterSettings = nullptr);
 
     /// Export an in-memory image to file on disk
-    static bool ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData);
+    static bool ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData, const FNVImageExporterSettings* ExporterSettings = nullptr);
+
+    /// Compare the speed and the compressed size of the PNG encoders on synthetic BGRA8, R8G8 and 16 bits frames
+    /// The result is printed to the log
+    static void BenchmarkPNGEncoders(IImageWrapperModule* ImageWrapperModule, const FIntPoint& ImageSize, int32 IterationCount);
+
+    /// Compare the encoding speed and the compressed size of the QOI encoder against the PNG encoder on a synthetic BGRA8 frame
+    /// The result is printed to the log
+    static void BenchmarkQOIEncoder(const FIntPoint& ImageSize, int32 IterationCount);
 
 	bool ExportImage(const FNVImageExporterData& ImageExporterData);
 
@@ -65,32 +262,112 @@ protected:
     IImageWrapperModule* ImageWrapperModule;
 };
 
-struct NVSCENECAPTURER_API FNVImageExporter_Thread : public FRunnable
+/// Callback writing a compressed image or an encoded data somewhere else than its own file on disk
+/// NOTE: It's called from the worker threads so it must be thread safe
+/// @param ExporterData      The exported image or data
+/// @param EncodedData       The compressed image or the encoded data
+/// result                   True if the data is written successfully
+typedef TFunction<bool(const FNVImageExporterData& ExporterData, const TArray<uint8>& EncodedData)> FNVEncodedDataWriter;
+
+/// Dedicated pool of worker threads exporting the queued images and encoded data files (e.g: the annotations)
+/// NOTE: The workers don't use the engine's thread pool so they don't starve the rendering and async loading tasks
+struct NVSCENECAPTURER_API FNVImageExporter_Thread
 {
 public:
-    FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule);
+    /// @param InEncodedDataWriter   If set, the compressed images and the encoded data are passed to this callback instead of being saved to their export file path
+    FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule,
+                            const FNVImageExporterSettings& InSettings = FNVImageExporterSettings(),
+                            FNVEncodedDataWriter InEncodedDataWriter = nullptr);
     ~FNVImageExporter_Thread();
 
     bool ExportImage(const FNVTexturePixelData& ExportPixelData,
                      const FString& ExportFilePath,
-					 const ENVImageFormat ExportImageFormat = ENVImageFormat::PNG);
+					 const ENVImageFormat ExportImageFormat = ENVImageFormat::PNG,
+                     int32 FrameIndex = INDEX_NONE,
+                     const FNVCaptureCreditPtr& CaptureCredit = nullptr);
+
+    /// Queue an already encoded data to be written to a file
+    /// NOTE: The data share the queue, the backpressure and the pending count with the images
+    bool ExportEncodedData(const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& EncodedData,
+                           const FString& ExportFilePath,
+                           int32 FrameIndex = INDEX_NONE,
+                           const FNVCaptureCreditPtr& CaptureCredit = nullptr);
 
-    virtual uint32 Run();
-    virtual void Stop() override;
+    /// Block until the workers exported all the queued images and data, or the exporter is stopped
+    void WaitUntilAllExported();
+
+    void Stop();
     void Kill();
 
     uint32 GetPendingImagesCount() const;
     bool IsExportingImage() const;
 
+    /// Get how much data is in flight compared to the memory budget, safe to call from any thread
+    FNVMemoryBudgetState GetMemoryBudgetState() const;
+    /// Count the encoded data kept in memory after the workers handed it over (e.g: by a shard writer) in the memory budget
+    /// NOTE: Safe to call from any thread, the size must be removed again when the data is released
+    void UpdateExternalByteSizeInFlight(int64 ByteSizeDelta);
+
+    FNVImageExporterStats GetStats() const;
+
+protected:
+    struct FNVImageExporter_Worker : public FRunnable
+    {
+    public:
+        FNVImageExporter_Worker(FNVImageExporter_Thread* InOwner);
+
+        virtual uint32 Run() override;
+
+    protected:
+        FNVImageExporter_Thread* Owner;
+    };
+
+    /// Add the data to the queue, block until there's space in the queue if it's bounded
+    bool EnqueueExporterData(FNVImageExporterData&& NewExporterData);
+    /// Export the queued images until the queue is empty or the exporter is stopped
+    void ProcessQueuedImages();
+    bool ExportQueuedData(const FNVImageExporterData& ExporterData);
+    bool DequeueImageData(FNVImageExporterData& OutImageData);
+    /// Remove all the data still in the queue without exporting them
+    void DropQueuedData();
+    void OnImageExported(double QueuedTime, double ExportTime);
+
+    /// Size (in bytes) of the raw and encoded data of a queued item which are counted in the memory budget
+    static int64 GetRawByteSize(const FNVImageExporterData& ExporterData);
+    static int64 GetEncodedByteSize(const FNVImageExporterData& ExporterData);
+    /// Add (or remove, with negative sizes) data in flight and update the memory budget state
+    void UpdateByteSizeInFlight(int64 RawByteSizeDelta, int64 EncodedByteSizeDelta);
+
 protected:
-    FRunnableThread* Thread;
+    FNVImageExporterSettings Settings;
+    FNVEncodedDataWriter EncodedDataWriter;
+
+    TArray<FNVImageExporter_Worker*> Workers;
+    TArray<FRunnableThread*> WorkerThreads;
     FThreadSafeBool bIsRunning;
 
-    TQueue<FNVImageExporterData> QueuedImageData;
+    TQueue<FNVImageExporterData, EQueueMode::Mpsc> QueuedImageData;
+    /// The queue only support single consumer so the workers must take turn to dequeue
+    FCriticalSection DequeueLock;
 
     IImageWrapperModule* ImageWrapperModule;
 
     FEvent* HavePendingImageEvent;
+    FEvent* QueueHasSpaceEvent;
+    /// Triggered every time a worker finished exporting an item
+    FEvent* ImageExportedEvent;
     FThreadSafeCounter PendingImageCounter;
-    TSharedPtr<FThreadSafeCounter, ESPMode::ThreadSafe> ExportingImageCounterPtr;
-};
\ No newline at end of file
+    FThreadSafeCounter ExportingImageCounter;
+
+    FThreadSafeCounter64 RawByteSizeInFlight;
+    FThreadSafeCounter64 EncodedByteSizeInFlight;
+    /// True after the data in flight reached the high watermark until they drop to the low watermark
+    bool bOverMemoryBudget;
+    mutable FCriticalSection MemoryBudgetLock;
+
+    mutable FCriticalSection StatsLock;
+    FNVImageExporterStats Stats;
+    double TotalQueuedTime;
+    double TotalExportTime;
+    double TotalBlockedTime;
+};
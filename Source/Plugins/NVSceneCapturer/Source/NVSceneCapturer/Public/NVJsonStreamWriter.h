@@ -0,0 +1,106 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+///
+/// Write json directly to an UTF-8 buffer without building a FJsonObject tree first
+/// The output is formatted exactly like the engine's pretty print TJsonWriter so the exported files don't change,
+/// the numbers are written with 17 significant digits just like the engine does for the FJsonValueNumber
+///
+class NVSCENECAPTURER_API FNVJsonStreamWriter
+{
+public:
+    FNVJsonStreamWriter(int32 InitialBufferSize = 4096);
+
+    void WriteObjectStart();
+    void WriteObjectStart(const TCHAR* Identifier);
+    void WriteObjectEnd();
+
+    void WriteArrayStart();
+    void WriteArrayStart(const TCHAR* Identifier);
+    void WriteArrayEnd();
+
+    /// Write values inside an array
+    void WriteNumber(double Value);
+    void WriteBool(bool bValue);
+    void WriteString(const FString& Value);
+    void WriteNull();
+
+    /// Write values inside an object
+    void WriteNumber(const TCHAR* Identifier, double Value);
+    void WriteBool(const TCHAR* Identifier, bool bValue);
+    void WriteString(const TCHAR* Identifier, const FString& Value);
+    void WriteNull(const TCHAR* Identifier);
+
+    /// Write a json value the same way FJsonSerializer does
+    void WriteJsonValue(const TSharedPtr<FJsonValue>& Value);
+    void WriteJsonValue(const TCHAR* Identifier, const TSharedPtr<FJsonValue>& Value);
+    void WriteJsonObjectFields(const TSharedPtr<FJsonObject>& JsonObject);
+
+    /// Write the math types as arrays of numbers rounded to 4 decimal digits, the same as NVSceneCapturerUtils::CustomPropertyToJsonValueFunc
+    void WriteVector(const TCHAR* Identifier, const FVector& Value);
+    void WriteVector(const FVector& Value);
+    void WriteVector2D(const TCHAR* Identifier, const FVector2D& Value);
+    void WriteVector2D(const FVector2D& Value);
+    void WriteQuat(const TCHAR* Identifier, const FQuat& Value);
+    void WriteMatrix(const TCHAR* Identifier, const FMatrix& Value);
+    void WriteFloatWithPrecision4(const TCHAR* Identifier, float Value);
+
+    const TArray<uint8>& GetBuffer() const
+    {
+        return Buffer;
+    }
+
+    /// Move the written data out of the writer
+    TArray<uint8> ReleaseBuffer();
+
+    /// Compare the speed of this writer with the FJsonObject path on a synthetic FCapturedSceneData
+    /// and check both of them produce the same bytes, the result is printed to the log
+    static void BenchmarkCapturedSceneData(int32 ObjectCount, int32 IterationCount);
+
+protected:
+    enum class EJsonToken : uint8
+    {
+        None,
+        CurlyOpen,
+        CurlyClose,
+        SquareOpen,
+        SquareClose,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+    };
+
+    static bool IsShortValue(EJsonToken Token)
+    {
+        return (Token == EJsonToken::Number) || (Token == EJsonToken::True) || (Token == EJsonToken::False) || (Token == EJsonToken::Null);
+    }
+
+    void WriteCommaIfNeeded();
+    void WriteIdentifier(const TCHAR* Identifier);
+    void PrepareArrayValue();
+    void WriteLineTerminator();
+    void WriteTabs();
+
+    void AppendChar(ANSICHAR Char)
+    {
+        Buffer.Add((uint8)Char);
+    }
+    void AppendNumber(double Value);
+    void AppendEscapedString(const TCHAR* Value);
+
+protected:
+    TArray<uint8> Buffer;
+    EJsonToken PreviousTokenWritten;
+    int32 IndentLevel;
+};
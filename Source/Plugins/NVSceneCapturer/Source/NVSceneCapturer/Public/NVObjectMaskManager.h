@@ -74,6 +74,10 @@ public:
 
     virtual void ScanActors(UWorld* World);
 
+    /// Update the mask of a single actor after it was shown, hidden or changed its mesh, without scanning the whole world again
+    /// NOTE: The mask ids are only assigned when the actors are scanned, an actor whose mask name wasn't scanned get no mask
+    virtual void UpdateActorMask(AActor* CheckActor);
+
 	void Init(ENVActorMaskNameType NewMaskNameType, ENVIdAssignmentType NewIdAssignmentType);
 
 protected:
@@ -115,6 +119,7 @@ public:
     UNVObjectMaskMananger_Stencil();
 
     void ScanActors(UWorld* World) override;
+    void UpdateActorMask(AActor* CheckActor) override;
 
     uint8 GetMaskId(const FString& MaskName) const;
     uint8 GetMaskId(const AActor* CheckActor) const;
@@ -136,6 +141,7 @@ public:
     UNVObjectMaskMananger_VertexColor();
 
     void ScanActors(UWorld* World) override;
+    void UpdateActorMask(AActor* CheckActor) override;
 
     uint32 GetMaskId(const FString& MaskName) const;
     uint32 GetMaskId(const AActor* CheckActor) const;
@@ -158,6 +164,8 @@ public:
 	uint32 GetInstanceId(const AActor* CheckActor) const;
 	void Init(UObject* OwnerObject);
 	void ScanActors(UWorld* World);
+	/// Update the instance mask of an actor which was hidden or shown again since the last scan, e.g: a pooled actor
+	void UpdateActorMask(AActor* CheckActor);
 
 protected:
 // Editor properties
@@ -202,6 +210,8 @@ public:
 	uint8 GetInstanceId(const AActor* CheckActor) const;
 	void Init(UObject* OwnerObject);
 	void ScanActors(UWorld* World);
+	/// Update the class mask of an actor which was hidden, shown again or changed its mesh since the last scan, e.g: a pooled actor
+	void UpdateActorMask(AActor* CheckActor);
 
 protected:
 // Editor properties
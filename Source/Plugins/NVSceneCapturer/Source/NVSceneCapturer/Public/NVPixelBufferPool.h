@@ -0,0 +1,101 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "HAL/CriticalSection.h"
+
+/// Statistics of the pixels buffer pool
+struct NVSCENECAPTURER_API FNVPixelBufferPoolStats
+{
+public:
+    FNVPixelBufferPoolStats();
+
+public:
+    /// Number of buffers requested from the pool
+    int32 AcquiredCount;
+    /// Number of requests served by a recycled buffer
+    int32 HitCount;
+    /// Number of requests which needed a new allocation
+    int32 MissCount;
+    /// Number of returned buffers freed because the pool was full
+    int32 DiscardedCount;
+    /// Number of free buffers in the pool
+    int32 PooledBufferCount;
+    /// Total size (in bytes) of the free buffers in the pool
+    int64 PooledByteSize;
+    /// Maximum size (in bytes) of the free buffers the pool can keep
+    int64 MaxPooledByteSize;
+};
+
+///
+/// Pool of pixels buffers bucketed by pixel format and resolution
+/// The texture readers get their buffers from this pool and the buffers are returned to it automatically
+/// when the last reference to them is released, e.g: after the image exporter finished writing the file
+///
+class NVSCENECAPTURER_API FNVPixelBufferPool : public TSharedFromThis<FNVPixelBufferPool, ESPMode::ThreadSafe>
+{
+public:
+    FNVPixelBufferPool();
+    ~FNVPixelBufferPool();
+
+    static FNVPixelBufferPool& Get();
+
+    /// Get a buffer which can hold the pixels of an image
+    /// NOTE: The buffer's content is uninitialized
+    /// @param PixelFormat       The format of the image's pixels
+    /// @param ImageSize         The resolution of the image
+    /// @param BufferByteSize    The size (in bytes) of the buffer
+    TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> AcquireBuffer(EPixelFormat PixelFormat, const FIntPoint& ImageSize, int32 BufferByteSize);
+
+    /// Set the maximum size (in bytes) of the free buffers the pool can keep, the least recently returned buffers are freed right away
+    void SetMaxPooledByteSize(int64 NewMaxPooledByteSize);
+
+    /// Free all the buffers in the pool
+    void Empty();
+
+    FNVPixelBufferPoolStats GetStats() const;
+
+protected:
+    struct FNVPixelBufferKey
+    {
+        EPixelFormat PixelFormat;
+        FIntPoint ImageSize;
+        int32 BufferByteSize;
+
+        bool operator==(const FNVPixelBufferKey& OtherKey) const
+        {
+            return (PixelFormat == OtherKey.PixelFormat) && (ImageSize == OtherKey.ImageSize) && (BufferByteSize == OtherKey.BufferByteSize);
+        }
+
+        friend uint32 GetTypeHash(const FNVPixelBufferKey& Key)
+        {
+            return HashCombine(HashCombine(GetTypeHash((uint8)Key.PixelFormat), GetTypeHash(Key.ImageSize)), GetTypeHash(Key.BufferByteSize));
+        }
+    };
+
+    struct FNVPooledBuffer
+    {
+        TArray<uint8>* Buffer;
+        /// Order in which the buffers were returned to the pool, across all the buckets
+        uint64 ReleaseIndex;
+    };
+
+    void ReleaseBuffer(const FNVPixelBufferKey& BufferKey, TArray<uint8>* ReleasedBuffer);
+    /// Free the least recently returned buffers, from any bucket, until the pool fit in its maximum size
+    void TrimPool();
+
+protected:
+    mutable FCriticalSection PoolLock;
+
+    /// Free buffers of each bucket, the most recently returned buffers are at the back
+    TMap<FNVPixelBufferKey, TArray<FNVPooledBuffer>> FreeBuffers;
+    uint64 NextReleaseIndex;
+
+    FNVPixelBufferPoolStats Stats;
+};
@@ -0,0 +1,40 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+///
+/// Encoder and decoder for the QOI ("Quite OK Image") lossless image format: https://qoiformat.org/qoi-specification.pdf
+/// QOI only need a single pass over the pixels without any entropy coding so it's much faster than PNG's deflate
+/// at the cost of bigger files
+/// NOTE: This codec only depend on the Core module so it can be used outside of the capturer, e.g: in the dataset tools
+///
+namespace NVQOICodec
+{
+    /// Size (in bytes) of the QOI header
+    static const int32 HeaderByteSize = 14;
+
+    /// Compress 8 bits per channel RGBA or BGRA pixels to QOI
+    /// @param Pixels        The source pixels, 4 bytes per pixel, rows are tightly packed
+    /// @param Width         Width (in pixels) of the image
+    /// @param Height        Height (in pixels) of the image
+    /// @param bIsBGRA       If true, the source pixels are in BGRA order, otherwise they are in RGBA order
+    /// result               The QOI compressed data, empty if the arguments are invalid
+    NVSCENECAPTURER_API TArray<uint8> Encode(const uint8* Pixels, int32 Width, int32 Height, bool bIsBGRA);
+
+    /// Decompress a QOI image to 8 bits per channel RGBA or BGRA pixels
+    /// NOTE: 3 channels images are decoded with alpha = 255
+    /// @param CompressedData    The QOI compressed data
+    /// @param CompressedSize    Size (in bytes) of the compressed data
+    /// @param OutPixels         The decoded pixels, 4 bytes per pixel
+    /// @param OutWidth          Width (in pixels) of the decoded image
+    /// @param OutHeight         Height (in pixels) of the decoded image
+    /// @param bOutputBGRA       If true, the decoded pixels are in BGRA order, otherwise they are in RGBA order
+    /// result                   True if the data is a valid QOI image
+    NVSCENECAPTURER_API bool Decode(const uint8* CompressedData, int32 CompressedSize, TArray<uint8>& OutPixels, int32& OutWidth, int32& OutHeight, bool bOutputBGRA);
+};
@@ -0,0 +1,139 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+///
+/// Counter based random stream (Philox4x32-10) for the domain randomization
+/// Every value is a pure function of the master seed, the stream's name, the epoch and the value's index in the stream,
+/// so each randomization component draws a reproducible sequence no matter how many values the other components drew
+/// The epoch is the captured frame's index when the capturer use a fixed seed: the streams restart at the beginning of every frame
+/// NOTE: A stream isn't thread safe but the streams don't share any state, each thread can use its own streams without contention
+///
+class NVSCENECAPTURER_API FNVRandomStream
+{
+public:
+    FNVRandomStream();
+    explicit FNVRandomStream(const FString& StreamName);
+
+    /// Derive the stream from its name, the streams with different names are independent
+    void Initialize(const FString& StreamName);
+    bool IsInitialized() const
+    {
+        return bInitialized;
+    }
+    uint32 GetStreamId() const
+    {
+        return StreamId;
+    }
+
+    /// Set the seed all the streams are derived from and the epoch they are in, the streams restart from their first value when it change
+    /// NOTE: Only set on the game thread, between the randomizations
+    static void SetMasterSeed(int32 InMasterSeed, int32 InEpoch = 0);
+    static int32 GetMasterSeed();
+    static int32 GetEpoch();
+
+    /// Restart the stream in a given master seed and epoch and stop following the global ones,
+    /// e.g: to draw ahead the values the stream will have in the next frames
+    void PinEpoch(int32 InMasterSeed, int32 InEpoch);
+    bool IsEpochPinned() const
+    {
+        return bEpochPinned;
+    }
+    /// The master seed and epoch the stream's values are currently drawn in
+    int32 GetStreamMasterSeed() const
+    {
+        return StreamMasterSeed;
+    }
+    int32 GetStreamEpoch() const
+    {
+        return StreamEpoch;
+    }
+
+    //================ Single values ================
+    uint32 GetUnsignedInt();
+    /// Uniform value in [0, 1)
+    float GetFraction();
+    /// Uniform integer in [0, Count), 0 if Count isn't positive
+    int32 RandHelper(int32 Count);
+    /// Uniform integer in [Min, Max]
+    int32 RandRange(int32 Min, int32 Max);
+    /// Uniform value in [Min, Max)
+    float FRandRange(float Min, float Max);
+    /// Normally distributed value (Ziggurat)
+    float Gaussian(float Mean = 0.f, float StdDev = 1.f);
+    /// Uniform point inside a box
+    FVector PointInBox(const FBox& Box);
+    /// Uniform direction on the unit sphere
+    FVector UnitVector();
+    /// Uniform direction inside a cone around a direction, same as FMath::VRandCone
+    FVector VRandCone(const FVector& Dir, float ConeHalfAngleRad);
+    /// Uniform rotation
+    FQuat Rotation();
+
+    /// Fisher-Yates shuffle of an array
+    template<typename ElementType>
+    void Shuffle(TArray<ElementType>& Array)
+    {
+        for (int32 i = Array.Num() - 1; i > 0; i--)
+        {
+            Array.Swap(i, RandHelper(i + 1));
+        }
+    }
+
+    //================ Batched values ================
+    /// The batches generate the stream's blocks in groups and convert them in plain loops the compiler can vectorize
+    /// NOTE: A batch draws the same values as the same number of calls to the single value functions, except for the gaussians
+    void FillUnsignedInts(TArrayView<uint32> OutValues);
+    void FillUniform(TArrayView<float> OutValues, float Min = 0.f, float Max = 1.f);
+    void FillGaussian(TArrayView<float> OutValues, float Mean = 0.f, float StdDev = 1.f);
+    void FillPointsInBox(TArrayView<FVector> OutPoints, const FBox& Box);
+    void FillUnitVectors(TArrayView<FVector> OutVectors);
+    void FillRotations(TArrayView<FQuat> OutRotations);
+
+    /// Check the stream's reference values, determinism and distributions, the result is printed to the log
+    static bool RunSelfTest();
+    /// Print the number of values per second the stream and the engine's global random stream generate
+    static void RunThroughputTest(int32 SampleCount);
+
+protected:
+    /// Restart the stream if the master seed or the epoch changed since its last value
+    void SyncMasterSeed();
+    void ResetCounter();
+    /// Generate the next blocks (4 values each) of the stream
+    void GenerateBlocks(uint32* OutValues, int32 BlockCount);
+    /// The slow path of the Ziggurat, when the value isn't inside the layer's rectangle
+    float GaussianSlowPath(int32 Hz, uint32 Layer);
+
+    /// The Philox4x32-10 bijection
+    static void Philox4x32(const uint32 Counter[4], const uint32 Key[2], uint32 OutValues[4]);
+    static FORCEINLINE float ToFraction(uint32 Value)
+    {
+        // NOTE: Only use the 24 high bits so the value is exactly representable and strictly less than 1
+        return (Value >> 8) * (1.f / 16777216.f);
+    }
+
+    /// Number of blocks generated together, their rounds are computed lane by lane so the compiler can vectorize them
+    static const int32 BlockLaneCount = 8;
+    /// Number of values the stream buffers, they are refilled with BlockLaneCount blocks at a time
+    static const int32 BufferSize = BlockLaneCount * 4;
+
+protected:
+    bool bInitialized;
+    /// Whether the stream stays in its master seed and epoch instead of following the global ones
+    bool bEpochPinned;
+    uint32 StreamId;
+    /// The master seed and epoch the stream's counter started in
+    int32 StreamMasterSeed;
+    int32 StreamEpoch;
+    /// Index of the next block to generate
+    uint64 BlockIndex;
+    /// The current blocks' values, BufferIndex is the next one to use
+    uint32 Buffer[BufferSize];
+    int32 BufferIndex;
+};
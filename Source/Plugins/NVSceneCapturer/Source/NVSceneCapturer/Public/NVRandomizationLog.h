@@ -0,0 +1,152 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/// Get the key of a randomization source, it must be the same in the run which recorded the log and the run which replay it
+typedef TFunction<FString()> FNVRandomizationLogKeyGetter;
+/// Save the randomized state of a source to the archive, or restore it from the archive when it's loading
+typedef TFunction<void(FArchive&)> FNVRandomizationStateSerializer;
+
+/// An object whose randomized state is recorded in the randomization log
+struct NVSCENECAPTURER_API FNVRandomizationLogSource
+{
+public:
+    TWeakObjectPtr<const UObject> SourceObject;
+    /// The sources with lower priority are restored first, e.g: the spawned actors must exist before their components' states are restored
+    int32 Priority;
+    FNVRandomizationLogKeyGetter GetKey;
+    FNVRandomizationStateSerializer SerializeState;
+};
+
+/// Statistics of the randomization log
+struct NVSCENECAPTURER_API FNVRandomizationLogStats
+{
+public:
+    FNVRandomizationLogStats();
+
+    /// Number of frames recorded to the log file
+    int32 RecordedFrameCount;
+    /// Number of source states written to the log file, the states which didn't change since the last written one are skipped
+    int32 RecordedStateCount;
+    /// Size (in bytes) of the log file
+    int64 RecordedByteCount;
+    /// Number of source states restored while replaying, the sources which already are in the logged state are skipped
+    int32 AppliedStateCount;
+};
+
+///
+/// Per world log of the randomized state of every registered source (transforms, meshes, materials, lights, spawned actors...) for each captured frame
+/// A frame's record only contain the states which changed since they were last written, the first record of a file has the states of all the sources
+/// While replaying, the randomization components don't randomize and the sources are restored to their logged states instead,
+/// so the frames can be re-rendered (e.g: with different feature extractors) without running the randomization
+/// NOTE: The log is only accessed on the game thread
+///
+class NVSCENECAPTURER_API FNVRandomizationLog
+{
+public:
+    FNVRandomizationLog();
+    ~FNVRandomizationLog();
+
+    /// Get the log of a world, it's created the first time it's requested
+    static FNVRandomizationLog* Get(UWorld* World);
+    /// Get the log of a world only if it was already created
+    static FNVRandomizationLog* Find(const UWorld* World);
+    /// Whether the world's sources are restored from a log instead of being randomized
+    static bool IsReplaying(const UWorld* World);
+
+    /// The name of the log file a capturer write in its output directory, prefixed by the first recorded frame's index like the frames' files
+    static FString GetLogFileName(int32 FirstFrameIndex);
+
+    void RegisterSource(const FNVRandomizationLogSource& NewSource);
+    /// Unregister all the sources of an object
+    void UnregisterSource(const UObject* SourceObject);
+
+    //================ Recording ================
+    /// Start writing the sources' states to a new log file
+    bool StartRecording(const FString& InRecordingFilePath);
+    /// Write the states of the sources which changed since the last recorded frame
+    void RecordFrame(int32 FrameIndex);
+    void StopRecording();
+    bool IsRecording() const
+    {
+        return RecordWriter.IsValid();
+    }
+
+    //================ Replaying ================
+    /// Load a log file, or all the log files in a directory (e.g: merged from multiple frame range shards)
+    bool LoadReplay(const FString& ReplayPath);
+    /// Restore the sources to their states in a frame, the frames can be replayed in any order
+    void ApplyFrame(int32 FrameIndex);
+    void StopReplaying();
+    bool IsReplaying() const
+    {
+        return bReplaying;
+    }
+    /// The range of frames the loaded log has records for, [FirstFrame, EndFrame)
+    int32 GetReplayFirstFrame() const;
+    int32 GetReplayEndFrame() const;
+
+    const FNVRandomizationLogStats& GetStats() const
+    {
+        return Stats;
+    }
+
+    /// Save a reference to an asset as its path, or load the asset back from its path
+    static void SerializeObjectReference(FArchive& Ar, UObject*& ObjectRef);
+    template<typename T>
+    static void SerializeObjectReference(FArchive& Ar, T*& ObjectRef)
+    {
+        UObject* CheckObject = ObjectRef;
+        SerializeObjectReference(Ar, CheckObject);
+        if (Ar.IsLoading())
+        {
+            ObjectRef = Cast<T>(CheckObject);
+        }
+    }
+
+    /// Check that a replayed log restore the recorded states, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    /// The states of one frame, with the indexes of their keys in ReplayKeys
+    struct FReplayRecord
+    {
+        int32 FrameIndex;
+        TArray<TPair<int32, TArray<uint8>>> States;
+    };
+
+    bool LoadReplayFile(const FString& FilePath);
+    static void SerializeSourceState(const FNVRandomizationLogSource& Source, TArray<uint8>& OutState);
+
+protected:
+    TArray<FNVRandomizationLogSource> Sources;
+    FNVRandomizationLogStats Stats;
+
+    // Recording
+    TUniquePtr<FArchive> RecordWriter;
+    FString RecordingFilePath;
+    /// The last state written to the log file for each key
+    TMap<FString, TArray<uint8>> RecordedStates;
+    /// The index of each key in the log file's key table
+    TMap<FString, int32> RecordedKeyIndexes;
+
+    // Replaying
+    bool bReplaying;
+    TArray<FString> ReplayKeys;
+    TMap<FString, int32> ReplayKeyIndexes;
+    /// The loaded records, sorted by frame index
+    TArray<FReplayRecord> ReplayRecords;
+    /// The latest state of each key (index in ReplayKeys) at ReplayedFrameIndex
+    TMap<int32, TArray<uint8>> ReplayedStates;
+    /// Number of records accumulated in ReplayedStates
+    int32 ReplayRecordCursor;
+    int32 ReplayedFrameIndex;
+};
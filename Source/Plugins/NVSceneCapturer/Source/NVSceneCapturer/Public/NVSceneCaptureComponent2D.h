@@ -62,6 +62,11 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Exporter")
     void StopCapturing();
 
+    FNVTextureReadbackRingStats GetReadbackStats() const;
+
+    /// Complete all the readbacks in flight right away instead of waiting for their turn in the ring
+    void FlushPendingReadbacks();
+
 protected:
     void BeginPlay() override;
     void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
@@ -106,6 +111,11 @@ public: // Editor properties
     /// If true, don't read back the raw alpha value from the render target but set it to 1
     UPROPERTY(EditAnywhere, Category = "SceneCapture")
     bool bIgnoreReadbackAlpha;
+
+    /// Number of frames the pixels readback can be in flight before the render thread map them
+    /// NOTE: With a depth of 1 the render thread wait for the GPU to finish copying the pixels right after the capture
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SceneCapture", meta = (ClampMin = "1", UIMin = "1", ClampMax = "8", UIMax = "8"))
+    int32 ReadbackRingDepth;
 protected: // Transient properties
     FNVTextureRenderTargetReader RenderTargetReader;
     TArray<UNVSceneCaptureComponent2D::OnFinishedCaptureScenePixelsDataCallback> ReadbackCallbackList;
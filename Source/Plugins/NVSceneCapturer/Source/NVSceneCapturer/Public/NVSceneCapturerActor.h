@@ -12,6 +12,8 @@
 #include "NVSceneCapturerViewpointComponent.h"
 #include "NVImageExporter.h"
 #include "NVSceneDataHandler.h"
+#include "NVSceneWorldSnapshot.h"
+#include "NVFrameRangeShard.h"
 #include "NVSceneCapturerActor.generated.h"
 
 USTRUCT(BlueprintType)
@@ -193,8 +195,29 @@ public:
     /// Control what to do with the captured scene data
 	UNVSceneDataVisualizer* GetSceneDataVisualizer() const;
 
+    /// Whether the capturer only capture the annotation data, without rendering anything
+    /// NOTE: Always true when the engine can't render (e.g: -nullrhi)
+    UFUNCTION(BlueprintCallable, Category = "Capturer")
+    bool IsAnnotationOnly() const;
+
+    /// The range of frames this capturer capture when the dataset is split between multiple processes, invalid otherwise
+    const FNVFrameRangeShard& GetFrameRangeShard() const
+    {
+        return FrameRangeShard;
+    }
+
+    /// How much captured data the scene data handler has in flight compared to its memory budget
+    /// NOTE: The capturer stop capturing new frames while the handler is throttled
+    FNVMemoryBudgetState GetSceneDataMemoryBudgetState() const;
+
     static TArray<FNVNamedImageSizePreset> const& GetImageSizePresets();
 
+    /// The camera independent data of the actors in the current captured frame, shared by all the viewpoints
+    FNVSceneWorldSnapshot& GetWorldSnapshot()
+    {
+        return WorldSnapshot;
+    }
+
     /// Event properties
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FNVSceneCapturer_Started OnStartedEvent;
@@ -218,8 +241,27 @@ protected:
     void UpdateSettingsFromCommandLine();
     void UpdateViewpointList();
     void StartCapturing_Internal();
-    void CaptureSceneToPixelsData();
+    /// @param CaptureCredit - The credit of the captured frame, kept by the captured data until the scene data handler handled them
+    void CaptureSceneToPixelsData(const FNVCaptureCreditPtr& CaptureCredit);
     void CheckCaptureScene();
+    /// Get a credit from the scene data handler to capture the current frame
+    /// If bPauseGameLogicWhenFlushing is true, block the game thread until the handler retire the credit of an older frame
+    FNVCaptureCreditPtr AcquireCaptureCredit();
+    /// Advance the simulation and the world's capture clock by a fixed step for each captured frame
+    void BeginFixedCaptureTimeStep();
+    void EndFixedCaptureTimeStep();
+    bool ShouldUseFixedCaptureTimeStep() const;
+    /// Seed the random streams for the randomization of a frame, only if bUseFixedRandomSeed is true
+    void SeedFrameRandomization(int32 FrameIndex);
+    /// Launch a capturer process for each frame range shard instead of capturing in this process
+    void LaunchFrameRangeShards();
+    /// Whether the randomization is restored from a log (-ReplayRandomization=) instead of being randomized
+    bool IsReplayingRandomization() const;
+    /// Start writing the randomization log in the scene data exporter's output directory
+    void StartRecordingRandomizationLog();
+    void StopRecordingRandomizationLog();
+    /// Save the randomized capturer settings to the randomization log, or restore them from it
+    void SerializeRandomizationState(FArchive& Ar);
     void UpdateCapturerSettings();
     void OnCompleted();
     bool CanHandleMoreSceneData() const;
@@ -266,10 +308,49 @@ protected: // Editor properties
     UPROPERTY(EditAnywhere, Instanced, BlueprintReadOnly, Category = "Capture")
     class UNVSceneDataVisualizer* SceneDataVisualizer;
 
-    /// If true, the capturer will pause the game logic when it's trying to flushing - handle the scene data from previous frame
+    /// If true, the game logic doesn't advance while the scene data handler is flushing the data of the previous frames:
+    /// the capturer wait for a capture credit before letting the frame go on
+    /// Otherwise the frames are skipped until the handler can handle more data
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
     bool bPauseGameLogicWhenFlushing;
 
+    /// If true, while capturing the simulation advance by a fixed step (TimeBetweenSceneCapture, or the engine's fixed delta time) for each frame
+    /// and the world's capture clock, which drive the randomization timers, only advance when a frame is captured
+    /// so the captured dataset doesn't depend on how fast the machine render and export the frames
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+    bool bUseFixedStepCaptureClock;
+
+    /// If true, only the annotation data are captured: the pixels feature extractors are not created and nothing is rendered
+    /// so the capturer can run without a GPU (e.g: with -nullrhi) and capture the frames as fast as the CPU allows
+    /// NOTE: The simulation always advance by the fixed step capture clock in this mode
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+    bool bAnnotationOnly;
+
+    /// If true, the random streams are seeded from RandomSeed and the frame's index at the start of each captured frame
+    /// so the same seed always produce the same frames, even when the dataset is split between multiple processes
+    /// NOTE: Set with -RandomSeed=
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+    bool bUseFixedRandomSeed;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture", meta = (EditCondition = "bUseFixedRandomSeed"))
+    int32 RandomSeed;
+
+    /// If true, the randomized state of the scene (transforms, meshes, materials, lights, spawned actors...) is logged for each captured frame
+    /// so the frames can be re-rendered later without running the randomization (-ReplayRandomization=<log file or directory>)
+    /// NOTE: The log is written in the scene data exporter's output directory
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+    bool bRecordRandomizationLog;
+
+    /// Time (in seconds) the game thread wait for a capture credit before a warning is logged
+    /// NOTE: The frame is never skipped, the capturer keep waiting (and warning) until the handler retire a credit
+    UPROPERTY(EditAnywhere, AdvancedDisplay, BlueprintReadOnly, Category = "Capture", meta = (ClampMin = 0, UIMin = 0, EditCondition = "bPauseGameLogicWhenFlushing"))
+    float CaptureCreditWaitWarningTime;
+
+    /// Maximum time (in seconds) the game thread wait for a capture credit
+    /// NOTE: The handler is considered stuck after that, an error is logged and the capturer stop capturing
+    UPROPERTY(EditAnywhere, AdvancedDisplay, BlueprintReadOnly, Category = "Capture", meta = (ClampMin = 1, UIMin = 1, EditCondition = "bPauseGameLogicWhenFlushing"))
+    float MaxCaptureCreditWaitTime;
+
     /// List of available image size presets
     UPROPERTY(config)
     TArray<FNVNamedImageSizePreset> ImageSizePresets;
@@ -290,6 +371,9 @@ protected: // Transient properties
     UPROPERTY(Transient)
     FNVFrameCounter CapturedFrameCounter;
 
+    /// Invalidated at the start of each captured frame
+    FNVSceneWorldSnapshot WorldSnapshot;
+
     UPROPERTY(Transient)
     AActor* CachedPlayerControllerViewTarget;
 
@@ -308,6 +392,22 @@ protected: // Transient properties
     UPROPERTY(Transient)
     bool bSkipFirstFrame;
 
+    /// Whether the capturer overrode the engine's fixed time step, and the settings to restore after capturing
+    bool bUsingFixedCaptureTimeStep;
+    bool bSavedUseFixedTimeStep;
+    double SavedFixedDeltaTime;
+
+    /// The range of frames this process capture when it's one of the frame range shards (-ShardCount= and -ShardIndex=)
+    /// The frames before the range are simulated without being captured
+    FNVFrameRangeShard FrameRangeShard;
+
+    /// Number of capturer processes to launch when this process only launch the frame range shards (-ShardCount= without -ShardIndex=)
+    int32 FrameRangeShardLaunchCount;
+    TSharedPtr<FNVFrameRangeShardLauncher> FrameRangeShardLauncher;
+
+    /// The first frame to re-render when replaying a randomization log, the frames before it are skipped
+    int32 ReplayStartFrame;
+
     UPROPERTY(Transient)
     FTimerHandle TimeHandle_StartCapturingDelay;
 
@@ -37,6 +37,10 @@ enum class ENVImageFormat : uint8
     /// Windows Bitmap.
     BMP               UMETA(DisplayName = "BMP (Windows Bitmap"),
 
+    /// Quite OK Image, lossless and much faster to compress than PNG but the files are bigger.
+    /// NOTE: Only support 8 bits per channel images, the other pixel formats are exported as PNG
+    QOI               UMETA(DisplayName = "QOI (Quite OK Image, fast lossless)"),
+
     // OpenEXR (HDR) image file format
     // TODO: Support HDR format
     // EXR UMETA(DisplayName = "EXR (OpenEXR (HDR) image"),
@@ -74,14 +78,42 @@ enum ENVCapturedPixelFormat
 };
 ETextureRenderTargetFormat ConvertCapturedFormatToRenderTargetFormat(ENVCapturedPixelFormat PixelFormat);
 
+/// Immutable, ref-counted buffer of pixels
+/// NOTE: The buffer is shared between all the copies of a FNVTexturePixelData so it must never be modified after it's built
+typedef TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> FNVPixelBufferPtr;
+
+/// Immutable, ref-counted buffer of serialized json (UTF-8) data
+typedef TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> FNVJsonBufferPtr;
+
+class FNVJsonStreamWriter;
+
+/// Pixels data read back from a texture
+/// NOTE: Copying this struct only copy the reference to the pixels buffer, the pixels themselves are never duplicated
 USTRUCT()
-struct FNVTexturePixelData
+struct NVSCENECAPTURER_API FNVTexturePixelData
 {
     GENERATED_BODY()
 
 public:
-    UPROPERTY(Transient)
-    TArray<uint8> PixelData;
+    FNVTexturePixelData();
+
+    /// Take ownership of the pixels buffer, the buffer is moved (not copied) into the shared buffer
+    void SetPixelData(TArray<uint8>&& NewPixelData);
+    /// Use an already built pixels buffer, e.g: one from FNVPixelBufferPool
+    void SetPixelBuffer(const FNVPixelBufferPtr& NewPixelBuffer);
+
+    /// Get the read-only pixels buffer, return an empty array if there's no pixels
+    const TArray<uint8>& GetPixelData() const;
+    const uint8* GetPixels() const;
+    int32 GetPixelsByteSize() const;
+
+    /// Number of pixels buffers built from the read back textures since the counter was reset
+    static int32 GetPixelsBufferCount();
+    /// Reset the pixels buffer counter, e.g: when a new capture start
+    static void ResetPixelsBufferCount();
+
+public:
+    FNVPixelBufferPtr PixelBuffer;
 
     EPixelFormat PixelFormat;
     UPROPERTY(Transient)
@@ -200,6 +232,10 @@ public:
 
     UPROPERTY()
     FVector2D bottom_right;
+
+public:
+    /// Write the exported properties to json, the same as NVSceneCapturerUtils::UStructToJsonObject
+    void WriteJson(FNVJsonStreamWriter& JsonWriter) const;
 };
 
 USTRUCT()
@@ -304,6 +340,11 @@ public:    // Properties
     TArray<FNVSocketData> socket_data;
 
     TSharedPtr<FJsonObject> custom_data;
+
+public:
+    /// Write the exported (non transient) properties and the custom data to json, the same as NVSceneCapturerUtils::UStructToJsonObject
+    /// NOTE: The properties must be written in the order they are declared
+    void WriteJson(FNVJsonStreamWriter& JsonWriter) const;
 };
 
 USTRUCT()
@@ -332,6 +373,9 @@ public: // Editor properties
     float fov;
 
     // TODO: Add the view projection matrix
+
+public:
+    void WriteJson(FNVJsonStreamWriter& JsonWriter) const;
 };
 
 USTRUCT()
@@ -345,6 +389,13 @@ public: // Editor properties
 
     UPROPERTY()
     TArray<FCapturedObjectData> Objects;
+
+public:
+    void WriteJson(FNVJsonStreamWriter& JsonWriter) const;
+
+    /// Serialize the scene data to an UTF-8 json buffer without building a FJsonObject first
+    /// The result is the same as serializing NVSceneCapturerUtils::UStructToJsonObject of this struct with SaveJsonObjectToFile
+    FNVJsonBufferPtr ToJsonBuffer() const;
 };
 
 USTRUCT()
@@ -371,6 +422,11 @@ public:
 
 	bool IsValid() const { return bIncludeMe && !Tag.IsEmpty();  }
 
+protected:
+    /// Register the owner actor with the world's FNVCapturableActorIndex
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public: // Editor properties
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
     FString Tag;
@@ -556,6 +612,29 @@ protected:
     float FPSAccumulatedDuration;
 };
 
+/// Collect the checks of a console self test (e.g: 'NV.TestCaptureClock') and print the failed ones to the log
+struct NVSCENECAPTURER_API FNVSelfTestResult
+{
+public:
+    /// @param InTestName       Name of the tested feature, printed in front of each message (e.g: "Capture clock")
+    /// @param InLogCategory    The log category of the tested module
+    FNVSelfTestResult(const TCHAR* InTestName, const FLogCategoryBase& InLogCategory);
+
+    /// Log the description of a check as an error if its condition is false
+    void Check(bool bCondition, const TCHAR* Description);
+    bool HasPassed() const
+    {
+        return bPassed;
+    }
+    /// Log whether all the checks passed and return it
+    bool Finish() const;
+
+protected:
+    FString TestName;
+    const FLogCategoryBase& LogCategory;
+    bool bPassed;
+};
+
 namespace NVSceneCapturerUtils
 {
     extern const FMatrix UE4ToOpenCVMatrix;
@@ -567,6 +646,8 @@ namespace NVSceneCapturerUtils
     //================ Helper functions ================
     NVSCENECAPTURER_API FQuat ConvertQuaternionToOpenCVCoordinateSystem(const FQuat& InQuat);
     NVSCENECAPTURER_API FVector ConvertDimensionToOpenCVCoordinateSystem(const FVector& InDimension);
+    /// Round a value to 4 decimal digits, used for all the exported floating point values
+    NVSCENECAPTURER_API float ConvertFloatWithPrecision4(const float InValue);
 
     NVSCENECAPTURER_API FString GetGameDataOutputFolder();
     NVSCENECAPTURER_API FString GetDefaultDataOutputFolder();
@@ -589,6 +670,9 @@ namespace NVSceneCapturerUtils
         return JsonObj;
     }
 
+    /// Serialize a json object to the same string SaveJsonObjectToFile write to the file
+    NVSCENECAPTURER_API bool SerializeJsonObjectToString(const TSharedPtr<FJsonObject>& JsonObjData, FString& OutJsonString);
+
     NVSCENECAPTURER_API bool SaveJsonObjectToFile(const TSharedPtr<FJsonObject>& JsonObjData, const FString& Filename);
 
     NVSCENECAPTURER_API FString GetExportImageExtension(EImageFormat ImageFormat);
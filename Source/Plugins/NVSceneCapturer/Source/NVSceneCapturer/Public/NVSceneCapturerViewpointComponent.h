@@ -68,24 +68,30 @@ class NVSCENECAPTURER_API UNVSceneCapturerViewpointComponent : public USceneComp
 public:
     UNVSceneCapturerViewpointComponent(const FObjectInitializer& ObjectInitializer);
 
-    /// Callback function get called after the scene capture component finished capturing scene and read back its pixels data
+    /// Callback function get called on a worker thread after the scene capture component finished capturing scene and read back its pixels data
     /// FNVTexturePixelData - The struct contain the captured scene's pixels data
-    /// UNVSceneFeatureExtractor_PixelData* - Reference to the feature extractor that captured the scene pixels data
-    /// UNVSceneCapturerViewpointComponent* - Reference to the viewpoint that captured the scene pixels data
-    typedef TFunction<void(const FNVTexturePixelData&, UNVSceneFeatureExtractor_PixelData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureScenePixelsDataCallback;
+    typedef TFunction<void(const FNVTexturePixelData&)> OnFinishedCaptureScenePixelsDataCallback;
+
+    /// Callback function get called on the game thread before a feature extractor capture the scene's pixels data
+    /// UNVSceneFeatureExtractor_PixelData* - Reference to the feature extractor that capture the scene pixels data
+    /// UNVSceneCapturerViewpointComponent* - Reference to the viewpoint that capture the scene pixels data
+    /// Return the callback handling the read back pixels data, nullptr if they don't need to be handled
+    typedef TFunction<OnFinishedCaptureScenePixelsDataCallback(UNVSceneFeatureExtractor_PixelData*, UNVSceneCapturerViewpointComponent*)> OnPrepareCaptureScenePixelsDataCallback;
 
-    bool CaptureSceneToPixelsData(UNVSceneCapturerViewpointComponent::OnFinishedCaptureScenePixelsDataCallback Callback);
+    bool CaptureSceneToPixelsData(UNVSceneCapturerViewpointComponent::OnPrepareCaptureScenePixelsDataCallback PrepareCallback);
 
     /// Callback function get called after the scene capture component finished capturing scene's annotation data
-    /// TSharedPtr<FJsonObject> - The JSON object contain the annotation data
+    /// FNVJsonBufferPtr - The annotation data, already serialized to json (UTF-8)
     /// UNVSceneFeatureExtractor_AnnotationData* - Reference to the feature extractor that captured the scene annotation data
     /// UNVSceneCapturerViewpointComponent* - Reference to the viewpoint that captured the scene pixels data
-    typedef TFunction<void(TSharedPtr<FJsonObject>, UNVSceneFeatureExtractor_AnnotationData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureSceneAnnotationDataCallback;
+    typedef TFunction<void(const FNVJsonBufferPtr&, UNVSceneFeatureExtractor_AnnotationData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureSceneAnnotationDataCallback;
 
     bool CaptureSceneAnnotationData(UNVSceneCapturerViewpointComponent::OnFinishedCaptureSceneAnnotationDataCallback Callback);
 
-    void SetupFeatureExtractors();
-    void UpdateCapturerSettings();
+    /// @param bAnnotationOnly - If true, the pixels feature extractors are skipped
+    void SetupFeatureExtractors(bool bAnnotationOnly = false);
+    /// @param bRandomizeSettings - If false, the current capture settings are only applied to the feature extractors
+    void UpdateCapturerSettings(bool bRandomizeSettings = true);
     const FNVSceneCapturerViewpointSettings& GetSettings() const;
     const FNVSceneCapturerSettings& GetCapturerSettings() const;
     const TArray<FNVFeatureExtractorSettings>& GetFeatureExtractorSettings() const;
@@ -8,6 +8,8 @@
 
 #include "NVSceneCapturerUtils.h"
 #include "NVImageExporter.h"
+#include "NVTarShardWriter.h"
+#include "NVCaptureCreditPool.h"
 #include "NVSceneDataHandler.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogNVSceneDataHandler, Log, All)
@@ -21,30 +23,52 @@ class NVSCENECAPTURER_API UNVSceneDataHandler : public UObject
     GENERATED_BODY()
 
 public:
-    UNVSceneDataHandler() { };
+    UNVSceneDataHandler();
 
     /// Check whether this handler can process more scene data
     /// If it can't then we should stop getting more data until it's available again
     virtual bool CanHandleMoreData() const PURE_VIRTUAL(UNVSceneDataHandler::CanHandleMoreData, return false; );
 
+    /// Get how much captured data this handler has in flight compared to its memory budget
+    /// NOTE: The handlers without a memory budget only report whether they can handle more data
+    virtual FNVMemoryBudgetState GetMemoryBudgetState() const;
+
     virtual bool IsHandlingData() const PURE_VIRTUAL(UNVSceneDataHandler::IsHandlingData, return false; );
 
-    /// Handle the pixels data captured from the scene
-    /// @param CapturedPixelData - The scene's pixels data
-    /// @param CapturedFeatureExtractor - The feature extractor which captured the data
-    /// @param CapturedViewpoint - The viewpoint which captured the data
+    /// Take a credit to capture a new frame
+    /// The credit is retired when all the data of the frame are handled, so at most MaxCapturedFramesInFlight frames are in flight
+    /// return nullptr if the capturer must wait before capturing the frame
+    virtual FNVCaptureCreditPtr AcquireCaptureCredit(int32 FrameIndex);
+
+    /// Find the outstanding credit of a captured frame, the handler keep it with the frame's data until they are handled
+    FNVCaptureCreditPtr FindCaptureCredit(int32 FrameIndex) const;
+
+    /// Wait until the credit of a frame is retired or the time out is reached
+    /// return true if a credit was retired
+    bool WaitForCaptureCredit(float TimeOutSeconds);
+
+    FNVCaptureCreditStats GetCaptureCreditStats() const;
+
+    /// Function handling the pixels read back for a feature extractor, it's called on a worker thread when the readback is completed
+    typedef TFunction<bool(const FNVTexturePixelData&)> FNVScenePixelsDataHandler;
+
+    /// Prepare the handling of the pixels a feature extractor is about to read back from the scene
+    /// NOTE: Called on the game thread when the readback is issued, everything needed to handle the pixels (e.g: export path, image format, capture credit)
+    /// must be resolved here: the returned function run on a worker thread and must not access the handler or any other UObject
+    /// @param CapturedFeatureExtractor - The feature extractor which capture the data
+    /// @param CapturedViewpoint - The viewpoint which capture the data
     /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
-        class UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
+    /// @return The function handling the read back pixels, nullptr if the pixels don't need to be handled
+    virtual FNVScenePixelsDataHandler PrepareScenePixelsData(class UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
         class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-        int32 FrameIndex) PURE_VIRTUAL(UNVSceneDataHandler::HandleScenePixelsData, return false; );
+        int32 FrameIndex) PURE_VIRTUAL(UNVSceneDataHandler::PrepareScenePixelsData, return nullptr; );
 
     /// Handle the annotation data captured from the scene
-    /// @param CapturedData  - The scene's annotated data
+    /// @param CapturedData  - The scene's annotated data, serialized to json (UTF-8)
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
     /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+    virtual bool HandleSceneAnnotationData(const FNVJsonBufferPtr& CapturedData,
         class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
         class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
         int32 FrameIndex) PURE_VIRTUAL(UNVSceneDataHandler::HandleSceneAnnotationData, return false; );
@@ -52,6 +76,14 @@ public:
     virtual void OnStartCapturingSceneData() PURE_VIRTUAL(UNVSceneDataHandler::OnStartCapturingSceneData, return; );
     virtual void OnStopCapturingSceneData() PURE_VIRTUAL(UNVSceneDataHandler::OnStopCapturingSceneData, return; );
     virtual void OnCapturingCompleted() PURE_VIRTUAL(UNVSceneDataHandler::OnCapturingCompleted, return; );
+
+protected: // Editor properties
+    /// Maximum number of captured frames whose data are still being handled before the capturer wait for the handler
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture", meta = (ClampMin = 1, UIMin = 1))
+    int32 MaxCapturedFramesInFlight;
+
+protected: // Transient
+    TSharedPtr<FNVCaptureCreditPool, ESPMode::ThreadSafe> CaptureCreditPool;
 };
 
 //=================================== UNVSceneDataExporter ===================================
@@ -84,24 +116,22 @@ public:
     /// Check whether this handler can process more scene data
     /// If it can't then we should stop getting more data until it's available again
     virtual bool CanHandleMoreData() const override;
+    /// The raw pixels and encoded data in flight in the image exporter are checked against ImageExporterSettings.MemoryBudgetMB
+    virtual FNVMemoryBudgetState GetMemoryBudgetState() const override;
     virtual bool IsHandlingData() const override;
 
-    /// Handle the pixels data captured from the scene
-    /// @param CapturedPixelData - The scene's pixels data
-    /// @param CapturedFeatureExtractor - The feature extractor which captured the data
-    /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
-                                       UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
-                                       UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-                                       int32 FrameIndex) override;
+    /// Resolve the export path, image format and capture credit of the pixels on the game thread
+    /// The returned function only queue the read back pixels and their resolved settings in the image exporter
+    virtual FNVScenePixelsDataHandler PrepareScenePixelsData(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
+                                                             UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+                                                             int32 FrameIndex) override;
 
     /// Handle the annotation data captured from the scene
-    /// @param CapturedData  - The scene's annotated data
+    /// @param CapturedData  - The scene's annotated data, serialized to json (UTF-8)
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
     /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+    virtual bool HandleSceneAnnotationData(const FNVJsonBufferPtr& CapturedData,
                                            class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
                                            class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
                                            int32 FrameIndex) override;
@@ -135,9 +165,24 @@ public:
 
     uint32 GetPendingToExportImagesCount() const;
 
+    /// Get the queue depth and latency statistics of the image exporter
+    UFUNCTION(BlueprintCallable, Category = "Exporter")
+    FNVImageExporterStats GetImageExporterStats() const;
+
 protected:
     void ExportCapturerSettings();
 
+    /// Create the threads exporting the captured images
+    virtual TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> CreateImageExporterThread();
+
+    /// Get a reference to the current image exporter thread so it stays alive while it's used
+    /// NOTE: Safe to call from any thread, the exporter is only replaced on the game thread while holding ImageExporterThreadLock
+    TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> GetImageExporterThread() const;
+
+    /// Get the image format a feature extractor's pixels are requested to be exported to
+    /// NOTE: Called on the game thread, the format is only adjusted to the read back pixels' format by the handling worker
+    virtual ENVImageFormat GetPixelsExportImageFormat(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor) const;
+
 public: // Editor properties
     // ToDo: move to protected.
     /// If true, the exporter will use the current map's name for the export folder, otherwise it will use the ExportFolderName
@@ -161,9 +206,20 @@ protected: // Editor properties
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Capture")
     bool bAutoOpenExportedDirectory;
 
+    /// Maximum number of images and data files in flight before the capturer wait for the exporter
+    /// NOTE: Only used when ImageExporterSettings.MemoryBudgetMB is 0, otherwise the exporter is throttled by the size of the data in flight
     UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture")
     uint32 MaxSaveImageAsyncCount;
 
+    /// Settings of the worker threads exporting the captured images
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture")
+    FNVImageExporterSettings ImageExporterSettings;
+
+    /// Maximum size (in MB) of the free pixels buffers kept to be reused for the next captured frames
+    /// NOTE: 0 mean the buffers are freed right after they are exported
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture", meta = (UIMin = 0))
+    int32 MaxPooledPixelsBufferSizeMB;
+
 protected: // Transient
     UPROPERTY(Transient)
     FString SubFolderName;
@@ -171,12 +227,50 @@ protected: // Transient
     UPROPERTY(Transient)
     FString FullOutputDirectoryPath;
 
-    TUniquePtr<FNVImageExporter_Thread> ImageExporterThread;
+    /// NOTE: Only changed on the game thread while holding ImageExporterThreadLock
+    TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> ImageExporterThread;
+    mutable FCriticalSection ImageExporterThreadLock;
     IImageWrapperModule* ImageWrapperModule;
 
     static const FString DefaultDataOutputFolder;
 };
 
+//=================================== UNVSceneDataShardExporter ===================================
+///
+/// NVSceneDataShardExporter - export all the captured data into a sequence of tar shards (WebDataset style) instead of one file per image/annotation
+/// Each shard has an index file (<shard name>.index.json) listing the offset and size of all the files in it
+/// NOTE: The files are added to the shards in the order the exporter's workers finished them, use the index to look up a file
+///
+UCLASS(Blueprintable, ClassGroup = (NVIDIA))
+class NVSCENECAPTURER_API UNVSceneDataShardExporter : public UNVSceneDataExporter
+{
+    GENERATED_BODY()
+
+public:
+    UNVSceneDataShardExporter();
+
+    virtual void OnStopCapturingSceneData() override;
+    virtual void OnCapturingCompleted() override;
+
+    /// Get the number of shards created in the current capturing session
+    UFUNCTION(BlueprintCallable, Category = "Exporter")
+    int32 GetShardCount() const;
+
+protected:
+    virtual TSharedPtr<FNVImageExporter_Thread, ESPMode::ThreadSafe> CreateImageExporterThread() override;
+    virtual ENVImageFormat GetPixelsExportImageFormat(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor) const override;
+
+    /// Wait for the exporting images to be written then finish the current shard
+    void CloseShardWriter();
+
+protected: // Editor properties
+    UPROPERTY(EditAnywhere, Category = "Shard")
+    FNVShardWriterSettings ShardWriterSettings;
+
+protected: // Transient
+    TSharedPtr<FNVTarShardWriter, ESPMode::ThreadSafe> ShardWriter;
+};
+
 //=================================== UNVSceneDataVisualizer ===================================
 ///
 /// NVSceneDataVisualizer - visualize all the captured data (image buffer and object annotation info) using material, UI
@@ -193,22 +287,16 @@ public:
     virtual bool CanHandleMoreData() const override;
     virtual bool IsHandlingData() const override;
 
-    /// Handle the pixels data captured from the scene
-    /// @param CapturedPixelData - The scene's pixels data
-    /// @param CapturedFeatureExtractor - The feature extractor which captured the data
-    /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
-                                       UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
-                                       UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-                                       int32 FrameIndex) override;
+    virtual FNVScenePixelsDataHandler PrepareScenePixelsData(UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
+                                                             UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+                                                             int32 FrameIndex) override;
 
     /// Handle the annotation data captured from the scene
-    /// @param CapturedData  - The scene's annotated data
+    /// @param CapturedData  - The scene's annotated data, serialized to json (UTF-8)
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
     /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+    virtual bool HandleSceneAnnotationData(const FNVJsonBufferPtr& CapturedData,
         class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
         class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
         int32 FrameIndex) override;
@@ -8,6 +8,8 @@
 
 #include "NVSceneFeatureExtractor.h"
 #include "NVSceneCapturerUtils.h"
+#include "NVSceneWorldSnapshot.h"
+#include "ConvexVolume.h"
 #include "NVSceneFeatureExtractor_DataExport.generated.h"
 
 USTRUCT(BlueprintType)
@@ -59,28 +61,29 @@ public:
     virtual void UpdateCapturerSettings() override;
 
     /// Callback function get called after capturing scene's annotation data
-    /// TSharedPtr<FJsonObject> - The JSON object contain the annotation data
+    /// FNVJsonBufferPtr - The annotation data, already serialized to json (UTF-8)
     /// UNVSceneFeatureExtractor_AnnotationData* - Reference to the feature extractor that captured the scene annotation data
-    typedef TFunction<void(TSharedPtr<FJsonObject>, UNVSceneFeatureExtractor_AnnotationData*)> OnFinishedCaptureSceneAnnotationDataCallback;
+    typedef TFunction<void(const FNVJsonBufferPtr&, UNVSceneFeatureExtractor_AnnotationData*)> OnFinishedCaptureSceneAnnotationDataCallback;
 
     /// Capture the annotation data of the scene and return it in JSON format
     bool CaptureSceneAnnotationData(UNVSceneFeatureExtractor_AnnotationData::OnFinishedCaptureSceneAnnotationDataCallback Callback);
 
 protected:
-    TSharedPtr<FJsonObject> CaptureSceneAnnotationData();
+    FNVJsonBufferPtr CaptureSceneAnnotationData();
     virtual void UpdateSettings() override;
 
     void UpdateProjectionMatrix();
-    /// NOTE: May make this function static
-    bool GatherActorData(const AActor* CheckActor, FCapturedObjectData& ActorData);
-    bool ShouldExportActor(const AActor* CheckActor) const;
-    bool IsActorInViewFrustum(const FConvexVolume& ViewFrustum, const AActor* CheckActor) const;
+    /// Fill in the actor's data for this viewpoint
+    /// NOTE: The camera independent data come from the actor's snapshot, only the projection and visibility are calculated here
+    bool GatherActorData(const FNVActorWorldSnapshot& ActorSnapshot, FCapturedObjectData& ActorData);
+    bool ShouldExportActor(const FNVActorWorldSnapshot& ActorSnapshot) const;
+    bool IsActorInViewFrustum(const FConvexVolume& CheckViewFrustum, const FNVActorWorldSnapshot& ActorSnapshot) const;
 
     FVector ProjectWorldPositionToImagePosition(const FVector& WorldPosition) const;
 
-    FBox2D GetBoundingBox2D(const AActor* CheckActor, bool bClampToImage = true) const;
+    FBox2D GetBoundingBox2D(const FNVActorWorldSnapshot& ActorSnapshot, bool bClampToImage = true) const;
     /// Calculate a 2D axis-aligned bounding box of a 3d shape knowing its vertexes on the viewport
-    FBox2D Calculate2dAABB(TArray<FVector> Vertexes, bool bClampToImage = true) const;
+    FBox2D Calculate2dAABB(const TArray<FVector>& Vertexes, bool bClampToImage = true) const;
     /// Calculate a 2D axis-aligned bounding box of a static mesh on the viewport
     FBox2D Calculate2dAABB_MeshComplexCollision(const class UMeshComponent* CheckMeshComp, bool bClampToImage = true) const;
 
@@ -96,4 +99,10 @@ protected: // Editor properties
 
 protected: // Transient properties
     FNVDataExportSettings ProtectedDataExportSettings;
+
+    /// The view frustum of the viewpoint, updated with the projection matrix
+    FConvexVolume ViewFrustum;
+
+    /// Snapshot used when the extractor doesn't have an owner capturer to share it with
+    FNVSceneWorldSnapshot LocalWorldSnapshot;
 };
@@ -43,6 +43,10 @@ public:
 
     virtual class UTextureRenderTarget2D* GetRenderTarget() const;
 
+    /// Get the image format this feature extractor's captured images should be exported to
+    /// NOTE: Use the owner viewpoint's capturer settings if this feature extractor doesn't override the export image type
+    ENVImageFormat GetExportImageFormat() const;
+
 protected:
     virtual void UpdateSettings() override;
     virtual void UpdateMaterial();
@@ -0,0 +1,143 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NVSceneCapturerUtils.h"
+
+class AActor;
+class UMeshComponent;
+class FJsonObject;
+
+/// World space location of a mesh socket
+struct NVSCENECAPTURER_API FNVSocketWorldData
+{
+public:
+    FString SocketName;
+    FVector WorldLocation;
+};
+
+/// The camera independent data of an exported actor
+struct NVSCENECAPTURER_API FNVActorWorldExportData
+{
+public:
+    FString Name;
+    /// Name of the class exported in the annotation data, the tag's name if the actor have one or the actor's name otherwise
+    FString Class;
+    uint32 InstanceId;
+
+    FTransform ActorToWorldTransform;
+    FMatrix ActorToWorldMatrix_UE4;
+    FMatrix ActorToWorldMatrix_OpenCV;
+    FVector Location;
+    FVector ForwardDirection;
+    /// The actor's rotation in world space in the OpenCV coordinate system
+    FQuat Quaternion_OpenCV;
+};
+
+///
+/// The camera independent data of an actor in the captured frame
+/// The cheap data needed to decide whether the actor should be exported are gathered when the snapshot is created,
+/// the expensive ones (cuboid, collision vertexes, sockets ...) are only calculated the first time they are requested
+/// NOTE: The snapshot is only valid during the frame it's captured
+///
+class NVSCENECAPTURER_API FNVActorWorldSnapshot
+{
+public:
+    FNVActorWorldSnapshot(const AActor* InActor);
+
+    const AActor* GetActor() const
+    {
+        return Actor;
+    }
+
+    /// The actor's tag component, null if it doesn't have one
+    const UNVCapturableActorTag* GetTag() const
+    {
+        return Tag;
+    }
+
+    /// Name, transform ... of the actor, only needed when it's exported
+    const FNVActorWorldExportData& GetExportData() const;
+
+    /// The first mesh component of the actor which can be exported, null if it doesn't have one
+    UMeshComponent* GetFirstValidMeshComponent() const;
+
+    /// Get the actor's cuboid in world space
+    const FNVCuboidData& GetCuboid(ENVBoundsGenerationType BoundsType) const;
+
+    /// Get the vertexes of the first valid mesh's simple collision in world space
+    const TArray<FVector>& GetSimpleCollisionVertexes() const;
+
+    /// Get the vertexes of all the meshes' collision bodies (or their render data when they don't have any) in world space
+    const TArray<FVector>& GetMeshCollisionVertexes() const;
+
+    /// Get the world location of the sockets the actor's tag want to export
+    const TArray<FNVSocketWorldData>& GetSockets() const;
+
+    TSharedPtr<FJsonObject> GetCustomData() const;
+
+    /// Get the vertexes of a mesh's collision bodies (or its render data when it doesn't have any) in world space
+    static void GatherMeshCollisionVertexes(const UMeshComponent* CheckMeshComp, TArray<FVector>& OutVertexes);
+
+public:
+    bool bHidden;
+    /// True if the actor have any mesh component
+    bool bHasMeshComponent;
+    /// Bounding box of all the actor's components, including the non-colliding ones
+    FBox ComponentsBoundingBox;
+
+protected:
+    const AActor* Actor;
+    const UNVCapturableActorTag* Tag;
+
+    mutable bool bExportDataCached;
+    mutable FNVActorWorldExportData ExportData;
+
+    mutable bool bValidMeshComponentCached;
+    mutable UMeshComponent* FirstValidMeshComponent;
+
+    mutable uint8 CachedCuboidFlags;
+    mutable FNVCuboidData Cuboids[3];
+
+    mutable bool bSimpleCollisionVertexesCached;
+    mutable TArray<FVector> SimpleCollisionVertexes;
+
+    mutable bool bMeshCollisionVertexesCached;
+    mutable TArray<FVector> MeshCollisionVertexes;
+
+    mutable bool bSocketsCached;
+    mutable TArray<FNVSocketWorldData> Sockets;
+
+    mutable bool bCustomDataCached;
+    mutable TSharedPtr<FJsonObject> CustomData;
+};
+
+///
+/// Cache of the camera independent actor data of the current captured frame
+/// All the viewpoints of a capturer capture the same frame so they share the snapshot
+/// and each of them only need to do the camera dependent projection and visibility work
+///
+class NVSCENECAPTURER_API FNVSceneWorldSnapshot
+{
+public:
+    FNVSceneWorldSnapshot();
+
+    /// Drop the cached data, need to be called at the start of each captured frame
+    void Invalidate();
+
+    /// Get the snapshot of an actor, it's created the first time the actor is requested in the frame
+    const FNVActorWorldSnapshot* GetActorSnapshot(const AActor* CheckActor);
+
+    int32 GetActorSnapshotCount() const
+    {
+        return ActorSnapshots.Num();
+    }
+
+protected:
+    TMap<const AActor*, TUniquePtr<FNVActorWorldSnapshot>> ActorSnapshots;
+};
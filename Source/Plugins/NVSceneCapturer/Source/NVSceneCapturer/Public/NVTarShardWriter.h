@@ -0,0 +1,171 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "NVTarShardWriter.generated.h"
+
+/// Settings of the shard files the captured data are packed into
+USTRUCT(BlueprintType)
+struct NVSCENECAPTURER_API FNVShardWriterSettings
+{
+    GENERATED_BODY()
+
+public:
+    FNVShardWriterSettings();
+
+public: // Editor properties
+    /// Prefix of the shard files' name, the shards are named <prefix>_<shard index>.tar
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shard")
+    FString ShardFileNamePrefix;
+
+    /// A new shard is started when the current one is bigger than this size (in MB)
+    /// NOTE: 0 mean there is no size limit
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shard", meta = (UIMin = 0))
+    int32 MaxShardSizeMB;
+
+    /// A new shard is started when the current one already contain this many frames
+    /// NOTE: 0 mean there is no frame count limit
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shard", meta = (UIMin = 0))
+    int32 MaxFramesPerShard;
+
+    /// Maximum size (in MB) of the files of the new frames kept in memory while a full shard wait for its pending frames
+    /// Past this size the shard is rolled over right away and the late files of its pending frames go to the next shard
+    /// NOTE: 0 mean there is no limit, the kept files still count in the exporter's memory budget
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Shard", meta = (UIMin = 0))
+    int32 MaxDeferredSizeMB;
+
+    /// If true, the files in the shards are stamped with the time they were written
+    /// NOTE: By default their time is 0 so capturing the same frames again produce the same shards byte for byte
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Shard")
+    bool bWriteFileTimestamps;
+};
+
+/// An entry in the index of a shard
+USTRUCT()
+struct NVSCENECAPTURER_API FNVTarShardIndexEntry
+{
+    GENERATED_BODY()
+
+public:
+    /// Name of the file in the shard
+    UPROPERTY()
+    FString name;
+
+    /// Index of the frame the file belong to
+    UPROPERTY()
+    int32 frame_index;
+
+    /// Offset (in bytes) of the file's content from the beginning of the shard
+    UPROPERTY()
+    int64 offset;
+
+    /// Size (in bytes) of the file's content
+    UPROPERTY()
+    int64 size;
+};
+
+/// Index of all the files in a shard, exported next to the shard so a file can be read without scanning the archive
+USTRUCT()
+struct NVSCENECAPTURER_API FNVTarShardIndexData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY()
+    FString shard_name;
+
+    UPROPERTY()
+    int32 frame_count;
+
+    UPROPERTY()
+    int64 byte_size;
+
+    UPROPERTY()
+    TArray<FNVTarShardIndexEntry> entries;
+};
+
+///
+/// Pack files into a sequence of tar (ustar) shards, WebDataset style: the files of a frame share the same name prefix (the frame index)
+/// The shards are only appended to and written sequentially, a shard is closed and its index exported when it reach its size or frame count limit
+/// NOTE: The files of a frame are not split between shards: once a shard is full, the files of the new frames are kept in memory
+/// until none of the frames already in the shard is pending anymore, then they are flushed together into the next shard
+/// Only when the kept files reach MaxDeferredSizeMB the shard is rolled over early, the index tell which frame each file belong to
+/// This writer is thread safe, the files can be added from multiple threads and in any order
+///
+class NVSCENECAPTURER_API FNVTarShardWriter
+{
+public:
+    /// Callback checking whether some files of a frame may still be added
+    typedef TFunction<bool(int32 FrameIndex)> FNVIsFramePendingCallback;
+    /// Callback notified when the size (in bytes) of the files kept in memory for the next shard change
+    typedef TFunction<void(int64 ByteSizeDelta)> FNVDeferredSizeChangedCallback;
+
+    /// @param InIsFramePending   If set, a full shard is only rolled over when none of its frames is pending anymore,
+    ///                           otherwise all the files of a frame must be added before the ones of the next frames
+    FNVTarShardWriter(const FString& InOutputDirectoryPath, const FNVShardWriterSettings& InSettings, FNVIsFramePendingCallback InIsFramePending = nullptr);
+    ~FNVTarShardWriter();
+
+    /// Append a file to the current shard
+    /// @param EntryName     Name of the file in the shard, must be less than 100 characters
+    /// @param FrameIndex    Index of the frame the file belong to
+    /// @param Data          The file's content
+    /// @param DataSize      Size (in bytes) of the file's content
+    bool AddEntry(const FString& EntryName, int32 FrameIndex, const uint8* Data, int64 DataSize);
+    bool AddEntry(const FString& EntryName, int32 FrameIndex, const TArray<uint8>& Data);
+
+    /// Finish the current shard and export its index, no more files can be added after this
+    void Close();
+
+    /// Get the number of shards created so far
+    int32 GetShardCount() const;
+
+    /// Let the owner count the files kept in memory for the next shard, e.g: in the exporter's memory budget so the capturer is throttled
+    void SetDeferredSizeChangedCallback(FNVDeferredSizeChangedCallback InDeferredSizeChanged);
+    /// Size (in bytes) of the files kept in memory for the next shard
+    int64 GetDeferredByteSize() const;
+
+protected:
+    /// A file of a frame which will be written to the next shard
+    struct FNVDeferredEntry
+    {
+        FString EntryName;
+        int32 FrameIndex;
+        TArray<uint8> Data;
+    };
+
+    bool OpenNextShard();
+    void CloseCurrentShard();
+    bool IsCurrentShardFull() const;
+    bool CanRollOverShard() const;
+    /// Close the current shard and write all the deferred files to the next one
+    bool RollOverShard();
+    void ResetDeferredEntries();
+    bool WriteEntry(const FString& EntryName, int32 FrameIndex, const uint8* Data, int64 DataSize);
+    bool WriteEntryHeader(const FString& EntryName, int64 DataSize);
+
+protected:
+    mutable FCriticalSection WriterLock;
+
+    FString OutputDirectoryPath;
+    FNVShardWriterSettings Settings;
+    FNVIsFramePendingCallback IsFramePending;
+    bool bIsClosed;
+
+    /// Handle of the shard file being written, nullptr if there is no opened shard
+    class IFileHandle* ShardFileHandle;
+    int32 ShardCount;
+    int64 ShardByteSize;
+    TSet<int32> ShardFrameIndexes;
+    FNVTarShardIndexData ShardIndexData;
+
+    /// The files of the frames waiting for the current (full) shard to be rolled over, in the order they were added
+    TArray<FNVDeferredEntry> DeferredEntries;
+    int64 DeferredByteSize;
+    FNVDeferredSizeChangedCallback DeferredSizeChanged;
+};
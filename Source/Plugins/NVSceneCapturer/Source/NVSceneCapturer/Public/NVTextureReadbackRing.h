@@ -0,0 +1,209 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+
+/// Statistics of the texture readback rings
+struct NVSCENECAPTURER_API FNVTextureReadbackRingStats
+{
+public:
+    FNVTextureReadbackRingStats();
+
+public:
+    /// Number of staging textures in the ring
+    int32 RingDepth;
+    /// Number of readbacks issued but not mapped yet
+    int32 PendingReadbackCount;
+    /// Number of readbacks mapped but not unmapped yet
+    int32 MappedReadbackCount;
+    /// Number of readbacks issued
+    int32 IssuedReadbackCount;
+    /// Number of readbacks completed, their pixels were passed to the callback
+    int32 CompletedReadbackCount;
+    /// Number of completed readbacks which were flushed out of the ring before their turn
+    int32 FlushedReadbackCount;
+    /// Number of staging textures created
+    int32 StagingTextureAllocationCount;
+    /// Total time (in seconds) spent waiting for the staging textures to be mapped
+    double TotalMapWaitTime;
+    /// Longest time (in seconds) spent waiting for a staging texture to be mapped
+    double MaxMapWaitTime;
+    /// Total time (in seconds) the ring waited for mapped readbacks to be released before reusing their staging textures
+    double TotalReleaseWaitTime;
+};
+
+///
+/// The staging textures used by a readback ring
+/// The texture reader implement them with the RHI, they can also be faked in memory to check the ring without a GPU
+///
+class NVSCENECAPTURER_API INVTextureReadbackStaging
+{
+public:
+    virtual ~INVTextureReadbackStaging() {}
+
+    /// (Re)create the staging texture of a slot in the ring
+    virtual void AllocateStagingTexture(int32 SlotIndex, const FIntPoint& TextureSize, EPixelFormat PixelFormat) = 0;
+    virtual void ReleaseStagingTexture(int32 SlotIndex) = 0;
+
+    /// Map the staging texture of a slot to read its pixels, this wait for the GPU to finish writing to the texture
+    /// @param OutMappedSize    The 2d size of the mapped pixels, the width may be bigger than the texture's width because of the row alignment
+    virtual void* MapStagingTexture(int32 SlotIndex, FIntPoint& OutMappedSize) = 0;
+    virtual void UnmapStagingTexture(int32 SlotIndex) = 0;
+};
+
+///
+/// The pixels of a staging texture mapped by a readback ring
+/// The pixels stay valid until the readback is released, the ring only unmap the staging texture after that
+///
+class NVSCENECAPTURER_API FNVMappedReadback
+{
+public:
+    FNVMappedReadback(uint8* InPixelData, EPixelFormat InPixelFormat, const FIntPoint& InMappedSize);
+    ~FNVMappedReadback();
+
+    uint8* GetPixelData() const
+    {
+        return PixelData;
+    }
+    EPixelFormat GetPixelFormat() const
+    {
+        return PixelFormat;
+    }
+    /// The 2d size of the mapped pixels, the width may be bigger than the texture's width because of the row alignment
+    const FIntPoint& GetMappedSize() const
+    {
+        return MappedSize;
+    }
+
+    /// Let the ring unmap the staging texture, the pixels must not be accessed after this
+    /// NOTE: Safe to call from any thread
+    void Release();
+    bool IsReleased() const;
+    /// Block the calling thread until the readback is released, without spinning
+    void WaitUntilReleased();
+
+protected:
+    uint8* PixelData;
+    EPixelFormat PixelFormat;
+    FIntPoint MappedSize;
+    FThreadSafeCounter ReleasedCounter;
+    /// Triggered when the readback is released
+    FEvent* ReleasedEvent;
+};
+
+typedef TSharedRef<FNVMappedReadback, ESPMode::ThreadSafe> FNVMappedReadbackRef;
+
+///
+/// Ring of staging textures letting a texture reader have multiple readbacks in flight
+/// The readback of frame K is only mapped after the readback of frame K + RingDepth - 1 was issued (or RingDepth - 1 frames passed)
+/// so the GPU have time to finish the copy and the render thread doesn't need to wait for it
+/// The readbacks are always completed in the order they were issued
+/// A completed readback can stay mapped while another thread read its pixels, its staging texture is unmapped on the next ring update after it's released
+/// NOTE: All the functions, except the stats ones, must be called on the same thread (the rendering thread for the RHI staging textures)
+///
+class NVSCENECAPTURER_API FNVTextureReadbackRing
+{
+public:
+    /// Callback function get called when a readback is completed
+    /// uint8* - pointer to the mapped pixels, only valid during the callback
+    /// EPixelFormat - format of the read back pixels
+    /// FIntPoint - 2d size of the mapped pixels
+    typedef TFunction<void(uint8*, EPixelFormat, FIntPoint)> OnReadbackCompletedCallback;
+
+    /// Callback function get called when a readback is mapped
+    /// FNVMappedReadbackRef - The mapped pixels, the callback (or whoever it pass the readback to) must release it when it's done reading the pixels
+    typedef TFunction<void(const FNVMappedReadbackRef&)> OnReadbackMappedCallback;
+
+    FNVTextureReadbackRing(const TSharedRef<INVTextureReadbackStaging, ESPMode::ThreadSafe>& InStaging, int32 InRingDepth);
+    ~FNVTextureReadbackRing();
+
+    int32 GetRingDepth() const
+    {
+        return RingDepth;
+    }
+
+    /// Issue a new readback
+    /// @param TextureSize       The 2d size of the staging texture
+    /// @param PixelFormat       The pixel format of the staging texture
+    /// @param FrameNumber       The frame the readback is issued in
+    /// @param CopyToStaging     Function to copy the source texture to the staging texture of the slot passed in
+    /// @param Callback          Function to call with the pixels when the readback is completed
+    void IssueReadback(const FIntPoint& TextureSize, EPixelFormat PixelFormat, uint64 FrameNumber,
+                       TFunctionRef<void(int32)> CopyToStaging, OnReadbackCompletedCallback Callback);
+
+    /// Issue a new readback whose pixels can be read after the callback returned
+    /// NOTE: If the slot of a mapped readback is needed again before it's released, the ring wait for it to be released
+    void IssueMappedReadback(const FIntPoint& TextureSize, EPixelFormat PixelFormat, uint64 FrameNumber,
+                       TFunctionRef<void(int32)> CopyToStaging, OnReadbackMappedCallback Callback);
+
+    /// Complete the readbacks which were issued at least RingDepth - 1 frames before the current frame
+    void RetireStaleReadbacks(uint64 CurrentFrameNumber);
+
+    /// Complete all the pending readbacks right away and wait for all the mapped readbacks to be released
+    void RetireAllReadbacks();
+
+    /// Unmap the staging textures of the readbacks which were released
+    void UnmapReleasedReadbacks();
+
+    /// Number of readbacks issued but not mapped yet, safe to call from any thread
+    int32 GetPendingReadbackCount() const
+    {
+        return PendingReadbackCounter.GetValue();
+    }
+    /// Number of readbacks mapped but not unmapped yet, safe to call from any thread
+    int32 GetMappedReadbackCount() const
+    {
+        return MappedReadbackCounter.GetValue();
+    }
+
+    FNVTextureReadbackRingStats GetStats() const;
+
+    /// Stats of all the readback rings together
+    static FNVTextureReadbackRingStats GetGlobalStats();
+
+    /// Number of readbacks issued but not unmapped yet in all the rings, safe to call from any thread
+    static int32 GetTotalPendingReadbackCount();
+
+    /// Check the ordering and retirement of the ring with fake staging textures, the result is printed to the log
+    static bool RunSelfTest();
+
+protected:
+    struct FNVReadbackSlot
+    {
+        FIntPoint TextureSize;
+        EPixelFormat PixelFormat;
+        bool bAllocated;
+        bool bPending;
+        uint64 FrameNumber;
+        OnReadbackMappedCallback Callback;
+        /// The readback of the slot which is mapped but not unmapped yet
+        TSharedPtr<FNVMappedReadback, ESPMode::ThreadSafe> MappedReadback;
+    };
+
+    void RetireOldestReadback(bool bFlushed);
+    /// Wait for the mapped readback of a slot to be released then unmap it
+    void WaitForMappedReadback(int32 SlotIndex);
+    void UnmapSlot(int32 SlotIndex);
+
+protected:
+    TSharedRef<INVTextureReadbackStaging, ESPMode::ThreadSafe> Staging;
+    int32 RingDepth;
+    TArray<FNVReadbackSlot> Slots;
+    /// Index of the slot to use for the next readback
+    int32 NextSlotIndex;
+    /// Index of the slot of the oldest pending readback
+    int32 OldestSlotIndex;
+    FThreadSafeCounter PendingReadbackCounter;
+    FThreadSafeCounter MappedReadbackCounter;
+
+    mutable FCriticalSection StatsLock;
+    FNVTextureReadbackRingStats Stats;
+};
@@ -7,10 +7,14 @@
 #pragma once
 
 #include "NVSceneCapturerUtils.h"
+#include "NVTextureReadbackRing.h"
 #include "NVTextureReader.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogNVTextureReader, Log, All)
 
+class FNVRHITextureReadbackStaging;
+struct FNVPixelsTaskChain;
+
 // This class read the pixels data from a texture target
 USTRUCT()
 struct NVSCENECAPTURER_API FNVTextureReader
@@ -36,12 +40,36 @@ public:
     /// @param Callback  The function to call after all the pixels data are read from the source texture
     /// @param bIgnoreAlpha          If true, just set the alpha value of the readback pixels to 1, otherwise read it correctly
     /// NOTE: This function is async, the reading process will run on the rendering thread in parallel with the game thread
+    /// The rendering thread only map the pixels, they are copied out and passed to the callback on a worker thread
+    /// The callbacks of a reader are called one at a time, in the order the pixels were read
     virtual bool ReadPixelsData(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha = false);
 
     /// Read back the pixels data from the current source texture
     /// NOTE: This function is sync, the pixels data is returned right away but it may cause the game to hitches since it flush the rendering commands
     virtual bool ReadPixelsData(FNVTexturePixelData& OutPixelsData);
 
+    /// Change the number of staging textures the async readbacks rotate through
+    /// With a depth of N, the readback of a frame is only mapped after N - 1 newer readbacks were issued (or N - 1 frames passed)
+    /// so the rendering thread doesn't need to wait for the GPU, a depth of 1 map the texture right after the copy
+    void SetReadbackRingDepth(int32 NewRingDepth);
+    int32 GetReadbackRingDepth() const
+    {
+        return ReadbackRingDepth;
+    }
+
+    /// Complete the pending readbacks which are old enough, need to be called every frame so the last readbacks are completed even when no new one is issued
+    void UpdatePendingReadbacks();
+    /// Complete all the pending readbacks as soon as possible
+    void FlushPendingReadbacks();
+    /// Complete all the pending readbacks and block until all their callbacks finished
+    /// NOTE: Must be called on the game thread before the objects the callbacks use are destroyed, the callbacks run on worker threads
+    void WaitForPendingCallbacks();
+
+    FNVTextureReadbackRingStats GetReadbackStats() const;
+
+    /// Number of async readbacks of all the texture readers which are requested but their callback is not finished yet
+    static int32 GetInFlightReadbackCount();
+
 protected:
     /// Change the information of the texture to read from
     /// @param NewSourceTexture          The texture to read from
@@ -78,18 +106,22 @@ protected:
         const FIntPoint& NewReadbackSize = FIntPoint::ZeroValue);
 
     /// Read the pixel data from a render target
+    /// @param ReadbackRing          The ring of staging textures to read back through
+    /// @param ReadbackStaging       The staging textures of the ring
     /// @param SourceTexture         The texture to read from
     /// @param SourceRect            The area where to read from the SourceRenderTarget
     /// @param TargetPixelFormat     The pixel format of the read back pixels data
     /// @param TargetSize            The size of the read back pixels area
     /// @param bIgnoreAlpha          If true, just set the alpha value of the readback pixels to 1, otherwise read it correctly
-    /// @param Callback              Function to call after finished reading pixels data
-    static bool ReadPixelsRaw(const FTexture2DRHIRef& SourceTexture,
+    /// @param Callback              Function to call on the rendering thread after the pixels are mapped, it must release the mapped readback
+    static bool ReadPixelsRaw(const TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe>& ReadbackRing,
+                              const TSharedPtr<FNVRHITextureReadbackStaging, ESPMode::ThreadSafe>& ReadbackStaging,
+                              const FTexture2DRHIRef& SourceTexture,
                               const FIntRect& SourceRect,
                               EPixelFormat TargetPixelFormat,
                               const FIntPoint& TargetSize,
                               bool bIgnoreAlpha,
-                              OnFinishedReadingRawPixelsCallback Callback);
+                              FNVTextureReadbackRing::OnReadbackMappedCallback Callback);
 
     static FNVTexturePixelData BuildPixelData(uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize);
     static void BuildPixelData(FNVTexturePixelData& OutPixelsData, uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize);
@@ -106,11 +138,21 @@ protected:
     static void CopyTexture2d(class IRendererModule* RendererModule, FRHICommandListImmediate& RHICmdList, const FTexture2DRHIRef& SourceTexture, const FIntRect& SourceRect,
                               FTexture2DRHIRef& TargetTexture, const FIntRect& TargetRect, bool bOverwriteAlpha = true);
 
+    /// Create the readback ring if it doesn't exist yet
+    void InitReadbackRing();
+
 protected:
     FTexture2DRHIRef SourceTexture;
     FIntRect SourceRect;
     EPixelFormat ReadbackPixelFormat;
     FIntPoint ReadbackSize;
+
+    int32 ReadbackRingDepth;
+    /// NOTE: The ring is only used on the rendering thread, the reader just keep a reference to it
+    TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> ReadbackRing;
+    TSharedPtr<FNVRHITextureReadbackStaging, ESPMode::ThreadSafe> ReadbackStaging;
+    /// The last task copying the mapped pixels of this reader, the next one wait for it so the callbacks keep their order
+    TSharedPtr<FNVPixelsTaskChain, ESPMode::ThreadSafe> PixelsTaskChain;
 };
 
 class UTextureRenderTarget2D;
@@ -18,6 +18,7 @@
 #include "DrawDebugHelpers.h"
 #include "NVSceneCapturerActor.h"
 #include "NVSceneCapturerUtils.h"
+#include "NVCapturableActorIndex.h"
 
 ANVSceneCapturerHUD::ANVSceneCapturerHUD(const FObjectInitializer& ObjectInitializer)
     : Super(ObjectInitializer)
@@ -127,17 +128,17 @@ void ANVSceneCapturerHUD::DrawDebugInfo()
     UWorld* World = GetWorld();
     if (World)
     {
-        for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+        // Only the tagged actors have debug info to draw so we don't need to check all the actors in the world
+        FNVCapturableActorIndex* ActorIndex = bShowExportActorDebug ? FNVCapturableActorIndex::Get(World) : nullptr;
+        if (ActorIndex)
         {
-            AActor* CheckActor = *ActorIt;
-            if (!CheckActor)
+            for (const FNVCapturableActorEntry& ActorEntry : ActorIndex->GetEntries())
             {
-                continue;
-            }
-
-            if (bShowExportActorDebug)
-            {
-                DrawDebugInfo_ExportedActor(CheckActor);
+                const AActor* CheckActor = ActorEntry.Actor.Get();
+                if (CheckActor)
+                {
+                    DrawDebugInfo_ExportedActor(CheckActor);
+                }
             }
         }
 